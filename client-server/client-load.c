@@ -0,0 +1,597 @@
+/**
+ *  \file client-load.c
+ * \brief TLS1.2 handshake load generator of the client/server
+ * exchange utility. Keeps a number of connections busy making
+ * handshakes against a server and reports where the handshake
+ * time goes: in each engine callback and waiting on the network.
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Atmel nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <openssl/rand.h>
+#include <openssl/rsa.h>
+#include <ecdsa/ecs_locl.h>
+#include <ecdh/ech_locl.h>
+
+#include "tlsutil.h"
+
+/* Defined in the tlsutil.c following an example in the openssl/apps/s_cb.c file */
+extern int verify_quiet;
+
+/*
+ * Every connection runs on its own thread, so the time a handshake spends
+ * in each phase is summed in thread local counters. The crypto methods in
+ * use (the engine's or OpenSSL's) are wrapped by copies that time each call
+ * and the socket BIO times every read and write. A call made from inside
+ * another timed call (the RAND_bytes of an ECDSA nonce, for instance) counts
+ * for the outer phase only, so the phases never overlap.
+ */
+
+#define LOAD_MAX_CONNECTIONS    (256)
+#define LOAD_DEFAULT_SECONDS    (10)
+
+enum {
+    LOAD_PHASE_SIGN,
+    LOAD_PHASE_ECDH,
+    LOAD_PHASE_VERIFY,
+    LOAD_PHASE_RAND,
+    LOAD_PHASE_NETWORK,
+    LOAD_PHASES
+};
+
+static const char *load_phase_names[LOAD_PHASES] = {
+    "sign", "ecdh", "verify", "rand", "network"
+};
+
+/**
+ * \brief Timing of one handshake
+ */
+typedef struct load_sample_s {
+    uint64_t total_ns;
+    uint64_t phase_ns[LOAD_PHASES];
+} load_sample_t;
+
+/**
+ * \brief State of one connection thread
+ */
+typedef struct load_conn_s {
+    pthread_t thread;
+    load_sample_t *samples;
+    size_t count;
+    size_t capacity;
+    unsigned long failed;
+    unsigned long resumed;
+} load_conn_t;
+
+static __thread uint64_t load_phase_ns[LOAD_PHASES];
+static __thread int load_phase_depth;
+
+static SSL_CTX *load_ctx;
+static const load_options_t *load_opts;
+static struct sockaddr_in load_addr;
+static volatile int load_stop;
+static unsigned long load_started;
+
+static const ECDSA_METHOD *inner_ecdsa;
+static const ECDH_METHOD *inner_ecdh;
+static const RAND_METHOD *inner_rand;
+static const RSA_METHOD *inner_rsa;
+static ECDSA_METHOD timed_ecdsa;
+static ECDH_METHOD timed_ecdh;
+static RAND_METHOD timed_rand;
+static RSA_METHOD timed_rsa;
+
+static uint64_t load_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t load_phase_enter(void)
+{
+    return load_phase_depth++ == 0 ? load_now_ns() : 0;
+}
+
+static void load_phase_leave(int phase, uint64_t start)
+{
+    if (--load_phase_depth == 0) {
+        load_phase_ns[phase] += load_now_ns() - start;
+    }
+}
+
+static ECDSA_SIG* load_ecdsa_do_sign(const unsigned char *dgst, int dgst_len,
+                                     const BIGNUM *inv, const BIGNUM *rp, EC_KEY *eckey)
+{
+    uint64_t start = load_phase_enter();
+    ECDSA_SIG *sig = inner_ecdsa->ecdsa_do_sign(dgst, dgst_len, inv, rp, eckey);
+
+    load_phase_leave(LOAD_PHASE_SIGN, start);
+    return sig;
+}
+
+static int load_ecdsa_do_verify(const unsigned char *dgst, int dgst_len,
+                                const ECDSA_SIG *sig, EC_KEY *eckey)
+{
+    uint64_t start = load_phase_enter();
+    int ret = inner_ecdsa->ecdsa_do_verify(dgst, dgst_len, sig, eckey);
+
+    load_phase_leave(LOAD_PHASE_VERIFY, start);
+    return ret;
+}
+
+static int load_ecdh_compute_key(void *out, size_t outlen, const EC_POINT *pub_key, EC_KEY *ecdh,
+                                 void *(*KDF)(const void *in, size_t inlen, void *out, size_t *outlen))
+{
+    uint64_t start = load_phase_enter();
+    int ret = inner_ecdh->compute_key(out, outlen, pub_key, ecdh, KDF);
+
+    load_phase_leave(LOAD_PHASE_ECDH, start);
+    return ret;
+}
+
+static int load_rand_bytes(unsigned char *buf, int num)
+{
+    uint64_t start = load_phase_enter();
+    int ret = inner_rand->bytes(buf, num);
+
+    load_phase_leave(LOAD_PHASE_RAND, start);
+    return ret;
+}
+
+static int load_rand_pseudorand(unsigned char *buf, int num)
+{
+    uint64_t start = load_phase_enter();
+    int ret = inner_rand->pseudorand(buf, num);
+
+    load_phase_leave(LOAD_PHASE_RAND, start);
+    return ret;
+}
+
+static int load_rsa_priv_enc(int flen, const unsigned char *from, unsigned char *to, RSA *rsa, int padding)
+{
+    uint64_t start = load_phase_enter();
+    int ret = inner_rsa->rsa_priv_enc(flen, from, to, rsa, padding);
+
+    load_phase_leave(LOAD_PHASE_SIGN, start);
+    return ret;
+}
+
+static int load_rsa_pub_dec(int flen, const unsigned char *from, unsigned char *to, RSA *rsa, int padding)
+{
+    uint64_t start = load_phase_enter();
+    int ret = inner_rsa->rsa_pub_dec(flen, from, to, rsa, padding);
+
+    load_phase_leave(LOAD_PHASE_VERIFY, start);
+    return ret;
+}
+
+static long load_bio_callback(BIO *bio, int oper, const char *argp, int argi, long argl, long ret)
+{
+    static __thread uint64_t start;
+
+    if (oper == BIO_CB_READ || oper == BIO_CB_WRITE) {
+        start = load_phase_enter();
+    } else if (oper == (BIO_CB_READ | BIO_CB_RETURN) || oper == (BIO_CB_WRITE | BIO_CB_RETURN)) {
+        load_phase_leave(LOAD_PHASE_NETWORK, start);
+    }
+    return ret;
+}
+
+/**
+ *
+ * \brief Replaces the ECDSA, ECDH, RAND and RSA methods in use
+ *        with timed copies that call the originals. A method
+ *        that comes from an engine is replaced in the engine:
+ *        the engine falls back to the default methods for the
+ *        work it does in software, so those must stay the
+ *        OpenSSL ones or the timed copy would call itself.
+ *
+ * \return 1 for success
+ */
+static int load_install_timers(void)
+{
+    ENGINE *e_ecdsa;
+    ENGINE *e_ecdh;
+    ENGINE *e_rsa;
+    RSA *rsa;
+
+    e_ecdsa = ENGINE_get_default_ECDSA();
+    inner_ecdsa = e_ecdsa ? ENGINE_get_ECDSA(e_ecdsa) : ECDSA_get_default_method();
+    e_ecdh = ENGINE_get_default_ECDH();
+    inner_ecdh = e_ecdh ? ENGINE_get_ECDH(e_ecdh) : ECDH_get_default_method();
+    e_rsa = ENGINE_get_default_RSA();
+    if (e_rsa) {
+        /* The engine fills its RSA method in when the first key is made */
+        rsa = RSA_new_method(e_rsa);
+        RSA_free(rsa);
+    }
+    inner_rsa = e_rsa ? ENGINE_get_RSA(e_rsa) : RSA_get_default_method();
+    /* RAND_set_rand_method() drops the engine reference, the ones taken above keep it loaded */
+    inner_rand = RAND_get_rand_method();
+    if (inner_ecdsa == NULL || inner_ecdh == NULL || inner_rsa == NULL || inner_rand == NULL) {
+        return 0;
+    }
+
+    timed_ecdsa = *inner_ecdsa;
+    timed_ecdsa.name = "timed ECDSA";
+    timed_ecdsa.ecdsa_do_sign = load_ecdsa_do_sign;
+    timed_ecdsa.ecdsa_do_verify = load_ecdsa_do_verify;
+    if (e_ecdsa) {
+        if (!ENGINE_set_ECDSA(e_ecdsa, &timed_ecdsa)) {
+            return 0;
+        }
+    } else {
+        ECDSA_set_default_method(&timed_ecdsa);
+    }
+
+    timed_ecdh = *inner_ecdh;
+    timed_ecdh.name = "timed ECDH";
+    timed_ecdh.compute_key = load_ecdh_compute_key;
+    if (e_ecdh) {
+        if (!ENGINE_set_ECDH(e_ecdh, &timed_ecdh)) {
+            return 0;
+        }
+    } else {
+        ECDH_set_default_method(&timed_ecdh);
+    }
+
+    timed_rsa = *inner_rsa;
+    timed_rsa.name = "timed RSA";
+    timed_rsa.rsa_priv_enc = load_rsa_priv_enc;
+    timed_rsa.rsa_pub_dec = load_rsa_pub_dec;
+    if (e_rsa) {
+        if (!ENGINE_set_RSA(e_rsa, &timed_rsa)) {
+            return 0;
+        }
+    } else {
+        RSA_set_default_method(&timed_rsa);
+    }
+
+    /* The engine draws on RAND_SSLeay() directly, so its method can be the default */
+    timed_rand = *inner_rand;
+    timed_rand.bytes = load_rand_bytes;
+    timed_rand.pseudorand = load_rand_pseudorand;
+    RAND_set_rand_method(&timed_rand);
+
+    return 1;
+}
+
+static int load_add_sample(load_conn_t *conn, const load_sample_t *sample)
+{
+    load_sample_t *samples;
+    size_t capacity;
+
+    if (conn->count == conn->capacity) {
+        capacity = conn->capacity ? conn->capacity * 2 : 1024;
+        samples = realloc(conn->samples, capacity * sizeof(*samples));
+        if (samples == NULL) {
+            return 0;
+        }
+        conn->samples = samples;
+        conn->capacity = capacity;
+    }
+    conn->samples[conn->count++] = *sample;
+    return 1;
+}
+
+/**
+ *
+ * \brief Makes one TCP connection and TLS handshake
+ *
+ * \param[in, out] session Session to resume, replaced by the new
+ *       one when resumption is on
+ * \param[out] sample Timing of the handshake
+ * \param[out] resumed Set if the session was resumed
+ * \return 1 for success
+ */
+static int load_handshake(SSL_SESSION **session, load_sample_t *sample, int *resumed)
+{
+    SSL *ssl = NULL;
+    uint64_t start, connected;
+    int sd;
+    int ok = 0;
+
+    memset(load_phase_ns, 0, sizeof(load_phase_ns));
+    load_phase_depth = 0;
+    start = load_now_ns();
+
+    sd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sd < 0) {
+        return 0;
+    }
+    if (connect(sd, (struct sockaddr *)&load_addr, sizeof(load_addr)) != 0) {
+        goto done;
+    }
+    connected = load_now_ns();
+    load_phase_ns[LOAD_PHASE_NETWORK] += connected - start;
+
+    ssl = SSL_new(load_ctx);
+    if (ssl == NULL) {
+        goto done;
+    }
+    SSL_set_fd(ssl, sd);
+    BIO_set_callback(SSL_get_rbio(ssl), load_bio_callback);
+    if (*session) {
+        SSL_set_session(ssl, *session);
+    }
+    if (SSL_connect(ssl) != 1) {
+        goto done;
+    }
+    sample->total_ns = load_now_ns() - start;
+    memcpy(sample->phase_ns, load_phase_ns, sizeof(sample->phase_ns));
+    *resumed = SSL_session_reused(ssl);
+    if (load_opts->resume) {
+        if (*session) {
+            SSL_SESSION_free(*session);
+        }
+        *session = SSL_get1_session(ssl);
+    }
+    SSL_shutdown(ssl);
+    ok = 1;
+done:
+    if (ssl) {
+        SSL_free(ssl);
+    }
+    close(sd);
+    ERR_clear_error();
+    return ok;
+}
+
+static void* load_connection(void *arg)
+{
+    load_conn_t *conn = (load_conn_t *)arg;
+    SSL_SESSION *session = NULL;
+    load_sample_t sample;
+    int resumed;
+
+    while (!load_stop) {
+        if (load_opts->handshakes &&
+            __atomic_fetch_add(&load_started, 1, __ATOMIC_RELAXED) >= load_opts->handshakes) {
+            break;
+        }
+        resumed = 0;
+        if (!load_handshake(&session, &sample, &resumed)) {
+            conn->failed++;
+            continue;
+        }
+        if (resumed) {
+            conn->resumed++;
+        }
+        if (!load_add_sample(conn, &sample)) {
+            break;
+        }
+    }
+    if (session) {
+        SSL_SESSION_free(session);
+    }
+    return NULL;
+}
+
+static int load_compare_ns(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/**
+ *
+ * \brief Prints the mean, percentiles and maximum of one phase
+ *        in milliseconds. Sorts values in place.
+ */
+static void load_print_phase(const char *name, uint64_t *values, size_t count)
+{
+    uint64_t sum = 0;
+    size_t i;
+
+    qsort(values, count, sizeof(*values), load_compare_ns);
+    for (i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    printf("%-10s %9.3f %9.3f %9.3f %9.3f %9.3f\n", name, (double)sum / count / 1e6,
+           values[(count - 1) * 50 / 100] / 1e6, values[(count - 1) * 90 / 100] / 1e6,
+           values[(count - 1) * 99 / 100] / 1e6, values[count - 1] / 1e6);
+}
+
+static void load_report(load_conn_t *conns, int connections, double elapsed)
+{
+    uint64_t *values = NULL;
+    unsigned long failed = 0;
+    unsigned long resumed = 0;
+    size_t count = 0;
+    size_t n;
+    uint64_t other;
+    int i, j, phase;
+
+    for (i = 0; i < connections; i++) {
+        count += conns[i].count;
+        failed += conns[i].failed;
+        resumed += conns[i].resumed;
+    }
+    printf("%zu handshakes in %.2f s, %.1f handshakes/s, %lu failed, %lu resumed\n",
+           count, elapsed, count / elapsed, failed, resumed);
+    if (count == 0) {
+        return;
+    }
+    values = malloc(count * sizeof(*values));
+    if (values == NULL) {
+        return;
+    }
+
+    printf("%-10s %9s %9s %9s %9s %9s  (ms per handshake)\n", "phase", "mean", "p50", "p90", "p99", "max");
+    for (phase = -1; phase <= LOAD_PHASES; phase++) {
+        n = 0;
+        for (i = 0; i < connections; i++) {
+            const load_sample_t *s = conns[i].samples;
+            const load_sample_t *end = s + conns[i].count;
+            for (; s < end; s++) {
+                if (phase < 0) {
+                    values[n++] = s->total_ns;
+                } else if (phase < LOAD_PHASES) {
+                    values[n++] = s->phase_ns[phase];
+                } else {
+                    /* TLS processing outside the engine callbacks: hashing, record crypto, parsing */
+                    other = s->total_ns;
+                    for (j = 0; j < LOAD_PHASES; j++) {
+                        other -= s->phase_ns[j];
+                    }
+                    values[n++] = other;
+                }
+            }
+        }
+        load_print_phase(phase < 0 ? "handshake" : phase < LOAD_PHASES ? load_phase_names[phase] : "other",
+                         values, n);
+    }
+    free(values);
+}
+
+/**
+ *
+ * \brief Opens options->connections concurrent connections to
+ *        the server, each making TLS1.2 handshakes one after
+ *        the other until the time or handshake count runs out,
+ *        and prints the handshake rate and where the handshake
+ *        time went
+ *
+ * \param[in] engine_id Engine ID (use Software libraries if
+ *       NULL)
+ * \param[in] ca_path Path to CA (Certificate Authority)
+ * \param[in] chain_file Chain File Name (Certificate Bundle)
+ * \param[in] cert_file Certificate File Name (NULL to take the
+ *       certificate chain from the engine)
+ * \param[in] key_file Private Key File Name
+ * \param[in] cipher_list Cipher list string
+ * \param[in] ip_address The server IP address
+ * \param[in] port_number The server port number
+ * \param[in] options Connections, duration and resumption
+ * \return 0 for success
+ */
+int load_client(const char *engine_id, const char *ca_path, const char *chain_file,
+                const char *cert_file, const char *key_file, const char *cipher_list,
+                const char *ip_address, uint16_t port_number, const load_options_t *options)
+{
+    load_conn_t *conns = NULL;
+    load_options_t opts = *options;
+    uint64_t start;
+    int err;
+    int i;
+
+    if (opts.connections <= 0 || opts.connections > LOAD_MAX_CONNECTIONS) {
+        fprintf(stderr, "load_client(): from 1 to %d connections\n", LOAD_MAX_CONNECTIONS);
+        return 1;
+    }
+    if (opts.seconds == 0 && opts.handshakes == 0) {
+        opts.seconds = LOAD_DEFAULT_SECONDS;
+    }
+    load_opts = &opts;
+
+    init_openssl();
+    if (!init_openssl_threads()) {
+        return 8;
+    }
+    load_ctx = create_context(0);
+    CHK_NULL(load_ctx);
+
+    err = setup_engine(engine_id);
+    if (err == 0) {
+        return 9;
+    }
+    if (!load_install_timers()) {
+        fprintf(stderr, "load_client(): cannot wrap the crypto methods\n");
+        return 9;
+    }
+
+    err = SSL_CTX_set_cipher_list(load_ctx, cipher_list);
+    if (err == 0) {
+        fprintf(stderr, "SSL_CTX_set_cipher_list() error\n");
+        return 10;
+    }
+
+    verify_quiet = 1;
+    SSL_CTX_set_verify(load_ctx, SSL_VERIFY_PEER, verify_callback);
+
+    if (engine_id && !cert_file) {
+        /* Take the certificate chain from the engine */
+        err = configure_context_engine(load_ctx, engine_id, ca_path);
+    } else {
+        err = configure_context(load_ctx, ca_path, chain_file, cert_file);
+    }
+    if (err == 0) {
+        return 11;
+    }
+
+    err = load_private_key(engine_id, load_ctx, key_file);
+    if (err == 0) {
+        return 13;
+    }
+    memset(&load_addr, '\0', sizeof(load_addr));
+    load_addr.sin_family = AF_INET;
+    load_addr.sin_addr.s_addr = inet_addr(ip_address);
+    load_addr.sin_port = htons(port_number);
+
+    conns = calloc(opts.connections, sizeof(*conns));
+    CHK_NULL(conns);
+
+    fprintf(stderr, "%d connections to %s, port %u, cipher %s%s\n", opts.connections,
+            inet_ntoa(load_addr.sin_addr), port_number, cipher_list, opts.resume ? ", resuming" : "");
+    load_stop = 0;
+    load_started = 0;
+    start = load_now_ns();
+    for (i = 0; i < opts.connections; i++) {
+        pthread_create(&conns[i].thread, NULL, load_connection, &conns[i]);
+    }
+    if (opts.seconds) {
+        sleep(opts.seconds);
+        load_stop = 1;
+    }
+    for (i = 0; i < opts.connections; i++) {
+        pthread_join(conns[i].thread, NULL);
+    }
+
+    load_report(conns, opts.connections, (load_now_ns() - start) / 1e9);
+
+    for (i = 0; i < opts.connections; i++) {
+        free(conns[i].samples);
+    }
+    free(conns);
+    SSL_CTX_free(load_ctx);
+    cleanup_openssl();
+
+    return 0;
+}
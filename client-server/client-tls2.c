@@ -49,7 +49,8 @@
  *       NULL)
  * \param[in] ca_path Path to CA (Certificate Authority)
  * \param[in] chain_file Chain File Name (Certificate Bundle)
- * \param[in] cert_file Certificate File Name
+ * \param[in] cert_file Certificate File Name (NULL to take the
+ *       certificate chain from the engine)
  * \param[in] key_file Private Key File Name
  * \param[in] cipher_list Cipher list string
  *                    (ECDH-ECDSA-AES128-SHA256,
@@ -91,7 +92,12 @@ int connect_client(const char *engine_id, const char *ca_path, const char *chain
 
     SSL_CTX_set_verify(ctx, verify, verify_callback);
 
-    err = configure_context(ctx, ca_path, chain_file, cert_file);
+    if (engine_id && !cert_file) {
+        /* Take the certificate chain from the engine */
+        err = configure_context_engine(ctx, engine_id, ca_path);
+    } else {
+        err = configure_context(ctx, ca_path, chain_file, cert_file);
+    }
     if (err == 0) {
         return 11;
     }
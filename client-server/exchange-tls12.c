@@ -59,7 +59,7 @@ void usage(void)
            "\t./exchange-tls12 -s -c <cipher_list> "
            "-p <ca_path> -b <chain_file>"
            "-f <cert_file> -k <key_file> -d <depth>"
-           "-C <cmd> [-E] [-e ateccx08]"
+           "-C <cmd> [-E] [-M <n>] [-L <n> [-T <sec>] [-N <n>] [-R]] [-W <n> [-K]] [-e ateccx08]"
            "[-I <IP_address>] [-P <port_number>]"
            " [-v] [h|?]");
     printf("\n\nWhere:\n");
@@ -72,7 +72,8 @@ void usage(void)
            "\t\tECCX08_CMD_VERIFY_DEVICE_CERT:\t %d\n"
            "\t\tECCX08_CMD_GET_ROOT_CERT:\t %d\n"
            "\t\tECCX08_CMD_EXTRACT_ALL_CERTS:\t %d\n"
-           "\t\tECCX08_CMD_GET_PRIV_KEY:\t %d\n",
+           "\t\tECCX08_CMD_GET_PRIV_KEY:\t %d\n"
+           "\t\tECCX08_CMD_GET_STATS:\t\t %d\n",
            ECCX08_CMD_GET_VERSION,
            ECCX08_CMD_GET_SIGNER_CERT,
            ECCX08_CMD_GET_PUB_KEY,
@@ -81,13 +82,24 @@ void usage(void)
            ECCX08_CMD_VERIFY_DEVICE_CERT,
            ECCX08_CMD_GET_ROOT_CERT,
            ECCX08_CMD_EXTRACT_ALL_CERTS,
-           ECCX08_CMD_GET_PRIV_KEY);
+           ECCX08_CMD_GET_PRIV_KEY,
+           ECCX08_CMD_GET_STATS);
     printf("\t-E Extract all certificates and save to files in /tmp directory\n");
+    printf("\t-M <n> Extract certificates from the kits on ports 0..n-1 in parallel and print the timing\n");
+    printf("\t-L <n> Load mode: keep n client connections making handshakes and print\n"
+           "\t\thandshakes/s and where the handshake time goes (needs -c)\n");
+    printf("\t-T <sec> Load mode run time (10 s if neither -T nor -N is given)\n");
+    printf("\t-N <n> Load mode number of handshakes\n");
+    printf("\t-R Load mode resumes the previous session of each connection\n");
+    printf("\t-W <n> Server mode with n worker threads serving any number of clients\n"
+           "\t\tuntil SIGINT/SIGTERM (needs -s)\n");
+    printf("\t-K Worker threads resume sessions by session ID only, no session tickets\n");
     printf("\t-c <cipher_list> specify the cipher list, utility in Client mode\n");
     printf("\t-s Use the utility in Server mode\n");
     printf("\t-p <ca_path> - Path to CA (Certificate Authority)\n");
     printf("\t-b <chain_file> - Chain File Name (Certificate Bundle)\n");
-    printf("\t-f <cert_file> - Certificate File Name\n");
+    printf("\t-f <cert_file> - Certificate File Name\n"
+           "\t\t(with -e and without -b/-f the certificate chain is taken from the engine)\n");
     printf("\t-k <key_file> - Private Key File Name\n");
     printf("\t-e <engine ID> Use utility with an engine (supported ateccx08 only)\n");
     printf("\t-d <depth> - the maximum length of the server certificate chain\n");
@@ -100,6 +112,68 @@ void usage(void)
     exit(1);
 }
 
+/**
+ *
+ * \brief Extracts the certificates from the kits on ports
+ *        0..num_devices-1 in parallel and prints the wall-clock
+ *        time of each phase
+ *
+ * \param[in] engine_id Engine ID
+ * \param[in] num_devices the number of devices to read
+ * \return 0 for success
+ */
+int extract_pool(const char *engine_id, int num_devices)
+{
+    ENGINE *e = NULL;
+    ATCAIfaceCfg cfgs[ECCX08_EXTRACT_POOL_MAX];
+    ATCAIfaceCfg *pcfgs[ECCX08_EXTRACT_POOL_MAX];
+    eccx08_extract_result_t *results = NULL;
+    eccx08_extract_pool_t pool;
+    int rc = 1;
+    int i;
+
+    if (num_devices <= 0 || num_devices > ECCX08_EXTRACT_POOL_MAX) {
+        fprintf(stderr, "extract_pool(): from 1 to %d devices\n", ECCX08_EXTRACT_POOL_MAX);
+        return 1;
+    }
+    results = OPENSSL_malloc(num_devices * sizeof(*results));
+    if (results == NULL) {
+        return 1;
+    }
+    for (i = 0; i < num_devices; i++) {
+        cfgs[i] = cfg_ecc508_kitcdc_default;
+        cfgs[i].atcauart.port = i;
+        pcfgs[i] = &cfgs[i];
+    }
+    pool.cfgs = pcfgs;
+    pool.count = num_devices;
+    pool.results = results;
+    pool.wall_us = 0;
+
+    e = ENGINE_by_id(engine_id);
+    if (e == NULL) {
+        goto done;
+    }
+    rc = ENGINE_ctrl(e, ECCX08_CMD_EXTRACT_POOL, 0, &pool, 0) ? 0 : 1;
+    for (i = 0; i < num_devices; i++) {
+        printf("device %d: status 0x%02X, total %llu us\n"
+               "\tsigner: read %llu us, rebuild %llu us, verify %llu us\n"
+               "\tdevice: read %llu us, rebuild %llu us, verify %llu us\n",
+               i, results[i].status, (unsigned long long)results[i].total_us,
+               (unsigned long long)results[i].read_us[ECCX08_EXTRACT_SIGNER],
+               (unsigned long long)results[i].build_us[ECCX08_EXTRACT_SIGNER],
+               (unsigned long long)results[i].verify_us[ECCX08_EXTRACT_SIGNER],
+               (unsigned long long)results[i].read_us[ECCX08_EXTRACT_DEVICE],
+               (unsigned long long)results[i].build_us[ECCX08_EXTRACT_DEVICE],
+               (unsigned long long)results[i].verify_us[ECCX08_EXTRACT_DEVICE]);
+    }
+    printf("%d devices in %llu us\n", num_devices, (unsigned long long)pool.wall_us);
+    ENGINE_free(e);
+done:
+    OPENSSL_free(results);
+    return rc;
+}
+
 /**
  *
  * \brief Main exchange-tls12 function. For help on arguments
@@ -126,8 +200,12 @@ int main(int argc, char *argv[])
     char *ip_address = "127.0.0.1";
     uint16_t port_number = PORT_NUMBER_DEFAULT;
     char cwd[200];
-    char cmd_buffer[256];
-    int buf_len = 128;
+    char cmd_buffer[8192];      /* Room for the ECCX08_CMD_GET_STATS text */
+    int buf_len = sizeof(cmd_buffer);
+    int num_devices = 0;
+    int workers = 0;
+    int tickets = 1;
+    load_options_t load = { 0, 0, 0, 0 };
 
     verify_depth = 0;
 
@@ -139,7 +217,7 @@ int main(int argc, char *argv[])
     }
     snprintf(cmd_buffer, 256, "%s/certstore", cwd);
 
-    while ((ch = getopt(argc, argv, "C:Ec:sp:b:f:k:e:d:I:P:vh?")) != (char)-1) {
+    while ((ch = getopt(argc, argv, "C:EM:L:T:N:RW:Kc:sp:b:f:k:e:d:I:P:vh?")) != (char)-1) {
         switch (ch) {
             case 'C':
                 cmd = strtol(optarg, NULL, 0);
@@ -147,6 +225,27 @@ int main(int argc, char *argv[])
             case 'E':
                 cmd = ECCX08_CMD_EXTRACT_ALL_CERTS;
                 break;
+            case 'M':
+                num_devices = strtol(optarg, NULL, 0);
+                break;
+            case 'L':
+                load.connections = strtol(optarg, NULL, 0);
+                break;
+            case 'T':
+                load.seconds = strtoul(optarg, NULL, 0);
+                break;
+            case 'N':
+                load.handshakes = strtoul(optarg, NULL, 0);
+                break;
+            case 'R':
+                load.resume = 1;
+                break;
+            case 'W':
+                workers = strtol(optarg, NULL, 0);
+                break;
+            case 'K':
+                tickets = 0;
+                break;
             case 'c':
                 is_client = 1;
                 cipher_list = strdup(optarg);
@@ -190,6 +289,21 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (num_devices) {
+        if (!engine_id) {
+            fprintf(stderr, "\nNo Engine specified - cannot extract certificates\n");
+            return (10);
+        }
+        init_openssl();
+        err = setup_engine(engine_id);
+        if (err == 0) {
+            err = 19;
+            goto done;
+        }
+        err = extract_pool(engine_id, num_devices);
+        goto done;
+    }
+
     if (cmd != -1) {
         if (!engine_id) {
             fprintf(stderr, "\nNo Engine specified - cannot run a command\n");
@@ -220,17 +334,21 @@ int main(int argc, char *argv[])
         fprintf(stderr, "\nCannot specify both -c or -s options");
         usage();
     }
-    if (!ca_path) {
-        fprintf(stderr, "\nMust specify CA path");
-        usage();
-    }
-    if (!chain_file) {
-        fprintf(stderr, "\nMust specify Chain File (certificate bundle)");
-        usage();
-    }
-    if (!cert_file) {
-        fprintf(stderr, "\nMust specify Certificate File");
-        usage();
+    if (engine_id && !cert_file && !chain_file) {
+        fprintf(stderr, "\nNo Certificate File specified - using the certificate chain from the engine\n");
+    } else {
+        if (!ca_path) {
+            fprintf(stderr, "\nMust specify CA path");
+            usage();
+        }
+        if (!chain_file) {
+            fprintf(stderr, "\nMust specify Chain File (certificate bundle)");
+            usage();
+        }
+        if (!cert_file) {
+            fprintf(stderr, "\nMust specify Certificate File");
+            usage();
+        }
     }
     if (!key_file) {
         fprintf(stderr, "\nMust specify Private Key File");
@@ -241,6 +359,24 @@ int main(int argc, char *argv[])
         fprintf(stderr, "\nNo Engine specified - using software crypto/ssl libraries\n");
     }
 
+    if (load.connections) {
+        if (!is_client) {
+            fprintf(stderr, "\nLoad mode needs a cipher list (-c)");
+            usage();
+        }
+        return load_client(engine_id, ca_path, chain_file, cert_file, key_file, cipher_list,
+                           ip_address, port_number, &load);
+    }
+
+    if (workers) {
+        if (!is_server) {
+            fprintf(stderr, "\nWorker threads need the server mode (-s)");
+            usage();
+        }
+        return serve_concurrent(engine_id, ca_path, chain_file, cert_file, key_file,
+                                port_number, workers, tickets);
+    }
+
     if (is_server) {
         err = connect_server(engine_id, ca_path, chain_file, cert_file, key_file,
                    ip_address, port_number);
@@ -0,0 +1,533 @@
+/**
+ *  \file server-epoll.c
+ * \brief Concurrent server of the TLS1.2 client/server exchange
+ * utility. Worker threads each run an epoll loop over their own
+ * SO_REUSEPORT listener and drive any number of non-blocking
+ * connections through the handshake and the exchange.
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Atmel nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "tlsutil.h"
+
+/* Defined in the tlsutil.c following an example in the openssl/apps/s_cb.c file */
+extern int verify_quiet;
+
+/*
+ * A connection is owned by the worker that accepted it for its whole life,
+ * so no state is shared between workers apart from the SSL_CTX. The engine
+ * callbacks run inline on the worker thread; more workers than cores keep
+ * the network busy while some of them wait on the device.
+ *
+ * On SIGINT or SIGTERM every worker closes its listener at once and gives
+ * the connections it has SERVE_DRAIN_SECONDS to finish before they are shut
+ * down.
+ *
+ * Sessions are resumed through the shared cache of session-cache.c, a
+ * resumed handshake needs no device operation at all.
+ */
+
+#define SERVE_MAX_WORKERS       (64)
+#define SERVE_MAX_EVENTS        (64)
+#define SERVE_BACKLOG           (128)
+#define SERVE_DRAIN_SECONDS     (5)
+#define SERVE_SESSION_SLOTS     (1024)
+#define SERVE_SESSION_TIMEOUT   (300)
+
+typedef enum {
+    SERVE_CONN_HANDSHAKE,
+    SERVE_CONN_READ,
+    SERVE_CONN_WRITE,
+    SERVE_CONN_SHUTDOWN
+} serve_conn_state_t;
+
+/**
+ * \brief One client connection
+ */
+typedef struct serve_conn_s {
+    int sd;
+    SSL *ssl;
+    serve_conn_state_t state;
+    uint32_t events;                //!< epoll events currently asked for
+    struct serve_conn_s *prev;
+    struct serve_conn_s *next;
+} serve_conn_t;
+
+/**
+ * \brief One worker thread and its counters
+ */
+typedef struct serve_worker_s {
+    pthread_t thread;
+    int id;
+    int epfd;
+    int listen_sd;
+    serve_conn_t *conns;            //!< Open connections, to close them on shutdown
+    unsigned long open;
+    unsigned long accepted;
+    unsigned long handshakes;
+    unsigned long resumed;
+    unsigned long failed;
+} serve_worker_t;
+
+static SSL_CTX *serve_ctx;
+static uint16_t serve_port;
+static int serve_stop_fd = -1;
+static volatile sig_atomic_t serve_stopping;
+
+/* epoll data of the listener and of the stop event, connections use their own pointer */
+static char serve_listen_tag;
+static char serve_stop_tag;
+
+static const char *serve_message = "Thank you, my lovely Client!";
+
+static void serve_signal(int signo)
+{
+    uint64_t one = 1;
+
+    serve_stopping = 1;
+    if (write(serve_stop_fd, &one, sizeof(one)) < 0) {
+        /* Nothing to do in a signal handler, the flag is set anyway */
+    }
+}
+
+static int serve_set_nonblocking(int sd)
+{
+    int flags = fcntl(sd, F_GETFL, 0);
+
+    return flags < 0 ? -1 : fcntl(sd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/**
+ *
+ * \brief Opens the listener of one worker. SO_REUSEPORT lets
+ *        every worker bind the same port and the kernel spread
+ *        the incoming connections between them.
+ *
+ * \return the listening socket, -1 for error
+ */
+static int serve_listen(void)
+{
+    struct sockaddr_in sa_s;
+    int enable = 1;
+    int sd;
+
+    sd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sd < 0) {
+        perror("socket");
+        return -1;
+    }
+    if (setsockopt(sd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) < 0 ||
+        setsockopt(sd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+        perror("setsockopt");
+        goto err;
+    }
+
+    memset(&sa_s, '\0', sizeof(sa_s));
+    sa_s.sin_family = AF_INET;
+    sa_s.sin_addr.s_addr = INADDR_ANY;
+    sa_s.sin_port = htons(serve_port);
+    if (bind(sd, (struct sockaddr *)&sa_s, sizeof(sa_s)) < 0) {
+        perror("bind");
+        goto err;
+    }
+    if (listen(sd, SERVE_BACKLOG) < 0 || serve_set_nonblocking(sd) < 0) {
+        perror("listen");
+        goto err;
+    }
+    return sd;
+err:
+    close(sd);
+    return -1;
+}
+
+static void serve_close(serve_worker_t *w, serve_conn_t *conn)
+{
+    epoll_ctl(w->epfd, EPOLL_CTL_DEL, conn->sd, NULL);
+    if (conn->prev) {
+        conn->prev->next = conn->next;
+    } else {
+        w->conns = conn->next;
+    }
+    if (conn->next) {
+        conn->next->prev = conn->prev;
+    }
+    SSL_free(conn->ssl);
+    close(conn->sd);
+    free(conn);
+    w->open--;
+}
+
+/**
+ *
+ * \brief Asks epoll for the events an SSL call is waiting for
+ *
+ * \return 1 if the connection can carry on, 0 if it failed
+ */
+static int serve_wait(serve_worker_t *w, serve_conn_t *conn, int ssl_error)
+{
+    struct epoll_event ev;
+    uint32_t events;
+
+    if (ssl_error == SSL_ERROR_WANT_READ) {
+        events = EPOLLIN;
+    } else if (ssl_error == SSL_ERROR_WANT_WRITE) {
+        events = EPOLLOUT;
+    } else {
+        return 0;
+    }
+    if (events != conn->events) {
+        ev.events = events;
+        ev.data.ptr = conn;
+        if (epoll_ctl(w->epfd, EPOLL_CTL_MOD, conn->sd, &ev) < 0) {
+            return 0;
+        }
+        conn->events = events;
+    }
+    return 1;
+}
+
+/**
+ *
+ * \brief Moves a connection on as far as it goes without
+ *        blocking: handshake, read the client message, answer
+ *        it, shut down. Closes the connection when it is done or
+ *        failed.
+ */
+static void serve_advance(serve_worker_t *w, serve_conn_t *conn)
+{
+    char buf[1024 * 8];
+    int ret;
+
+    for (;;) {
+        ERR_clear_error();
+        switch (conn->state) {
+            case SERVE_CONN_HANDSHAKE:
+                ret = SSL_accept(conn->ssl);
+                if (ret != 1) {
+                    if (!serve_wait(w, conn, SSL_get_error(conn->ssl, ret))) {
+                        w->failed++;
+                        serve_close(w, conn);
+                    }
+                    return;
+                }
+                w->handshakes++;
+                if (SSL_session_reused(conn->ssl)) {
+                    w->resumed++;
+                }
+                conn->state = SERVE_CONN_READ;
+                break;
+
+            case SERVE_CONN_READ:
+                ret = SSL_read(conn->ssl, buf, sizeof(buf));
+                if (ret <= 0) {
+                    ret = SSL_get_error(conn->ssl, ret);
+                    if (ret == SSL_ERROR_ZERO_RETURN) {
+                        /* The client closed without a message, as the load generator does */
+                        conn->state = SERVE_CONN_SHUTDOWN;
+                        break;
+                    }
+                    if (!serve_wait(w, conn, ret)) {
+                        serve_close(w, conn);
+                    }
+                    return;
+                }
+                conn->state = SERVE_CONN_WRITE;
+                break;
+
+            case SERVE_CONN_WRITE:
+                ret = SSL_write(conn->ssl, serve_message, strlen(serve_message));
+                if (ret <= 0) {
+                    if (!serve_wait(w, conn, SSL_get_error(conn->ssl, ret))) {
+                        serve_close(w, conn);
+                    }
+                    return;
+                }
+                conn->state = SERVE_CONN_SHUTDOWN;
+                break;
+
+            case SERVE_CONN_SHUTDOWN:
+                /* One close_notify is enough, the client closes the socket next */
+                ret = SSL_shutdown(conn->ssl);
+                if (ret < 0 && serve_wait(w, conn, SSL_get_error(conn->ssl, ret))) {
+                    return;
+                }
+                serve_close(w, conn);
+                return;
+        }
+    }
+}
+
+static void serve_accept(serve_worker_t *w)
+{
+    struct epoll_event ev;
+    serve_conn_t *conn;
+    int sd;
+
+    for (;;) {
+        sd = accept(w->listen_sd, NULL, NULL);
+        if (sd < 0) {
+            /* EAGAIN once the backlog is empty, anything else is the client's problem */
+            return;
+        }
+        conn = calloc(1, sizeof(*conn));
+        if (conn == NULL || serve_set_nonblocking(sd) < 0 || (conn->ssl = SSL_new(serve_ctx)) == NULL) {
+            free(conn);
+            close(sd);
+            continue;
+        }
+        conn->sd = sd;
+        conn->state = SERVE_CONN_HANDSHAKE;
+        conn->events = EPOLLIN;
+        SSL_set_fd(conn->ssl, sd);
+        SSL_set_accept_state(conn->ssl);
+
+        ev.events = conn->events;
+        ev.data.ptr = conn;
+        if (epoll_ctl(w->epfd, EPOLL_CTL_ADD, sd, &ev) < 0) {
+            SSL_free(conn->ssl);
+            free(conn);
+            close(sd);
+            continue;
+        }
+        conn->next = w->conns;
+        if (w->conns) {
+            w->conns->prev = conn;
+        }
+        w->conns = conn;
+        w->open++;
+        w->accepted++;
+
+        /* The ClientHello is often there already */
+        serve_advance(w, conn);
+    }
+}
+
+static void* serve_worker(void *arg)
+{
+    serve_worker_t *w = (serve_worker_t *)arg;
+    struct epoll_event events[SERVE_MAX_EVENTS];
+    struct timespec now;
+    time_t drain_until = 0;
+    int n, i;
+
+    for (;;) {
+        n = epoll_wait(w->epfd, events, SERVE_MAX_EVENTS, drain_until ? 100 : -1);
+        if (n < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            break;
+        }
+        for (i = 0; i < n; i++) {
+            if (events[i].data.ptr == &serve_listen_tag) {
+                serve_accept(w);
+            } else if (events[i].data.ptr != &serve_stop_tag) {
+                serve_advance(w, (serve_conn_t *)events[i].data.ptr);
+            }
+        }
+
+        if (serve_stopping) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (drain_until == 0) {
+                /* Stop taking connections, the stop event stays readable for the other workers */
+                epoll_ctl(w->epfd, EPOLL_CTL_DEL, w->listen_sd, NULL);
+                epoll_ctl(w->epfd, EPOLL_CTL_DEL, serve_stop_fd, NULL);
+                close(w->listen_sd);
+                w->listen_sd = -1;
+                drain_until = now.tv_sec + SERVE_DRAIN_SECONDS;
+            }
+            if (w->conns == NULL || now.tv_sec >= drain_until) {
+                break;
+            }
+        }
+    }
+
+    while (w->conns) {
+        SSL_shutdown(w->conns->ssl);
+        serve_close(w, w->conns);
+    }
+    return NULL;
+}
+
+/**
+ *
+ * \brief Serves TLS1.2 clients concurrently until SIGINT or
+ *        SIGTERM, then prints how many connections each worker
+ *        handled
+ *
+ * \param[in] engine_id Engine ID (use Software libraries if
+ *       NULL)
+ * \param[in] ca_path Path to CA (Certificate Authority)
+ * \param[in] chain_file Chain File Name (Certificate Bundle)
+ * \param[in] cert_file Certificate File Name (NULL to take the
+ *       certificate chain from the engine)
+ * \param[in] key_file Private Key File Name
+ * \param[in] port_number The server port number
+ * \param[in] workers The number of worker threads
+ * \param[in] tickets 1 to resume sessions from session tickets
+ *       as well as from session IDs
+ * \return 0 for success
+ */
+int serve_concurrent(const char *engine_id, const char *ca_path, const char *chain_file,
+                     const char *cert_file, const char *key_file,
+                     uint16_t port_number, int workers, int tickets)
+{
+    SSL_CONF_CTX *cctx = NULL;
+    serve_worker_t *w = NULL;
+    struct epoll_event ev;
+    struct sigaction sa;
+    session_stats_t stats;
+    unsigned long handshakes = 0;
+    unsigned long resumed = 0;
+    int verify = SSL_VERIFY_PEER | SSL_VERIFY_CLIENT_ONCE;
+    int err = 0;
+    int i;
+
+    if (workers <= 0 || workers > SERVE_MAX_WORKERS) {
+        fprintf(stderr, "serve_concurrent(): from 1 to %d workers\n", SERVE_MAX_WORKERS);
+        return 1;
+    }
+    serve_port = port_number;
+
+    init_openssl();
+    if (!init_openssl_threads()) {
+        return 8;
+    }
+    serve_ctx = create_context(1);
+    CHK_NULL(serve_ctx);
+    err = setup_engine(engine_id);
+    if (err == 0) {
+        return 9;
+    }
+
+    verify_quiet = 1;
+    SSL_CTX_set_verify(serve_ctx, verify, verify_callback);
+
+    if (engine_id && !cert_file) {
+        /* Take the certificate chain from the engine */
+        err = configure_context_engine(serve_ctx, engine_id, ca_path);
+    } else {
+        err = configure_context(serve_ctx, ca_path, chain_file, cert_file);
+    }
+    if (err == 0) {
+        return 11;
+    }
+
+    err = load_private_key(engine_id, serve_ctx, key_file);
+    if (err == 0) {
+        return 13;
+    }
+
+    /* ECDHE needs a curve, as in connect_server() */
+    cctx = SSL_CONF_CTX_new();
+    if (!cctx) {
+        return 13;
+    }
+    SSL_CONF_CTX_set_flags(cctx, SSL_CONF_FLAG_SERVER);
+    SSL_CONF_CTX_set_flags(cctx, SSL_CONF_FLAG_CMDLINE);
+    if (!config_args_ssl_call(serve_ctx, cctx)) {
+        return 13;
+    }
+
+    /* After setup_engine() so that the ticket keys come from the device */
+    if (!session_cache_init(SERVE_SESSION_SLOTS, SERVE_SESSION_TIMEOUT) ||
+        !configure_session_resumption(serve_ctx, tickets)) {
+        return 14;
+    }
+
+    serve_stop_fd = eventfd(0, EFD_NONBLOCK);
+    CHK_ERR(serve_stop_fd, "eventfd");
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = serve_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    w = calloc(workers, sizeof(*w));
+    CHK_NULL(w);
+    for (i = 0; i < workers; i++) {
+        w[i].id = i;
+        w[i].listen_sd = serve_listen();
+        w[i].epfd = epoll_create1(0);
+        if (w[i].listen_sd < 0 || w[i].epfd < 0) {
+            exit(1);
+        }
+        ev.events = EPOLLIN;
+        ev.data.ptr = &serve_listen_tag;
+        epoll_ctl(w[i].epfd, EPOLL_CTL_ADD, w[i].listen_sd, &ev);
+        ev.events = EPOLLIN;
+        ev.data.ptr = &serve_stop_tag;
+        epoll_ctl(w[i].epfd, EPOLL_CTL_ADD, serve_stop_fd, &ev);
+    }
+
+    fprintf(stderr, "Serving on port %u with %d workers, SIGINT or SIGTERM to stop\n", port_number, workers);
+    for (i = 0; i < workers; i++) {
+        pthread_create(&w[i].thread, NULL, serve_worker, &w[i]);
+    }
+    for (i = 0; i < workers; i++) {
+        pthread_join(w[i].thread, NULL);
+    }
+
+    for (i = 0; i < workers; i++) {
+        fprintf(stderr, "worker %d: %lu accepted, %lu handshakes (%lu resumed), %lu failed\n", i,
+                w[i].accepted, w[i].handshakes, w[i].resumed, w[i].failed);
+        handshakes += w[i].handshakes;
+        resumed += w[i].resumed;
+        close(w[i].epfd);
+    }
+    fprintf(stderr, "%lu handshakes, %lu resumed (%.1f%%)\n", handshakes, resumed,
+            handshakes ? 100.0 * resumed / handshakes : 0.0);
+    if (session_cache_stats(&stats)) {
+        fprintf(stderr, "session cache: %lu hits, %lu misses, %lu stores, %lu evictions, %lu too big\n",
+                stats.cache_hits, stats.cache_misses, stats.cache_stores,
+                stats.cache_evictions, stats.cache_too_big);
+        fprintf(stderr, "session tickets: %lu issued, %lu resumed, %lu renewed, %lu unknown, "
+                "%lu key rotations\n", stats.tickets_issued, stats.tickets_resumed,
+                stats.tickets_renewed, stats.tickets_unknown, stats.key_rotations);
+    }
+
+    free(w);
+    close(serve_stop_fd);
+    SSL_CONF_CTX_free(cctx);
+    SSL_CTX_free(serve_ctx);
+    session_cache_free();
+    cleanup_openssl();
+
+    return 0;
+}
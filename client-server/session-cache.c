@@ -0,0 +1,421 @@
+/**
+ *  \file session-cache.c
+ * \brief TLS session resumption for the servers of the TLS1.2
+ * client/server exchange utility: a session cache in shared
+ * memory and session ticket keys drawn from the device RNG.
+ *
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Atmel nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <openssl/rand.h>
+#include <openssl/hmac.h>
+
+#include "tlsutil.h"
+
+/*
+ * A full handshake on an engine backed server costs a device sign and a
+ * device ECDH, a resumed one costs neither. Both ways of resuming are
+ * backed by one segment of shared anonymous memory so that it works the
+ * same for worker threads and for worker processes forked after
+ * session_cache_init():
+ *
+ * - Session IDs are looked up in a direct mapped table of DER encoded
+ *   sessions. OpenSSL's internal cache is turned off, every process sees
+ *   the sessions stored by the others.
+ *
+ * - Session tickets are encrypted with a key shared by all workers. The
+ *   keys come from RAND_bytes(), which is the device RNG once the engine
+ *   is the default, and are replaced every cache timeout. The previous key
+ *   is still accepted for one more period and the ticket is renewed.
+ */
+
+#define SESSION_ID_MAX          (32)
+#define SESSION_DER_MAX         (2048)
+#define SESSION_ID_CONTEXT      "exchange-tls12"
+
+typedef struct {
+    unsigned char id[SESSION_ID_MAX];
+    unsigned int id_len;
+    time_t expires;
+    unsigned int der_len;
+    unsigned char der[SESSION_DER_MAX];
+} session_slot_t;
+
+typedef struct {
+    unsigned char name[16];
+    unsigned char aes_key[16];
+    unsigned char hmac_key[16];
+    unsigned char iv_key[16];       //!< Derives the ticket IVs, so they need no RNG call each
+    time_t created;
+} session_ticket_key_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    long timeout;
+    unsigned int slots;
+    session_ticket_key_t keys[2];
+    int key_current;
+    unsigned long iv_counter;
+    session_stats_t stats;
+    session_slot_t slot[];
+} session_shared_t;
+
+static session_shared_t *session_shm = NULL;
+static size_t session_shm_size;
+
+static session_slot_t* session_slot(const unsigned char *id, unsigned int id_len)
+{
+    uint32_t hash = 0;
+    unsigned int i;
+
+    /* Session IDs are random, a plain mix is enough */
+    for (i = 0; i < id_len; i++) {
+        hash = hash * 31 + id[i];
+    }
+    return &session_shm->slot[hash % session_shm->slots];
+}
+
+static int session_new_ticket_key(session_ticket_key_t *key, time_t now)
+{
+    if (RAND_bytes((unsigned char *)key, offsetof(session_ticket_key_t, created)) != 1) {
+        return 0;
+    }
+    key->created = now;
+    return 1;
+}
+
+/**
+ *
+ * \brief Creates the shared memory used by
+ *        configure_session_resumption(). Call it after
+ *        setup_engine() and before forking any worker.
+ *
+ * \param[in] slots Number of sessions the cache can hold
+ * \param[in] timeout Session and ticket key lifetime in
+ *       seconds
+ * \return 1 for success, 0 for error
+ */
+int session_cache_init(unsigned int slots, long timeout)
+{
+    pthread_mutexattr_t attr;
+    time_t now = time(NULL);
+
+    if (session_shm != NULL) {
+        return 1;
+    }
+    if (slots == 0 || timeout <= 0) {
+        return 0;
+    }
+    session_shm_size = sizeof(session_shared_t) + slots * sizeof(session_slot_t);
+    session_shm = mmap(NULL, session_shm_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (session_shm == MAP_FAILED) {
+        perror("mmap");
+        session_shm = NULL;
+        return 0;
+    }
+    session_shm->slots = slots;
+    session_shm->timeout = timeout;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&session_shm->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    if (!session_new_ticket_key(&session_shm->keys[0], now)) {
+        fprintf(stderr, "session_cache_init(): no random bytes for the ticket key\n");
+        session_cache_free();
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ *
+ * \brief Releases the memory of session_cache_init()
+ */
+void session_cache_free(void)
+{
+    if (session_shm) {
+        pthread_mutex_destroy(&session_shm->lock);
+        munmap(session_shm, session_shm_size);
+        session_shm = NULL;
+    }
+}
+
+static int session_new_cb(SSL *ssl, SSL_SESSION *sess)
+{
+    unsigned char der[SESSION_DER_MAX];
+    unsigned char *p = der;
+    const unsigned char *id;
+    unsigned int id_len;
+    session_slot_t *slot;
+    int der_len;
+
+    id = SSL_SESSION_get_id(sess, &id_len);
+    der_len = i2d_SSL_SESSION(sess, NULL);
+    if (id_len == 0 || id_len > SESSION_ID_MAX || der_len <= 0 || der_len > SESSION_DER_MAX) {
+        pthread_mutex_lock(&session_shm->lock);
+        session_shm->stats.cache_too_big++;
+        pthread_mutex_unlock(&session_shm->lock);
+        return 0;
+    }
+    i2d_SSL_SESSION(sess, &p);
+
+    pthread_mutex_lock(&session_shm->lock);
+    slot = session_slot(id, id_len);
+    if (slot->id_len && slot->expires > time(NULL)) {
+        session_shm->stats.cache_evictions++;
+    }
+    memcpy(slot->id, id, id_len);
+    slot->id_len = id_len;
+    slot->expires = time(NULL) + session_shm->timeout;
+    memcpy(slot->der, der, der_len);
+    slot->der_len = der_len;
+    session_shm->stats.cache_stores++;
+    pthread_mutex_unlock(&session_shm->lock);
+
+    /* The cache keeps its own copy, OpenSSL may free the session */
+    return 0;
+}
+
+static SSL_SESSION* session_get_cb(SSL *ssl, unsigned char *id, int id_len, int *copy)
+{
+    unsigned char der[SESSION_DER_MAX];
+    const unsigned char *p = der;
+    session_slot_t *slot;
+    unsigned int der_len = 0;
+
+    *copy = 0;
+    if (id_len <= 0 || id_len > SESSION_ID_MAX) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&session_shm->lock);
+    slot = session_slot(id, id_len);
+    if (slot->id_len == (unsigned int)id_len && !memcmp(slot->id, id, id_len)) {
+        if (slot->expires > time(NULL)) {
+            der_len = slot->der_len;
+            memcpy(der, slot->der, der_len);
+        } else {
+            slot->id_len = 0;
+        }
+    }
+    if (der_len) {
+        session_shm->stats.cache_hits++;
+    } else {
+        session_shm->stats.cache_misses++;
+    }
+    pthread_mutex_unlock(&session_shm->lock);
+
+    return der_len ? d2i_SSL_SESSION(NULL, &p, der_len) : NULL;
+}
+
+static void session_remove_cb(SSL_CTX *ctx, SSL_SESSION *sess)
+{
+    const unsigned char *id;
+    unsigned int id_len;
+    session_slot_t *slot;
+
+    id = SSL_SESSION_get_id(sess, &id_len);
+    if (id_len == 0 || id_len > SESSION_ID_MAX) {
+        return;
+    }
+    pthread_mutex_lock(&session_shm->lock);
+    slot = session_slot(id, id_len);
+    if (slot->id_len == id_len && !memcmp(slot->id, id, id_len)) {
+        slot->id_len = 0;
+    }
+    pthread_mutex_unlock(&session_shm->lock);
+}
+
+/*
+ * Called with enc = 1 to issue a ticket and with enc = 0 to open one.
+ * Returns 1 to go on, 2 to go on and issue a fresh ticket, 0 for a
+ * full handshake and -1 for an error.
+ */
+static int session_ticket_cb(SSL *ssl, unsigned char *key_name, unsigned char *iv,
+                             EVP_CIPHER_CTX *ectx, HMAC_CTX *hctx, int enc)
+{
+    session_ticket_key_t key;
+    session_ticket_key_t fresh;
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned char counter[sizeof(unsigned long) + sizeof(pid_t)];
+    unsigned int mac_len;
+    time_t now = time(NULL);
+    int have_fresh = 0;
+    int ret = 1;
+    int i;
+
+    if (enc) {
+        /*
+         * Only the rotation check is done under the lock, RAND_bytes is a
+         * device round trip and runs after the lock is released
+         */
+        pthread_mutex_lock(&session_shm->lock);
+        i = session_shm->key_current;
+        have_fresh = now - session_shm->keys[i].created >= session_shm->timeout;
+        pthread_mutex_unlock(&session_shm->lock);
+        if (have_fresh) {
+            have_fresh = session_new_ticket_key(&fresh, now);
+        }
+    }
+
+    pthread_mutex_lock(&session_shm->lock);
+    if (enc) {
+        i = session_shm->key_current;
+        /* Another worker may have rotated the key in the meantime */
+        if (have_fresh && now - session_shm->keys[i].created >= session_shm->timeout) {
+            session_shm->keys[i ^ 1] = fresh;
+            /* The old key stays as keys[i] to open the tickets it issued */
+            session_shm->key_current = i ^= 1;
+            session_shm->stats.key_rotations++;
+        }
+        key = session_shm->keys[i];
+        memcpy(counter, &session_shm->iv_counter, sizeof(unsigned long));
+        session_shm->iv_counter++;
+        session_shm->stats.tickets_issued++;
+    } else {
+        for (i = 0; i < 2; i++) {
+            if (session_shm->keys[i].created &&
+                !memcmp(key_name, session_shm->keys[i].name, sizeof(key.name)) &&
+                now - session_shm->keys[i].created < 2 * session_shm->timeout) {
+                break;
+            }
+        }
+        if (i == 2) {
+            session_shm->stats.tickets_unknown++;
+            ret = 0;
+        } else {
+            key = session_shm->keys[i];
+            if (i != session_shm->key_current) {
+                session_shm->stats.tickets_renewed++;
+                ret = 2;
+            }
+            session_shm->stats.tickets_resumed++;
+        }
+    }
+    pthread_mutex_unlock(&session_shm->lock);
+    OPENSSL_cleanse(&fresh, sizeof(fresh));
+
+    if (ret == 0) {
+        return 0;
+    }
+
+    if (enc) {
+        /* Unique and unpredictable without the key, the pid keeps forked workers apart */
+        *(pid_t *)(counter + sizeof(unsigned long)) = getpid();
+        if (!HMAC(EVP_sha256(), key.iv_key, sizeof(key.iv_key), counter, sizeof(counter),
+                  mac, &mac_len)) {
+            ret = -1;
+            goto done;
+        }
+        memcpy(iv, mac, EVP_MAX_IV_LENGTH);
+        memcpy(key_name, key.name, sizeof(key.name));
+        if (!EVP_EncryptInit_ex(ectx, EVP_aes_128_cbc(), NULL, key.aes_key, iv)) {
+            ret = -1;
+            goto done;
+        }
+    } else if (!EVP_DecryptInit_ex(ectx, EVP_aes_128_cbc(), NULL, key.aes_key, iv)) {
+        ret = -1;
+        goto done;
+    }
+    if (!HMAC_Init_ex(hctx, key.hmac_key, sizeof(key.hmac_key), EVP_sha256(), NULL)) {
+        ret = -1;
+    }
+
+done:
+    OPENSSL_cleanse(&key, sizeof(key));
+    return ret;
+}
+
+/**
+ *
+ * \brief Makes a server context resume sessions through the
+ *        cache of session_cache_init()
+ *
+ * \param[in] ctx Server SSL context
+ * \param[in] tickets 1 to resume from session tickets as well,
+ *       0 to resume from session IDs only
+ * \return 1 for success, 0 for error
+ */
+int configure_session_resumption(SSL_CTX *ctx, int tickets)
+{
+    if (session_shm == NULL) {
+        fprintf(stderr, "configure_session_resumption(): no session cache\n");
+        return 0;
+    }
+
+    /* Sessions of verified clients are only resumed within the same context */
+    if (!SSL_CTX_set_session_id_context(ctx, (const unsigned char *)SESSION_ID_CONTEXT,
+                                        sizeof(SESSION_ID_CONTEXT) - 1)) {
+        return 0;
+    }
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+    SSL_CTX_set_timeout(ctx, session_shm->timeout);
+    SSL_CTX_sess_set_new_cb(ctx, session_new_cb);
+    SSL_CTX_sess_set_get_cb(ctx, session_get_cb);
+    SSL_CTX_sess_set_remove_cb(ctx, session_remove_cb);
+
+    if (tickets) {
+        SSL_CTX_clear_options(ctx, SSL_OP_NO_TICKET);
+        SSL_CTX_set_tlsext_ticket_key_cb(ctx, session_ticket_cb);
+    } else {
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+    }
+    return 1;
+}
+
+/**
+ *
+ * \brief Takes a snapshot of the counters of the session cache
+ *
+ * \param[out] stats Counters of all workers
+ * \return 1 for success, 0 if there is no session cache
+ */
+int session_cache_stats(session_stats_t *stats)
+{
+    if (session_shm == NULL) {
+        return 0;
+    }
+    pthread_mutex_lock(&session_shm->lock);
+    *stats = session_shm->stats;
+    pthread_mutex_unlock(&session_shm->lock);
+    return 1;
+}
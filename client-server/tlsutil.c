@@ -89,6 +89,48 @@ void init_openssl(void)
     OpenSSL_add_ssl_algorithms();
 }
 
+static pthread_mutex_t *openssl_locks = NULL;
+
+static void openssl_locking_callback(int mode, int n, const char *file, int line)
+{
+    if (mode & CRYPTO_LOCK) {
+        pthread_mutex_lock(&openssl_locks[n]);
+    } else {
+        pthread_mutex_unlock(&openssl_locks[n]);
+    }
+}
+
+static void openssl_threadid_callback(CRYPTO_THREADID *id)
+{
+    CRYPTO_THREADID_set_numeric(id, (unsigned long)pthread_self());
+}
+
+/**
+ *
+ * \brief Installs the locking callbacks OpenSSL needs before
+ * it is used from more than one thread
+ *
+ * \return 1 for success, 0 for error
+ */
+int init_openssl_threads(void)
+{
+    int i;
+
+    if (openssl_locks != NULL) {
+        return 1;
+    }
+    openssl_locks = OPENSSL_malloc(CRYPTO_num_locks() * sizeof(*openssl_locks));
+    if (openssl_locks == NULL) {
+        return 0;
+    }
+    for (i = 0; i < CRYPTO_num_locks(); i++) {
+        pthread_mutex_init(&openssl_locks[i], NULL);
+    }
+    CRYPTO_THREADID_set_callback(openssl_threadid_callback);
+    CRYPTO_set_locking_callback(openssl_locking_callback);
+    return 1;
+}
+
 /**
  *
  * \brief Creates the SSL context for server or
@@ -175,6 +217,75 @@ done:
     return (rc);
 }
 
+/**
+ *
+ * \brief Configures the SSL context with the certificate chain
+ * taken straight from the engine, without temporary files: the
+ * device certificate is used as the context certificate, the
+ * signer certificate is sent as an extra chain certificate and
+ * the root certificate is trusted for peer verification
+ *
+ * \param[in] ctx SSL context
+ * \param[in] engine_id Engine ID
+ * \param[in] ca_path Optional path to more CA (Certificate
+ *       Authority) certificates, can be NULL
+ * \return 1 for success
+ */
+int configure_context_engine(SSL_CTX *ctx, const char *engine_id, const char *ca_path)
+{
+    int rc = 0;
+    ENGINE *e = NULL;
+    STACK_OF(X509) *certs = NULL;
+    X509 *signer_cert = NULL;
+
+    if (!SSL_CTX_set_options(ctx, SSL_OP_NO_COMPRESSION)) {
+        fprintf(stderr, "SSL_CTX_set_options(SSL_OP_NO_COMPRESSION) error\n");
+        goto done;
+    }
+
+    e = ENGINE_by_id(engine_id);
+    if (!e) {
+        fprintf(stderr, "configure_context_engine(): FAILED to load engine: %s\n", engine_id);
+        goto done;
+    }
+    if (!ENGINE_ctrl(e, ECCX08_CMD_GET_CERT_CHAIN, 0, &certs, 0) || sk_X509_num(certs) != 3) {
+        fprintf(stderr, "configure_context_engine(): cannot get the certificate chain\n");
+        goto done;
+    }
+
+    if (SSL_CTX_use_certificate(ctx, sk_X509_value(certs, 0)) <= 0) {
+        ERR_print_errors_fp(stderr);
+        goto done;
+    }
+    /* SSL_CTX_add_extra_chain_cert() takes the ownership on success */
+    signer_cert = X509_dup(sk_X509_value(certs, 1));
+    if (signer_cert == NULL || SSL_CTX_add_extra_chain_cert(ctx, signer_cert) <= 0) {
+        X509_free(signer_cert);
+        ERR_print_errors_fp(stderr);
+        goto done;
+    }
+    if (X509_STORE_add_cert(SSL_CTX_get_cert_store(ctx), sk_X509_value(certs, 2)) <= 0) {
+        ERR_print_errors_fp(stderr);
+        goto done;
+    }
+    if (ca_path && SSL_CTX_load_verify_locations(ctx, NULL, ca_path) <= 0) {
+        ERR_print_errors_fp(stderr);
+        goto done;
+    }
+    if (!SSL_CTX_set_default_verify_paths(ctx)) {
+        ERR_print_errors_fp(stderr);
+        goto done;
+    }
+
+    rc = 1;
+done:
+    sk_X509_pop_free(certs, X509_free);
+    if (e) {
+        ENGINE_free(e);
+    }
+    return (rc);
+}
+
 /**
  *
  * \brief setup OpenSSL engine by engine ID
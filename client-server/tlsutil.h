@@ -54,6 +54,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <pthread.h>
 
 #include <openssl/crypto.h>
 #include <openssl/x509.h>
@@ -73,10 +74,12 @@
 
 int setup_engine(const char *engine_id);
 void init_openssl(void);
+int init_openssl_threads(void);
 SSL_CTX* create_context(uint32_t is_server);
 int config_args_ssl_call(SSL_CTX *ctx, SSL_CONF_CTX *cctx);
 int configure_context(SSL_CTX *ctx, const char *ca_path, const char *chain_file,
                       const char *cert_file);
+int configure_context_engine(SSL_CTX *ctx, const char *engine_id, const char *ca_path);
 int verify_callback(int ok, X509_STORE_CTX *ctx);
 int load_private_key(const char *engine_id, SSL_CTX *ctx, const char *key_file);
 void cleanup_openssl(void);
@@ -87,6 +90,44 @@ int connect_client(const char *engine_id, const char *ca_path, const char *chain
 int connect_server(const char *engine_id, const char *ca_path, const char *chain_file,
                    const char *cert_file, const char *key_file,
                    const char *ip_address, uint16_t port_number);
+int serve_concurrent(const char *engine_id, const char *ca_path, const char *chain_file,
+                     const char *cert_file, const char *key_file,
+                     uint16_t port_number, int workers, int tickets);
+
+/**
+ * \brief Options of the handshake load generator
+ */
+typedef struct load_options_s {
+    int connections;            //!< Concurrent connections
+    unsigned int seconds;       //!< Run time, 0 to stop after handshakes only
+    unsigned long handshakes;   //!< Handshakes to make, 0 to stop after seconds only
+    int resume;                 //!< Resume the previous session of each connection
+} load_options_t;
+
+int load_client(const char *engine_id, const char *ca_path, const char *chain_file,
+                const char *cert_file, const char *key_file, const char *cipher_list,
+                const char *ip_address, uint16_t port_number, const load_options_t *options);
+
+/**
+ * \brief Counters of the shared session cache and of the session tickets
+ */
+typedef struct session_stats_s {
+    unsigned long cache_hits;       //!< Sessions found by ID
+    unsigned long cache_misses;     //!< Session IDs not found or expired
+    unsigned long cache_stores;
+    unsigned long cache_evictions;  //!< Live sessions overwritten by a new one
+    unsigned long cache_too_big;    //!< Sessions too big for a cache slot
+    unsigned long tickets_issued;
+    unsigned long tickets_resumed;  //!< Tickets opened with a known key
+    unsigned long tickets_renewed;  //!< Tickets opened with the previous key
+    unsigned long tickets_unknown;  //!< Tickets of an unknown or expired key
+    unsigned long key_rotations;
+} session_stats_t;
+
+int session_cache_init(unsigned int slots, long timeout);
+int configure_session_resumption(SSL_CTX *ctx, int tickets);
+int session_cache_stats(session_stats_t *stats);
+void session_cache_free(void);
 
 int save_private_key(EVP_PKEY *pkey, const char *privkey_fname);
 int save_x509_certificate(X509 *x509, const char *cert_fname);
@@ -0,0 +1,124 @@
+/**
+ * \file
+ *
+ * \brief  Per thread deadlines of device operations
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#include <time.h>
+#include "atca_deadline.h"
+
+/** \defgroup deadline Operation deadlines (atca_deadline_)
+   @{ */
+
+// Absolute CLOCK_MONOTONIC time in ms of the calling thread, 0 for none
+static __thread uint64_t g_deadline_ms = 0;
+
+/** \brief monotonic time the deadlines are kept in
+ * \return milliseconds since an arbitrary start
+ */
+uint64_t atca_deadline_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/** \brief starts a deadline for the device operations of the calling
+ *         thread, replacing the one it may already have
+ * \param[in] timeout_ms time from now, 0 removes the deadline
+ * \return the previous deadline for atca_deadline_restore()
+ */
+uint64_t atca_deadline_set(uint32_t timeout_ms)
+{
+	uint64_t previous = g_deadline_ms;
+
+	g_deadline_ms = timeout_ms ? atca_deadline_now_ms() + timeout_ms : 0;
+	return previous;
+}
+
+/** \brief puts back the deadline atca_deadline_set() replaced
+ * \param[in] deadline return value of atca_deadline_set()
+ */
+void atca_deadline_restore(uint64_t deadline)
+{
+	g_deadline_ms = deadline;
+}
+
+/** \brief time the HAL may still wait for the device
+ * \return milliseconds left, 0 once the deadline has passed and
+ *         ATCA_DEADLINE_DEFAULT_MS when there is no deadline
+ */
+uint32_t atca_deadline_remaining_ms(void)
+{
+	uint64_t now_ms;
+
+	if (g_deadline_ms == 0) {
+		return ATCA_DEADLINE_DEFAULT_MS;
+	}
+	now_ms = atca_deadline_now_ms();
+	return now_ms < g_deadline_ms ? (uint32_t)(g_deadline_ms - now_ms) : 0;
+}
+
+/** \brief whether the deadline of the calling thread has passed
+ * \return true if there is a deadline and it has passed
+ */
+bool atca_deadline_expired(void)
+{
+	return g_deadline_ms != 0 && atca_deadline_now_ms() >= g_deadline_ms;
+}
+
+/** \brief whether a status means the device did not answer in time
+ * \param[in] status result of a device operation
+ * \return true for the timeout codes the HAL and atsend() return
+ */
+bool atca_status_is_timeout(ATCA_STATUS status)
+{
+	switch (status) {
+	case ATCA_TIMEOUT:
+	case ATCA_RX_FAIL:
+	case ATCA_RX_TIMEOUT:
+	case ATCA_TX_TIMEOUT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/** @} */
@@ -0,0 +1,79 @@
+/* atca_deadline.h
+ *
+ * \file
+ *
+ * \brief  Per thread deadlines of device operations
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#ifndef ATCA_DEADLINE_H
+#define ATCA_DEADLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "atca_status.h"
+
+/** \defgroup deadline Operation deadlines (atca_deadline_)
+ *  \brief A deadline bounds everything the calling thread does with the
+ *  device until it is restored: atsend() refuses to start a command past
+ *  it and the HAL waits for the device no longer than it. The operation
+ *  then fails with ATCA_TIMEOUT (nothing received), ATCA_RX_FAIL (a partial
+ *  response) or ATCA_TX_TIMEOUT instead of blocking.
+ *
+ *  Without a deadline every single transfer is still bounded by
+ *  ATCA_DEADLINE_DEFAULT_MS, so a stalled kit never hangs the caller.
+   @{ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ATCA_DEADLINE_DEFAULT_MS    (5000)      //!< Bound of one transfer when no deadline is set
+
+uint64_t atca_deadline_now_ms(void);
+uint64_t atca_deadline_set(uint32_t timeout_ms);
+void atca_deadline_restore(uint64_t deadline);
+uint32_t atca_deadline_remaining_ms(void);
+bool atca_deadline_expired(void);
+bool atca_status_is_timeout(ATCA_STATUS status);
+
+#ifdef __cplusplus
+}
+#endif
+/** @} */
+#endif
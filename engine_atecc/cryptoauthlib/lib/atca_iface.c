@@ -44,6 +44,10 @@
 #include <stdlib.h>
 #include "atca_iface.h"
 #include "hal/atca_hal.h"
+#include "atca_stats.h"
+#include "atca_trace.h"
+#include "atca_log.h"
+#include "atca_deadline.h"
 
 /** \defgroup interface ATCAIface (atca_)
  *  \brief Abstract interface to all CryptoAuth device types.  This interface
@@ -74,6 +78,9 @@ struct atca_iface {
 
 ATCA_STATUS _atinit(ATCAIface caiface, ATCAHAL_t *hal);
 
+// Command sent by this thread and not answered yet, for its trace end event
+static __thread const char *g_trace_command = NULL;
+
 /** \brief constructor for ATCAIface objects
  * \param[in] ATCAIfaceCfg pointer - points to the logical configuration for the interface
  * \return ATCAIface
@@ -98,10 +105,12 @@ ATCAIface newATCAIface(ATCAIfaceCfg *cfg)  // constructor
 
 ATCA_STATUS atinit(ATCAIface caiface)
 {
+	ATCA_TRACE_SCOPE("iface", "init");
 	ATCA_STATUS status = ATCA_COMM_FAIL;
 	ATCAHAL_t hal;
 
 	_atinit( caiface, &hal );
+	atca_stats_init();
 
 	status = caiface->atinit( &hal, caiface->mIfaceCFG );
 	if (status == ATCA_SUCCESS) {
@@ -109,6 +118,9 @@ ATCA_STATUS atinit(ATCAIface caiface)
 
 		// Perform the post init
 		status = caiface->atpostinit( caiface );
+		// The HAL opened the port, do not leave it open for a kit that did not answer
+		if (status != ATCA_SUCCESS)
+			hal_iface_release(caiface->mType, caiface->hal_data);
 	}
 
 	return status;
@@ -116,28 +128,70 @@ ATCA_STATUS atinit(ATCAIface caiface)
 
 ATCA_STATUS atsend(ATCAIface caiface, uint8_t *txdata, int txlength)
 {
-	return caiface->atsend(caiface, txdata, txlength);
+	// txdata is an ATCAPacket
+	uint8_t opcode = ((ATCAPacket*)txdata)->opcode;
+	const char *name = atca_stats_command_name(atca_stats_command_of(opcode));
+	uint64_t start_us = atca_stats_now_us();
+	ATCA_STATUS status;
+
+	ATCA_TRACE_BEGIN("atcab", name, opcode);
+	// Past the deadline the command is not started, the device is left alone
+	if (atca_deadline_expired())
+		status = ATCA_TIMEOUT;
+	else
+		status = caiface->atsend(caiface, txdata, txlength);
+	atca_stats_sent(opcode, start_us, status);
+	if (status != ATCA_SUCCESS) {
+		ATCA_LOG_E(ATCA_LOG_ATCAB, "atsend(%s): error 0x%02X%s\n", name, status,
+		           atca_status_is_timeout(status) ? ", deadline expired" : "");
+		ATCA_TRACE_END("atcab", name, opcode);
+		name = NULL;
+	}
+	g_trace_command = name;
+	return status;
 }
 
 ATCA_STATUS atreceive( ATCAIface caiface, uint8_t *rxdata, uint16_t *rxlength)
 {
-	return caiface->atreceive(caiface, rxdata, rxlength);
+	uint64_t start_us = atca_stats_now_us();
+	ATCA_STATUS status = caiface->atreceive(caiface, rxdata, rxlength);
+
+	atca_stats_received(rxdata, start_us, status);
+	if (status != ATCA_SUCCESS) {
+		ATCA_LOG_E(ATCA_LOG_ATCAB, "atreceive(%s): error 0x%02X%s\n", g_trace_command ? g_trace_command : "-", status,
+		           atca_status_is_timeout(status) ? ", deadline expired" : "");
+	}
+	if (g_trace_command) {
+		ATCA_TRACE_END("atcab", g_trace_command, 0);
+		g_trace_command = NULL;
+	}
+	return status;
 }
 
 ATCA_STATUS atwake(ATCAIface caiface)
 {
-	return caiface->atwake(caiface);
+	ATCA_TRACE_SCOPE("iface", "wake");
+	ATCA_STATUS status = caiface->atwake(caiface);
+
+	atca_stats_wake(status);
+	return status;
 }
 
 ATCA_STATUS atidle(ATCAIface caiface)
 {
+	ATCA_TRACE_SCOPE("iface", "idle");
+
 	atca_delay_ms(1);
+	atca_stats_idle();
 	return caiface->atidle(caiface);
 }
 
 ATCA_STATUS atsleep(ATCAIface caiface)
 {
+	ATCA_TRACE_SCOPE("iface", "sleep");
+
 	atca_delay_ms(1);
+	atca_stats_sleep();
 	return caiface->atsleep(caiface);
 }
 
@@ -0,0 +1,337 @@
+/**
+ * \file
+ *
+ * \brief Leveled, rate limited logging with an asynchronous buffered sink
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "atca_log.h"
+#include "atca_stats.h"
+
+/** \defgroup log Logging (atca_log_)
+   @{ */
+
+int atca_log_levels[ATCA_LOG_CATEGORIES] = {
+	ATCA_LOG_DEFAULT_LEVEL, ATCA_LOG_DEFAULT_LEVEL, ATCA_LOG_DEFAULT_LEVEL, ATCA_LOG_DEFAULT_LEVEL
+};
+
+static const char *g_category_names[ATCA_LOG_CATEGORIES] = { "engine", "atcab", "hal", "cert" };
+static const char *g_level_names[] = { "none", "error", "warn", "info", "debug" };
+
+/* The queue is a ring of fixed size lines under g_mutex. Callers only
+ * copy a formatted line in, the sink thread takes every queued line at
+ * once and writes them with one write().
+ */
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static char g_queue[ATCA_LOG_QUEUE_LINES][ATCA_LOG_LINE_MAX];
+static uint16_t g_queue_len[ATCA_LOG_QUEUE_LINES];
+static uint32_t g_head;
+static uint32_t g_tail;
+static uint32_t g_unreported;   //!< Dropped lines not yet reported in the output
+static int g_running;
+static int g_stop;
+static int g_fd = STDERR_FILENO;
+static pthread_t g_thread;
+
+static atca_log_stats g_stats;
+
+static void write_all(int fd, const char *buf, size_t len)
+{
+	ssize_t n;
+
+	while (len > 0) {
+		n = write(fd, buf, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return;
+		}
+		buf += n;
+		len -= (size_t)n;
+	}
+}
+
+static void *sink_main(void *arg)
+{
+	// Only this thread uses it, big enough for a full queue
+	static char batch[ATCA_LOG_QUEUE_LINES * ATCA_LOG_LINE_MAX + ATCA_LOG_LINE_MAX];
+	size_t len;
+	uint32_t lines, unreported;
+
+	(void)arg;
+	for (;;) {
+		pthread_mutex_lock(&g_mutex);
+		while (g_head == g_tail && !g_stop)
+			pthread_cond_wait(&g_cond, &g_mutex);
+		if (g_head == g_tail) {
+			// Stopped and drained, callers write directly from now on
+			g_running = 0;
+			pthread_mutex_unlock(&g_mutex);
+			break;
+		}
+		len = 0;
+		lines = g_tail - g_head;
+		for (; g_head != g_tail; g_head++) {
+			uint32_t slot = g_head % ATCA_LOG_QUEUE_LINES;
+			memcpy(batch + len, g_queue[slot], g_queue_len[slot]);
+			len += g_queue_len[slot];
+		}
+		unreported = g_unreported;
+		g_unreported = 0;
+		pthread_mutex_unlock(&g_mutex);
+
+		if (unreported)
+			len += snprintf(batch + len, ATCA_LOG_LINE_MAX, "ATECCX08 log: %u lines dropped, queue full\n", unreported);
+		write_all(g_fd, batch, len);
+		__atomic_add_fetch(&g_stats.written, lines, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+static void queue_line(const char *line, size_t len)
+{
+	uint32_t slot;
+
+	pthread_mutex_lock(&g_mutex);
+	if (!g_running) {
+		pthread_mutex_unlock(&g_mutex);
+		write_all(g_fd, line, len);
+		__atomic_add_fetch(&g_stats.written, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	if (g_tail - g_head >= ATCA_LOG_QUEUE_LINES) {
+		g_unreported++;
+		pthread_mutex_unlock(&g_mutex);
+		__atomic_add_fetch(&g_stats.dropped, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	slot = g_tail % ATCA_LOG_QUEUE_LINES;
+	memcpy(g_queue[slot], line, len);
+	g_queue_len[slot] = (uint16_t)len;
+	if (g_tail++ == g_head)
+		pthread_cond_signal(&g_cond);
+	pthread_mutex_unlock(&g_mutex);
+}
+
+/** \brief rate limit of warnings and errors, one second windows per call site
+ * \param[in,out] site the call site
+ * \param[out] suppressed messages of the site held back before this one
+ * \return 1 if the message may be written
+ */
+static int site_allow(atca_log_site *site, uint64_t now_us, uint32_t *suppressed)
+{
+	uint64_t window = __atomic_load_n(&site->window_us, __ATOMIC_RELAXED);
+
+	*suppressed = 0;
+	if (now_us - window >= 1000000 &&
+	    __atomic_compare_exchange_n(&site->window_us, &window, now_us, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&site->count, 0, __ATOMIC_RELAXED);
+		*suppressed = __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+	}
+	if (__atomic_fetch_add(&site->count, 1, __ATOMIC_RELAXED) >= ATCA_LOG_BURST) {
+		__atomic_add_fetch(&site->suppressed, 1, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&g_stats.suppressed, 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+	return 1;
+}
+
+/** \brief formats and queues one message, call it through ATCA_LOG()
+ *         which has already checked the level
+ * \param[in,out] site rate limiting state of the call site
+ * \param[in] cat category
+ * \param[in] level level
+ * \param[in] fmt printf format
+ */
+void atca_log_emit(atca_log_site *site, atca_log_category_t cat, int level, const char *fmt, ...)
+{
+	char line[ATCA_LOG_LINE_MAX];
+	uint32_t suppressed = 0;
+	va_list args;
+	int len, n;
+
+	if (cat >= ATCA_LOG_CATEGORIES || level <= ATCA_LOG_NONE || level > ATCA_LOG_DEBUG)
+		return;
+	if (level <= ATCA_LOG_WARN && !site_allow(site, atca_stats_now_us(), &suppressed))
+		return;
+
+	len = snprintf(line, sizeof(line), "ATECCX08 %s %s: ", g_category_names[cat], g_level_names[level]);
+	va_start(args, fmt);
+	n = vsnprintf(line + len, sizeof(line) - len, fmt, args);
+	va_end(args);
+	len = (n < 0) ? len : (len + n >= (int)sizeof(line)) ? (int)sizeof(line) - 1 : len + n;
+
+	// One line per message, the caller's newline is optional
+	while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+		len--;
+	if (suppressed) {
+		n = snprintf(line + len, sizeof(line) - len, " (%u more suppressed)", suppressed);
+		len = (n < 0) ? len : (len + n >= (int)sizeof(line)) ? (int)sizeof(line) - 1 : len + n;
+	}
+	if (len >= (int)sizeof(line) - 1)
+		len = sizeof(line) - 2;
+	line[len++] = '\n';
+
+	queue_line(line, len);
+}
+
+/** \brief sets the runtime level of a category
+ * \param[in] cat category
+ * \param[in] level ATCA_LOG_NONE to ATCA_LOG_DEBUG
+ */
+void atca_log_set_level(atca_log_category_t cat, int level)
+{
+	if (cat >= ATCA_LOG_CATEGORIES)
+		return;
+	if (level < ATCA_LOG_NONE)
+		level = ATCA_LOG_NONE;
+	if (level > ATCA_LOG_DEBUG)
+		level = ATCA_LOG_DEBUG;
+	__atomic_store_n(&atca_log_levels[cat], level, __ATOMIC_RELAXED);
+}
+
+static int parse_level(const char *name, size_t len)
+{
+	int level;
+
+	if (len == 1 && name[0] >= '0' && name[0] <= '0' + ATCA_LOG_DEBUG)
+		return name[0] - '0';
+	for (level = ATCA_LOG_NONE; level <= ATCA_LOG_DEBUG; level++)
+		if (strlen(g_level_names[level]) == len && strncmp(name, g_level_names[level], len) == 0)
+			return level;
+	return -1;
+}
+
+/** \brief sets runtime levels from a text such as "debug" (every
+ *         category) or "warn,engine=debug,hal=info"
+ * \param[in] spec the levels, comma or space separated, NULL or empty
+ *            changes nothing
+ * \return ATCA_SUCCESS, or ATCA_BAD_PARAM for an unknown category or
+ *         level (the items before it are applied)
+ */
+ATCA_STATUS atca_log_configure(const char *spec)
+{
+	const char *item, *eq;
+	size_t len;
+	int cat, level;
+
+	if (spec == NULL)
+		return ATCA_SUCCESS;
+	for (item = spec; *item != '\0'; item += len) {
+		item += strspn(item, ", \t");
+		len = strcspn(item, ", \t");
+		if (len == 0)
+			break;
+		eq = memchr(item, '=', len);
+		if (eq == NULL) {
+			if ((level = parse_level(item, len)) < 0)
+				return ATCA_BAD_PARAM;
+			for (cat = 0; cat < ATCA_LOG_CATEGORIES; cat++)
+				atca_log_set_level(cat, level);
+			continue;
+		}
+		for (cat = 0; cat < ATCA_LOG_CATEGORIES; cat++)
+			if (strlen(g_category_names[cat]) == (size_t)(eq - item) &&
+			    strncmp(item, g_category_names[cat], eq - item) == 0)
+				break;
+		level = parse_level(eq + 1, len - (eq + 1 - item));
+		if (cat == ATCA_LOG_CATEGORIES || level < 0)
+			return ATCA_BAD_PARAM;
+		atca_log_set_level(cat, level);
+	}
+	return ATCA_SUCCESS;
+}
+
+/** \brief starts the sink thread, messages are queued from now on
+ * \param[in] fd where the lines go, e.g. STDERR_FILENO
+ * \return ATCA_SUCCESS, or ATCA_GEN_FAIL if the thread did not start
+ *         (lines are then still written directly)
+ */
+ATCA_STATUS atca_log_start(int fd)
+{
+	ATCA_STATUS status = ATCA_SUCCESS;
+
+	pthread_mutex_lock(&g_mutex);
+	g_fd = fd;
+	if (!g_running) {
+		g_stop = 0;
+		if (pthread_create(&g_thread, NULL, sink_main, NULL) == 0)
+			g_running = 1;
+		else
+			status = ATCA_GEN_FAIL;
+	}
+	pthread_mutex_unlock(&g_mutex);
+	return status;
+}
+
+/** \brief writes out every queued line and stops the sink thread,
+ *         messages are written directly from then on
+ */
+void atca_log_stop(void)
+{
+	pthread_mutex_lock(&g_mutex);
+	if (!g_running || g_stop) {
+		pthread_mutex_unlock(&g_mutex);
+		return;
+	}
+	g_stop = 1;
+	pthread_cond_signal(&g_cond);
+	pthread_mutex_unlock(&g_mutex);
+	pthread_join(g_thread, NULL);
+}
+
+/** \brief returns the output counters
+ * \param[out] stats the counters
+ */
+void atca_log_get_stats(atca_log_stats *stats)
+{
+	stats->written = __atomic_load_n(&g_stats.written, __ATOMIC_RELAXED);
+	stats->dropped = __atomic_load_n(&g_stats.dropped, __ATOMIC_RELAXED);
+	stats->suppressed = __atomic_load_n(&g_stats.suppressed, __ATOMIC_RELAXED);
+}
+
+/** @} */
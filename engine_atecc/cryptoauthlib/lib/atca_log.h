@@ -0,0 +1,145 @@
+/* atca_log.h
+ *
+ * \file
+ *
+ * \brief Leveled, rate limited logging with an asynchronous buffered sink
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#ifndef ATCA_LOG_H
+#define ATCA_LOG_H
+
+#include <stdint.h>
+#include "atca_status.h"
+
+/** \defgroup log Logging (atca_log_)
+ *  \brief Messages go through ATCA_LOG() and its shorthands. A message
+ *  above the compile time cap ATCA_LOG_MAX_LEVEL is compiled out, one
+ *  above the runtime level of its category costs a load and a compare,
+ *  its arguments are not evaluated and nothing is formatted.
+ *
+ *  Kept messages are formatted into a line on the calling thread and
+ *  queued for the sink thread started by atca_log_start(), which writes
+ *  them out in batches. When the queue is full the message is dropped
+ *  and counted rather than blocking the caller. Without a sink thread
+ *  every line is written directly.
+ *
+ *  Warnings and errors are rate limited per call site: at most
+ *  ATCA_LOG_BURST per second, the rest are counted and reported with
+ *  the next message of that site that gets through.
+   @{ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ATCA_LOG_NONE           (0)
+#define ATCA_LOG_ERROR          (1)
+#define ATCA_LOG_WARN           (2)
+#define ATCA_LOG_INFO           (3)
+#define ATCA_LOG_DEBUG          (4)
+
+/** \brief highest level compiled in, debug builds keep everything */
+#ifndef ATCA_LOG_MAX_LEVEL
+#if defined(ECC_DEBUG) || defined(KIT_DEBUG)
+#define ATCA_LOG_MAX_LEVEL      ATCA_LOG_DEBUG
+#else
+#define ATCA_LOG_MAX_LEVEL      ATCA_LOG_ERROR
+#endif
+#endif
+
+/** \brief runtime level of every category until configured */
+#define ATCA_LOG_DEFAULT_LEVEL  ATCA_LOG_WARN
+
+#define ATCA_LOG_LINE_MAX       (256)   //!< Longer messages are cut
+#define ATCA_LOG_QUEUE_LINES    (512)   //!< Lines the sink queue holds
+#define ATCA_LOG_BURST          (10)    //!< Warnings and errors per second per call site
+
+typedef enum {
+	ATCA_LOG_ENGINE,        //!< OpenSSL engine
+	ATCA_LOG_ATCAB,         //!< Device commands
+	ATCA_LOG_HAL,           //!< Kit protocol and physical interface
+	ATCA_LOG_CERT,          //!< Certificate rebuild, cache and extraction
+	ATCA_LOG_CATEGORIES
+} atca_log_category_t;
+
+/** \brief rate limiting state of one call site, zero initialized */
+typedef struct {
+	uint64_t window_us;     //!< Start of the current one second window
+	uint32_t count;         //!< Messages in the current window
+	uint32_t suppressed;    //!< Messages dropped since the last one written
+} atca_log_site;
+
+typedef struct {
+	uint64_t written;       //!< Lines handed to the output
+	uint64_t dropped;       //!< Lines lost to a full queue
+	uint64_t suppressed;    //!< Messages held back by the rate limit
+} atca_log_stats;
+
+extern int atca_log_levels[ATCA_LOG_CATEGORIES];
+
+void atca_log_emit(atca_log_site *site, atca_log_category_t cat, int level, const char *fmt, ...)
+__attribute__((format(printf, 4, 5)));
+void atca_log_set_level(atca_log_category_t cat, int level);
+ATCA_STATUS atca_log_configure(const char *spec);
+ATCA_STATUS atca_log_start(int fd);
+void atca_log_stop(void);
+void atca_log_get_stats(atca_log_stats *stats);
+
+#define atca_log_enabled(cat, level) \
+	((level) <= ATCA_LOG_MAX_LEVEL && (level) <= __atomic_load_n(&atca_log_levels[(cat)], __ATOMIC_RELAXED))
+
+/** \brief logs a printf style message of a category at a level */
+#define ATCA_LOG(cat, level, ...) \
+	do { \
+		if (atca_log_enabled((cat), (level))) { \
+			static atca_log_site atca_log_site_; \
+			atca_log_emit(&atca_log_site_, (cat), (level), __VA_ARGS__); \
+		} \
+	} while (0)
+
+#define ATCA_LOG_E(cat, ...)    ATCA_LOG((cat), ATCA_LOG_ERROR, __VA_ARGS__)
+#define ATCA_LOG_W(cat, ...)    ATCA_LOG((cat), ATCA_LOG_WARN, __VA_ARGS__)
+#define ATCA_LOG_I(cat, ...)    ATCA_LOG((cat), ATCA_LOG_INFO, __VA_ARGS__)
+#define ATCA_LOG_D(cat, ...)    ATCA_LOG((cat), ATCA_LOG_DEBUG, __VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+/** @} */
+#endif
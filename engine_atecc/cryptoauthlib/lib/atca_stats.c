@@ -0,0 +1,301 @@
+/**
+ * \file
+ *
+ * \brief  Per command latency and error counters of the device interface
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include "atca_stats.h"
+#include "atca_command.h"
+#include "atca_deadline.h"
+
+/** \defgroup stats Device statistics (atca_stats_)
+   @{ */
+
+/* Commands are serialized on the device, so relaxed atomics on one set of
+ * counters never contend. Only the command in flight is per thread: the
+ * time it was sent and its transport time so far.
+ */
+
+typedef struct {
+	int pending;
+	atca_stats_command_t command;
+	uint64_t sent_us;
+	uint64_t transport_us;
+} atca_stats_inflight;
+
+static atca_stats g_stats;
+static __thread atca_stats_inflight g_inflight;
+
+static const char* const g_command_names[ATCA_STATS_COMMANDS] = {
+	"random", "nonce", "genkey", "sign", "verify", "ecdh", "read", "write", "gendig", "sha", "other"
+};
+
+#define ATCA_STATS_ADD(field, n)    __atomic_add_fetch(&(field), (n), __ATOMIC_RELAXED)
+
+static unsigned atca_stats_bucket(uint64_t us)
+{
+	unsigned bucket = us ? 64 - __builtin_clzll(us) : 0;
+
+	return bucket < ATCA_STATS_BUCKETS ? bucket : ATCA_STATS_BUCKETS - 1;
+}
+
+static void atca_stats_complete(uint64_t wait_us, int error, ATCA_STATUS status)
+{
+	atca_stats_command *cmd = &g_stats.command[g_inflight.command];
+
+	ATCA_STATS_ADD(cmd->count, 1);
+	if (error) {
+		ATCA_STATS_ADD(cmd->errors, 1);
+	}
+	if (atca_status_is_timeout(status)) {
+		ATCA_STATS_ADD(cmd->timeouts, 1);
+	}
+	ATCA_STATS_ADD(cmd->transport_us, g_inflight.transport_us);
+	ATCA_STATS_ADD(cmd->transport_hist[atca_stats_bucket(g_inflight.transport_us)], 1);
+	ATCA_STATS_ADD(cmd->wait_us, wait_us);
+	ATCA_STATS_ADD(cmd->wait_hist[atca_stats_bucket(wait_us)], 1);
+	g_inflight.pending = 0;
+}
+
+/** \brief monotonic time for the interface timings
+ * \return microseconds since an arbitrary start
+ */
+uint64_t atca_stats_now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/** \brief name of a command counter, as in atca_stats_print()
+ * \param[in] command counter index
+ * \return name, "other" for an unknown index
+ */
+const char* atca_stats_command_name(atca_stats_command_t command)
+{
+	return command < ATCA_STATS_COMMANDS ? g_command_names[command] : g_command_names[ATCA_STATS_OTHER];
+}
+
+/** \brief maps a command op-code to its counters
+ * \param[in] opcode command op-code, e.g. ATCA_SIGN
+ * \return counter index
+ */
+atca_stats_command_t atca_stats_command_of(uint8_t opcode)
+{
+	switch (opcode) {
+	case ATCA_RANDOM:   return ATCA_STATS_RANDOM;
+	case ATCA_NONCE:    return ATCA_STATS_NONCE;
+	case ATCA_GENKEY:   return ATCA_STATS_GENKEY;
+	case ATCA_SIGN:     return ATCA_STATS_SIGN;
+	case ATCA_VERIFY:   return ATCA_STATS_VERIFY;
+	case ATCA_ECDH:     return ATCA_STATS_ECDH;
+	case ATCA_READ:     return ATCA_STATS_READ;
+	case ATCA_WRITE:    return ATCA_STATS_WRITE;
+	case ATCA_GENDIG:   return ATCA_STATS_GENDIG;
+	case ATCA_SHA:      return ATCA_STATS_SHA;
+	default:            return ATCA_STATS_OTHER;
+	}
+}
+
+/** \brief records a command sent by atsend(), a failed send
+ *         completes the command with an error
+ * \param[in] opcode command op-code
+ * \param[in] start_us atca_stats_now_us() before the send
+ * \param[in] status result of the send
+ */
+void atca_stats_sent(uint8_t opcode, uint64_t start_us, ATCA_STATUS status)
+{
+	uint64_t now_us = atca_stats_now_us();
+
+	g_inflight.pending = 1;
+	g_inflight.command = atca_stats_command_of(opcode);
+	g_inflight.sent_us = now_us;
+	g_inflight.transport_us = now_us - start_us;
+	if (status != ATCA_SUCCESS) {
+		atca_stats_complete(0, 1, status);
+	}
+}
+
+/** \brief completes the command of atca_stats_sent() with the
+ *         response read by atreceive(). Responses that do not
+ *         follow a command of this thread are not counted.
+ * \param[in] rxdata response packet, count byte first
+ * \param[in] start_us atca_stats_now_us() before the receive
+ * \param[in] status result of the receive
+ */
+void atca_stats_received(const uint8_t *rxdata, uint64_t start_us, ATCA_STATUS status)
+{
+	int error = status != ATCA_SUCCESS;
+
+	if (!g_inflight.pending) {
+		return;
+	}
+	// A 4 byte response is a status byte, non zero for a device error
+	if (!error && rxdata && rxdata[0] == 4 && rxdata[1] != 0x00) {
+		error = 1;
+	}
+	g_inflight.transport_us += atca_stats_now_us() - start_us;
+	atca_stats_complete(start_us - g_inflight.sent_us, error, status);
+}
+
+/** \brief counts a wake and whether it failed
+ * \param[in] status result of the wake
+ */
+void atca_stats_wake(ATCA_STATUS status)
+{
+	ATCA_STATS_ADD(g_stats.wakes, 1);
+	if (status != ATCA_SUCCESS) {
+		ATCA_STATS_ADD(g_stats.wake_errors, 1);
+	}
+}
+
+/** \brief counts an idle */
+void atca_stats_idle(void)
+{
+	ATCA_STATS_ADD(g_stats.idles, 1);
+}
+
+/** \brief counts a sleep */
+void atca_stats_sleep(void)
+{
+	ATCA_STATS_ADD(g_stats.sleeps, 1);
+}
+
+/** \brief counts an interface (re)initialization */
+void atca_stats_init(void)
+{
+	ATCA_STATS_ADD(g_stats.inits, 1);
+}
+
+/** \brief snapshot of the counters, each counter is read atomically
+ * \param[out] stats counters of all threads
+ */
+void atca_stats_get(atca_stats *stats)
+{
+	const uint64_t *src = (const uint64_t*)&g_stats;
+	uint64_t *dst = (uint64_t*)stats;
+	size_t i;
+
+	// atca_stats is made of uint64_t only
+	for (i = 0; i < sizeof(atca_stats) / sizeof(uint64_t); i++) {
+		dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+	}
+}
+
+/** \brief clears the counters */
+void atca_stats_reset(void)
+{
+	uint64_t *dst = (uint64_t*)&g_stats;
+	size_t i;
+
+	for (i = 0; i < sizeof(atca_stats) / sizeof(uint64_t); i++) {
+		__atomic_store_n(&dst[i], 0, __ATOMIC_RELAXED);
+	}
+}
+
+// Appends to buf at len like snprintf(), len keeps growing once buf is full
+static int atca_stats_append(char *buf, size_t size, int len, const char *fmt, ...)
+{
+	size_t off = (size_t)len < size ? (size_t)len : size;
+	va_list args;
+	int n;
+
+	va_start(args, fmt);
+	n = vsnprintf(buf + off, size - off, fmt, args);
+	va_end(args);
+	return n < 0 ? len : len + n;
+}
+
+static int atca_stats_append_hist(char *buf, size_t size, int len, const char *name, const char *kind,
+                                  const uint64_t *hist)
+{
+	int i;
+
+	len = atca_stats_append(buf, size, len, "%s.%s_hist", name, kind);
+	for (i = 0; i < ATCA_STATS_BUCKETS; i++) {
+		len = atca_stats_append(buf, size, len, "%c%llu", i ? ',' : ' ', (unsigned long long)hist[i]);
+	}
+	return atca_stats_append(buf, size, len, "\n");
+}
+
+/** \brief prints the counters as "name value" lines for scraping,
+ *         commands that were never sent are left out. The
+ *         histograms are ATCA_STATS_BUCKETS comma separated counts.
+ * \param[in] stats counters from atca_stats_get()
+ * \param[out] buf output, always terminated if size > 0
+ * \param[in] size size of buf
+ * \return length of the whole text like snprintf(), it was cut
+ *         short if not below size
+ */
+int atca_stats_print(const atca_stats *stats, char *buf, size_t size)
+{
+	const atca_stats_command *cmd;
+	const char *name;
+	int len = 0;
+	int i;
+
+	len = atca_stats_append(buf, size, len, "wake.count %llu\nwake.errors %llu\nidle.count %llu\n"
+	                        "sleep.count %llu\ninit.count %llu\n",
+	                        (unsigned long long)stats->wakes, (unsigned long long)stats->wake_errors,
+	                        (unsigned long long)stats->idles, (unsigned long long)stats->sleeps,
+	                        (unsigned long long)stats->inits);
+	for (i = 0; i < ATCA_STATS_COMMANDS; i++) {
+		cmd = &stats->command[i];
+		if (cmd->count == 0) {
+			continue;
+		}
+		name = atca_stats_command_name((atca_stats_command_t)i);
+		len = atca_stats_append(buf, size, len, "%s.count %llu\n%s.errors %llu\n%s.timeouts %llu\n"
+		                        "%s.transport_us %llu\n%s.wait_us %llu\n",
+		                        name, (unsigned long long)cmd->count, name, (unsigned long long)cmd->errors,
+		                        name, (unsigned long long)cmd->timeouts,
+		                        name, (unsigned long long)cmd->transport_us,
+		                        name, (unsigned long long)cmd->wait_us);
+		len = atca_stats_append_hist(buf, size, len, name, "transport", cmd->transport_hist);
+		len = atca_stats_append_hist(buf, size, len, name, "wait", cmd->wait_hist);
+	}
+	return len;
+}
+
+/** @} */
@@ -0,0 +1,122 @@
+/* atca_stats.h
+ *
+ * \file
+ *
+ * \brief  Per command latency and error counters of the device interface
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#ifndef ATCA_STATS_H
+#define ATCA_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "atca_status.h"
+
+/** \defgroup stats Device statistics (atca_stats_)
+ *  \brief Counts and times every command that goes through ATCAIface.
+ *
+ *  Transport time is spent inside atsend() and atreceive(), execution wait
+ *  is the host side gap between the two, usually the atca_delay_ms() for the
+ *  command's execution time. The kit protocol waits for the device inside
+ *  atreceive(), so over a kit that time shows up as transport.
+ *
+ *  Histogram bucket 0 counts latencies under 1 us, bucket i latencies from
+ *  2^(i-1) us up to 2^i us, the last bucket everything longer.
+   @{ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ATCA_STATS_BUCKETS      (20)
+
+typedef enum {
+	ATCA_STATS_RANDOM,
+	ATCA_STATS_NONCE,
+	ATCA_STATS_GENKEY,
+	ATCA_STATS_SIGN,
+	ATCA_STATS_VERIFY,
+	ATCA_STATS_ECDH,
+	ATCA_STATS_READ,
+	ATCA_STATS_WRITE,
+	ATCA_STATS_GENDIG,
+	ATCA_STATS_SHA,
+	ATCA_STATS_OTHER,       //!< Any other op-code
+	ATCA_STATS_COMMANDS
+} atca_stats_command_t;
+
+typedef struct {
+	uint64_t count;
+	uint64_t errors;                                //!< Interface errors and device error status
+	uint64_t timeouts;                              //!< Errors that were a deadline expiring, see atca_deadline.h
+	uint64_t transport_us;                          //!< Sum of the transport times
+	uint64_t wait_us;                               //!< Sum of the execution waits
+	uint64_t transport_hist[ATCA_STATS_BUCKETS];
+	uint64_t wait_hist[ATCA_STATS_BUCKETS];
+} atca_stats_command;
+
+typedef struct {
+	atca_stats_command command[ATCA_STATS_COMMANDS];
+	uint64_t wakes;
+	uint64_t wake_errors;
+	uint64_t idles;
+	uint64_t sleeps;
+	uint64_t inits;                                 //!< Interface (re)initializations
+} atca_stats;
+
+const char* atca_stats_command_name(atca_stats_command_t command);
+atca_stats_command_t atca_stats_command_of(uint8_t opcode);
+
+void atca_stats_sent(uint8_t opcode, uint64_t start_us, ATCA_STATUS status);
+void atca_stats_received(const uint8_t *rxdata, uint64_t start_us, ATCA_STATUS status);
+void atca_stats_wake(ATCA_STATUS status);
+void atca_stats_idle(void);
+void atca_stats_sleep(void);
+void atca_stats_init(void);
+uint64_t atca_stats_now_us(void);
+
+void atca_stats_get(atca_stats *stats);
+void atca_stats_reset(void);
+int atca_stats_print(const atca_stats *stats, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+/** @} */
+#endif
@@ -0,0 +1,155 @@
+/**
+ * \file
+ *
+ * \brief  Ring buffer of timestamped device and engine events
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "atca_trace.h"
+#include "atca_stats.h"
+
+/** \defgroup trace Event trace (atca_trace_)
+   @{ */
+
+/* Writers claim a slot with one atomic add on the head and publish it by
+ * storing its sequence (index + 1) last, readers skip any slot whose
+ * sequence is not the one they expect before and after the copy, i.e.
+ * slots still being written or already reused by a newer event.
+ */
+
+typedef struct {
+	uint64_t seq;           //!< Index + 1 once written, 0 while being written
+	uint64_t ts_us;
+	const char *cat;
+	const char *name;
+	uint32_t tid;
+	uint32_t arg;
+	char phase;             //!< 'B' or 'E'
+} atca_trace_event;
+
+int atca_trace_on = 0;
+
+static atca_trace_event g_ring[ATCA_TRACE_RING_SIZE];
+static uint64_t g_head;
+static uint64_t g_start;    //!< First index after the last atca_trace_clear()
+static __thread uint32_t g_tid;
+
+/** \brief records one event, call it through ATCA_TRACE_BEGIN(),
+ *         ATCA_TRACE_END() or ATCA_TRACE_SCOPE()
+ * \param[in] phase 'B' for begin, 'E' for end
+ * \param[in] cat category, a string literal
+ * \param[in] name event name, a string literal
+ * \param[in] arg event argument, e.g. the command op-code
+ */
+void atca_trace_record(char phase, const char *cat, const char *name, uint32_t arg)
+{
+	uint64_t ts_us = atca_stats_now_us();
+	uint64_t idx = __atomic_fetch_add(&g_head, 1, __ATOMIC_RELAXED);
+	atca_trace_event *ev = &g_ring[idx & (ATCA_TRACE_RING_SIZE - 1)];
+
+	if (g_tid == 0) {
+		g_tid = (uint32_t)syscall(SYS_gettid);
+	}
+	__atomic_store_n(&ev->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	ev->ts_us = ts_us;
+	ev->cat = cat;
+	ev->name = name;
+	ev->tid = g_tid;
+	ev->arg = arg;
+	ev->phase = phase;
+	__atomic_store_n(&ev->seq, idx + 1, __ATOMIC_RELEASE);
+}
+
+/** \brief switches recording on or off, the ring is kept
+ * \param[in] on non zero to record
+ */
+void atca_trace_enable(int on)
+{
+	__atomic_store_n(&atca_trace_on, on ? 1 : 0, __ATOMIC_RELAXED);
+}
+
+/** \brief forgets the events recorded so far */
+void atca_trace_clear(void)
+{
+	__atomic_store_n(&g_start, __atomic_load_n(&g_head, __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+}
+
+/** \brief writes the events in the ring as Chrome trace event JSON,
+ *         which chrome://tracing and Perfetto open. Recording may go
+ *         on meanwhile.
+ * \param[in] fp output file
+ * \return number of events written
+ */
+int atca_trace_write_chrome(FILE *fp)
+{
+	uint64_t head = __atomic_load_n(&g_head, __ATOMIC_ACQUIRE);
+	uint64_t start = __atomic_load_n(&g_start, __ATOMIC_RELAXED);
+	uint64_t idx;
+	atca_trace_event *slot;
+	atca_trace_event ev;
+	int pid = (int)getpid();
+	int count = 0;
+
+	if (head - start > ATCA_TRACE_RING_SIZE) {
+		start = head - ATCA_TRACE_RING_SIZE;
+	}
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	for (idx = start; idx < head; idx++) {
+		slot = &g_ring[idx & (ATCA_TRACE_RING_SIZE - 1)];
+		if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != idx + 1) {
+			continue;
+		}
+		ev = *slot;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != idx + 1) {
+			continue;
+		}
+		fprintf(fp, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":%d,\"tid\":%u,"
+		        "\"args\":{\"arg\":%u}}", count ? "," : "", ev.name, ev.cat, ev.phase,
+		        (unsigned long long)ev.ts_us, pid, ev.tid, ev.arg);
+		count++;
+	}
+	fprintf(fp, "\n]}\n");
+	return count;
+}
+
+/** @} */
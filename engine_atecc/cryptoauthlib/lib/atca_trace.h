@@ -0,0 +1,119 @@
+/* atca_trace.h
+ *
+ * \file
+ *
+ * \brief  Ring buffer of timestamped device and engine events
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#ifndef ATCA_TRACE_H
+#define ATCA_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** \defgroup trace Event trace (atca_trace_)
+ *  \brief Begin and end events of device commands, interface calls, delays
+ *  and engine callbacks, kept in a fixed ring of the last
+ *  ATCA_TRACE_RING_SIZE events. Recording takes no lock and allocates
+ *  nothing, and costs one load while tracing is off.
+ *
+ *  Event names and categories must be string literals, only the pointers
+ *  are stored.
+   @{ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ATCA_TRACE_RING_SIZE    (8192)      //!< Events kept, a power of two
+
+extern int atca_trace_on;
+
+void atca_trace_record(char phase, const char *cat, const char *name, uint32_t arg);
+void atca_trace_enable(int on);
+void atca_trace_clear(void);
+int atca_trace_write_chrome(FILE *fp);
+
+#define atca_trace_enabled()    __atomic_load_n(&atca_trace_on, __ATOMIC_RELAXED)
+
+/** \brief begin event, nothing if tracing is off */
+#define ATCA_TRACE_BEGIN(cat, name, arg) \
+	do { if (atca_trace_enabled()) atca_trace_record('B', (cat), (name), (arg)); } while (0)
+
+/** \brief end event, nothing if tracing is off */
+#define ATCA_TRACE_END(cat, name, arg) \
+	do { if (atca_trace_enabled()) atca_trace_record('E', (cat), (name), (arg)); } while (0)
+
+typedef struct {
+	const char *cat;
+	const char *name;
+} atca_trace_scope;
+
+static inline atca_trace_scope atca_trace_scope_begin(const char *cat, const char *name)
+{
+	atca_trace_scope scope = { NULL, NULL };
+
+	if (atca_trace_enabled()) {
+		atca_trace_record('B', cat, name, 0);
+		scope.cat = cat;
+		scope.name = name;
+	}
+	return scope;
+}
+
+static inline void atca_trace_scope_end(atca_trace_scope *scope)
+{
+	if (scope->name) {
+		atca_trace_record('E', scope->cat, scope->name, 0);
+	}
+}
+
+/** \brief begin event now and the matching end event when the enclosing
+ *         block is left, whichever return it takes. Declare it first in
+ *         the block, once per block.
+ */
+#define ATCA_TRACE_SCOPE(cat, name) \
+	atca_trace_scope atca_trace_scope_ __attribute__((cleanup(atca_trace_scope_end))) = \
+		atca_trace_scope_begin((cat), (name))
+
+#ifdef __cplusplus
+}
+#endif
+/** @} */
+#endif
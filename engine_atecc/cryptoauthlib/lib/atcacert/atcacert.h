@@ -73,6 +73,7 @@
 #define ATCACERT_E_BAD_CERT             10  //!< Certificate structure is bad in some way.
 #define ATCACERT_E_WRONG_CERT_DEF       11
 #define ATCACERT_E_VERIFY_FAILED        12  //!< Certificate or challenge/response verification failed.
+#define ATCACERT_E_BAD_CHALLENGE        13  //!< Challenge is unknown, expired, or has already been answered.
 
 /** @} */
 #endif
\ No newline at end of file
@@ -67,32 +67,51 @@ int atcacert_read_cert( const atcacert_def_t* cert_def,
 	if (ret != ATCACERT_E_SUCCESS)
 		return ret;
 
+	// Combine and order the reads so they can all run in a single wake window
+	ret = atcacert_plan_device_reads(device_locs, &device_locs_count, 32);
+	if (ret != ATCACERT_E_SUCCESS)
+		return ret;
+
 	ret = atcacert_cert_build_start(&build_state, cert_def, cert, cert_size, ca_public_key);
 	if (ret != ATCACERT_E_SUCCESS)
 		return ret;
 
+	ret = atcab_wake_hold();
+	if (ret != ATCA_SUCCESS)
+		return ret;
+
 	for (i = 0; i < device_locs_count; i++) {
 		uint8_t data[416];
 		if (device_locs[i].zone == DEVZONE_DATA && device_locs[i].is_genkey) {
 			ret = atcab_get_pubkey(device_locs[i].slot, data);
 			if (ret != ATCA_SUCCESS)
-				return ret;
+				break;
 		}else  {
 			size_t start_block = device_locs[i].offset / 32;
 			uint8_t block;
 			size_t end_block = (device_locs[i].offset + device_locs[i].count) / 32;
+			if (device_locs[i].count > sizeof(data)) {
+				ret = ATCACERT_E_BAD_CERT;
+				break;
+			}
 			for (block = (uint8_t)start_block; block < end_block; block++) {
 				ret = atcab_read_zone(device_locs[i].zone, device_locs[i].slot, block, 0, &data[block * 32 - device_locs[i].offset], 32);
 				if (ret != ATCA_SUCCESS)
-					return ret;
+					break;
 			}
+			if (ret != ATCA_SUCCESS)
+				break;
 		}
 
 		ret = atcacert_cert_build_process(&build_state, &device_locs[i], data);
 		if (ret != ATCACERT_E_SUCCESS)
-			return ret;
+			break;
 	}
 
+	atcab_wake_release();
+	if (ret != ATCACERT_E_SUCCESS)
+		return ret;
+
 	ret = atcacert_cert_build_finish(&build_state);
 	if (ret != ATCACERT_E_SUCCESS)
 		return ret;
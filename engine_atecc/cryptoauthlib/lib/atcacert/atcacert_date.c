@@ -92,6 +92,77 @@ int atcacert_date_dec( atcacert_date_format_t  format,
 	return ATCACERT_E_SUCCESS;
 }
 
+typedef int (*atcacert_date_enc_func)(const atcacert_tm_utc_t* timestamp, uint8_t* formatted_date);
+typedef int (*atcacert_date_dec_func)(const uint8_t* formatted_date, atcacert_tm_utc_t* timestamp);
+
+static const atcacert_date_enc_func ATCACERT_DATE_ENC_FUNCS[] = {
+	atcacert_date_enc_iso8601_sep,
+	atcacert_date_enc_rfc5280_utc,
+	atcacert_date_enc_posix_uint32_be,
+	atcacert_date_enc_posix_uint32_le,
+	atcacert_date_enc_rfc5280_gen
+};
+
+static const atcacert_date_dec_func ATCACERT_DATE_DEC_FUNCS[] = {
+	atcacert_date_dec_iso8601_sep,
+	atcacert_date_dec_rfc5280_utc,
+	atcacert_date_dec_posix_uint32_be,
+	atcacert_date_dec_posix_uint32_le,
+	atcacert_date_dec_rfc5280_gen
+};
+
+int atcacert_date_enc_batch( atcacert_date_format_t    format,
+                             const atcacert_tm_utc_t*  timestamps,
+                             size_t                    count,
+                             uint8_t*                  formatted_dates)
+{
+	int ret = 0;
+	size_t i;
+	size_t date_size;
+	atcacert_date_enc_func enc_func;
+
+	if (timestamps == NULL || formatted_dates == NULL || format < 0 || format >= sizeof(ATCACERT_DATE_ENC_FUNCS) / sizeof(ATCACERT_DATE_ENC_FUNCS[0]))
+		return ATCACERT_E_BAD_PARAMS;
+
+	// Resolve the format once for the whole batch
+	enc_func = ATCACERT_DATE_ENC_FUNCS[format];
+	date_size = ATCACERT_DATE_FORMAT_SIZES[format];
+
+	for (i = 0; i < count; i++) {
+		ret = enc_func(&timestamps[i], &formatted_dates[i * date_size]);
+		if (ret != ATCACERT_E_SUCCESS)
+			return ret;
+	}
+
+	return ATCACERT_E_SUCCESS;
+}
+
+int atcacert_date_dec_batch( atcacert_date_format_t  format,
+                             const uint8_t*          formatted_dates,
+                             size_t                  count,
+                             atcacert_tm_utc_t*      timestamps)
+{
+	int ret = 0;
+	size_t i;
+	size_t date_size;
+	atcacert_date_dec_func dec_func;
+
+	if (formatted_dates == NULL || timestamps == NULL || format < 0 || format >= sizeof(ATCACERT_DATE_DEC_FUNCS) / sizeof(ATCACERT_DATE_DEC_FUNCS[0]))
+		return ATCACERT_E_BAD_PARAMS;
+
+	// Resolve the format once for the whole batch
+	dec_func = ATCACERT_DATE_DEC_FUNCS[format];
+	date_size = ATCACERT_DATE_FORMAT_SIZES[format];
+
+	for (i = 0; i < count; i++) {
+		ret = dec_func(&formatted_dates[i * date_size], &timestamps[i]);
+		if (ret != ATCACERT_E_SUCCESS)
+			return ret;
+	}
+
+	return ATCACERT_E_SUCCESS;
+}
+
 int atcacert_date_get_max_date( atcacert_date_format_t format, atcacert_tm_utc_t* timestamp )
 {
     
@@ -151,72 +222,79 @@ int atcacert_date_get_max_date( atcacert_date_format_t format, atcacert_tm_utc_t
 }
 
 /**
- * \brief Convert an unsigned integer to a zero padded string with no terminating null.
+ * \brief Two character ASCII decimal representation of 0 through 99, used to format two digits
+ *        per lookup instead of one division per digit.
  */
-static uint8_t* uint_to_str(uint32_t num, int width, uint8_t* str)
+static const uint8_t DEC_DIGIT_PAIRS[200] = {
+	'0','0', '0','1', '0','2', '0','3', '0','4', '0','5', '0','6', '0','7', '0','8', '0','9',
+	'1','0', '1','1', '1','2', '1','3', '1','4', '1','5', '1','6', '1','7', '1','8', '1','9',
+	'2','0', '2','1', '2','2', '2','3', '2','4', '2','5', '2','6', '2','7', '2','8', '2','9',
+	'3','0', '3','1', '3','2', '3','3', '3','4', '3','5', '3','6', '3','7', '3','8', '3','9',
+	'4','0', '4','1', '4','2', '4','3', '4','4', '4','5', '4','6', '4','7', '4','8', '4','9',
+	'5','0', '5','1', '5','2', '5','3', '5','4', '5','5', '5','6', '5','7', '5','8', '5','9',
+	'6','0', '6','1', '6','2', '6','3', '6','4', '6','5', '6','6', '6','7', '6','8', '6','9',
+	'7','0', '7','1', '7','2', '7','3', '7','4', '7','5', '7','6', '7','7', '7','8', '7','9',
+	'8','0', '8','1', '8','2', '8','3', '8','4', '8','5', '8','6', '8','7', '8','8', '8','9',
+	'9','0', '9','1', '9','2', '9','3', '9','4', '9','5', '9','6', '9','7', '9','8', '9','9'
+};
+
+/**
+ * \brief Convert an unsigned integer (0 to 99) to a zero padded two digit string with no
+ *        terminating null.
+ */
+static uint8_t* uint_to_str2(uint32_t num, uint8_t* str)
 {
-	uint8_t* ret = str + width;
-	int i;
+	const uint8_t* pair = &DEC_DIGIT_PAIRS[num * 2];
 
-	// Pre-fill the string width with zeros
-	for (i = 0; i < width; i++)
-		*(str++) = '0';
-	// Convert the number from right to left
-	for (; num; num /= 10)
-		*(--str) = '0' + (num % 10);
+	str[0] = pair[0];
+	str[1] = pair[1];
 
-	return ret;
+	return str + 2;
 }
 
 /**
- * \brief Convert a number string as a zero padded unsigned integer back into a number
+ * \brief Convert an unsigned integer (0 to 9999) to a zero padded four digit string with no
+ *        terminating null.
  */
-static const uint8_t* str_to_uint(const uint8_t* str, int width, uint32_t* num)
+static uint8_t* uint_to_str4(uint32_t num, uint8_t* str)
 {
-	const uint8_t* error_ret = str;
-	const uint8_t* good_ret = str + width;
-	uint32_t prev_num = 0;
-	uint32_t digit_value = 1;
-	int digit;
-
-	str += width - 1;
-	*num = 0;
-	for (digit = 0; digit < width; digit++) {
-		if (*str < '0' || *str > '9')
-			return error_ret; // Character is not a digit
-		if (digit >= 10) {
-			if (*str != '0')
-				return error_ret; // Number is larger than the output can handle
-			continue;
-		}
-		if (digit == 9 && *str > '4')
-			return error_ret; // Number is larger than the output can handle
+	return uint_to_str2(num % 100, uint_to_str2(num / 100, str));
+}
 
-		*num += digit_value * (*str - '0');
-		if (*num < prev_num)
-			return error_ret; // Number rolled over, it is larger than the output can handle
+/**
+ * \brief Convert a two digit number string back into a number.
+ *
+ * \return Position after the digits on success, str if either character isn't a digit.
+ */
+static const uint8_t* str2_to_int(const uint8_t* str, int* num)
+{
+	uint32_t d1 = (uint32_t)str[0] - '0';
+	uint32_t d0 = (uint32_t)str[1] - '0';
 
-		digit_value *= 10;
-		prev_num = *num;
-		str--;
-	}
+	if ((d1 > 9) | (d0 > 9))
+		return str; // Character is not a digit
+
+	*num = (int)(d1 * 10 + d0);
 
-	return good_ret;
+	return str + 2;
 }
 
 /**
- * \brief Convert a number string as a zero padded unsigned integer back into a number constrained
- *        to an integer's size.
+ * \brief Convert a four digit number string back into a number.
+ *
+ * \return Position after the digits on success, str if any character isn't a digit.
  */
-static const uint8_t* str_to_int(const uint8_t* str, int width, int* num)
+static const uint8_t* str4_to_int(const uint8_t* str, int* num)
 {
-	uint32_t unum = 0;
-	const uint8_t* ret = str_to_uint(str, width, &unum);
+	int hi = 0;
+	int lo = 0;
+
+	if (str2_to_int(str, &hi) == str || str2_to_int(str + 2, &lo) == str + 2)
+		return str; // Character is not a digit
+
+	*num = hi * 100 + lo;
 
-	if (ret != str && unum > 2147483647UL)
-		ret = str; // Number exceeds int32's range
-	*num = (int)unum;
-	return ret;
+	return str + 4;
 }
 
 int atcacert_date_enc_iso8601_sep( const atcacert_tm_utc_t*  timestamp,
@@ -232,37 +310,37 @@ int atcacert_date_enc_iso8601_sep( const atcacert_tm_utc_t*  timestamp,
 
 	if (year < 0 || year > 9999)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(year, 4, cur_pos);
+	cur_pos = uint_to_str4(year, cur_pos);
 
 	*(cur_pos++) = '-';
 
 	if (timestamp->tm_mon < 0 || timestamp->tm_mon > 11)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_mon + 1, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_mon + 1, cur_pos);
 
 	*(cur_pos++) = '-';
 
 	if (timestamp->tm_mday < 1 || timestamp->tm_mday > 31)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_mday, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_mday, cur_pos);
 
 	*(cur_pos++) = 'T';
 
 	if (timestamp->tm_hour < 0 || timestamp->tm_hour > 23)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_hour, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_hour, cur_pos);
 
 	*(cur_pos++) = ':';
 
 	if (timestamp->tm_min < 0 || timestamp->tm_min > 59)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_min, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_min, cur_pos);
 
 	*(cur_pos++) = ':';
 
 	if (timestamp->tm_sec < 0 || timestamp->tm_sec > 59)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_sec, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_sec, cur_pos);
 
 	*(cur_pos++) = 'Z';
 
@@ -280,7 +358,7 @@ int atcacert_date_dec_iso8601_sep( const uint8_t       formatted_date[DATEFMT_IS
 
 	memset(timestamp, 0, sizeof(*timestamp));
 
-	new_pos = str_to_int(cur_pos, 4, &timestamp->tm_year);
+	new_pos = str4_to_int(cur_pos, &timestamp->tm_year);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
@@ -289,7 +367,7 @@ int atcacert_date_dec_iso8601_sep( const uint8_t       formatted_date[DATEFMT_IS
 	if (*(cur_pos++) != '-')
 		return ATCACERT_E_DECODING_ERROR; // Unexpected separator
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_mon);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_mon);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
@@ -298,7 +376,7 @@ int atcacert_date_dec_iso8601_sep( const uint8_t       formatted_date[DATEFMT_IS
 	if (*(cur_pos++) != '-')
 		return ATCACERT_E_DECODING_ERROR; // Unexpected separator
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_mday);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_mday);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
@@ -306,7 +384,7 @@ int atcacert_date_dec_iso8601_sep( const uint8_t       formatted_date[DATEFMT_IS
 	if (*(cur_pos++) != 'T')
 		return ATCACERT_E_DECODING_ERROR; // Unexpected separator
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_hour);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_hour);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
@@ -314,7 +392,7 @@ int atcacert_date_dec_iso8601_sep( const uint8_t       formatted_date[DATEFMT_IS
 	if (*(cur_pos++) != ':')
 		return ATCACERT_E_DECODING_ERROR; // Unexpected separator
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_min);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_min);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
@@ -322,7 +400,7 @@ int atcacert_date_dec_iso8601_sep( const uint8_t       formatted_date[DATEFMT_IS
 	if (*(cur_pos++) != ':')
 		return ATCACERT_E_DECODING_ERROR; // Unexpected separator
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_sec);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_sec);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
@@ -350,27 +428,27 @@ int atcacert_date_enc_rfc5280_utc( const atcacert_tm_utc_t*  timestamp,
 		year = year - 2000;
 	else
 		return ATCACERT_E_INVALID_DATE;  // Year out of range for RFC2459 UTC format
-	cur_pos = uint_to_str(year, 2, cur_pos);
+	cur_pos = uint_to_str2(year, cur_pos);
 
 	if (timestamp->tm_mon < 0 || timestamp->tm_mon > 11)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_mon + 1, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_mon + 1, cur_pos);
 
 	if (timestamp->tm_mday < 1 || timestamp->tm_mday > 31)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_mday, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_mday, cur_pos);
 
 	if (timestamp->tm_hour < 0 || timestamp->tm_hour > 23)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_hour, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_hour, cur_pos);
 
 	if (timestamp->tm_min < 0 || timestamp->tm_min > 59)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_min, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_min, cur_pos);
 
 	if (timestamp->tm_sec < 0 || timestamp->tm_sec > 59)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_sec, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_sec, cur_pos);
 
 	*(cur_pos++) = 'Z';
 
@@ -388,7 +466,7 @@ int atcacert_date_dec_rfc5280_utc( const uint8_t       formatted_date[DATEFMT_RF
 
 	memset(timestamp, 0, sizeof(*timestamp));
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_year);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_year);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
@@ -398,28 +476,28 @@ int atcacert_date_dec_rfc5280_utc( const uint8_t       formatted_date[DATEFMT_RF
 		timestamp->tm_year += 1900;
 	timestamp->tm_year -= 1900;
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_mon);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_mon);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
 	timestamp->tm_mon -= 1;
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_mday);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_mday);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_hour);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_hour);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_min);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_min);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_sec);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_sec);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
@@ -443,27 +521,27 @@ int atcacert_date_enc_rfc5280_gen( const atcacert_tm_utc_t*  timestamp,
 
 	if (year < 0 || year > 9999)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(year, 4, cur_pos);
+	cur_pos = uint_to_str4(year, cur_pos);
 
 	if (timestamp->tm_mon < 0 || timestamp->tm_mon > 11)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_mon + 1, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_mon + 1, cur_pos);
 
 	if (timestamp->tm_mday < 1 || timestamp->tm_mday > 31)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_mday, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_mday, cur_pos);
 
 	if (timestamp->tm_hour < 0 || timestamp->tm_hour > 23)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_hour, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_hour, cur_pos);
 
 	if (timestamp->tm_min < 0 || timestamp->tm_min > 59)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_min, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_min, cur_pos);
 
 	if (timestamp->tm_sec < 0 || timestamp->tm_sec > 59)
 		return ATCACERT_E_INVALID_DATE;
-	cur_pos = uint_to_str(timestamp->tm_sec, 2, cur_pos);
+	cur_pos = uint_to_str2(timestamp->tm_sec, cur_pos);
 
 	*(cur_pos++) = 'Z';
 
@@ -481,34 +559,34 @@ int atcacert_date_dec_rfc5280_gen( const uint8_t       formatted_date[DATEFMT_RF
 
 	memset(timestamp, 0, sizeof(*timestamp));
 
-	new_pos = str_to_int(cur_pos, 4, &timestamp->tm_year);
+	new_pos = str4_to_int(cur_pos, &timestamp->tm_year);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
 	timestamp->tm_year -= 1900;
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_mon);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_mon);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
 	timestamp->tm_mon -= 1;
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_mday);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_mday);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_hour);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_hour);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_min);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_min);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
 
-	new_pos = str_to_int(cur_pos, 2, &timestamp->tm_sec);
+	new_pos = str2_to_int(cur_pos, &timestamp->tm_sec);
 	if (new_pos == cur_pos)
 		return ATCACERT_E_DECODING_ERROR; // There was a problem converting the string to a number
 	cur_pos = new_pos;
@@ -519,94 +597,68 @@ int atcacert_date_dec_rfc5280_gen( const uint8_t       formatted_date[DATEFMT_RF
 	return ATCACERT_E_SUCCESS;
 }
 
-static int is_leap_year(int year)
-{
-    return (year % 400 == 0) || ((year % 4 == 0) && (year % 100 != 0));
-}
-
-static uint32_t get_year_secs(int year)
+/**
+ * \brief Number of days from 1970-01-01 to the given civil date in the proleptic Gregorian calendar.
+ *
+ * Counts years from March so the leap day falls at the end of the year and the day of year is a
+ * closed form of the month. No per-year or per-month loops. Valid for years 1970 and later.
+ *
+ * \param[in] year  Full year (e.g. 2015).
+ * \param[in] mon   Month, 0 to 11.
+ * \param[in] mday  Day of the month, 1 to 31.
+ */
+static uint32_t days_from_civil(int year, int mon, int mday)
 {
-    if (is_leap_year(year))
-        return (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31 + 30 + 31) * 86400;
-    else
-        return (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31 + 30 + 31) * 86400;
+	uint32_t y = (uint32_t)year - (mon < 2);                            // Year starting in March
+	uint32_t era = y / 400;
+	uint32_t yoe = y - era * 400;                                       // Year of era [0, 399]
+	uint32_t mp = (uint32_t)(mon + (mon < 2 ? 10 : -2));                // Month from March [0, 11]
+	uint32_t doy = (153 * mp + 2) / 5 + (uint32_t)mday - 1;             // Day of year [0, 365]
+	uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;               // Day of era [0, 146096]
+
+	return era * 146097 + doe - 719468;                                 // 719468 days from 0000-03-01 to 1970-01-01
 }
 
-static uint32_t get_month_secs(int year, int mon)
+/**
+ * \brief Inverse of days_from_civil(). Sets tm_year, tm_mon, and tm_mday in result from a
+ *        count of days since 1970-01-01.
+ */
+static void civil_from_days(uint32_t days, atcacert_tm_utc_t* result)
 {
-    static const uint32_t month_secs[] = { 2678400, 2419200, 2678400, 2592000, 2678400, 2592000, 2678400, 2678400, 2592000, 2678400, 2592000, 2678400 };
-    if (mon == 1 && is_leap_year(year))
-        return 2505600;
-    else if (mon < 12)
-        return month_secs[mon];
-    else
-        return 0;
+	uint32_t z = days + 719468;
+	uint32_t era = z / 146097;
+	uint32_t doe = z - era * 146097;                                    // Day of era [0, 146096]
+	uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // Year of era [0, 399]
+	uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);             // Day of year from March [0, 365]
+	uint32_t mp = (5 * doy + 2) / 153;                                  // Month from March [0, 11]
+	int mon = (int)mp + (mp < 10 ? 2 : -10);
+
+	result->tm_year = (int)(yoe + era * 400) + (mon < 2) - 1900;
+	result->tm_mon = mon;
+	result->tm_mday = (int)(doy - (153 * mp + 2) / 5 + 1);
 }
 
 static atcacert_tm_utc_t *atcacert_gmtime32(const uint32_t *posix_time, atcacert_tm_utc_t *result)
 {
-    uint32_t secs_remaining = *posix_time;
-    uint32_t secs = 0;
-
-    result->tm_year = 1970;
-    result->tm_mon = 0;
-    result->tm_mday = 1;
-    result->tm_hour = 0;
-    result->tm_min = 0;
-    result->tm_sec = 0;
-
-    secs = get_year_secs(result->tm_year);
-    while (secs_remaining >= secs)
-    {
-        result->tm_year++;
-        secs_remaining -= secs;
-        secs = get_year_secs(result->tm_year);
-    }
-
-    secs = get_month_secs(result->tm_year, result->tm_mon);
-    while (secs_remaining >= secs)
-    {
-        result->tm_mon++;
-        secs_remaining -= secs;
-        secs = get_month_secs(result->tm_year, result->tm_mon);
-    }
-
-    result->tm_year -= 1900;
-
-    result->tm_mday += secs_remaining / 86400;
-    secs_remaining %= 86400;
+	uint32_t days = *posix_time / 86400;
+	uint32_t secs = *posix_time - days * 86400;
 
-    result->tm_hour += secs_remaining / 3600;
-    secs_remaining %= 3600;
+	civil_from_days(days, result);
 
-    result->tm_min += secs_remaining / 60;
-    secs_remaining %= 60;
+	result->tm_hour = (int)(secs / 3600);
+	secs -= (uint32_t)result->tm_hour * 3600;
+	result->tm_min = (int)(secs / 60);
+	result->tm_sec = (int)(secs - (uint32_t)result->tm_min * 60);
 
-    result->tm_sec += secs_remaining;
-
-    return result;
+	return result;
 }
 
 static uint32_t atcacert_mkgmtime32(const atcacert_tm_utc_t *timeptr)
 {
-    uint32_t posix_time = 0;
-    int cur_value = 0;
-    int year = timeptr->tm_year + 1900;
-
-    cur_value = year - 1;
-    while (cur_value >= 1970)
-        posix_time += get_year_secs(cur_value--);
-
-    cur_value = timeptr->tm_mon - 1;
-    while (cur_value >= 0)
-        posix_time += get_month_secs(year, cur_value--);
-
-    posix_time += (timeptr->tm_mday - 1) * 86400;
-    posix_time += timeptr->tm_hour * 3600;
-    posix_time += timeptr->tm_min * 60;
-    posix_time += timeptr->tm_sec;
-
-    return posix_time;
+	return days_from_civil(timeptr->tm_year + 1900, timeptr->tm_mon, timeptr->tm_mday) * 86400
+	       + (uint32_t)timeptr->tm_hour * 3600
+	       + (uint32_t)timeptr->tm_min * 60
+	       + (uint32_t)timeptr->tm_sec;
 }
 
 static int atcacert_date_enc_posix_uint32(const atcacert_tm_utc_t* timestamp, uint32_t* posix_uint32)
@@ -814,6 +866,8 @@ int atcacert_date_enc_compcert( const atcacert_tm_utc_t*  issue_date,
 	 *
 	 * Minutes and seconds are always zero.
 	 */
+	uint32_t packed = 0;
+
 	if (issue_date == NULL || enc_dates == NULL)
 		return ATCACERT_E_BAD_PARAMS;
 
@@ -828,15 +882,16 @@ int atcacert_date_enc_compcert( const atcacert_tm_utc_t*  issue_date,
 	if (expire_years > 31)
 		return ATCACERT_E_INVALID_DATE;
 
-	memset(enc_dates, 0, 3);
+	// Fields are already range checked, so pack all 24 bits at once and split into bytes
+	packed = ((uint32_t)(issue_date->tm_year + 1900 - 2000) << 19)
+	         | ((uint32_t)(issue_date->tm_mon + 1) << 15)
+	         | ((uint32_t)issue_date->tm_mday << 10)
+	         | ((uint32_t)issue_date->tm_hour << 5)
+	         | (uint32_t)expire_years;
 
-	enc_dates[0] = (enc_dates[0] & 0x07) | (((issue_date->tm_year + 1900 - 2000) & 0x1F) << 3);
-	enc_dates[0] = (enc_dates[0] & 0xF8) | (((issue_date->tm_mon + 1) & 0x0F) >> 1);
-	enc_dates[1] = (enc_dates[1] & 0x7F) | (((issue_date->tm_mon + 1) & 0x0F) << 7);
-	enc_dates[1] = (enc_dates[1] & 0x83) | ((issue_date->tm_mday & 0x1F) << 2);
-	enc_dates[1] = (enc_dates[1] & 0xFC) | ((issue_date->tm_hour & 0x1F) >> 3);
-	enc_dates[2] = (enc_dates[2] & 0x1F) | ((issue_date->tm_hour & 0x1F) << 5);
-	enc_dates[2] = (enc_dates[2] & 0xE0) | (expire_years & 0x1F);
+	enc_dates[0] = (uint8_t)(packed >> 16);
+	enc_dates[1] = (uint8_t)(packed >> 8);
+	enc_dates[2] = (uint8_t)packed;
 
 	return ATCACERT_E_SUCCESS;
 }
@@ -848,6 +903,7 @@ int atcacert_date_dec_compcert( const uint8_t           enc_dates[3],
 {
     int ret = ATCACERT_E_SUCCESS;
 	uint8_t expire_years = 0;
+	uint32_t packed = 0;
 
 	/*
 	 * Issue and expire dates are compressed/encoded as below
@@ -869,12 +925,14 @@ int atcacert_date_dec_compcert( const uint8_t           enc_dates[3],
 	memset(issue_date, 0, sizeof(*issue_date));
 	memset(expire_date, 0, sizeof(*expire_date));
 
-	issue_date->tm_year = (enc_dates[0] >> 3) + 2000 - 1900;
-	issue_date->tm_mon  = (((enc_dates[0] & 0x07) << 1) | ((enc_dates[1] & 0x80) >> 7)) - 1;
-	issue_date->tm_mday = ((enc_dates[1] & 0x7C) >> 2);
-	issue_date->tm_hour = ((enc_dates[1] & 0x03) << 3) | ((enc_dates[2] & 0xE0) >> 5);
+	packed = ((uint32_t)enc_dates[0] << 16) | ((uint32_t)enc_dates[1] << 8) | (uint32_t)enc_dates[2];
+
+	issue_date->tm_year = (int)(packed >> 19) + 2000 - 1900;
+	issue_date->tm_mon  = (int)((packed >> 15) & 0x0F) - 1;
+	issue_date->tm_mday = (int)((packed >> 10) & 0x1F);
+	issue_date->tm_hour = (int)((packed >> 5) & 0x1F);
 
-	expire_years = (enc_dates[2] & 0x1F);
+	expire_years = (uint8_t)(packed & 0x1F);
 
 	if (expire_years != 0) {
 		expire_date->tm_year = issue_date->tm_year + expire_years;
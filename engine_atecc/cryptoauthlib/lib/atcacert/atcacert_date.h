@@ -124,6 +124,39 @@ int atcacert_date_dec( atcacert_date_format_t  format,
                        size_t                  formatted_date_size,
                        atcacert_tm_utc_t*      timestamp);
 
+/**
+ * \brief Format an array of timestamps according to the format type. The format is resolved once
+ *        for the whole batch rather than per timestamp.
+ *
+ * \param[in]  format           Format to use.
+ * \param[in]  timestamps       Array of timestamps to format.
+ * \param[in]  count            Number of timestamps in the array.
+ * \param[out] formatted_dates  Formatted dates are returned back to back in this buffer. Must be
+ *                              at least count * ATCACERT_DATE_FORMAT_SIZES[format] bytes.
+ *
+ * \return 0 on success. Stops at the first timestamp that fails to encode.
+ */
+int atcacert_date_enc_batch( atcacert_date_format_t    format,
+                             const atcacert_tm_utc_t*  timestamps,
+                             size_t                    count,
+                             uint8_t*                  formatted_dates);
+
+/**
+ * \brief Parse an array of formatted timestamps according to the specified format.
+ *
+ * \param[in]  format           Format to parse the formatted dates as.
+ * \param[in]  formatted_dates  Formatted dates stored back to back,
+ *                              count * ATCACERT_DATE_FORMAT_SIZES[format] bytes.
+ * \param[in]  count            Number of formatted dates to parse.
+ * \param[out] timestamps       Parsed timestamps are returned in this array.
+ *
+ * \return 0 on success. Stops at the first date that fails to parse.
+ */
+int atcacert_date_dec_batch( atcacert_date_format_t  format,
+                             const uint8_t*          formatted_dates,
+                             size_t                  count,
+                             atcacert_tm_utc_t*      timestamps);
+
 /**
  * \brief Encode the issue and expire dates in the format used by the compressed certificate.
  *
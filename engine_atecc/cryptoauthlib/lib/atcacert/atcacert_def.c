@@ -58,7 +58,7 @@ int atcacert_merge_device_loc( atcacert_device_loc_t*       device_locs,
 	size_t new_offset;
 	size_t new_end;
 
-	if (device_locs == NULL || device_locs_count == NULL || device_loc == NULL || block_size <= 0)
+	if (device_locs == NULL || device_locs_count == NULL || device_loc == NULL || block_size == 0)
 		return ATCACERT_E_BAD_PARAMS;
 
 	if (device_loc->zone == DEVZONE_NONE || device_loc->count == 0)
@@ -186,6 +186,83 @@ int atcacert_get_device_locs( const atcacert_def_t*  cert_def,
 	return ATCACERT_E_SUCCESS;
 }
 
+/**
+ * \brief Orders two device locations by zone, slot, read method and offset.
+ *
+ * \return negative, zero or positive when device_loc1 sorts before, with or after device_loc2.
+ */
+static int atcacert_device_loc_cmp( const atcacert_device_loc_t* device_loc1,
+                                    const atcacert_device_loc_t* device_loc2)
+{
+	if (device_loc1->zone != device_loc2->zone)
+		return (int)device_loc1->zone - (int)device_loc2->zone;
+	if (device_loc1->zone == DEVZONE_DATA) {
+		if (device_loc1->slot != device_loc2->slot)
+			return (int)device_loc1->slot - (int)device_loc2->slot;
+		if (device_loc1->is_genkey != device_loc2->is_genkey)
+			return (int)device_loc1->is_genkey - (int)device_loc2->is_genkey;
+	}
+	return (int)device_loc1->offset - (int)device_loc2->offset;
+}
+
+int atcacert_plan_device_reads( atcacert_device_loc_t* device_locs,
+                                size_t*                device_locs_count,
+                                size_t block_size)
+{
+	size_t i = 0;
+	size_t j = 0;
+	size_t count = 0;
+	size_t offset;
+	size_t end;
+	size_t prev_end;
+	atcacert_device_loc_t device_loc;
+	atcacert_device_loc_t* prev = NULL;
+
+	if (device_locs == NULL || device_locs_count == NULL || block_size == 0)
+		return ATCACERT_E_BAD_PARAMS;
+
+	// Insertion sort, the lists are short (a few entries per certificate)
+	for (i = 1; i < *device_locs_count; i++) {
+		device_loc = device_locs[i];
+		for (j = i; j > 0 && atcacert_device_loc_cmp(&device_locs[j - 1], &device_loc) > 0; j--)
+			device_locs[j] = device_locs[j - 1];
+		device_locs[j] = device_loc;
+	}
+
+	// Align and combine neighbours from the same zone, slot and read method
+	for (i = 0; i < *device_locs_count; i++) {
+		device_loc = device_locs[i];
+		if (device_loc.zone == DEVZONE_NONE || device_loc.count == 0)
+			continue;
+
+		offset = device_loc.offset;
+		end = device_loc.offset + device_loc.count;
+		if (!(device_loc.zone == DEVZONE_DATA && device_loc.is_genkey)) {
+			// Public keys from GenKey are not read by block, leave those as is
+			offset = (offset / block_size) * block_size;
+			end = ((end + block_size - 1) / block_size) * block_size;
+		}
+
+		if (prev != NULL
+		    && prev->zone == device_loc.zone
+		    && (device_loc.zone != DEVZONE_DATA || (prev->slot == device_loc.slot && prev->is_genkey == device_loc.is_genkey))
+		    && offset <= (size_t)prev->offset + prev->count) {
+			prev_end = (size_t)prev->offset + prev->count;
+			if (end > prev_end)
+				prev->count = (uint16_t)(end - prev->offset);
+			continue;
+		}
+
+		prev = &device_locs[count++];
+		*prev = device_loc;
+		prev->offset = (uint16_t)offset;
+		prev->count = (uint16_t)(end - offset);
+	}
+	*device_locs_count = count;
+
+	return ATCACERT_E_SUCCESS;
+}
+
 static const uint8_t* atcacert_is_device_loc_match( const atcacert_device_loc_t* device_loc_dest,
                                                     const atcacert_device_loc_t* device_loc_src,
                                                     const uint8_t* src_data)
@@ -700,6 +700,27 @@ int atcacert_merge_device_loc( atcacert_device_loc_t*       device_locs,
                                const atcacert_device_loc_t* device_loc,
                                size_t block_size);
 
+/**
+ * \brief Turn a list of device locations into an ordered read plan.
+ *
+ * The locations are sorted by zone, then slot and read method, then offset. This keeps zone and
+ * slot switches to a minimum when they are read in order. Offsets and counts are aligned to
+ * block_size (public keys from GenKey are left unaligned), and locations that overlap or are
+ * adjacent once aligned are combined into one.
+ * This also catches merges atcacert_merge_device_loc() misses when a later location bridges
+ * two earlier ones.
+ *
+ * \param[inout] device_locs        Device location list to plan, modified in place.
+ * \param[inout] device_locs_count  As input, the number of items in the device_locs list. As
+ *                                  output, the number of reads in the plan.
+ * \param[in]    block_size         Block size to align all offsets and counts to.
+ *
+ * \return 0 on success
+ */
+int atcacert_plan_device_reads( atcacert_device_loc_t* device_locs,
+                                size_t*                device_locs_count,
+                                size_t block_size);
+
 int atcacert_is_device_loc_overlap( const atcacert_device_loc_t* device_loc1,
                                     const atcacert_device_loc_t* device_loc2);
 
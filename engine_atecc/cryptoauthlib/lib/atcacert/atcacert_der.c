@@ -44,24 +44,23 @@
 int atcacert_der_enc_length(uint32_t length, uint8_t* der_length, size_t* der_length_size)
 {
 	size_t der_length_size_calc = 0;
-	int exp = sizeof(length) - 1;
+	size_t i = 0;
 
 	if (der_length_size == NULL)
 		return ATCACERT_E_BAD_PARAMS;
 
-	if (length < 0x80) {
-		// The length can take the short form with only one byte
+	// Short form for lengths under 0x80, otherwise long form with the length as a multi-byte
+	// big-endian unsigned integer after the number of bytes octet
+	if (length < 0x80)
 		der_length_size_calc = 1;
-		exp = 0;
-	}else  {
-		// Length is long-form, encoded as a multi-byte big-endian unsigned integer
-
-		// Find first non-zero octet
-		while (length / ((size_t)1 << (8 * exp)) == 0)
-			exp--;
-
-		der_length_size_calc = 2 + exp;
-	}
+	else if (length < 0x100)
+		der_length_size_calc = 2;
+	else if (length < 0x10000)
+		der_length_size_calc = 3;
+	else if (length < 0x1000000)
+		der_length_size_calc = 4;
+	else
+		der_length_size_calc = 5;
 
 	if (der_length != NULL && *der_length_size < der_length_size_calc) {
 		*der_length_size = der_length_size_calc;
@@ -73,12 +72,16 @@ int atcacert_der_enc_length(uint32_t length, uint8_t* der_length, size_t* der_le
 	if (der_length == NULL)
 		return ATCACERT_E_SUCCESS; // Caller is only requesting the size
 
-	// Encode length in big-endian format
-	for (; exp >= 0; exp--)
-		der_length[der_length_size_calc - 1 - exp] = (uint8_t)((length >> (exp * 8)) & 0xFF);
+	if (der_length_size_calc == 1) {
+		der_length[0] = (uint8_t)length;
+		return ATCACERT_E_SUCCESS;
+	}
 
-	if (der_length_size_calc > 1)
-		der_length[0] = 0x80 | (uint8_t)(der_length_size_calc - 1); // Set number of bytes octet with long-form flag
+	der_length[0] = 0x80 | (uint8_t)(der_length_size_calc - 1); // Set number of bytes octet with long-form flag
+	for (i = der_length_size_calc - 1; i > 0; i--) {
+		der_length[i] = (uint8_t)(length & 0xFF);
+		length >>= 8;
+	}
 
 	return ATCACERT_E_SUCCESS;
 }
@@ -124,8 +127,7 @@ int atcacert_der_enc_integer( const uint8_t* int_data,
                               uint8_t*       der_int,
                               size_t*        der_int_size)
 {
-	uint8_t der_length[5];
-	size_t der_length_size = sizeof(der_length);
+	size_t der_length_size = 0;
 	size_t der_int_size_calc = 0;
 	size_t trim = 0;
 	size_t pad = 0;
@@ -145,7 +147,7 @@ int atcacert_der_enc_integer( const uint8_t* int_data,
 		// Will be adding extra byte for unsigned padding so it's not interpreted as negative
 		pad = 1;
 
-	int ret = atcacert_der_enc_length(int_data_size + pad - trim, der_length, &der_length_size);
+	int ret = atcacert_der_enc_length((uint32_t)(int_data_size + pad - trim), NULL, &der_length_size);
 	if (ret != ATCACERT_E_SUCCESS)
 		return ret;
 
@@ -162,7 +164,7 @@ int atcacert_der_enc_integer( const uint8_t* int_data,
 		return ATCACERT_E_SUCCESS;                                                      // Caller just wanted the size of the encoded integer
 
 	der_int[0] = 0x02;                                                                  // Integer tag
-	memcpy(&der_int[1], der_length, der_length_size);                                   // Integer length
+	atcacert_der_enc_length((uint32_t)(int_data_size + pad - trim), &der_int[1], &der_length_size); // Integer length
 	if (pad)
 		der_int[der_length_size + 1] = 0;                                               // Unsigned integer value requires padding byte so it's not interpreted as negative
 	memcpy(&der_int[der_length_size + 1 + pad], &int_data[trim], int_data_size - trim); // Integer value
@@ -216,31 +218,202 @@ int atcacert_der_dec_integer( const uint8_t* der_int,
 	return ATCACERT_E_SUCCESS;
 }
 
-int atcacert_der_enc_ecdsa_sig_value( const uint8_t raw_sig[64],
-                                      uint8_t*      der_sig,
-                                      size_t*       der_sig_size)
+/**
+ * \brief Finds the size of the DER integer value for a 32 byte unsigned big-endian integer, the
+ *        fixed shape of P256 keys and ECDSA signature components.
+ *
+ * \param[in]  int_data  32 byte unsigned integer.
+ * \param[out] trim      Number of leading bytes of int_data left out of the encoding.
+ *
+ * \return Size of the integer value in bytes (1 to 33). 33 includes a padding byte.
+ */
+static size_t atcacert_der_uint256_size(const uint8_t int_data[32], size_t* trim)
+{
+	size_t i = 0;
+
+	if (int_data[0] & 0x80) {
+		*trim = 0;
+		return 33; // Needs a padding byte so it's not interpreted as negative
+	}
+
+	// Trim a byte when the upper 9 bits are all 0s
+	while (i < 31 && int_data[i] == 0x00 && (int_data[i + 1] & 0x80) == 0)
+		i++;
+	*trim = i;
+
+	return 32 - i;
+}
+
+/**
+ * \brief Writes a 32 byte unsigned integer as a DER integer, sized with atcacert_der_uint256_size().
+ *
+ * \return Pointer just past the encoded integer.
+ */
+static uint8_t* atcacert_der_put_uint256(uint8_t* der_int, const uint8_t int_data[32], size_t size, size_t trim)
+{
+	*der_int++ = 0x02;          // Integer tag
+	*der_int++ = (uint8_t)size; // Integer length, always the short form
+	if (size > 32)
+		*der_int++ = 0x00;      // Padding byte
+	memcpy(der_int, &int_data[trim], 32 - trim);
+
+	return der_int + 32 - trim;
+}
+
+/**
+ * \brief Reads a DER integer of up to 32 bytes (33 with a padding byte) into a 32 byte unsigned
+ *        big-endian integer.
+ *
+ * \param[in]    der_int       DER encoded integer.
+ * \param[inout] der_int_size  As input, the size of the der_int buffer in bytes.
+ *                             As output, the size of the DER integer decoded in bytes.
+ * \param[out]   int_data      Integer is returned here, left padded with 0s. Can be NULL.
+ *
+ * \return 0 on success
+ */
+static int atcacert_der_get_uint256(const uint8_t* der_int, size_t* der_int_size, uint8_t* int_data)
 {
 	int ret = 0;
+	size_t der_length_size = 0;
+	uint32_t length = 0;
+	const uint8_t* value = NULL;
+
+	if (*der_int_size < 1 || der_int[0] != 0x02)
+		return ATCACERT_E_DECODING_ERROR; // No data left or not an integer tag
+
+	der_length_size = *der_int_size - 1;
+	ret = atcacert_der_dec_length(&der_int[1], &der_length_size, &length);
+	if (ret != ATCACERT_E_SUCCESS)
+		return ret;
+	if (*der_int_size < 1 + der_length_size + length)
+		return ATCACERT_E_DECODING_ERROR; // Invalid DER integer, not enough data
+	*der_int_size = 1 + der_length_size + length;
+
+	value = &der_int[1 + der_length_size];
+	if (length == 33) {
+		if (value[0] != 0x00)
+			return ATCACERT_E_DECODING_ERROR; // Integer is too large
+		// DER integer was 0-padded to keep it positive
+		value++;
+		length--;
+	}else if (length > 33)
+		return ATCACERT_E_DECODING_ERROR; // Integer is too large
+
+	if (int_data != NULL) {
+		memset(int_data, 0, 32 - length);
+		memcpy(&int_data[32 - length], value, length);
+	}
+
+	return ATCACERT_E_SUCCESS;
+}
+
+int atcacert_der_enc_ecdsa_sig( const uint8_t raw_sig[64],
+                                uint8_t*      der_sig,
+                                size_t*       der_sig_size)
+{
+	size_t r_trim = 0;
+	size_t s_trim = 0;
 	size_t r_size = 0;
 	size_t s_size = 0;
 	size_t der_sig_size_calc = 0;
+	uint8_t* der_s = NULL;
 
 	if (raw_sig == NULL || der_sig_size == NULL)
 		return ATCACERT_E_BAD_PARAMS;
 
-	// Find size of the DER encoded R integer
-	ret = atcacert_der_enc_integer(&raw_sig[0], 32, TRUE, NULL, &r_size);
+	r_size = atcacert_der_uint256_size(&raw_sig[0], &r_trim);
+	s_size = atcacert_der_uint256_size(&raw_sig[32], &s_trim);
+
+	// All DER lengths are a single byte, the sequence is 72 bytes at most
+	der_sig_size_calc = 2 + (2 + r_size) + (2 + s_size);
+
+	if (der_sig != NULL && *der_sig_size < der_sig_size_calc) {
+		*der_sig_size = der_sig_size_calc;
+		return ATCACERT_E_BUFFER_TOO_SMALL;
+	}
+
+	*der_sig_size = der_sig_size_calc;
+
+	if (der_sig == NULL)
+		return ATCACERT_E_SUCCESS;                  // Caller just wanted the encoded size
+
+	der_sig[0] = 0x30;                              // sequence tag
+	der_sig[1] = (uint8_t)(der_sig_size_calc - 2);  // sequence length
+	der_s = atcacert_der_put_uint256(&der_sig[2], &raw_sig[0], r_size, r_trim);
+	atcacert_der_put_uint256(der_s, &raw_sig[32], s_size, s_trim);
+
+	return ATCACERT_E_SUCCESS;
+}
+
+int atcacert_der_dec_ecdsa_sig( const uint8_t* der_sig,
+                                size_t*        der_sig_size,
+                                uint8_t raw_sig[64])
+{
+	int ret = 0;
+	size_t curr_idx = 0;
+	size_t dec_size = 0;
+	uint32_t seq_length = 0;
+	size_t r_size = 0;
+	size_t s_size = 0;
+
+	if (der_sig == NULL || der_sig_size == NULL)
+		return ATCACERT_E_BAD_PARAMS;
+
+	// sequence tag
+	if (*der_sig_size < 1)
+		return ATCACERT_E_DECODING_ERROR;   // No data to decode
+	if (der_sig[curr_idx] != 0x30)
+		return ATCACERT_E_DECODING_ERROR;   // Unexpected tag value
+	curr_idx++;
+
+	// sequence length
+	dec_size = *der_sig_size - curr_idx;
+	ret = atcacert_der_dec_length(&der_sig[curr_idx], &dec_size, &seq_length);
+	if (ret != ATCACERT_E_SUCCESS)
+		return ret; // Failed to decode length
+	curr_idx += dec_size;
+	if (curr_idx + seq_length > *der_sig_size)
+		return ATCACERT_E_DECODING_ERROR; // Not enough data in buffer to decode the rest
+
+	// R integer, decoded straight into place
+	r_size = *der_sig_size - curr_idx;
+	ret = atcacert_der_get_uint256(&der_sig[curr_idx], &r_size, raw_sig != NULL ? &raw_sig[0] : NULL);
+	if (ret != ATCACERT_E_SUCCESS)
+		return ret;
+	curr_idx += r_size;
+
+	// S integer
+	s_size = *der_sig_size - curr_idx;
+	ret = atcacert_der_get_uint256(&der_sig[curr_idx], &s_size, raw_sig != NULL ? &raw_sig[32] : NULL);
 	if (ret != ATCACERT_E_SUCCESS)
 		return ret;
+	curr_idx += s_size;
+
+	if (seq_length != r_size + s_size)
+		return ATCACERT_E_DECODING_ERROR; // Unexpected extra data in sequence
+
+	*der_sig_size = curr_idx;
+
+	return ATCACERT_E_SUCCESS;
+}
+
+int atcacert_der_enc_ecdsa_sig_value( const uint8_t raw_sig[64],
+                                      uint8_t*      der_sig,
+                                      size_t*       der_sig_size)
+{
+	int ret = 0;
+	size_t seq_size = 0;
+	size_t der_sig_size_calc = 0;
+
+	if (raw_sig == NULL || der_sig_size == NULL)
+		return ATCACERT_E_BAD_PARAMS;
 
-	// Find size of the DER encoded S integer
-	ret = atcacert_der_enc_integer(&raw_sig[32], 32, TRUE, NULL, &s_size);
+	// Find size of the DER encoded ECDSA-Sig-Value
+	ret = atcacert_der_enc_ecdsa_sig(raw_sig, NULL, &seq_size);
 	if (ret != ATCACERT_E_SUCCESS)
 		return ret;
 
-	// This calculation assumes all DER lengths are a single byte, which is fine for 32 byte
-	// R and S integers.
-	der_sig_size_calc = 5 + r_size + s_size;
+	der_sig_size_calc = 3 + seq_size;
 
 	if (der_sig != NULL && *der_sig_size < der_sig_size_calc) {
 		*der_sig_size = der_sig_size_calc;
@@ -257,20 +430,7 @@ int atcacert_der_enc_ecdsa_sig_value( const uint8_t raw_sig[64],
 	der_sig[2] = 0x00;                              // signatureValue bit string spare bits
 
 	// signatureValue bit string value is the DER encoding of ECDSA-Sig-Value
-	der_sig[3] = 0x30;                              // sequence tag
-	der_sig[4] = (uint8_t)(der_sig_size_calc - 5);  // sequence length
-
-	// Add R integer
-	ret = atcacert_der_enc_integer(&raw_sig[0], 32, TRUE, &der_sig[5], &r_size);
-	if (ret != ATCACERT_E_SUCCESS)
-		return ret;
-
-	// Add S integer
-	ret = atcacert_der_enc_integer(&raw_sig[32], 32, TRUE, &der_sig[5 + r_size], &s_size);
-	if (ret != ATCACERT_E_SUCCESS)
-		return ret;
-
-	return ATCACERT_E_SUCCESS;
+	return atcacert_der_enc_ecdsa_sig(raw_sig, &der_sig[3], &seq_size);
 }
 
 int atcacert_der_dec_ecdsa_sig_value( const uint8_t* der_sig,
@@ -281,11 +441,6 @@ int atcacert_der_dec_ecdsa_sig_value( const uint8_t* der_sig,
 	size_t curr_idx = 0;
 	size_t dec_size = 0;
 	uint32_t bs_length = 0;
-	uint32_t seq_length = 0;
-	size_t r_size = 0;
-	size_t s_size = 0;
-	uint8_t int_data[33];
-	size_t int_data_size = 0;
 
 	if (der_sig == NULL || der_sig_size == NULL)
 		return ATCACERT_E_BAD_PARAMS;
@@ -294,7 +449,6 @@ int atcacert_der_dec_ecdsa_sig_value( const uint8_t* der_sig,
 		return ATCACERT_E_DECODING_ERROR; // No data to decode
 
 	// signatureValue bit string tag
-	curr_idx = 0;
 	if (der_sig[curr_idx] != 0x03)
 		return ATCACERT_E_DECODING_ERROR; // Unexpected tag value
 	curr_idx++;
@@ -316,79 +470,63 @@ int atcacert_der_dec_ecdsa_sig_value( const uint8_t* der_sig,
 	curr_idx++;
 
 	// signatureValue bit string value is the DER encoding of ECDSA-Sig-Value
-
-	// sequence tag
-	if (curr_idx >= *der_sig_size)
-		return ATCACERT_E_DECODING_ERROR;   // No data left
-	if (der_sig[curr_idx] != 0x30)
-		return ATCACERT_E_DECODING_ERROR;   // Unexpected tag value
-	curr_idx++;
-
-	// sequence length
-	if (curr_idx >= *der_sig_size)
-		return ATCACERT_E_DECODING_ERROR; // No data left
 	dec_size = *der_sig_size - curr_idx;
-	ret = atcacert_der_dec_length(&der_sig[curr_idx], &dec_size, &seq_length);
+	ret = atcacert_der_dec_ecdsa_sig(&der_sig[curr_idx], &dec_size, raw_sig);
 	if (ret != ATCACERT_E_SUCCESS)
-		return ret; // Failed to decode length
+		return ret;
 	curr_idx += dec_size;
-	if (curr_idx + seq_length > *der_sig_size)
-		return ATCACERT_E_DECODING_ERROR; // Not enough data in buffer to decode the rest
 
-	// R integer
-	if (curr_idx >= *der_sig_size)
-		return ATCACERT_E_DECODING_ERROR; // No data left
-	r_size = *der_sig_size - curr_idx;
-	int_data_size = sizeof(int_data);
-	ret = atcacert_der_dec_integer(&der_sig[curr_idx], &r_size, int_data, &int_data_size);
-	if (ret != ATCACERT_E_SUCCESS)
-		return ret; // Failed to decode length
-	curr_idx += r_size;
+	if (bs_length != dec_size + 1)
+		return ATCACERT_E_DECODING_ERROR; // Unexpected extra data in bit string
 
-	if (raw_sig != NULL)
-		memset(raw_sig, 0, 64); // Zero out the raw sig as the decoded integers may not touch all bytes
+	*der_sig_size = curr_idx;
 
-	if (int_data_size <= 32) {
-		if (raw_sig != NULL)
-			memcpy(&raw_sig[32 - int_data_size], &int_data[0], int_data_size);
-	}else if (int_data_size == 33) {
-		if (int_data[0] != 0x00)
-			return ATCACERT_E_DECODING_ERROR; // R integer is too large
-		// DER integer was 0-padded to keep it positive
-		if (raw_sig != NULL)
-			memcpy(&raw_sig[0], &int_data[1], 32);
-	}else
-		return ATCACERT_E_DECODING_ERROR; // R integer is too large
+	return ATCACERT_E_SUCCESS;
+}
 
-	// S integer
-	if (curr_idx >= *der_sig_size)
-		return ATCACERT_E_DECODING_ERROR; // No data left
-	s_size = *der_sig_size - curr_idx;
-	int_data_size = sizeof(int_data);
-	ret = atcacert_der_dec_integer(&der_sig[curr_idx], &s_size, int_data, &int_data_size);
-	if (ret != ATCACERT_E_SUCCESS)
-		return ret; // Failed to decode length
-	curr_idx += s_size;
+int atcacert_der_enc_public_key( const uint8_t public_key[64],
+                                 uint8_t*      der_key,
+                                 size_t*       der_key_size)
+{
+	if (public_key == NULL || der_key_size == NULL)
+		return ATCACERT_E_BAD_PARAMS;
 
-	if (int_data_size <= 32) {
-		if (raw_sig != NULL)
-			memcpy(&raw_sig[64 - int_data_size], &int_data[0], int_data_size);
-	}else if (int_data_size == 33) {
-		if (int_data[0] != 0x00)
-			return ATCACERT_E_DECODING_ERROR; // S integer is too large
-		// DER integer was 0-padded to keep it positive
-		if (raw_sig != NULL)
-			memcpy(&raw_sig[32], &int_data[1], 32);
-	}else
-		return ATCACERT_E_DECODING_ERROR; // S integer is too large
+	if (der_key != NULL && *der_key_size < ATCACERT_DER_PUBLIC_KEY_SIZE) {
+		*der_key_size = ATCACERT_DER_PUBLIC_KEY_SIZE;
+		return ATCACERT_E_BUFFER_TOO_SMALL;
+	}
 
-	if (seq_length != r_size + s_size)
-		return ATCACERT_E_DECODING_ERROR; // Unexpected extra data in sequence
+	*der_key_size = ATCACERT_DER_PUBLIC_KEY_SIZE;
 
-	if (bs_length != r_size + s_size + 3)
-		return ATCACERT_E_DECODING_ERROR; // Unexpected extra data in bit string
+	if (der_key == NULL)
+		return ATCACERT_E_SUCCESS; // Caller just wanted the encoded size
 
-	*der_sig_size = curr_idx;
+	der_key[0] = 0x03;  // subjectPublicKey bit string tag
+	der_key[1] = 0x42;  // subjectPublicKey bit string length
+	der_key[2] = 0x00;  // subjectPublicKey bit string spare bits
+	der_key[3] = 0x04;  // Uncompressed point
+	memcpy(&der_key[4], public_key, 64);
 
 	return ATCACERT_E_SUCCESS;
-}
\ No newline at end of file
+}
+
+int atcacert_der_dec_public_key( const uint8_t* der_key,
+                                 size_t*        der_key_size,
+                                 uint8_t public_key[64])
+{
+	if (der_key == NULL || der_key_size == NULL)
+		return ATCACERT_E_BAD_PARAMS;
+
+	if (*der_key_size < ATCACERT_DER_PUBLIC_KEY_SIZE)
+		return ATCACERT_E_DECODING_ERROR; // Not enough data to decode
+
+	if (der_key[0] != 0x03 || der_key[1] != 0x42 || der_key[2] != 0x00 || der_key[3] != 0x04)
+		return ATCACERT_E_DECODING_ERROR; // Not an uncompressed P256 public key bit string
+
+	*der_key_size = ATCACERT_DER_PUBLIC_KEY_SIZE;
+
+	if (public_key != NULL)
+		memcpy(public_key, &der_key[4], 64);
+
+	return ATCACERT_E_SUCCESS;
+}
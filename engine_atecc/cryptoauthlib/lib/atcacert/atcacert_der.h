@@ -45,6 +45,9 @@
 #include <stdint.h>
 #include "atcacert.h"
 
+#define ATCACERT_DER_ECDSA_SIG_MAX_SIZE 72  //!< Max size of a DER encoded P256 ECDSA-Sig-Value.
+#define ATCACERT_DER_PUBLIC_KEY_SIZE    68  //!< Size of a DER encoded P256 subjectPublicKey bit string.
+
 // Inform function naming when compiling in C++
 #ifdef __cplusplus
 extern "C" {
@@ -167,6 +170,70 @@ int atcacert_der_dec_ecdsa_sig_value( const uint8_t * der_sig,
                                       size_t *        der_sig_size,
                                       uint8_t raw_sig[64]);
 
+/**
+ * \brief Formats a raw ECDSA P256 signature as a DER encoded ECDSA-Sig-Value.
+ *
+ * This is the SEQUENCE of the R and S integers as specified by RFC 5480 and SECG SEC1, the
+ * format OpenSSL's i2d_ECDSA_SIG() produces and TLS carries. It's written directly into der_sig,
+ * ATCACERT_DER_ECDSA_SIG_MAX_SIZE bytes is always enough.
+ *
+ * \param[in]    raw_sig       P256 ECDSA signature to be formatted. Input format is R and S
+ *                             integers concatenated together. 64 bytes.
+ * \param[out]   der_sig       DER encoded ECDSA-Sig-Value is returned in this buffer.
+ * \param[inout] der_sig_size  As input, the size of the der_sig buffer in bytes.
+ *                             As output, the size of the DER encoded signature in bytes.
+ *
+ * \return 0 on success
+ */
+int atcacert_der_enc_ecdsa_sig( const uint8_t raw_sig[64],
+                                uint8_t*      der_sig,
+                                size_t*       der_sig_size);
+
+/**
+ * \brief Parses a DER encoded ECDSA-Sig-Value into a raw ECDSA P256 signature.
+ *
+ * \param[in]    der_sig       DER encoded ECDSA-Sig-Value to be parsed.
+ * \param[inout] der_sig_size  As input, size of the der_sig buffer in bytes.
+ *                             As output, size of the DER encoded signature parsed from the buffer.
+ * \param[out]   raw_sig       Parsed P256 ECDSA signature will be returned in this buffer.
+ *                             Formatted as R and S integers concatenated together. 64 bytes.
+ *
+ * \return 0 on success
+ */
+int atcacert_der_dec_ecdsa_sig( const uint8_t* der_sig,
+                                size_t*        der_sig_size,
+                                uint8_t raw_sig[64]);
+
+/**
+ * \brief Formats a raw P256 public key in the DER encoding of the subjectPublicKey field of an
+ *        X.509 certificate (RFC 5480). This is a bit string holding the uncompressed point.
+ *
+ * \param[in]    public_key    P256 public key as X and Y integers concatenated together. 64 bytes.
+ * \param[out]   der_key       DER encoded subjectPublicKey is returned in this buffer.
+ * \param[inout] der_key_size  As input, the size of the der_key buffer in bytes.
+ *                             As output, the size of the DER encoded key in bytes.
+ *
+ * \return 0 on success
+ */
+int atcacert_der_enc_public_key( const uint8_t public_key[64],
+                                 uint8_t*      der_key,
+                                 size_t*       der_key_size);
+
+/**
+ * \brief Parses the DER encoding of a P256 subjectPublicKey field into a raw public key.
+ *
+ * \param[in]    der_key       DER encoded subjectPublicKey to be parsed.
+ * \param[inout] der_key_size  As input, size of the der_key buffer in bytes.
+ *                             As output, size of the DER encoded key parsed from the buffer.
+ * \param[out]   public_key    Parsed public key as X and Y integers concatenated together.
+ *                             64 bytes.
+ *
+ * \return 0 on success
+ */
+int atcacert_der_dec_public_key( const uint8_t* der_key,
+                                 size_t*        der_key_size,
+                                 uint8_t public_key[64]);
+
 /** @} */
 #ifdef __cplusplus
 }
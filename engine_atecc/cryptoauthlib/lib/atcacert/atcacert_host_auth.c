@@ -0,0 +1,563 @@
+/** \brief Host side device authentication service using software implementations
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#include "atcacert_host_auth.h"
+#include "crypto/atca_crypto_sw_sha2.h"
+#include "crypto/atca_crypto_sw_ecdsa.h"
+#include "crypto/atca_crypto_sw_rand.h"
+#include <string.h>
+#include <time.h>
+
+#if (ATCACERT_AUTH_KEY_CACHE_SIZE & (ATCACERT_AUTH_KEY_CACHE_SIZE - 1)) != 0
+#error ATCACERT_AUTH_KEY_CACHE_SIZE must be a power of 2
+#endif
+#if (ATCACERT_AUTH_CHALLENGE_TABLE_SIZE & (ATCACERT_AUTH_CHALLENGE_TABLE_SIZE - 1)) != 0
+#error ATCACERT_AUTH_CHALLENGE_TABLE_SIZE must be a power of 2
+#endif
+
+static uint32_t atcacert_auth_monotonic_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint32_t)ts.tv_sec * 1000 + (uint32_t)(ts.tv_nsec / 1000000);
+}
+
+/**
+ * \brief Table index for a digest or challenge. Both are uniformly random, so the leading bytes
+ *        are used as they are.
+ */
+static size_t atcacert_auth_index(const uint8_t* data, size_t table_size)
+{
+	return (((size_t)data[0] << 24) | ((size_t)data[1] << 16) | ((size_t)data[2] << 8) | data[3]) & (table_size - 1);
+}
+
+/**
+ * \brief Look up a certificate's public key in the key cache. Only keys validated in the same role
+ *        match, so a device certificate can never be passed off as a signer. Caller must hold the
+ *        lock.
+ */
+static const atcacert_auth_key_t* atcacert_auth_find_key(const atcacert_auth_ctx_t* ctx, const uint8_t cert_digest[32], int is_signer)
+{
+	size_t index = atcacert_auth_index(cert_digest, ATCACERT_AUTH_KEY_CACHE_SIZE);
+	size_t i;
+
+	for (i = 0; i < ATCACERT_AUTH_PROBES; i++) {
+		const atcacert_auth_key_t* key = &ctx->keys[(index + i) & (ATCACERT_AUTH_KEY_CACHE_SIZE - 1)];
+		if (key->is_valid && key->is_signer == is_signer && memcmp(key->cert_digest, cert_digest, sizeof(key->cert_digest)) == 0)
+			return key;
+	}
+
+	return NULL;
+}
+
+/**
+ * \brief Add a validated public key to the key cache, replacing the first probed entry if all are
+ *        taken. Caller must hold the lock.
+ */
+static void atcacert_auth_add_key(atcacert_auth_ctx_t* ctx, const uint8_t cert_digest[32], const uint8_t public_key[64], int is_signer)
+{
+	size_t index = atcacert_auth_index(cert_digest, ATCACERT_AUTH_KEY_CACHE_SIZE);
+	atcacert_auth_key_t* key = &ctx->keys[index];
+	size_t i;
+
+	for (i = 0; i < ATCACERT_AUTH_PROBES; i++) {
+		atcacert_auth_key_t* probe = &ctx->keys[(index + i) & (ATCACERT_AUTH_KEY_CACHE_SIZE - 1)];
+		if (!probe->is_valid || (probe->is_signer == is_signer && memcmp(probe->cert_digest, cert_digest, sizeof(probe->cert_digest)) == 0)) {
+			key = probe;
+			break;
+		}
+	}
+
+	memcpy(key->cert_digest, cert_digest, sizeof(key->cert_digest));
+	memcpy(key->public_key, public_key, sizeof(key->public_key));
+	key->is_signer = (uint8_t)is_signer;
+	key->is_valid = TRUE;
+}
+
+/**
+ * \brief Copy a certificate's public key out of the key cache.
+ *
+ * \return TRUE if the certificate was found in that role.
+ */
+static int atcacert_auth_lookup_key(atcacert_auth_ctx_t* ctx, const uint8_t cert_digest[32], int is_signer, uint8_t public_key[64])
+{
+	const atcacert_auth_key_t* key = NULL;
+
+	pthread_mutex_lock(&ctx->lock);
+	key = atcacert_auth_find_key(ctx, cert_digest, is_signer);
+	if (key != NULL) {
+		memcpy(public_key, key->public_key, 64);
+		ctx->stats.key_hits++;
+	}else  {
+		ctx->stats.key_misses++;
+	}
+	pthread_mutex_unlock(&ctx->lock);
+
+	return key != NULL;
+}
+
+/**
+ * \brief Pull out what it takes to verify a certificate: the digest of its TBS part, its signature
+ *        and the subject public key it vouches for.
+ */
+static int atcacert_auth_parse_cert(const atcacert_def_t* cert_def,
+                                    const uint8_t* cert,
+                                    size_t cert_size,
+                                    uint8_t tbs_digest[32],
+                                    uint8_t signature[64],
+                                    uint8_t public_key[64])
+{
+	int ret = 0;
+
+	ret = atcacert_get_tbs_digest(cert_def, cert, cert_size, tbs_digest);
+	if (ret != ATCACERT_E_SUCCESS)
+		return ret;
+
+	ret = atcacert_get_signature(cert_def, cert, cert_size, signature);
+	if (ret != ATCACERT_E_SUCCESS)
+		return ret;
+
+	return atcacert_get_subj_public_key(cert_def, cert, cert_size, public_key);
+}
+
+/**
+ * \brief Verify a certificate against its issuer's public key and add its subject public key to the
+ *        key cache in the given role.
+ */
+static int atcacert_auth_validate_cert(atcacert_auth_ctx_t* ctx,
+                                       const atcacert_def_t* cert_def,
+                                       int is_signer,
+                                       const uint8_t* cert,
+                                       size_t cert_size,
+                                       const uint8_t cert_digest[32],
+                                       const uint8_t issuer_public_key[64],
+                                       uint8_t public_key[64])
+{
+	int ret = 0;
+	uint8_t tbs_digest[32];
+	uint8_t signature[64];
+
+	ret = atcacert_auth_parse_cert(cert_def, cert, cert_size, tbs_digest, signature, public_key);
+	if (ret != ATCACERT_E_SUCCESS)
+		return ret;
+
+	ret = atcac_sw_ecdsa_verify_p256(tbs_digest, signature, issuer_public_key);
+
+	pthread_mutex_lock(&ctx->lock);
+	if (ret == ATCA_SUCCESS)
+		atcacert_auth_add_key(ctx, cert_digest, public_key, is_signer);
+	else
+		ctx->stats.failed++;
+	pthread_mutex_unlock(&ctx->lock);
+
+	if (ret == ATCA_FUNC_FAIL)
+		return ATCACERT_E_VERIFY_FAILED;
+
+	return ret;
+}
+
+/**
+ * \brief Consume a challenge if it was issued and hasn't expired.
+ *
+ * \return TRUE if the challenge was live.
+ */
+static int atcacert_auth_consume_challenge(atcacert_auth_ctx_t* ctx, const uint8_t challenge[ATCACERT_AUTH_CHALLENGE_SIZE])
+{
+	uint32_t now = 0;
+	size_t index = 0;
+	size_t i;
+	int is_live = FALSE;
+
+	pthread_mutex_lock(&ctx->lock);
+	now = ctx->now_ms();
+	index = atcacert_auth_index(challenge, ATCACERT_AUTH_CHALLENGE_TABLE_SIZE);
+	for (i = 0; i < ATCACERT_AUTH_PROBES; i++) {
+		atcacert_auth_challenge_t* probe = &ctx->challenges[(index + i) & (ATCACERT_AUTH_CHALLENGE_TABLE_SIZE - 1)];
+		if (probe->is_pending && memcmp(probe->challenge, challenge, sizeof(probe->challenge)) == 0) {
+			is_live = (uint32_t)(now - probe->issued_ms) <= ctx->window_ms;
+			memset(probe, 0, sizeof(*probe));
+			break;
+		}
+	}
+	if (!is_live)
+		ctx->stats.bad_challenges++;
+	pthread_mutex_unlock(&ctx->lock);
+
+	return is_live;
+}
+
+int atcacert_auth_init( atcacert_auth_ctx_t*  ctx,
+                        const atcacert_def_t* signer_cert_def,
+                        const atcacert_def_t* device_cert_def,
+                        const uint8_t         ca_public_key[64],
+                        uint32_t              window_ms)
+{
+	if (ctx == NULL || signer_cert_def == NULL || device_cert_def == NULL || ca_public_key == NULL || window_ms == 0)
+		return ATCACERT_E_BAD_PARAMS;
+
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->signer_cert_def = signer_cert_def;
+	ctx->device_cert_def = device_cert_def;
+	memcpy(ctx->ca_public_key, ca_public_key, sizeof(ctx->ca_public_key));
+	ctx->window_ms = window_ms;
+	ctx->random = atcac_sw_random;
+	ctx->now_ms = atcacert_auth_monotonic_ms;
+
+	if (pthread_mutex_init(&ctx->lock, NULL) != 0)
+		return ATCACERT_E_ERROR;
+
+	// Not fatal: without the table the CA key is simply verified the slow way
+	ctx->ca_key_pinned = (atcac_sw_ecdsa_pin_key(ctx->ca_public_key) == ATCA_SUCCESS);
+
+	return ATCACERT_E_SUCCESS;
+}
+
+void atcacert_auth_release( atcacert_auth_ctx_t* ctx )
+{
+	if (ctx == NULL)
+		return;
+
+	if (ctx->ca_key_pinned)
+		atcac_sw_ecdsa_unpin_key(ctx->ca_public_key);
+	pthread_mutex_destroy(&ctx->lock);
+	memset(ctx, 0, sizeof(*ctx));
+}
+
+int atcacert_auth_gen_challenge( atcacert_auth_ctx_t* ctx,
+                                 uint8_t              challenge[ATCACERT_AUTH_CHALLENGE_SIZE])
+{
+	int ret = 0;
+	uint32_t now = 0;
+	size_t index = 0;
+	size_t i;
+	atcacert_auth_challenge_t* slot = NULL;
+
+	if (ctx == NULL || challenge == NULL)
+		return ATCACERT_E_BAD_PARAMS;
+
+	ret = ctx->random(challenge, ATCACERT_AUTH_CHALLENGE_SIZE);
+	if (ret != ATCA_SUCCESS)
+		return ret;
+
+	pthread_mutex_lock(&ctx->lock);
+	now = ctx->now_ms();
+	index = atcacert_auth_index(challenge, ATCACERT_AUTH_CHALLENGE_TABLE_SIZE);
+	// Take the first free or expired slot. If every probed challenge is still pending, drop the oldest.
+	for (i = 0; i < ATCACERT_AUTH_PROBES; i++) {
+		atcacert_auth_challenge_t* probe = &ctx->challenges[(index + i) & (ATCACERT_AUTH_CHALLENGE_TABLE_SIZE - 1)];
+		if (!probe->is_pending || (uint32_t)(now - probe->issued_ms) > ctx->window_ms) {
+			slot = probe;
+			break;
+		}
+		if (slot == NULL || (uint32_t)(now - probe->issued_ms) > (uint32_t)(now - slot->issued_ms))
+			slot = probe;
+	}
+	if (i == ATCACERT_AUTH_PROBES)
+		ctx->stats.evicted++;
+
+	memcpy(slot->challenge, challenge, sizeof(slot->challenge));
+	slot->issued_ms = now;
+	slot->is_pending = TRUE;
+	ctx->stats.challenges++;
+	pthread_mutex_unlock(&ctx->lock);
+
+	return ATCACERT_E_SUCCESS;
+}
+
+int atcacert_auth_get_device_key( atcacert_auth_ctx_t* ctx,
+                                  const uint8_t*       signer_cert,
+                                  size_t               signer_cert_size,
+                                  const uint8_t*       device_cert,
+                                  size_t               device_cert_size,
+                                  uint8_t              device_public_key[64])
+{
+	int ret = 0;
+	uint8_t device_cert_digest[32];
+	uint8_t signer_cert_digest[32];
+	uint8_t signer_public_key[64];
+
+	if (ctx == NULL || device_cert == NULL || device_public_key == NULL)
+		return ATCACERT_E_BAD_PARAMS;
+
+	// A cached device certificate has already been validated, so its signer isn't needed
+	ret = atcac_sw_sha2_256(device_cert, device_cert_size, device_cert_digest);
+	if (ret != ATCA_SUCCESS)
+		return ret;
+	if (atcacert_auth_lookup_key(ctx, device_cert_digest, FALSE, device_public_key))
+		return ATCACERT_E_SUCCESS;
+
+	if (signer_cert == NULL)
+		return ATCACERT_E_BAD_PARAMS;
+
+	ret = atcac_sw_sha2_256(signer_cert, signer_cert_size, signer_cert_digest);
+	if (ret != ATCA_SUCCESS)
+		return ret;
+	if (!atcacert_auth_lookup_key(ctx, signer_cert_digest, TRUE, signer_public_key)) {
+		ret = atcacert_auth_validate_cert(ctx, ctx->signer_cert_def, TRUE, signer_cert, signer_cert_size, signer_cert_digest,
+		                                  ctx->ca_public_key, signer_public_key);
+		if (ret != ATCACERT_E_SUCCESS)
+			return ret;
+	}
+
+	return atcacert_auth_validate_cert(ctx, ctx->device_cert_def, FALSE, device_cert, device_cert_size, device_cert_digest,
+	                                   signer_public_key, device_public_key);
+}
+
+int atcacert_auth_verify_response( atcacert_auth_ctx_t* ctx,
+                                   const uint8_t        device_public_key[64],
+                                   const uint8_t        challenge[ATCACERT_AUTH_CHALLENGE_SIZE],
+                                   const uint8_t        response[64])
+{
+	int ret = 0;
+
+	if (ctx == NULL || device_public_key == NULL || challenge == NULL || response == NULL)
+		return ATCACERT_E_BAD_PARAMS;
+
+	// Consume the challenge first so it can only ever be answered once
+	if (!atcacert_auth_consume_challenge(ctx, challenge))
+		return ATCACERT_E_BAD_CHALLENGE;
+
+	ret = atcac_sw_ecdsa_verify_p256(challenge, response, device_public_key);
+
+	pthread_mutex_lock(&ctx->lock);
+	if (ret == ATCA_SUCCESS)
+		ctx->stats.verified++;
+	else
+		ctx->stats.failed++;
+	pthread_mutex_unlock(&ctx->lock);
+
+	if (ret == ATCA_FUNC_FAIL)
+		return ATCACERT_E_VERIFY_FAILED;
+
+	return ret;
+}
+
+int atcacert_auth_device( atcacert_auth_ctx_t* ctx,
+                          const uint8_t*       signer_cert,
+                          size_t               signer_cert_size,
+                          const uint8_t*       device_cert,
+                          size_t               device_cert_size,
+                          const uint8_t        challenge[ATCACERT_AUTH_CHALLENGE_SIZE],
+                          const uint8_t        response[64])
+{
+	int ret = 0;
+	uint8_t device_public_key[64];
+
+	ret = atcacert_auth_get_device_key(ctx, signer_cert, signer_cert_size, device_cert, device_cert_size, device_public_key);
+	if (ret != ATCACERT_E_SUCCESS)
+		return ret;
+
+	return atcacert_auth_verify_response(ctx, device_public_key, challenge, response);
+}
+
+/**
+ * Work for one request of a batch. The *_job fields index the signatures handed to
+ * atcac_sw_ecdsa_verify_p256_batch(), -1 when there is nothing to verify.
+ */
+typedef struct {
+	uint8_t device_cert_digest[32];
+	uint8_t signer_cert_digest[32];
+	uint8_t signer_public_key[64];
+	uint8_t device_public_key[64];
+	uint8_t signer_tbs_digest[32];
+	uint8_t signer_signature[64];
+	uint8_t device_tbs_digest[32];
+	uint8_t device_signature[64];
+	int     signer_job;
+	int     owns_signer_job;    //!< FALSE when an earlier request in the batch has the same signer.
+	int     device_job;
+	int     response_job;
+	int     ret;
+} atcacert_auth_batch_item_t;
+
+/**
+ * \brief First pass over a request: look its certificates up in the key cache and queue the
+ *        signatures that need verifying.
+ */
+static int atcacert_auth_batch_prepare(atcacert_auth_ctx_t*           ctx,
+                                       const atcacert_auth_request_t* request,
+                                       atcacert_auth_batch_item_t*    items,
+                                       size_t                         item,
+                                       const uint8_t**                msgs,
+                                       const uint8_t**                signatures,
+                                       const uint8_t**                public_keys,
+                                       size_t*                        jobs)
+{
+	atcacert_auth_batch_item_t* it = &items[item];
+	int ret = 0;
+	size_t i;
+
+	it->signer_job = -1;
+	it->device_job = -1;
+	it->response_job = -1;
+
+	if (request->device_cert == NULL || request->challenge == NULL || request->response == NULL)
+		return ATCACERT_E_BAD_PARAMS;
+
+	ret = atcac_sw_sha2_256(request->device_cert, request->device_cert_size, it->device_cert_digest);
+	if (ret != ATCA_SUCCESS)
+		return ret;
+	if (!atcacert_auth_lookup_key(ctx, it->device_cert_digest, FALSE, it->device_public_key)) {
+		if (request->signer_cert == NULL)
+			return ATCACERT_E_BAD_PARAMS;
+
+		ret = atcac_sw_sha2_256(request->signer_cert, request->signer_cert_size, it->signer_cert_digest);
+		if (ret != ATCA_SUCCESS)
+			return ret;
+		if (!atcacert_auth_lookup_key(ctx, it->signer_cert_digest, TRUE, it->signer_public_key)) {
+			for (i = 0; i < item; i++) {
+				if (items[i].owns_signer_job && memcmp(items[i].signer_cert_digest, it->signer_cert_digest, 32) == 0)
+					break;
+			}
+			if (i < item) {
+				memcpy(it->signer_public_key, items[i].signer_public_key, sizeof(it->signer_public_key));
+				it->signer_job = items[i].signer_job;
+			}else  {
+				ret = atcacert_auth_parse_cert(ctx->signer_cert_def, request->signer_cert, request->signer_cert_size,
+				                               it->signer_tbs_digest, it->signer_signature, it->signer_public_key);
+				if (ret != ATCACERT_E_SUCCESS)
+					return ret;
+				it->signer_job = (int)*jobs;
+				it->owns_signer_job = TRUE;
+				msgs[*jobs] = it->signer_tbs_digest;
+				signatures[*jobs] = it->signer_signature;
+				public_keys[*jobs] = ctx->ca_public_key;
+				(*jobs)++;
+			}
+		}
+
+		ret = atcacert_auth_parse_cert(ctx->device_cert_def, request->device_cert, request->device_cert_size,
+		                               it->device_tbs_digest, it->device_signature, it->device_public_key);
+		if (ret != ATCACERT_E_SUCCESS)
+			return ret;
+		it->device_job = (int)*jobs;
+		msgs[*jobs] = it->device_tbs_digest;
+		signatures[*jobs] = it->device_signature;
+		public_keys[*jobs] = it->signer_public_key;
+		(*jobs)++;
+	}
+
+	if (!atcacert_auth_consume_challenge(ctx, request->challenge))
+		return ATCACERT_E_BAD_CHALLENGE;
+	it->response_job = (int)*jobs;
+	msgs[*jobs] = request->challenge;
+	signatures[*jobs] = request->response;
+	public_keys[*jobs] = it->device_public_key;
+	(*jobs)++;
+
+	return ATCACERT_E_SUCCESS;
+}
+
+int atcacert_auth_device_batch( atcacert_auth_ctx_t*           ctx,
+                                size_t                         count,
+                                const atcacert_auth_request_t* requests,
+                                int*                           results)
+{
+	atcacert_auth_batch_item_t items[ATCACERT_AUTH_BATCH_MAX];
+	const uint8_t* msgs[ATCACERT_AUTH_BATCH_MAX * 3] = { NULL };
+	const uint8_t* signatures[ATCACERT_AUTH_BATCH_MAX * 3] = { NULL };
+	const uint8_t* public_keys[ATCACERT_AUTH_BATCH_MAX * 3] = { NULL };
+	int verified[ATCACERT_AUTH_BATCH_MAX * 3];
+	atcacert_auth_batch_item_t* it = NULL;
+	size_t jobs = 0;
+	size_t i;
+
+	if (ctx == NULL || count > ATCACERT_AUTH_BATCH_MAX || (count > 0 && (requests == NULL || results == NULL)))
+		return ATCACERT_E_BAD_PARAMS;
+
+	memset(items, 0, sizeof(items));
+	for (i = 0; i < count; i++)
+		items[i].ret = atcacert_auth_batch_prepare(ctx, &requests[i], items, i, msgs, signatures, public_keys, &jobs);
+
+	// Crypto outside the lock, same as the single device path
+	atcac_sw_ecdsa_verify_p256_batch(jobs, msgs, signatures, public_keys, verified);
+
+	// Settle each request in the order atcacert_auth_device() would have checked things
+	pthread_mutex_lock(&ctx->lock);
+	for (i = 0; i < count; i++) {
+		it = &items[i];
+		if (it->signer_job >= 0) {
+			if (verified[it->signer_job] == ATCA_SUCCESS) {
+				if (it->owns_signer_job)
+					atcacert_auth_add_key(ctx, it->signer_cert_digest, it->signer_public_key, TRUE);
+			}else  {
+				ctx->stats.failed++;
+				it->ret = ATCACERT_E_VERIFY_FAILED;
+				continue;
+			}
+		}
+		if (it->device_job >= 0) {
+			if (verified[it->device_job] == ATCA_SUCCESS) {
+				atcacert_auth_add_key(ctx, it->device_cert_digest, it->device_public_key, FALSE);
+			}else  {
+				ctx->stats.failed++;
+				it->ret = ATCACERT_E_VERIFY_FAILED;
+				continue;
+			}
+		}
+		if (it->response_job >= 0) {
+			if (verified[it->response_job] == ATCA_SUCCESS) {
+				ctx->stats.verified++;
+			}else  {
+				ctx->stats.failed++;
+				it->ret = ATCACERT_E_VERIFY_FAILED;
+			}
+		}
+	}
+	pthread_mutex_unlock(&ctx->lock);
+
+	for (i = 0; i < count; i++)
+		results[i] = items[i].ret;
+
+	return ATCACERT_E_SUCCESS;
+}
+
+int atcacert_auth_get_stats( atcacert_auth_ctx_t* ctx, atcacert_auth_stats_t* stats )
+{
+	if (ctx == NULL || stats == NULL)
+		return ATCACERT_E_BAD_PARAMS;
+
+	pthread_mutex_lock(&ctx->lock);
+	*stats = ctx->stats;
+	pthread_mutex_unlock(&ctx->lock);
+
+	return ATCACERT_E_SUCCESS;
+}
@@ -0,0 +1,262 @@
+/** \brief Host side device authentication service. Issues challenges, tracks them in a replay
+ * window, and verifies responses with software crypto against public keys validated through the
+ * certificate chain.
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#ifndef ATCACERT_HOST_AUTH_H
+#define ATCACERT_HOST_AUTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "atcacert_def.h"
+
+// Inform function naming when compiling in C++
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \defgroup atcacert_ Certificate manipulation methods (atcacert_)
+ *
+ * \brief
+ * These methods provide convenient ways to perform certification I/O with
+ * CryptoAuth chips and perform certificate manipulation in memory
+ *
+   @{ */
+
+#ifndef ATCACERT_AUTH_KEY_CACHE_SIZE
+#define ATCACERT_AUTH_KEY_CACHE_SIZE        (256)   //!< Validated public keys kept. Must be a power of 2.
+#endif
+#ifndef ATCACERT_AUTH_CHALLENGE_TABLE_SIZE
+#define ATCACERT_AUTH_CHALLENGE_TABLE_SIZE  (1024)  //!< Outstanding challenges kept. Must be a power of 2.
+#endif
+#define ATCACERT_AUTH_PROBES                (8)     //!< Slots searched for an entry before one is evicted.
+#define ATCACERT_AUTH_CHALLENGE_SIZE        (32)
+#define ATCACERT_AUTH_BATCH_MAX             (32)    //!< Most requests atcacert_auth_device_batch() takes at once.
+
+/**
+ * Public key of a certificate that has been validated up to the CA. Signer and device keys share
+ * the cache, but a key is only ever returned for the role its certificate was validated in.
+ */
+typedef struct atcacert_auth_key_s {
+	uint8_t cert_digest[32];    //!< SHA-256 of the full certificate the key came from.
+	uint8_t public_key[64];     //!< X and Y integers concatenated.
+	uint8_t is_signer;          //!< TRUE if the certificate was validated as a signer, FALSE as a device.
+	uint8_t is_valid;
+} atcacert_auth_key_t;
+
+/**
+ * Challenge that has been issued and not yet answered.
+ */
+typedef struct atcacert_auth_challenge_s {
+	uint8_t  challenge[ATCACERT_AUTH_CHALLENGE_SIZE];
+	uint32_t issued_ms;         //!< now_ms() when the challenge was issued.
+	uint8_t  is_pending;
+} atcacert_auth_challenge_t;
+
+/**
+ * One device to authenticate with atcacert_auth_device_batch(). Same arguments as atcacert_auth_device().
+ */
+typedef struct atcacert_auth_request_s {
+	const uint8_t* signer_cert;         //!< Only used if the device certificate isn't cached.
+	size_t         signer_cert_size;
+	const uint8_t* device_cert;
+	size_t         device_cert_size;
+	const uint8_t* challenge;           //!< ATCACERT_AUTH_CHALLENGE_SIZE bytes.
+	const uint8_t* response;            //!< 64 bytes.
+} atcacert_auth_request_t;
+
+/**
+ * Running counts kept by the authentication service.
+ */
+typedef struct atcacert_auth_stats_s {
+	uint32_t challenges;        //!< Challenges issued.
+	uint32_t evicted;           //!< Pending challenges dropped to make room for new ones.
+	uint32_t key_hits;          //!< Certificates found in the key cache.
+	uint32_t key_misses;        //!< Certificates that had to be verified.
+	uint32_t verified;          //!< Responses that verified.
+	uint32_t failed;            //!< Responses or certificates that failed to verify.
+	uint32_t bad_challenges;    //!< Responses to unknown, expired, or already answered challenges.
+} atcacert_auth_stats_t;
+
+/**
+ * State of an authentication service. Large, so it is best allocated statically or on the heap.
+ * All functions taking a context are thread safe; crypto is done outside the context lock.
+ */
+typedef struct atcacert_auth_ctx_s {
+	const atcacert_def_t*       signer_cert_def;
+	const atcacert_def_t*       device_cert_def;
+	uint8_t                     ca_public_key[64];
+	int                         ca_key_pinned;                      //!< ca_public_key has a verification table, see atcac_sw_ecdsa_pin_key().
+	uint32_t                    window_ms;                          //!< How long a challenge may be answered after it is issued.
+	int                         (*random)(uint8_t* data, size_t data_size); //!< Challenge source. Defaults to atcac_sw_random().
+	uint32_t                    (*now_ms)(void);                    //!< Millisecond clock. Defaults to CLOCK_MONOTONIC.
+	pthread_mutex_t             lock;
+	atcacert_auth_stats_t       stats;
+	atcacert_auth_key_t         keys[ATCACERT_AUTH_KEY_CACHE_SIZE];
+	atcacert_auth_challenge_t   challenges[ATCACERT_AUTH_CHALLENGE_TABLE_SIZE];
+} atcacert_auth_ctx_t;
+
+/**
+ * \brief Initialize an authentication service for devices whose certificates chain to ca_public_key
+ *        through a signer certificate. The CA key is pinned, so every signer certificate is
+ *        checked with its precomputed verification table.
+ *
+ * \param[out] ctx              Context to initialize.
+ * \param[in]  signer_cert_def  Certificate definition of the signer certificates.
+ * \param[in]  device_cert_def  Certificate definition of the device certificates.
+ * \param[in]  ca_public_key    Root CA public key, X and Y integers concatenated. 64 bytes.
+ * \param[in]  window_ms        Time in milliseconds a device has to answer a challenge.
+ *
+ * \return 0 on success
+ */
+int atcacert_auth_init( atcacert_auth_ctx_t*  ctx,
+                        const atcacert_def_t* signer_cert_def,
+                        const atcacert_def_t* device_cert_def,
+                        const uint8_t         ca_public_key[64],
+                        uint32_t              window_ms);
+
+/**
+ * \brief Release an authentication service, wiping its cached keys and pending challenges.
+ *
+ * \param[inout] ctx  Context to release.
+ */
+void atcacert_auth_release( atcacert_auth_ctx_t* ctx );
+
+/**
+ * \brief Generate a random challenge for a device and remember it in the replay window.
+ *
+ * \param[inout] ctx        Authentication service.
+ * \param[out]   challenge  Challenge is returned here. 32 bytes.
+ *
+ * \return 0 on success
+ */
+int atcacert_auth_gen_challenge( atcacert_auth_ctx_t* ctx,
+                                 uint8_t              challenge[ATCACERT_AUTH_CHALLENGE_SIZE]);
+
+/**
+ * \brief Get a device's public key, validating the signer and device certificates up to the CA
+ *        only if they aren't already in the key cache.
+ *
+ * \param[inout] ctx                Authentication service.
+ * \param[in]    signer_cert        Signer certificate. Only used if the device certificate isn't cached.
+ * \param[in]    signer_cert_size   Size of the signer certificate in bytes.
+ * \param[in]    device_cert        Device certificate.
+ * \param[in]    device_cert_size   Size of the device certificate in bytes.
+ * \param[out]   device_public_key  Device public key is returned here. 64 bytes.
+ *
+ * \return 0 on success, ATCACERT_E_VERIFY_FAILED if either certificate doesn't verify.
+ */
+int atcacert_auth_get_device_key( atcacert_auth_ctx_t* ctx,
+                                  const uint8_t*       signer_cert,
+                                  size_t               signer_cert_size,
+                                  const uint8_t*       device_cert,
+                                  size_t               device_cert_size,
+                                  uint8_t              device_public_key[64]);
+
+/**
+ * \brief Verify a device's response to a challenge issued by atcacert_auth_gen_challenge().
+ *
+ * The challenge is consumed whether or not the response verifies, so every challenge can be answered
+ * only once.
+ *
+ * \param[inout] ctx                Authentication service.
+ * \param[in]    device_public_key  Device public key. 64 bytes.
+ * \param[in]    challenge          Challenge that was sent to the device. 32 bytes.
+ * \param[in]    response           Response returned from the device. 64 bytes.
+ *
+ * \return 0 if the verify succeeds. ATCACERT_E_BAD_CHALLENGE if the challenge wasn't issued, has
+ *         expired, or was already answered. ATCACERT_E_VERIFY_FAILED if the verify fails.
+ */
+int atcacert_auth_verify_response( atcacert_auth_ctx_t* ctx,
+                                   const uint8_t        device_public_key[64],
+                                   const uint8_t        challenge[ATCACERT_AUTH_CHALLENGE_SIZE],
+                                   const uint8_t        response[64]);
+
+/**
+ * \brief Authenticate a device from its certificate chain and its response to a challenge. Same as
+ *        atcacert_auth_get_device_key() followed by atcacert_auth_verify_response().
+ *
+ * \return 0 if the device is authenticated.
+ */
+int atcacert_auth_device( atcacert_auth_ctx_t* ctx,
+                          const uint8_t*       signer_cert,
+                          size_t               signer_cert_size,
+                          const uint8_t*       device_cert,
+                          size_t               device_cert_size,
+                          const uint8_t        challenge[ATCACERT_AUTH_CHALLENGE_SIZE],
+                          const uint8_t        response[64]);
+
+/**
+ * \brief Authenticate several devices at once. Gives the same results as calling
+ *        atcacert_auth_device() for each request, but all the signatures that need checking (signer
+ *        and device certificates not in the key cache, and the responses) are verified as one
+ *        batch, and a signer certificate shared by several uncached devices is verified once.
+ *
+ * Unlike atcacert_auth_device(), every challenge is consumed, even for a device whose certificates
+ * don't verify.
+ *
+ * \param[inout] ctx       Authentication service.
+ * \param[in]    count     Number of requests, up to ATCACERT_AUTH_BATCH_MAX.
+ * \param[in]    requests  Devices to authenticate.
+ * \param[out]   results   What atcacert_auth_device() would have returned for each request.
+ *
+ * \return 0 if the results were filled in, even when some devices failed.
+ */
+int atcacert_auth_device_batch( atcacert_auth_ctx_t*           ctx,
+                                size_t                         count,
+                                const atcacert_auth_request_t* requests,
+                                int*                           results);
+
+/**
+ * \brief Get a snapshot of the service counters.
+ *
+ * \param[in]  ctx    Authentication service.
+ * \param[out] stats  Counters are returned here.
+ *
+ * \return 0 on success
+ */
+int atcacert_auth_get_stats( atcacert_auth_ctx_t* ctx, atcacert_auth_stats_t* stats );
+
+/** @} */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
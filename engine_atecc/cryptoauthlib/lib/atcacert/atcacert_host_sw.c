@@ -63,7 +63,9 @@ int atcacert_verify_cert_sw( const atcacert_def_t* cert_def,
 		return ret;
 
 	ret = atcac_sw_ecdsa_verify_p256(tbs_digest, signature, ca_public_key);
-	if (ret != ATCACERT_E_SUCCESS)
+	if (ret == ATCA_FUNC_FAIL)
+		return ATCACERT_E_VERIFY_FAILED;
+	if (ret != ATCA_SUCCESS)
 		return ret;
 
 	return ATCACERT_E_SUCCESS;
@@ -81,8 +83,14 @@ int atcacert_verify_response_sw( const uint8_t device_public_key[64],
                                  const uint8_t challenge[32],
                                  const uint8_t response[64])
 {
+	int ret = 0;
+
 	if (device_public_key == NULL || challenge == NULL || response == NULL)
 		return ATCACERT_E_BAD_PARAMS;
 
-	return atcac_sw_ecdsa_verify_p256(challenge, response, device_public_key);
+	ret = atcac_sw_ecdsa_verify_p256(challenge, response, device_public_key);
+	if (ret == ATCA_FUNC_FAIL)
+		return ATCACERT_E_VERIFY_FAILED;
+
+	return ret;
 }
\ No newline at end of file
@@ -70,7 +70,7 @@ extern "C" {
  *                           certificate. Formatted as the 32 byte X and Y integers concatenated
  *                           together (64 bytes total).
  *
- * \return 0 if the verify succeeds, ATCACERT_VERIFY_FAILED if it fails to verify.
+ * \return 0 if the verify succeeds, ATCACERT_E_VERIFY_FAILED if it fails to verify.
  */
 int atcacert_verify_cert_sw( const atcacert_def_t* cert_def,
                              const uint8_t*        cert,
@@ -98,7 +98,7 @@ int atcacert_gen_challenge_sw( uint8_t challenge[32] );
  * \param[in] challenge          Challenge that was sent to the client. 32 bytes.
  * \param[in] response           Response returned from the client to be verified. 64 bytes.
  *
- * \return 0 if the verify succeeds. ATCACERT_BAD_RESPONSE if the verify fails.
+ * \return 0 if the verify succeeds. ATCACERT_E_VERIFY_FAILED if the verify fails.
  */
 int atcacert_verify_response_sw( const uint8_t device_public_key[64],
                                  const uint8_t challenge[32],
@@ -48,6 +48,7 @@
 
 #include "atca_basic.h"
 #include "host/atca_host.h"
+#include "crypto/atca_crypto_sw_rand.h"
 
 char atca_version[] = { "20151130" };  // change for each release, yyyymmdd
 
@@ -67,11 +68,26 @@ ATCA_STATUS atcab_version( char *verstr )
  *  the fundamental premise of the basic API is it is based on a single interface
  *  instance and that instance is global, so all basic API commands assume that
  *  one global device is the one to operate on.
+ *
+ *  Where the compiler supports it the instance is global per thread, so several threads can each
+ *  atcab_init() their own device and use them in parallel. Define ATCA_NO_THREAD_LOCAL to share
+ *  one instance between all threads.
  */
 
-ATCADevice _gDevice = NULL;
-ATCACommand _gCommandObj = NULL;
-ATCAIface _gIface = NULL;
+#if defined(__GNUC__) && !defined(ATCA_NO_THREAD_LOCAL)
+#define ATCA_THREAD_LOCAL __thread
+#else
+#define ATCA_THREAD_LOCAL
+#endif
+
+ATCA_THREAD_LOCAL ATCADevice _gDevice = NULL;
+ATCA_THREAD_LOCAL ATCACommand _gCommandObj = NULL;
+ATCA_THREAD_LOCAL ATCAIface _gIface = NULL;
+
+/** \brief nesting depth of atcab_wake_hold(). While non-zero the device is kept awake between
+ *  commands instead of being woken and idled around each one.
+ */
+static ATCA_THREAD_LOCAL int _gWakeHold = 0;
 
 /** \brief atcab_init is called once for the life of the application and creates a global ATCADevice object used by Basic API.
  *  This method builds a global ATCADevice instance behinds the scenes that's used for all Basic API operations
@@ -86,7 +102,7 @@ ATCA_STATUS atcab_init( ATCAIfaceCfg *cfg )
 
 	_gDevice = newATCADevice( cfg );
 	if ( _gDevice == NULL )
-		return ATCA_GEN_FAIL; // Device creation failed
+		return atca_deadline_expired() ? ATCA_TIMEOUT : ATCA_GEN_FAIL; // Device creation failed
 
 	_gCommandObj = atGetCommands( _gDevice );
 	_gIface = atGetIFace( _gDevice );
@@ -127,6 +143,7 @@ ATCA_STATUS atcab_init_device( ATCADevice cadevice )
  */
 ATCA_STATUS atcab_release( void )
 {
+	_gWakeHold = 0;
 	deleteATCADevice(&_gDevice);
 	return ATCA_SUCCESS;
 }
@@ -149,6 +166,9 @@ ATCA_STATUS atcab_wakeup(void)
 	if ( _gDevice == NULL )
 		return ATCA_GEN_FAIL;
 
+	if ( _gWakeHold > 0 )
+		return ATCA_SUCCESS;    // already awake, see atcab_wake_hold()
+
 	return atwake(_gIface);
 }
 
@@ -163,6 +183,39 @@ ATCA_STATUS atcab_idle(void)
 	return atidle(_gIface);
 }
 
+/** \brief wakes the device once and keeps it awake for the atcab_ commands that follow, until the
+ *  matching atcab_wake_release(). Lets a sequence of commands share a single wake/idle cycle.
+ *  Calls may be nested. The whole sequence must fit in the device watchdog period (about 1.3 s).
+ *  \return ATCA_STATUS
+ */
+ATCA_STATUS atcab_wake_hold(void)
+{
+	ATCA_STATUS status;
+
+	if ( _gDevice == NULL )
+		return ATCA_GEN_FAIL;
+
+	if ( _gWakeHold == 0 && (status = atwake(_gIface)) != ATCA_SUCCESS )
+		return status;
+
+	_gWakeHold++;
+	return ATCA_SUCCESS;
+}
+
+/** \brief ends an atcab_wake_hold() window, idling the device when the outermost hold is released
+ *  \return ATCA_STATUS
+ */
+ATCA_STATUS atcab_wake_release(void)
+{
+	if ( _gDevice == NULL )
+		return ATCA_GEN_FAIL;
+
+	if ( _gWakeHold == 0 || --_gWakeHold > 0 )
+		return ATCA_SUCCESS;
+
+	return atidle(_gIface);
+}
+
 /** \brief invoke sleep on the CryptoAuth device
  *  \return ATCA_STATUS
  */
@@ -266,6 +319,9 @@ ATCA_STATUS atcab_cfg_discover( ATCAIfaceCfg cfgArray[], int maxIfaces)
  */
 static ATCA_STATUS _atcab_exit(void)
 {
+	if ( _gWakeHold > 0 )
+		return ATCA_SUCCESS;    // the device stays awake until atcab_wake_release()
+
 	return atcab_idle();
 }
 
@@ -1091,6 +1147,10 @@ ATCA_STATUS atcab_read_enc(uint8_t slotid, uint8_t block, uint8_t *data, const u
 		nonceParam.rand_out = (uint8_t*)&randout;
 		nonceParam.temp_key = &tempkey;
 
+		// Host side NumIn, the zeroes stay in place where no host random source is available
+		if (atcac_sw_random(numin, sizeof(numin)) != ATCA_SUCCESS)
+			memset(numin, 0, sizeof(numin));
+
 		// Send the random Nonce command
 		if ((status = atcab_nonce_rand(numin, randout)) != ATCA_SUCCESS) BREAK(status, "Nonce failed");
 
@@ -1161,6 +1221,10 @@ ATCA_STATUS atcab_write_enc(uint8_t slotid, uint8_t block, const uint8_t *data,
 		nonceParam.rand_out = (uint8_t*)&randout;
 		nonceParam.temp_key = &tempkey;
 
+		// Host side NumIn, the zeroes stay in place where no host random source is available
+		if (atcac_sw_random(numin, sizeof(numin)) != ATCA_SUCCESS)
+			memset(numin, 0, sizeof(numin));
+
 		// Send the random Nonce command
 		if ((status = atcab_nonce_rand(numin, randout)) != ATCA_SUCCESS) BREAK(status, "Nonce failed");
 
@@ -2083,6 +2147,10 @@ ATCA_STATUS atcab_priv_write(uint8_t slot, const uint8_t priv_key[36], uint8_t w
 			memcpy(privKey, priv_key, 36);
 			memcpy(writeKey, write_key, 32);
 
+			// Host side NumIn, the zeroes stay in place where no host random source is available
+			if (atcac_sw_random(numin, sizeof(numin)) != ATCA_SUCCESS)
+				memset(numin, 0, sizeof(numin));
+
 			// Send the random Nonce command
 			if ((status = atcab_nonce_rand(numin, randout)) != ATCA_SUCCESS)
 				break;
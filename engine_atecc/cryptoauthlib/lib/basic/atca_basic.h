@@ -68,6 +68,8 @@ ATCADevice atcab_getDevice(void);
 ATCA_STATUS atcab_wakeup(void);
 ATCA_STATUS atcab_idle(void);
 ATCA_STATUS atcab_sleep(void);
+ATCA_STATUS atcab_wake_hold(void);
+ATCA_STATUS atcab_wake_release(void);
 
 // discovery
 ATCA_STATUS atcab_cfg_discover( ATCAIfaceCfg cfgArray[], int max);
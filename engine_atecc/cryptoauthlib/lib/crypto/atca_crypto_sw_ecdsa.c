@@ -1,5 +1,5 @@
-/** \brief API wrapper for software ECDSA verify.  Currently unimplemented but could be
- * implemented via a 3rd party library such as MicroECC.
+/** \brief API wrapper for software ECDSA verify.  The P-256 arithmetic is implemented in
+ * ecc/p256_routines.c, without any 3rd party library.
  *
  * Copyright (c) 2015 Atmel Corporation. All rights reserved.
  *
@@ -40,17 +40,290 @@
 
 
 #include "atca_crypto_sw_ecdsa.h"
+#include "atca_crypto_sw_rand.h"
+#include "ecc/p256_routines.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Keys that verify most of the signatures a host sees (the root CA, the signer CAs) can be
+ * pinned. A pinned key gets a fixed-base table built once, and atcac_sw_ecdsa_verify_p256()
+ * switches to the table path whenever it is handed one of them. The generator table is shared by
+ * all pinned keys and lives as long as at least one key is pinned.
+ *
+ * Verifies hold the read lock for as long as they use a table, so pin and unpin are safe at any
+ * time, they just wait for the verifies in flight.
+ */
+typedef struct {
+	unsigned      refs;     //!< Pin count, the slot is free when 0
+	uint8_t       public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE];
+	p256_precomp* precomp;
+} atcac_pinned_key;
+
+static pthread_rwlock_t g_pinned_lock = PTHREAD_RWLOCK_INITIALIZER;
+static atcac_pinned_key g_pinned_keys[ATCAC_ECDSA_PINNED_KEYS];
+static p256_precomp* g_pinned_generator;
+static volatile int g_pinned_count;
+
+static atcac_pinned_key* atcac_find_pinned(const uint8_t public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE])
+{
+	int i;
+
+	for (i = 0; i < ATCAC_ECDSA_PINNED_KEYS; i++) {
+		if (g_pinned_keys[i].refs && memcmp(g_pinned_keys[i].public_key, public_key, ATCA_ECC_P256_PUBLIC_KEY_SIZE) == 0)
+			return &g_pinned_keys[i];
+	}
+	return NULL;
+}
 
 /** \brief return software generated ECDSA verification result
  * \param[in] msg ptr to message or challenge
  * \param[in] signature ptr to the signature to verify
  * \param[in] public key ptr to public key of device which signed the challenge
- * return ATCA_STATUS
+ * return ATCA_SUCCESS if the signature is valid, ATCA_FUNC_FAIL if it is not
  */
 
 int atcac_sw_ecdsa_verify_p256( const uint8_t msg[ATCA_ECC_P256_FIELD_SIZE],
                                 const uint8_t signature[ATCA_ECC_P256_SIGNATURE_SIZE],
                                 const uint8_t public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE])
 {
-	return ATCA_UNIMPLEMENTED;
-}
\ No newline at end of file
+	atcac_pinned_key* pinned;
+	int valid;
+
+	if (msg == NULL || signature == NULL || public_key == NULL)
+		return ATCA_BAD_PARAM;
+
+	if (g_pinned_count > 0) {
+		pthread_rwlock_rdlock(&g_pinned_lock);
+		pinned = atcac_find_pinned(public_key);
+		if (pinned) {
+			valid = sw_p256_ecdsa_verify_precomp(msg, signature, g_pinned_generator, pinned->precomp);
+			pthread_rwlock_unlock(&g_pinned_lock);
+			return valid ? ATCA_SUCCESS : ATCA_FUNC_FAIL;
+		}
+		pthread_rwlock_unlock(&g_pinned_lock);
+	}
+
+	if (!sw_p256_ecdsa_verify(msg, signature, public_key))
+		return ATCA_FUNC_FAIL;
+
+	return ATCA_SUCCESS;
+}
+
+/** \brief Pins a trusted public key: builds its verification table so later verifies with it are
+ *         several times faster. Pinning a key that is already pinned only counts one more pin.
+ * \param[in] public_key  X and Y of the public key, big-endian
+ * return ATCA_SUCCESS on success, ATCA_BAD_PARAM if the key is not a valid P-256 point,
+ *        ATCA_INVALID_SIZE if ATCAC_ECDSA_PINNED_KEYS keys are already pinned, ATCA_GEN_FAIL if
+ *        the tables could not be allocated
+ */
+int atcac_sw_ecdsa_pin_key(const uint8_t public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE])
+{
+	atcac_pinned_key* pinned;
+	p256_precomp* precomp;
+	int ret = ATCA_SUCCESS;
+	int i;
+
+	if (public_key == NULL || !sw_p256_public_key_valid(public_key))
+		return ATCA_BAD_PARAM;
+
+	pthread_rwlock_wrlock(&g_pinned_lock);
+	pinned = atcac_find_pinned(public_key);
+	if (pinned) {
+		pinned->refs++;
+		goto done;
+	}
+
+	for (i = 0; i < ATCAC_ECDSA_PINNED_KEYS && g_pinned_keys[i].refs; i++)
+		;
+	if (i == ATCAC_ECDSA_PINNED_KEYS) {
+		ret = ATCA_INVALID_SIZE;
+		goto done;
+	}
+
+	if (g_pinned_generator == NULL) {
+		g_pinned_generator = sw_p256_precomp_new(NULL);
+		if (g_pinned_generator == NULL) {
+			ret = ATCA_GEN_FAIL;
+			goto done;
+		}
+	}
+	precomp = sw_p256_precomp_new(public_key);
+	if (precomp == NULL) {
+		if (g_pinned_count == 0) {
+			sw_p256_precomp_free(g_pinned_generator);
+			g_pinned_generator = NULL;
+		}
+		ret = ATCA_GEN_FAIL;
+		goto done;
+	}
+
+	pinned = &g_pinned_keys[i];
+	memcpy(pinned->public_key, public_key, sizeof(pinned->public_key));
+	pinned->precomp = precomp;
+	pinned->refs = 1;
+	g_pinned_count++;
+
+done:
+	pthread_rwlock_unlock(&g_pinned_lock);
+	return ret;
+}
+
+/** \brief Drops one pin of a key pinned with atcac_sw_ecdsa_pin_key(). Its table is released with
+ *         the last pin.
+ * \param[in] public_key  X and Y of the public key, big-endian
+ * return ATCA_SUCCESS on success, ATCA_BAD_PARAM if the key is not pinned
+ */
+int atcac_sw_ecdsa_unpin_key(const uint8_t public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE])
+{
+	atcac_pinned_key* pinned;
+	int ret = ATCA_SUCCESS;
+
+	if (public_key == NULL)
+		return ATCA_BAD_PARAM;
+
+	pthread_rwlock_wrlock(&g_pinned_lock);
+	pinned = atcac_find_pinned(public_key);
+	if (pinned == NULL) {
+		ret = ATCA_BAD_PARAM;
+	}else if (--pinned->refs == 0) {
+		sw_p256_precomp_free(pinned->precomp);
+		memset(pinned, 0, sizeof(*pinned));
+		if (--g_pinned_count == 0) {
+			sw_p256_precomp_free(g_pinned_generator);
+			g_pinned_generator = NULL;
+		}
+	}
+	pthread_rwlock_unlock(&g_pinned_lock);
+	return ret;
+}
+
+typedef struct {
+	const uint8_t* public_key;
+	size_t         index;
+} atcac_batch_entry;
+
+//! Orders batch entries by public key so signatures by the same key end up in the same batch
+static int atcac_batch_entry_cmp(const void* a, const void* b)
+{
+	const atcac_batch_entry* ea = (const atcac_batch_entry*)a;
+	const atcac_batch_entry* eb = (const atcac_batch_entry*)b;
+	int diff = memcmp(ea->public_key, eb->public_key, ATCA_ECC_P256_PUBLIC_KEY_SIZE);
+
+	if (diff != 0)
+		return diff;
+	return ea->index < eb->index ? -1 : (ea->index > eb->index);
+}
+
+/** \brief Verifies up to P256_BATCH_MAX signatures together. When the batch fails, each half is
+ *         tried again on its own until the invalid signatures are singled out.
+ */
+static void atcac_verify_batch_bisect(const atcac_batch_entry* entries, size_t count,
+                                      const uint8_t* const msgs[],
+                                      const uint8_t* const signatures[],
+                                      const uint8_t multipliers[][P256_BATCH_MULTIPLIER_SIZE],
+                                      int results[])
+{
+	const uint8_t* batch_msgs[P256_BATCH_MAX] = { NULL };
+	const uint8_t* batch_signatures[P256_BATCH_MAX] = { NULL };
+	const uint8_t* batch_public_keys[P256_BATCH_MAX] = { NULL };
+	size_t i;
+
+	if (count == 1) {
+		i = entries[0].index;
+		results[i] = sw_p256_ecdsa_verify(msgs[i], signatures[i], entries[0].public_key) ? ATCA_SUCCESS : ATCA_FUNC_FAIL;
+		return;
+	}
+
+	for (i = 0; i < count; i++) {
+		batch_msgs[i] = msgs[entries[i].index];
+		batch_signatures[i] = signatures[entries[i].index];
+		batch_public_keys[i] = entries[i].public_key;
+	}
+	if (sw_p256_ecdsa_verify_batch(count, batch_msgs, batch_signatures, batch_public_keys, multipliers)) {
+		for (i = 0; i < count; i++)
+			results[entries[i].index] = ATCA_SUCCESS;
+		return;
+	}
+
+	atcac_verify_batch_bisect(entries, count / 2, msgs, signatures, multipliers, results);
+	atcac_verify_batch_bisect(&entries[count / 2], count - count / 2, msgs, signatures, &multipliers[count / 2], results);
+}
+
+/** \brief Verifies many ECDSA P-256 signatures at once, which costs less per signature than
+ *         verifying them one by one, most of all when many of them share a public key.
+ *
+ * Signatures by pinned keys take the table path of atcac_sw_ecdsa_verify_p256(). The others are
+ * grouped by key and checked P256_BATCH_MAX at a time with random linear combinations; a failing
+ * group is split until the invalid signatures are found, so the results are exactly those of
+ * verifying each signature on its own.
+ *
+ * \param[in]  count       number of signatures
+ * \param[in]  msgs        message digest of each signature
+ * \param[in]  signatures  the signatures
+ * \param[in]  public_keys public key each signature is checked against
+ * \param[out] results     ATCA_SUCCESS or ATCA_FUNC_FAIL for each signature
+ * return ATCA_SUCCESS if all signatures are valid, ATCA_FUNC_FAIL if any is not
+ */
+int atcac_sw_ecdsa_verify_p256_batch(size_t count,
+                                     const uint8_t* const msgs[],
+                                     const uint8_t* const signatures[],
+                                     const uint8_t* const public_keys[],
+                                     int results[])
+{
+	uint8_t multipliers[P256_BATCH_MAX][P256_BATCH_MULTIPLIER_SIZE];
+	atcac_batch_entry* entries = NULL;
+	atcac_pinned_key* pinned;
+	size_t entry_count = 0;
+	size_t batch;
+	size_t i;
+	int ret = ATCA_SUCCESS;
+
+	if (count > 0 && (msgs == NULL || signatures == NULL || public_keys == NULL || results == NULL))
+		return ATCA_BAD_PARAM;
+	for (i = 0; i < count; i++) {
+		if (msgs[i] == NULL || signatures[i] == NULL || public_keys[i] == NULL)
+			return ATCA_BAD_PARAM;
+	}
+	if (count == 0)
+		return ATCA_SUCCESS;
+
+	entries = (atcac_batch_entry*)malloc(count * sizeof(*entries));
+	if (entries == NULL) {
+		// Still correct, just not faster
+		for (i = 0; i < count; i++)
+			results[i] = atcac_sw_ecdsa_verify_p256(msgs[i], signatures[i], public_keys[i]);
+		goto done;
+	}
+
+	pthread_rwlock_rdlock(&g_pinned_lock);
+	for (i = 0; i < count; i++) {
+		pinned = g_pinned_count > 0 ? atcac_find_pinned(public_keys[i]) : NULL;
+		if (pinned) {
+			results[i] = sw_p256_ecdsa_verify_precomp(msgs[i], signatures[i], g_pinned_generator, pinned->precomp)
+			             ? ATCA_SUCCESS : ATCA_FUNC_FAIL;
+		}else  {
+			entries[entry_count].public_key = public_keys[i];
+			entries[entry_count].index = i;
+			entry_count++;
+		}
+	}
+	pthread_rwlock_unlock(&g_pinned_lock);
+
+	qsort(entries, entry_count, sizeof(*entries), atcac_batch_entry_cmp);
+	for (i = 0; i < entry_count; i += batch) {
+		batch = entry_count - i < P256_BATCH_MAX ? entry_count - i : P256_BATCH_MAX;
+		if (batch > 1 && atcac_sw_random(&multipliers[0][0], batch * P256_BATCH_MULTIPLIER_SIZE) != ATCA_SUCCESS)
+			batch = 1;  // Without fresh randomness a batch would not be sound, verify alone instead
+		atcac_verify_batch_bisect(&entries[i], batch, msgs, signatures, (const uint8_t(*)[P256_BATCH_MULTIPLIER_SIZE])multipliers, results);
+	}
+	free(entries);
+
+done:
+	for (i = 0; i < count; i++) {
+		if (results[i] != ATCA_SUCCESS)
+			ret = ATCA_FUNC_FAIL;
+	}
+	return ret;
+}
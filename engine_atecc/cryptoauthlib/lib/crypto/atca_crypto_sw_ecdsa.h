@@ -58,6 +58,10 @@
 #define ATCA_ECC_P256_PUBLIC_KEY_SIZE  (ATCA_ECC_P256_FIELD_SIZE * 2)
 #define ATCA_ECC_P256_SIGNATURE_SIZE   (ATCA_ECC_P256_FIELD_SIZE * 2)
 
+#ifndef ATCAC_ECDSA_PINNED_KEYS
+#define ATCAC_ECDSA_PINNED_KEYS        (8)     //!< Most keys pinned at once, each table takes about 150 KB
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -66,6 +70,15 @@ int atcac_sw_ecdsa_verify_p256( const uint8_t msg[ATCA_ECC_P256_FIELD_SIZE],
                                 const uint8_t signature[ATCA_ECC_P256_SIGNATURE_SIZE],
                                 const uint8_t public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE]);
 
+int atcac_sw_ecdsa_verify_p256_batch(size_t count,
+                                     const uint8_t* const msgs[],
+                                     const uint8_t* const signatures[],
+                                     const uint8_t* const public_keys[],
+                                     int results[]);
+
+int atcac_sw_ecdsa_pin_key(const uint8_t public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE]);
+int atcac_sw_ecdsa_unpin_key(const uint8_t public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE]);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,6 +39,148 @@
 
 #include "atca_crypto_sw_rand.h"
 
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/*
+ * Random bytes come from the kernel CSPRNG, through getrandom(2) when the kernel supports it and
+ * /dev/urandom otherwise. Small requests, such as 20 byte nonce inputs, are served from a per-thread
+ * cache so they cost neither a syscall nor a lock. Bytes are wiped from the cache as they are handed
+ * out, and a fork invalidates every cache so parent and child never return the same bytes.
+ */
+
+#define ATCAC_RAND_CACHE_SIZE   (256)
+
+typedef struct {
+	uint8_t buf[ATCAC_RAND_CACHE_SIZE];
+	size_t avail;           //!< Unused bytes, at the end of buf
+	unsigned generation;    //!< Fork generation the bytes were read in
+} atcac_rand_cache;
+
+static __thread atcac_rand_cache g_rand_cache;
+static volatile unsigned g_rand_generation = 1;
+static pthread_once_t g_rand_once = PTHREAD_ONCE_INIT;
+
+static void atcac_rand_atfork_child(void)
+{
+	g_rand_generation++;
+}
+
+static void atcac_rand_init(void)
+{
+	pthread_atfork(NULL, NULL, atcac_rand_atfork_child);
+}
+
+/** \brief reads from /dev/urandom, for kernels without getrandom(2)
+ * \return ATCA_SUCCESS if data was filled completely
+ */
+static int atcac_rand_urandom(uint8_t* data, size_t data_size)
+{
+	ssize_t ret;
+	int fd;
+
+	do {
+		fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+	} while (fd < 0 && errno == EINTR);
+	if (fd < 0)
+		return ATCA_GEN_FAIL;
+
+	while (data_size > 0) {
+		ret = read(fd, data, data_size);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			break;
+		data += ret;
+		data_size -= (size_t)ret;
+	}
+	close(fd);
+
+	return data_size == 0 ? ATCA_SUCCESS : ATCA_GEN_FAIL;
+}
+
+/** \brief reads random bytes straight from the kernel
+ * \return ATCA_SUCCESS if data was filled completely
+ */
+static int atcac_rand_os(uint8_t* data, size_t data_size)
+{
+#ifdef SYS_getrandom
+	static volatile int no_getrandom = 0;
+	long ret;
+
+	while (!no_getrandom && data_size > 0) {
+		ret = syscall(SYS_getrandom, data, data_size, 0);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno != ENOSYS)
+				return ATCA_GEN_FAIL;
+			no_getrandom = 1;
+			break;
+		}
+		data += ret;
+		data_size -= (size_t)ret;
+	}
+	if (data_size == 0)
+		return ATCA_SUCCESS;
+#endif
+	return atcac_rand_urandom(data, data_size);
+}
+
+/** \brief return software generated random number
+ * \param[out] data ptr to space to receive the random
+ * \param[in] size of data buffer
+ * return ATCA_STATUS
+ */
+
+int atcac_sw_random(uint8_t* data, size_t data_size)
+{
+	atcac_rand_cache* cache = &g_rand_cache;
+	uint8_t* src;
+	size_t chunk;
+	int ret;
+
+	if (data == NULL && data_size > 0)
+		return ATCA_BAD_PARAM;
+
+	pthread_once(&g_rand_once, atcac_rand_init);
+	if (cache->generation != g_rand_generation) {
+		memset(cache->buf, 0, sizeof(cache->buf));
+		cache->avail = 0;
+		cache->generation = g_rand_generation;
+	}
+
+	// Large requests bypass the cache
+	if (data_size >= ATCAC_RAND_CACHE_SIZE)
+		return atcac_rand_os(data, data_size);
+
+	while (data_size > 0) {
+		if (cache->avail == 0) {
+			ret = atcac_rand_os(cache->buf, sizeof(cache->buf));
+			if (ret != ATCA_SUCCESS)
+				return ret;
+			cache->avail = sizeof(cache->buf);
+		}
+		chunk = data_size < cache->avail ? data_size : cache->avail;
+		src = &cache->buf[sizeof(cache->buf) - cache->avail];
+		memcpy(data, src, chunk);
+		memset(src, 0, chunk);
+		cache->avail -= chunk;
+		data += chunk;
+		data_size -= chunk;
+	}
+
+	return ATCA_SUCCESS;
+}
+
+#else
+
 /** \brief return software generated random number
  * \param[out] data ptr to space to receive the random
  * \param[in] size of data buffer
@@ -48,4 +190,6 @@
 int atcac_sw_random(uint8_t* data, size_t data_size)
 {
 	return ATCA_UNIMPLEMENTED;
-}
\ No newline at end of file
+}
+
+#endif
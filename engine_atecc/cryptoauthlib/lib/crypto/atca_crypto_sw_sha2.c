@@ -108,4 +108,36 @@ int atcac_sw_sha2_256(const uint8_t* data, size_t data_size, uint8_t digest[ATCA
 		return ret;
 
 	return ATCA_SUCCESS;
-}
\ No newline at end of file
+}
+/** \brief computes the SHA256 of several independent messages in one call, hashing them side by
+ *         side when the CPU supports it
+ * \param[in] data array of pointers to the messages to hash
+ * \param[in] data_size array of message sizes, in bytes
+ * \param[in] count number of messages
+ * \param[out] digests receives one digest per message, in the same order
+ * \return ATCA_STATUS
+ */
+
+int atcac_sw_sha2_256_mb(const uint8_t* const data[], const size_t data_size[], size_t count, uint8_t digests[][ATCA_SHA2_256_DIGEST_SIZE])
+{
+	uint32_t lens[SW_SHA256_MB_LANES * 4];
+	size_t chunk;
+	size_t i;
+
+	while (count > 0) {
+		chunk = count < sizeof(lens) / sizeof(lens[0]) ? count : sizeof(lens) / sizeof(lens[0]);
+		for (i = 0; i < chunk; i++) {
+			if (data_size[i] > UINT32_MAX)
+				return ATCA_BAD_PARAM;
+			lens[i] = (uint32_t)data_size[i];
+		}
+		sw_sha256_mb(data, lens, (uint32_t)chunk, digests);
+
+		data += chunk;
+		data_size += chunk;
+		digests += chunk;
+		count -= chunk;
+	}
+
+	return ATCA_SUCCESS;
+}
@@ -66,6 +66,7 @@ int atcac_sw_sha2_256_init(atcac_sha2_256_ctx* ctx);
 int atcac_sw_sha2_256_update(atcac_sha2_256_ctx* ctx, const uint8_t* data, size_t data_size);
 int atcac_sw_sha2_256_finish(atcac_sha2_256_ctx * ctx, uint8_t digest[ATCA_SHA2_256_DIGEST_SIZE]);
 int atcac_sw_sha2_256(const uint8_t * data, size_t data_size, uint8_t digest[ATCA_SHA2_256_DIGEST_SIZE]);
+int atcac_sw_sha2_256_mb(const uint8_t* const data[], const size_t data_size[], size_t count, uint8_t digests[][ATCA_SHA2_256_DIGEST_SIZE]);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,1141 @@
+/** \brief Software implementation of ECDSA verification on the NIST P-256 curve.
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "p256_routines.h"
+
+/*
+ * Field elements and scalars are 8 little-endian 32-bit limbs, kept in Montgomery form
+ * (a * 2^256 mod m) while being worked on. Points use Jacobian coordinates (X / Z^2, Y / Z^3),
+ * with Z == 0 for the point at infinity, so no inversion is needed until the very end.
+ *
+ * Everything here works on public data (signature, public key and digest), so the code is
+ * written for speed rather than constant time. It must not be reused for signing.
+ */
+
+#define P256_LIMBS      (8)
+#define P256_G_WINDOW   (7)     //!< wNAF window used for the generator, matches the size of p256_g_table
+#define P256_Q_WINDOW   (5)     //!< wNAF window used for the public key
+#define P256_Q_TABLE    (1 << (P256_Q_WINDOW - 2))
+#define P256_NAF_SIZE   (257)
+#define P256_COMB_WINDOW    (7)     //!< Signed window width of the precomputed tables
+#define P256_COMB_POINTS    (1 << (P256_COMB_WINDOW - 1))
+#define P256_COMB_WINDOWS   ((P256_LIMBS * 32 + P256_COMB_WINDOW - 1) / P256_COMB_WINDOW)
+
+typedef struct {
+	uint32_t m[P256_LIMBS];     //!< Modulus
+	uint32_t rr[P256_LIMBS];    //!< 2^512 mod m, converts into Montgomery form
+	uint32_t m0inv;             //!< -m^-1 mod 2^32
+} p256_modulus;
+
+typedef struct {
+	uint32_t x[P256_LIMBS];
+	uint32_t y[P256_LIMBS];
+} p256_affine;
+
+typedef struct {
+	uint32_t x[P256_LIMBS];
+	uint32_t y[P256_LIMBS];
+	uint32_t z[P256_LIMBS];
+} p256_jacobian;
+
+//! Field prime p = 2^256 - 2^224 + 2^192 + 2^96 - 1
+static const p256_modulus p256_p = {
+	{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000, 0x00000001, 0xFFFFFFFF },
+	{ 0x00000003, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFB, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFD, 0x00000004 },
+	0x00000001
+};
+
+//! Group order n
+static const p256_modulus p256_n = {
+	{ 0xFC632551, 0xF3B9CAC2, 0xA7179E84, 0xBCE6FAAD, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF },
+	{ 0xBE79EEA2, 0x83244C95, 0x49BD6FA6, 0x4699799C, 0x2B6BEC59, 0x2845B239, 0xF3D95620, 0x66E12D94 },
+	0xEE00BC4F
+};
+
+//! 1 in Montgomery form mod p
+static const uint32_t p256_one[P256_LIMBS] = {
+	0x00000001, 0x00000000, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFE, 0x00000000
+};
+
+//! Curve constant b in Montgomery form mod p
+static const uint32_t p256_b[P256_LIMBS] = {
+	0x29C4BDDF, 0xD89CDF62, 0x78843090, 0xACF005CD, 0xF7212ED6, 0xE5A220AB, 0x04874834, 0xDC30061D
+};
+
+//! Odd multiples 1G, 3G, ..., 63G of the generator, affine and in Montgomery form mod p
+static const p256_affine p256_g_table[1 << (P256_G_WINDOW - 2)] = {
+	{ { 0x18A9143C, 0x79E730D4, 0x5FEDB601, 0x75BA95FC, 0x77622510, 0x79FB732B, 0xA53755C6, 0x18905F76 },
+	  { 0xCE95560A, 0xDDF25357, 0xBA19E45C, 0x8B4AB8E4, 0xDD21F325, 0xD2E88688, 0x25885D85, 0x8571FF18 } },
+	{ { 0x4EEBC127, 0xFFAC3F90, 0x087D81FB, 0xB027F84A, 0x87CBBC98, 0x66AD77DD, 0xB6FF747E, 0x26936A3F },
+	  { 0xC983A7EB, 0xB04C5C1F, 0x0861FE1A, 0x583E47AD, 0x1A2EE98E, 0x78820831, 0xE587CC07, 0xD5F06A29 } },
+	{ { 0xC45C61F5, 0xBE1B8AAE, 0x94B9537D, 0x90EC649A, 0xD076C20C, 0x941CB5AA, 0x890523C8, 0xC9079605 },
+	  { 0xE7BA4F10, 0xEB309B4A, 0xE5EB882B, 0x73C568EF, 0x7E7A1F68, 0x3540A987, 0x2DD1E916, 0x73A076BB } },
+	{ { 0xA0173B4F, 0x0746354E, 0xD23C00F7, 0x2BD20213, 0x0C23BB08, 0xF43EAAB5, 0xC3123E03, 0x13BA5119 },
+	  { 0x3F5B9D4D, 0x2847D030, 0x5DA67BDD, 0x6742F2F2, 0x77C94195, 0xEF933BDC, 0x6E240867, 0xEAEDD915 } },
+	{ { 0x264E20E8, 0x75C96E8F, 0x59A7A841, 0xABE6BFED, 0x44C8EB00, 0x2CC09C04, 0xF0C4E16B, 0xE05B3080 },
+	  { 0xA45F3314, 0x1EB7777A, 0xCE5D45E3, 0x56AF7BED, 0x88B12F1A, 0x2B6E019A, 0xFD835F9B, 0x086659CD } },
+	{ { 0x6245E404, 0xEA7D260A, 0x6E7FDFE0, 0x9DE40795, 0x8DAC1AB5, 0x1FF3A415, 0x649C9073, 0x3E7090F1 },
+	  { 0x2B944E88, 0x1A768561, 0xE57F61C8, 0x250F939E, 0x1EAD643D, 0x0C0DAA89, 0xE125B88E, 0x68930023 } },
+	{ { 0x4B2ED709, 0xCCC42563, 0x856FD30D, 0x0E356769, 0x559E9811, 0xBCBCD43F, 0x5395B759, 0x738477AC },
+	  { 0xC00EE17F, 0x35752B90, 0x742ED2E3, 0x68748390, 0xBD1F5BC1, 0x7CD06422, 0xC9E7B797, 0xFBC08769 } },
+	{ { 0xBC60055B, 0x72BCD8B7, 0x56E27E4B, 0x03CC23EE, 0xE4819370, 0xEE337424, 0x0AD3DA09, 0xE2AA0E43 },
+	  { 0x6383C45D, 0x40B8524F, 0x42A41B25, 0xD7663554, 0x778A4797, 0x64EFA6DE, 0x7079ADF4, 0x2042170A } },
+	{ { 0xD53C5C9D, 0x97091DCB, 0xAC0A177B, 0xF17624B6, 0x2CFE2DFF, 0xB0F13975, 0x6C7A574E, 0xC1A35C0A },
+	  { 0x93E79987, 0x227D3146, 0xE89CB80E, 0x0575BF30, 0x0D1883BB, 0x2F4E247F, 0x3274C3D0, 0xEBD51226 } },
+	{ { 0xA5659AE8, 0xFEA912BA, 0x25E1A16E, 0x68363ABA, 0x752C41AC, 0xB8842277, 0x2897C3FC, 0xFE545C28 },
+	  { 0xDC4C696B, 0x2D36E9E7, 0xFBA977C5, 0x5806244A, 0xE39508C1, 0x85665E9B, 0x6D12597B, 0xF720EE25 } },
+	{ { 0xC135B208, 0x562E4CEC, 0x4783F47D, 0x74E1B265, 0x5A3F3B30, 0x6D2A506C, 0xC16762FC, 0xECEAD9F4 },
+	  { 0xE286E5B9, 0xF29DD4B2, 0x83BB3C61, 0x1B0FADC0, 0x7FAC29A4, 0x7A75023E, 0xC9477FA3, 0xC086D5F1 } },
+	{ { 0x2DE45068, 0xF4F87653, 0x9E2E1F6E, 0x37C7A7E8, 0xA3584069, 0xD0825FA2, 0x1727BF42, 0xAF2CEA7C },
+	  { 0x9E4785A9, 0x0360A4FB, 0x27299F4A, 0xE5FDA49C, 0x71AC2F71, 0x48068E13, 0x9077666F, 0x83D0687B } },
+	{ { 0xD837879F, 0xA4A319AC, 0xED6B67B0, 0x6FC1B49E, 0x32F1F3AF, 0xE3959933, 0x65432A2E, 0x966742EB },
+	  { 0xB4966228, 0x4B8DC9FE, 0x43F43950, 0x96CC6312, 0xC9B731EE, 0x12068859, 0x56F79968, 0x7B948DC3 } },
+	{ { 0x97E2FEB4, 0x042C2AF4, 0xAEBF7313, 0xD36A42D7, 0x084FFDD7, 0x49D2C9EB, 0x2EF7C76A, 0x9F8AA54B },
+	  { 0x09895E70, 0x9200B7BA, 0xDDB7FB58, 0x3BD0C66F, 0x78EB4CBB, 0x2D97D108, 0xD84BDE31, 0x2D431068 } },
+	{ { 0xCB66E132, 0x5E5DB46A, 0x0D925880, 0xF1BE963A, 0x0317B9E2, 0x944A7027, 0x48603D48, 0xE266F959 },
+	  { 0x5C208899, 0x98DB6673, 0xA2FB18A3, 0x90472447, 0x777C619F, 0x8A966939, 0x2A3BE21B, 0x3798142A } },
+	{ { 0x6755FF89, 0xE2F73C69, 0x473017E6, 0xDD3CF7E7, 0x3CF7600D, 0x8EF5689D, 0xB1FC87B4, 0x948DC4F8 },
+	  { 0x4EA53299, 0xD9E9FE81, 0x98EB6028, 0x2D921CA2, 0x0C9803FC, 0xFAECEDFD, 0x4D7B4745, 0xF38AE891 } },
+	{ { 0x0F664534, 0x87151456, 0x4B68F103, 0x85CEAE7C, 0x65578AB9, 0xAC09C4AE, 0xF044B10C, 0x33EC6868 },
+	  { 0x3A8EC1F1, 0x6AC4832B, 0x5847D5EF, 0x5509D128, 0x763F1574, 0xF909604F, 0xC32F63C4, 0xB16C4303 } },
+	{ { 0xDEC67EF5, 0xFD16847F, 0x233E76B7, 0x742EE464, 0xEFC2B4C8, 0x0B8E4134, 0x42A3E521, 0xCA640B86 },
+	  { 0x8CEB6AA9, 0x653A0190, 0x547852D5, 0x313C300C, 0x6B237AF7, 0x24E4AB12, 0x8BB47AF8, 0x2BA90162 } },
+	{ { 0x8CCE08B5, 0x00467BC5, 0x7F178D55, 0xB636458C, 0xA677D806, 0xC5748BAE, 0xDFA394EB, 0x2763A387 },
+	  { 0x7D3CEBB6, 0xA12B448A, 0x6F20D850, 0xE7ADDA3E, 0x1558462C, 0xF63EBCE5, 0x620088A8, 0x58B36143 } },
+	{ { 0xA059C142, 0xA9D89488, 0xFF0B9346, 0x6F5AE714, 0x16FB3664, 0x068F237D, 0x363186AC, 0x5853E4C4 },
+	  { 0x63C52F98, 0xE2D87D23, 0x81828876, 0x2EC4A766, 0xE14E7B1C, 0x47B864FA, 0x69192408, 0x0C0BC0E5 } },
+	{ { 0x2ED22E91, 0x624D6049, 0x6F072822, 0x6FDFE0B5, 0x39CE2271, 0xEECA1115, 0xDB01614F, 0x98100A4F },
+	  { 0xA35C628F, 0xB6B0DAA2, 0xC87E9A47, 0xB6F94D2E, 0x1D57D9CE, 0xC6773259, 0x03884A7B, 0xF70BFEEC } },
+	{ { 0x248A7D06, 0x4FF23FFD, 0x878873FA, 0x80C5BFB4, 0x05745981, 0xB7D9AD90, 0x3DB01994, 0x179C85DB },
+	  { 0x61A6966C, 0xBA41B062, 0xEADCE5A8, 0x4D82D052, 0xA5E6A318, 0x9E91CD3B, 0x95B2DDA0, 0x47795F4F } },
+	{ { 0xD5CD79BF, 0x1EE426CC, 0x946C6E18, 0x0032940B, 0x57477F58, 0x1B1E8AE0, 0x6D823278, 0xE94F7D34 },
+	  { 0x782BA21A, 0xC747CB96, 0xF72B33A5, 0xC5254469, 0xC7F80C81, 0x772EF6DE, 0x2CD9E6B5, 0xD73ACBFE } },
+	{ { 0xCAA76097, 0x283C7513, 0x36C83906, 0x0A624FA9, 0x715AF2C7, 0x6B20AFEC, 0xEBA78BFD, 0x4B969974 },
+	  { 0xD921D60E, 0x220755CC, 0x7BAECA13, 0x9B944E10, 0x5DED93D4, 0x04819D51, 0x6DDDFD27, 0x9BBFF86E } },
+	{ { 0x1FF6ACD3, 0x21950B42, 0x53DC6909, 0xFFE70484, 0x28766127, 0xFF4CD0B2, 0x4FB7DB2B, 0xABDBE608 },
+	  { 0x5E1109E8, 0x837C9228, 0xF4645B5A, 0x26147D27, 0xF7818ED8, 0x4D78F592, 0xF247FA36, 0xD394077E } },
+	{ { 0x3B3F64C9, 0x508CEC1C, 0x1E5EDF3F, 0xE20BC0BA, 0x2F4318D4, 0xDA1DEB85, 0x5C3FA443, 0xD20EBE0D },
+	  { 0x73241EA3, 0x370B4EA7, 0x5E1A5F65, 0x61F1511C, 0x82681C62, 0x99A5E23D, 0xA2F54C2D, 0xD731E383 } },
+	{ { 0x546C4D8D, 0x97359638, 0x92F24679, 0x5F9C3FC4, 0xA8C8ACD9, 0x912E8BED, 0x306634B0, 0xEC3A318D },
+	  { 0xC31CB264, 0x80167F41, 0x522113F2, 0x3DB82F6F, 0xDCAFE197, 0xB155BCD2, 0x43465283, 0xFBA1DA59 } },
+	{ { 0xE7305683, 0x258BBBF9, 0x07EF5BE6, 0x31EEA5BF, 0x46C814C1, 0x0DEB0E4A, 0xA7B730DD, 0x5CEE8449 },
+	  { 0xA0182BDE, 0xEAB495C5, 0x9E27A6B4, 0xEE759F87, 0x80E518CA, 0xC2CF6A68, 0xF14CF3F4, 0x25E8013F } },
+	{ { 0x7ACACA28, 0x3EC832E7, 0xC7385B29, 0x1BFEEA57, 0xFD1EAF38, 0x068212E3, 0x6ACF8CCC, 0xC1329830 },
+	  { 0x2AAC9E59, 0xB909F2DB, 0xB661782A, 0x5748060D, 0xC79B7A01, 0xC5AB2632, 0x00017626, 0xDA44C6C6 } },
+	{ { 0x5C46AA8E, 0x69D44ED6, 0xA8D063D1, 0x2100D5D3, 0xA2D17C36, 0xCB9727EA, 0x8ADD53B7, 0x4C2BAB1B },
+	  { 0x15426704, 0xA084E90C, 0xA837EBEA, 0x778AFCD3, 0x7CE477F8, 0x6651F701, 0x46FB7A8B, 0xA0624998 } },
+	{ { 0x7F4C04CC, 0x3667EB1A, 0xA9404F84, 0x59556621, 0x7ECEB50A, 0x71CDF653, 0x9B8335FA, 0x994A44A6 },
+	  { 0xDBEB9B69, 0xD7FAF819, 0xEED4350D, 0x473C5680, 0xDA44BBA2, 0xB6658466, 0x872BDBF3, 0x0D1BC780 } },
+	{ { 0x9FF91FE5, 0xB8D3D931, 0xF0518EED, 0x039C4800, 0x9182CB26, 0x95C37632, 0x82FC568D, 0x0763A434 },
+	  { 0x383E76BA, 0x707C04D5, 0x824E8197, 0xAC98B930, 0x91230DE0, 0x92BF7C8F, 0x40959B70, 0x90876A01 } },
+};
+
+static int p256_is_zero(const uint32_t a[P256_LIMBS])
+{
+	uint32_t acc = 0;
+	int i;
+
+	for (i = 0; i < P256_LIMBS; i++)
+		acc |= a[i];
+	return acc == 0;
+}
+
+/** \brief Compares two integers.
+ * \return -1, 0 or 1 when a is less than, equal to or greater than b
+ */
+static int p256_cmp(const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS])
+{
+	int i;
+
+	for (i = P256_LIMBS - 1; i >= 0; i--) {
+		if (a[i] != b[i])
+			return a[i] > b[i] ? 1 : -1;
+	}
+	return 0;
+}
+
+//! r = a + b, returns the carry out
+static uint32_t p256_add_raw(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS])
+{
+	uint64_t c = 0;
+	int i;
+
+	for (i = 0; i < P256_LIMBS; i++) {
+		c += (uint64_t)a[i] + b[i];
+		r[i] = (uint32_t)c;
+		c >>= 32;
+	}
+	return (uint32_t)c;
+}
+
+//! r = a - b, returns the borrow out
+static uint32_t p256_sub_raw(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS])
+{
+	int64_t c = 0;
+	int i;
+
+	for (i = 0; i < P256_LIMBS; i++) {
+		c += (int64_t)a[i] - b[i];
+		r[i] = (uint32_t)c;
+		c >>= 32;
+	}
+	return (uint32_t)(c & 1);
+}
+
+//! r = a + b mod m, for a, b < m
+static void p256_mod_add(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS], const p256_modulus* m)
+{
+	if (p256_add_raw(r, a, b) || p256_cmp(r, m->m) >= 0)
+		p256_sub_raw(r, r, m->m);
+}
+
+//! r = a - b mod m, for a, b < m
+static void p256_mod_sub(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS], const p256_modulus* m)
+{
+	if (p256_sub_raw(r, a, b))
+		p256_add_raw(r, r, m->m);
+}
+
+/** \brief Montgomery multiplication r = a * b / 2^256 mod m (CIOS method). r may alias a or b.
+ */
+static void p256_mont_mul(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS], const p256_modulus* m)
+{
+	uint32_t t[P256_LIMBS + 2];
+	uint32_t u;
+	uint64_t c;
+	int i, j;
+
+	memset(t, 0, sizeof(t));
+	for (i = 0; i < P256_LIMBS; i++) {
+		c = 0;
+		for (j = 0; j < P256_LIMBS; j++) {
+			c += (uint64_t)a[j] * b[i] + t[j];
+			t[j] = (uint32_t)c;
+			c >>= 32;
+		}
+		c += t[P256_LIMBS];
+		t[P256_LIMBS] = (uint32_t)c;
+		t[P256_LIMBS + 1] = (uint32_t)(c >> 32);
+
+		u = t[0] * m->m0inv;
+		c = ((uint64_t)u * m->m[0] + t[0]) >> 32;
+		for (j = 1; j < P256_LIMBS; j++) {
+			c += (uint64_t)u * m->m[j] + t[j];
+			t[j - 1] = (uint32_t)c;
+			c >>= 32;
+		}
+		c += t[P256_LIMBS];
+		t[P256_LIMBS - 1] = (uint32_t)c;
+		t[P256_LIMBS] = t[P256_LIMBS + 1] + (uint32_t)(c >> 32);
+	}
+
+	if (t[P256_LIMBS] || p256_cmp(t, m->m) >= 0)
+		p256_sub_raw(t, t, m->m);
+	memcpy(r, t, P256_LIMBS * sizeof(uint32_t));
+}
+
+static void p256_fe_mul(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS])
+{
+	p256_mont_mul(r, a, b, &p256_p);
+}
+
+static void p256_fe_sqr(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS])
+{
+	p256_mont_mul(r, a, a, &p256_p);
+}
+
+static void p256_fe_add(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS])
+{
+	p256_mod_add(r, a, b, &p256_p);
+}
+
+static void p256_fe_sub(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t b[P256_LIMBS])
+{
+	p256_mod_sub(r, a, b, &p256_p);
+}
+
+//! Reads a 32 byte big-endian integer
+static void p256_from_bytes(uint32_t r[P256_LIMBS], const uint8_t bytes[P256_FIELD_SIZE])
+{
+	int i;
+
+	for (i = 0; i < P256_LIMBS; i++) {
+		const uint8_t* b = &bytes[P256_FIELD_SIZE - 4 * (i + 1)];
+		r[i] = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+	}
+}
+
+/** \brief r = a^exp mod m, with a and r in Montgomery form and exp plain.
+ */
+static void p256_mod_pow(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS], const uint32_t exp[P256_LIMBS], const p256_modulus* m)
+{
+	uint32_t pow[16][P256_LIMBS];   // a^0 .. a^15
+	uint32_t acc[P256_LIMBS];
+	uint32_t nibble;
+	int i, j;
+
+	// a^0 = 1 in Montgomery form is 2^256 mod m = 2^256 - m
+	memset(acc, 0, sizeof(acc));
+	p256_sub_raw(pow[0], acc, m->m);
+	memcpy(pow[1], a, sizeof(pow[1]));
+	for (i = 2; i < 16; i++)
+		p256_mont_mul(pow[i], pow[i - 1], a, m);
+
+	// Fixed 4-bit window, most significant nibble first
+	memcpy(acc, pow[0], sizeof(acc));
+	for (i = P256_LIMBS * 8 - 1; i >= 0; i--) {
+		for (j = 0; j < 4; j++)
+			p256_mont_mul(acc, acc, acc, m);
+		nibble = (exp[i / 8] >> (4 * (i % 8))) & 0xF;
+		if (nibble)
+			p256_mont_mul(acc, acc, pow[nibble], m);
+	}
+	memcpy(r, acc, sizeof(acc));
+}
+
+//! r = a^-1 mod n by Fermat's little theorem (a^(n-2))
+static void p256_scalar_inv(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS])
+{
+	static const uint32_t n_minus_2[P256_LIMBS] = {
+		0xFC63254F, 0xF3B9CAC2, 0xA7179E84, 0xBCE6FAAD, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF
+	};
+
+	p256_mod_pow(r, a, n_minus_2, &p256_n);
+}
+
+//! r = a^-1 mod p
+static void p256_fe_inv(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS])
+{
+	static const uint32_t p_minus_2[P256_LIMBS] = {
+		0xFFFFFFFD, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000, 0x00000001, 0xFFFFFFFF
+	};
+
+	p256_mod_pow(r, a, p_minus_2, &p256_p);
+}
+
+/** \brief r = sqrt(a) mod p as a^((p+1)/4), which works because p = 3 mod 4.
+ * \return 1 if a is a square, 0 otherwise
+ */
+static int p256_fe_sqrt(uint32_t r[P256_LIMBS], const uint32_t a[P256_LIMBS])
+{
+	static const uint32_t p_plus_1_div_4[P256_LIMBS] = {
+		0x00000000, 0x00000000, 0x40000000, 0x00000000, 0x00000000, 0x40000000, 0xC0000000, 0x3FFFFFFF
+	};
+	uint32_t t[P256_LIMBS];
+
+	p256_mod_pow(r, a, p_plus_1_div_4, &p256_p);
+	p256_fe_sqr(t, r);
+	return p256_cmp(t, a) == 0;
+}
+
+/** \brief Computes the width-w non-adjacent form of k.
+ * \param[out] naf  digits, least significant first; each is 0 or odd with |digit| < 2^(w-1)
+ * \param[in]  k    scalar
+ * \param[in]  w    window width
+ * \return number of digits
+ */
+static int p256_wnaf(int8_t naf[P256_NAF_SIZE], const uint32_t k[P256_LIMBS], int w)
+{
+	uint32_t d[P256_LIMBS + 1];
+	uint64_t c;
+	int32_t digit;
+	int len = 0;
+	int i;
+
+	memcpy(d, k, P256_LIMBS * sizeof(uint32_t));
+	d[P256_LIMBS] = 0;
+	memset(naf, 0, P256_NAF_SIZE);
+
+	while (!p256_is_zero(d) || d[P256_LIMBS]) {
+		if (d[0] & 1) {
+			digit = (int32_t)(d[0] & ((1u << w) - 1));
+			if (digit >= (1 << (w - 1)))
+				digit -= 1 << w;
+			naf[len] = (int8_t)digit;
+
+			// d -= digit, which clears the low w bits
+			if (digit > 0) {
+				c = (uint64_t)d[0] - (uint32_t)digit;
+				d[0] = (uint32_t)c;
+				for (i = 1; i <= P256_LIMBS && (c >> 63); i++) {
+					c = (uint64_t)d[i] - 1;
+					d[i] = (uint32_t)c;
+				}
+			}else  {
+				c = (uint64_t)d[0] + (uint32_t)(-digit);
+				d[0] = (uint32_t)c;
+				for (i = 1; i <= P256_LIMBS && (c >> 32); i++) {
+					c = (uint64_t)d[i] + 1;
+					d[i] = (uint32_t)c;
+				}
+			}
+		}
+		for (i = 0; i < P256_LIMBS; i++)
+			d[i] = (d[i] >> 1) | (d[i + 1] << 31);
+		d[P256_LIMBS] >>= 1;
+		len++;
+	}
+
+	return len;
+}
+
+/** \brief r = 2 * a, using the a = -3 doubling formulas (dbl-2001-b). r may alias a.
+ */
+static void p256_point_double(p256_jacobian* r, const p256_jacobian* a)
+{
+	uint32_t delta[P256_LIMBS], gamma[P256_LIMBS], beta[P256_LIMBS], alpha[P256_LIMBS];
+	uint32_t t1[P256_LIMBS], t2[P256_LIMBS];
+
+	if (p256_is_zero(a->z)) {
+		memcpy(r, a, sizeof(*r));
+		return;
+	}
+
+	p256_fe_sqr(delta, a->z);
+	p256_fe_sqr(gamma, a->y);
+	p256_fe_mul(beta, a->x, gamma);
+
+	// alpha = 3 * (X - delta) * (X + delta)
+	p256_fe_sub(t1, a->x, delta);
+	p256_fe_add(t2, a->x, delta);
+	p256_fe_mul(alpha, t1, t2);
+	p256_fe_add(t1, alpha, alpha);
+	p256_fe_add(alpha, t1, alpha);
+
+	// Z3 = (Y + Z)^2 - gamma - delta
+	p256_fe_add(t1, a->y, a->z);
+	p256_fe_sqr(t1, t1);
+	p256_fe_sub(t1, t1, gamma);
+	p256_fe_sub(r->z, t1, delta);
+
+	// X3 = alpha^2 - 8 * beta
+	p256_fe_add(beta, beta, beta);
+	p256_fe_add(beta, beta, beta);  // 4 * beta
+	p256_fe_add(t2, beta, beta);    // 8 * beta
+	p256_fe_sqr(t1, alpha);
+	p256_fe_sub(r->x, t1, t2);
+
+	// Y3 = alpha * (4 * beta - X3) - 8 * gamma^2
+	p256_fe_sub(t1, beta, r->x);
+	p256_fe_mul(t1, alpha, t1);
+	p256_fe_sqr(gamma, gamma);
+	p256_fe_add(gamma, gamma, gamma);
+	p256_fe_add(gamma, gamma, gamma);
+	p256_fe_add(gamma, gamma, gamma);
+	p256_fe_sub(r->y, t1, gamma);
+}
+
+/** \brief r = a + b where b is affine (madd-2007-bl). negate_b adds -b instead. r may alias a.
+ */
+static void p256_point_add_affine(p256_jacobian* r, const p256_jacobian* a, const p256_affine* b, int negate_b)
+{
+	uint32_t z1z1[P256_LIMBS], u2[P256_LIMBS], s2[P256_LIMBS], h[P256_LIMBS], hh[P256_LIMBS];
+	uint32_t i4[P256_LIMBS], j[P256_LIMBS], rr[P256_LIMBS], v[P256_LIMBS], t[P256_LIMBS];
+	p256_jacobian out;
+
+	if (p256_is_zero(a->z)) {
+		memcpy(r->x, b->x, sizeof(r->x));
+		if (negate_b)
+			p256_fe_sub(r->y, p256_p.m, b->y);
+		else
+			memcpy(r->y, b->y, sizeof(r->y));
+		memcpy(r->z, p256_one, sizeof(r->z));
+		return;
+	}
+
+	p256_fe_sqr(z1z1, a->z);
+	p256_fe_mul(u2, b->x, z1z1);
+	p256_fe_mul(s2, b->y, a->z);
+	p256_fe_mul(s2, s2, z1z1);
+	if (negate_b)
+		p256_fe_sub(s2, p256_p.m, s2);
+	p256_fe_sub(h, u2, a->x);
+	p256_fe_sub(rr, s2, a->y);
+
+	if (p256_is_zero(h)) {
+		if (p256_is_zero(rr)) {
+			p256_point_double(r, a);
+		}else  {
+			memset(r, 0, sizeof(*r));
+		}
+		return;
+	}
+
+	p256_fe_sqr(hh, h);
+	p256_fe_add(i4, hh, hh);
+	p256_fe_add(i4, i4, i4);
+	p256_fe_mul(j, h, i4);
+	p256_fe_add(rr, rr, rr);
+	p256_fe_mul(v, a->x, i4);
+
+	// X3 = r^2 - J - 2 * V
+	p256_fe_sqr(t, rr);
+	p256_fe_sub(t, t, j);
+	p256_fe_sub(t, t, v);
+	p256_fe_sub(out.x, t, v);
+
+	// Y3 = r * (V - X3) - 2 * Y1 * J
+	p256_fe_sub(t, v, out.x);
+	p256_fe_mul(t, rr, t);
+	p256_fe_mul(j, a->y, j);
+	p256_fe_add(j, j, j);
+	p256_fe_sub(out.y, t, j);
+
+	// Z3 = (Z1 + H)^2 - Z1Z1 - HH
+	p256_fe_add(t, a->z, h);
+	p256_fe_sqr(t, t);
+	p256_fe_sub(t, t, z1z1);
+	p256_fe_sub(out.z, t, hh);
+
+	memcpy(r, &out, sizeof(out));
+}
+
+/** \brief r = a + b, both Jacobian (add-2007-bl). negate_b adds -b instead. r may alias a.
+ */
+static void p256_point_add(p256_jacobian* r, const p256_jacobian* a, const p256_jacobian* b, int negate_b)
+{
+	uint32_t z1z1[P256_LIMBS], z2z2[P256_LIMBS], u1[P256_LIMBS], u2[P256_LIMBS], s1[P256_LIMBS], s2[P256_LIMBS];
+	uint32_t h[P256_LIMBS], i4[P256_LIMBS], j[P256_LIMBS], rr[P256_LIMBS], v[P256_LIMBS], t[P256_LIMBS];
+	p256_jacobian out;
+
+	if (p256_is_zero(b->z))
+		return;
+	if (p256_is_zero(a->z)) {
+		memcpy(r, b, sizeof(*r));
+		if (negate_b)
+			p256_fe_sub(r->y, p256_p.m, b->y);
+		return;
+	}
+
+	p256_fe_sqr(z1z1, a->z);
+	p256_fe_sqr(z2z2, b->z);
+	p256_fe_mul(u1, a->x, z2z2);
+	p256_fe_mul(u2, b->x, z1z1);
+	p256_fe_mul(s1, a->y, b->z);
+	p256_fe_mul(s1, s1, z2z2);
+	p256_fe_mul(s2, b->y, a->z);
+	p256_fe_mul(s2, s2, z1z1);
+	if (negate_b)
+		p256_fe_sub(s2, p256_p.m, s2);
+	p256_fe_sub(h, u2, u1);
+	p256_fe_sub(rr, s2, s1);
+
+	if (p256_is_zero(h)) {
+		if (p256_is_zero(rr)) {
+			p256_point_double(r, a);
+		}else  {
+			memset(r, 0, sizeof(*r));
+		}
+		return;
+	}
+
+	p256_fe_add(i4, h, h);
+	p256_fe_sqr(i4, i4);
+	p256_fe_mul(j, h, i4);
+	p256_fe_add(rr, rr, rr);
+	p256_fe_mul(v, u1, i4);
+
+	// Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2) * H
+	p256_fe_add(t, a->z, b->z);
+	p256_fe_sqr(t, t);
+	p256_fe_sub(t, t, z1z1);
+	p256_fe_sub(t, t, z2z2);
+	p256_fe_mul(out.z, t, h);
+
+	// X3 = r^2 - J - 2 * V
+	p256_fe_sqr(t, rr);
+	p256_fe_sub(t, t, j);
+	p256_fe_sub(t, t, v);
+	p256_fe_sub(out.x, t, v);
+
+	// Y3 = r * (V - X3) - 2 * S1 * J
+	p256_fe_sub(t, v, out.x);
+	p256_fe_mul(t, rr, t);
+	p256_fe_mul(s1, s1, j);
+	p256_fe_add(s1, s1, s1);
+	p256_fe_sub(out.y, t, s1);
+
+	memcpy(r, &out, sizeof(out));
+}
+
+//! r = x^3 - 3x + b, the square of y for a point on the curve
+static void p256_curve_rhs(uint32_t r[P256_LIMBS], const uint32_t x[P256_LIMBS])
+{
+	uint32_t t[P256_LIMBS];
+
+	p256_fe_sqr(r, x);
+	p256_fe_mul(r, r, x);
+	p256_fe_add(t, x, x);
+	p256_fe_add(t, t, x);
+	p256_fe_sub(r, r, t);
+	p256_fe_add(r, r, p256_b);
+}
+
+/** \brief Loads a public key and checks it is a valid point on the curve.
+ * \return 1 if the point is valid, 0 otherwise
+ */
+static int p256_load_public_key(p256_affine* q, const uint8_t public_key[P256_PUBLIC_KEY_SIZE])
+{
+	uint32_t lhs[P256_LIMBS], rhs[P256_LIMBS];
+
+	p256_from_bytes(q->x, public_key);
+	p256_from_bytes(q->y, public_key + P256_FIELD_SIZE);
+	if (p256_cmp(q->x, p256_p.m) >= 0 || p256_cmp(q->y, p256_p.m) >= 0)
+		return 0;
+	p256_fe_mul(q->x, q->x, p256_p.rr);
+	p256_fe_mul(q->y, q->y, p256_p.rr);
+
+	// y^2 == x^3 - 3x + b
+	p256_fe_sqr(lhs, q->y);
+	p256_curve_rhs(rhs, q->x);
+
+	return p256_cmp(lhs, rhs) == 0;
+}
+
+//! Odd multiples P, 3P, ..., 15P, for the wNAF digits of a P256_Q_WINDOW recoding
+static void p256_odd_multiples(p256_jacobian table[P256_Q_TABLE], const p256_affine* p)
+{
+	p256_jacobian p2;
+	int i;
+
+	memcpy(table[0].x, p->x, sizeof(p->x));
+	memcpy(table[0].y, p->y, sizeof(p->y));
+	memcpy(table[0].z, p256_one, sizeof(p256_one));
+	p256_point_double(&p2, &table[0]);
+	for (i = 1; i < P256_Q_TABLE; i++)
+		p256_point_add(&table[i], &table[i - 1], &p2, 0);
+}
+
+//! acc += digit * P, from the odd multiples of P
+static void p256_naf_add(p256_jacobian* acc, const p256_jacobian table[P256_Q_TABLE], int8_t digit)
+{
+	if (digit > 0)
+		p256_point_add(acc, acc, &table[digit / 2], 0);
+	else if (digit < 0)
+		p256_point_add(acc, acc, &table[-digit / 2], 1);
+}
+
+/** \brief Checks that a public key is a valid point on the curve.
+ * \param[in] public_key  X and Y of the public key, big-endian
+ * \return 1 if the point is valid, 0 otherwise
+ */
+int sw_p256_public_key_valid(const uint8_t public_key[P256_PUBLIC_KEY_SIZE])
+{
+	p256_affine q;
+
+	return p256_load_public_key(&q, public_key);
+}
+
+/** \brief Checks r and s and computes u1 = e / s and u2 = r / s mod n for a signature.
+ * \param[out] u1         e / s mod n, plain form
+ * \param[out] u2         r / s mod n, plain form
+ * \param[out] r          R from the signature
+ * \return 1 if r and s are in range, 0 otherwise
+ */
+static int p256_ecdsa_scalars(uint32_t u1[P256_LIMBS], uint32_t u2[P256_LIMBS], uint32_t r[P256_LIMBS],
+                              const uint8_t digest[P256_FIELD_SIZE], const uint8_t signature[P256_SIGNATURE_SIZE])
+{
+	uint32_t s[P256_LIMBS], e[P256_LIMBS], w[P256_LIMBS];
+
+	// 1 <= r, s < n
+	p256_from_bytes(r, signature);
+	p256_from_bytes(s, signature + P256_FIELD_SIZE);
+	if (p256_is_zero(r) || p256_is_zero(s) || p256_cmp(r, p256_n.m) >= 0 || p256_cmp(s, p256_n.m) >= 0)
+		return 0;
+
+	// e = digest mod n, digest < 2^256 < 2n so one subtraction is enough
+	p256_from_bytes(e, digest);
+	if (p256_cmp(e, p256_n.m) >= 0)
+		p256_sub_raw(e, e, p256_n.m);
+
+	// w = s^-1 (Montgomery form), u1 = e * w, u2 = r * w (plain form)
+	p256_mont_mul(w, s, p256_n.rr, &p256_n);
+	p256_scalar_inv(w, w);
+	p256_mont_mul(u1, e, w, &p256_n);
+	p256_mont_mul(u2, r, w, &p256_n);
+
+	return 1;
+}
+
+/** \brief Checks x(acc) mod n == r.
+ *
+ * Rather than converting to affine, check X == r * Z^2 mod p, and X == (r + n) * Z^2 too when
+ * r + n < p.
+ *
+ * \return 1 if the signature is valid, 0 otherwise
+ */
+static int p256_ecdsa_check_r(const p256_jacobian* acc, uint32_t r[P256_LIMBS])
+{
+	uint32_t t[P256_LIMBS], z2[P256_LIMBS];
+
+	if (p256_is_zero(acc->z))
+		return 0;
+
+	p256_fe_sqr(z2, acc->z);
+	p256_fe_mul(t, r, p256_p.rr);
+	p256_fe_mul(t, t, z2);
+	if (p256_cmp(t, acc->x) == 0)
+		return 1;
+
+	if (!p256_add_raw(r, r, p256_n.m) && p256_cmp(r, p256_p.m) < 0) {
+		p256_fe_mul(t, r, p256_p.rr);
+		p256_fe_mul(t, t, z2);
+		if (p256_cmp(t, acc->x) == 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+/** \brief Verifies an ECDSA P-256 signature.
+ *
+ * Computes u1 * G + u2 * Q with Shamir's trick: both scalars are recoded in wNAF and share a
+ * single chain of doublings. G uses the precomputed affine table of odd multiples, Q gets a
+ * smaller table of odd multiples built on the fly.
+ *
+ * \param[in] digest      message digest, big-endian
+ * \param[in] signature   R and S, big-endian
+ * \param[in] public_key  X and Y of the signer's public key, big-endian
+ * \return 1 if the signature is valid, 0 otherwise
+ */
+int sw_p256_ecdsa_verify(const uint8_t digest[P256_FIELD_SIZE],
+                         const uint8_t signature[P256_SIGNATURE_SIZE],
+                         const uint8_t public_key[P256_PUBLIC_KEY_SIZE])
+{
+	uint32_t r[P256_LIMBS], u1[P256_LIMBS], u2[P256_LIMBS];
+	int8_t naf1[P256_NAF_SIZE], naf2[P256_NAF_SIZE];
+	p256_jacobian q_table[P256_Q_TABLE];
+	p256_jacobian acc;
+	p256_affine q;
+	int len1, len2, i;
+
+	if (!p256_ecdsa_scalars(u1, u2, r, digest, signature))
+		return 0;
+
+	if (!p256_load_public_key(&q, public_key))
+		return 0;
+
+	len1 = p256_wnaf(naf1, u1, P256_G_WINDOW);
+	len2 = p256_wnaf(naf2, u2, P256_Q_WINDOW);
+
+	p256_odd_multiples(q_table, &q);
+
+	memset(&acc, 0, sizeof(acc));
+	for (i = (len1 > len2 ? len1 : len2) - 1; i >= 0; i--) {
+		p256_point_double(&acc, &acc);
+		if (naf1[i] > 0)
+			p256_point_add_affine(&acc, &acc, &p256_g_table[naf1[i] / 2], 0);
+		else if (naf1[i] < 0)
+			p256_point_add_affine(&acc, &acc, &p256_g_table[-naf1[i] / 2], 1);
+		p256_naf_add(&acc, q_table, naf2[i]);
+	}
+
+	return p256_ecdsa_check_r(&acc, r);
+}
+
+/*
+ * Fixed-base tables. For a point P, window i holds j * 2^(7i) * P for j = 1 .. 64, affine and in
+ * Montgomery form. A scalar recoded into signed 7-bit digits d_i in [-63, 64] is then
+ * sum(d_i * 2^(7i) * P): one mixed addition per non-zero digit and no doublings at all. A
+ * table is 37 * 64 points, about 150 KB, so they are only worth building for keys that verify
+ * many signatures (a root CA, an intermediate signer).
+ */
+struct p256_precomp {
+	p256_affine table[P256_COMB_WINDOWS][P256_COMB_POINTS];
+};
+
+/** \brief Recodes k into P256_COMB_WINDOWS signed digits, least significant first, so that
+ *         k = sum(digits[i] * 2^(P256_COMB_WINDOW * i)) with each digit in [-63, 64].
+ */
+static void p256_comb_recode(int8_t digits[P256_COMB_WINDOWS], const uint32_t k[P256_LIMBS])
+{
+	uint32_t bits;
+	int carry = 0;
+	int bit, limb, shift;
+	int i;
+
+	for (i = 0; i < P256_COMB_WINDOWS; i++) {
+		bit = i * P256_COMB_WINDOW;
+		limb = bit / 32;
+		shift = bit % 32;
+		bits = k[limb] >> shift;
+		if (shift > 32 - P256_COMB_WINDOW && limb + 1 < P256_LIMBS)
+			bits |= k[limb + 1] << (32 - shift);
+		bits = (bits & ((1u << P256_COMB_WINDOW) - 1)) + carry;
+
+		// The top window only holds 4 bits, so it never carries out
+		carry = bits > P256_COMB_POINTS;
+		digits[i] = (int8_t)(carry ? (int)bits - (1 << P256_COMB_WINDOW) : (int)bits);
+	}
+}
+
+/** \brief Builds the fixed-base table for a public key, or for the generator.
+ *
+ * The multiples are computed in Jacobian coordinates and then moved to affine all together,
+ * sharing a single field inversion (Montgomery's trick).
+ *
+ * \param[in] public_key  X and Y of the public key, big-endian. NULL for the generator G.
+ * \return the table, or NULL if the key is not a valid point or memory ran out. Release it
+ *         with sw_p256_precomp_free().
+ */
+p256_precomp* sw_p256_precomp_new(const uint8_t public_key[P256_PUBLIC_KEY_SIZE])
+{
+	const int count = P256_COMB_WINDOWS * P256_COMB_POINTS;
+	p256_precomp* precomp = NULL;
+	p256_jacobian* jac = NULL;
+	uint32_t (*prod)[P256_LIMBS] = NULL;
+	uint32_t inv[P256_LIMBS], zinv[P256_LIMBS], zinv2[P256_LIMBS];
+	p256_affine base;
+	p256_affine* out;
+	p256_jacobian* row;
+	int i, j;
+
+	if (public_key == NULL)
+		memcpy(&base, &p256_g_table[0], sizeof(base));
+	else if (!p256_load_public_key(&base, public_key))
+		return NULL;
+
+	precomp = (p256_precomp*)malloc(sizeof(*precomp));
+	jac = (p256_jacobian*)malloc(count * sizeof(*jac));
+	prod = malloc(count * sizeof(*prod));
+	if (precomp == NULL || jac == NULL || prod == NULL) {
+		free(precomp);
+		precomp = NULL;
+		goto done;
+	}
+
+	// Row i holds 1..64 times B_i = 2^(7i) * P, and B_(i+1) = 2 * (64 * B_i)
+	for (i = 0; i < P256_COMB_WINDOWS; i++) {
+		row = &jac[i * P256_COMB_POINTS];
+		if (i == 0) {
+			memcpy(row[0].x, base.x, sizeof(base.x));
+			memcpy(row[0].y, base.y, sizeof(base.y));
+			memcpy(row[0].z, p256_one, sizeof(p256_one));
+		}else  {
+			p256_point_double(&row[0], &row[-1]);
+		}
+		p256_point_double(&row[1], &row[0]);
+		for (j = 2; j < P256_COMB_POINTS; j++)
+			p256_point_add(&row[j], &row[j - 1], &row[0], 0);
+	}
+
+	// None of the multiples is the point at infinity as n is prime, so every Z is invertible
+	memcpy(prod[0], jac[0].z, sizeof(prod[0]));
+	for (i = 1; i < count; i++)
+		p256_fe_mul(prod[i], prod[i - 1], jac[i].z);
+	p256_fe_inv(inv, prod[count - 1]);
+
+	for (i = count - 1; i >= 0; i--) {
+		if (i > 0) {
+			p256_fe_mul(zinv, inv, prod[i - 1]);
+			p256_fe_mul(inv, inv, jac[i].z);
+		}else  {
+			memcpy(zinv, inv, sizeof(zinv));
+		}
+		out = &precomp->table[i / P256_COMB_POINTS][i % P256_COMB_POINTS];
+		p256_fe_sqr(zinv2, zinv);
+		p256_fe_mul(out->x, jac[i].x, zinv2);
+		p256_fe_mul(zinv2, zinv2, zinv);
+		p256_fe_mul(out->y, jac[i].y, zinv2);
+	}
+
+done:
+	free(jac);
+	free(prod);
+	return precomp;
+}
+
+/** \brief Releases a table from sw_p256_precomp_new(). NULL is ignored.
+ */
+void sw_p256_precomp_free(p256_precomp* precomp)
+{
+	free(precomp);
+}
+
+//! acc += digit * 2^(7 * window) * P, from the table of P
+static void p256_comb_add(p256_jacobian* acc, const p256_precomp* precomp, int window, int8_t digit)
+{
+	if (digit > 0)
+		p256_point_add_affine(acc, acc, &precomp->table[window][digit - 1], 0);
+	else if (digit < 0)
+		p256_point_add_affine(acc, acc, &precomp->table[window][-digit - 1], 1);
+}
+
+/** \brief Verifies an ECDSA P-256 signature with fixed-base tables for both G and the public key.
+ *
+ * Same result as sw_p256_ecdsa_verify(), but u1 * G + u2 * Q costs at most 74 mixed additions
+ * instead of 256 doublings plus the additions. The public key was already checked when its table
+ * was built.
+ *
+ * \param[in] digest      message digest, big-endian
+ * \param[in] signature   R and S, big-endian
+ * \param[in] g_precomp   table of the generator, from sw_p256_precomp_new(NULL)
+ * \param[in] q_precomp   table of the signer's public key
+ * \return 1 if the signature is valid, 0 otherwise
+ */
+int sw_p256_ecdsa_verify_precomp(const uint8_t digest[P256_FIELD_SIZE],
+                                 const uint8_t signature[P256_SIGNATURE_SIZE],
+                                 const p256_precomp* g_precomp,
+                                 const p256_precomp* q_precomp)
+{
+	uint32_t r[P256_LIMBS], u1[P256_LIMBS], u2[P256_LIMBS];
+	int8_t digits1[P256_COMB_WINDOWS], digits2[P256_COMB_WINDOWS];
+	p256_jacobian acc;
+	int i;
+
+	if (g_precomp == NULL || q_precomp == NULL)
+		return 0;
+
+	if (!p256_ecdsa_scalars(u1, u2, r, digest, signature))
+		return 0;
+
+	p256_comb_recode(digits1, u1);
+	p256_comb_recode(digits2, u2);
+
+	memset(&acc, 0, sizeof(acc));
+	for (i = 0; i < P256_COMB_WINDOWS; i++) {
+		p256_comb_add(&acc, g_precomp, i, digits1[i]);
+		p256_comb_add(&acc, q_precomp, i, digits2[i]);
+	}
+
+	return p256_ecdsa_check_r(&acc, r);
+}
+
+/*
+ * Batch verification. A valid signature has u1 * G + u2 * Q = R with x(R) = r, so for random
+ * multipliers z_i a batch of valid signatures satisfies
+ *
+ *     (sum z_i * u1_i) * G + sum over keys Q of (sum z_i * u2_i) * Q = sum z_i * R_i
+ *
+ * The left side is a single multi-scalar multiplication sharing one chain of doublings, and
+ * signatures by the same key share their Q term. R_i is recovered from r_i only up to its sign,
+ * so the right side is searched over the sign patterns, comparing x coordinates so that one sign
+ * is free: 2^(count - 1) point additions, which is what bounds P256_BATCH_MAX. An invalid
+ * signature passes only if some pattern happens to cancel its error, with probability about
+ * 2^(count - 1) / 2^127 for the 127-bit multipliers.
+ */
+
+/** \brief Reads the multiplier of signature i, odd so it is never 0. Scaling the whole equation
+ *         does not change it, so the first multiplier can be 1 and R_0 needs no multiplication.
+ */
+static void p256_batch_multiplier(uint32_t z[P256_LIMBS], const uint8_t multipliers[][P256_BATCH_MULTIPLIER_SIZE], size_t i)
+{
+	uint8_t padded[P256_FIELD_SIZE];
+
+	memset(padded, 0, sizeof(padded));
+	if (i == 0)
+		padded[sizeof(padded) - 1] = 1;
+	else
+		memcpy(&padded[sizeof(padded) - P256_BATCH_MULTIPLIER_SIZE], multipliers[i], P256_BATCH_MULTIPLIER_SIZE);
+	p256_from_bytes(z, padded);
+	z[0] |= 1;
+}
+
+//! r = k * P, for a short k
+static void p256_point_mul(p256_jacobian* r, const p256_affine* p, const uint32_t k[P256_LIMBS])
+{
+	p256_jacobian table[P256_Q_TABLE];
+	int8_t naf[P256_NAF_SIZE];
+	int len, i;
+
+	len = p256_wnaf(naf, k, P256_Q_WINDOW);
+	p256_odd_multiples(table, p);
+	memset(r, 0, sizeof(*r));
+	for (i = len - 1; i >= 0; i--) {
+		p256_point_double(r, r);
+		p256_naf_add(r, table, naf[i]);
+	}
+}
+
+/** \brief Verifies up to P256_BATCH_MAX ECDSA P-256 signatures at once.
+ *
+ * A pass means every signature is valid. A failure only means at least one of them may not be:
+ * a valid signature whose R has x = r + n (a 2^-128 chance) also fails the batch, so callers
+ * should settle failures with sw_p256_ecdsa_verify() on smaller groups.
+ *
+ * \param[in] count        number of signatures, 1 to P256_BATCH_MAX
+ * \param[in] digests      message digests, big-endian
+ * \param[in] signatures   R and S of each signature, big-endian
+ * \param[in] public_keys  X and Y of each signer's public key, big-endian. Signatures by the
+ *                         same key are cheaper than signatures by different keys.
+ * \param[in] multipliers  fresh random bytes for each signature, unknown to the signers. The
+ *                         first entry is not used.
+ * \return 1 if all signatures are valid, 0 otherwise
+ */
+int sw_p256_ecdsa_verify_batch(size_t count,
+                               const uint8_t* const digests[],
+                               const uint8_t* const signatures[],
+                               const uint8_t* const public_keys[],
+                               const uint8_t multipliers[][P256_BATCH_MULTIPLIER_SIZE])
+{
+	uint32_t r[P256_BATCH_MAX][P256_LIMBS], e[P256_BATCH_MAX][P256_LIMBS], w[P256_BATCH_MAX][P256_LIMBS];
+	uint32_t prod[P256_BATCH_MAX][P256_LIMBS], u2_sum[P256_BATCH_MAX][P256_LIMBS];
+	uint32_t u1_sum[P256_LIMBS], s[P256_LIMBS], z[P256_LIMBS], t[P256_LIMBS], inv[P256_LIMBS];
+	uint32_t zt2[P256_LIMBS], zs2[P256_LIMBS];
+	int8_t naf_g[P256_NAF_SIZE], naf_q[P256_BATCH_MAX][P256_NAF_SIZE];
+	p256_jacobian q_table[P256_BATCH_MAX][P256_Q_TABLE];
+	p256_jacobian zr[P256_BATCH_MAX], zr2[P256_BATCH_MAX];
+	p256_jacobian lhs, rhs;
+	p256_affine q, rpt;
+	size_t key_first[P256_BATCH_MAX];
+	size_t key_index[P256_BATCH_MAX];
+	uint8_t negated[P256_BATCH_MAX];
+	size_t keys = 0;
+	size_t i, j;
+	unsigned k;
+	int len, len_max;
+
+	if (count == 0 || count > P256_BATCH_MAX)
+		return 0;
+
+	for (i = 0; i < count; i++) {
+		// 1 <= r, s < n, as in sw_p256_ecdsa_verify()
+		p256_from_bytes(r[i], signatures[i]);
+		p256_from_bytes(s, signatures[i] + P256_FIELD_SIZE);
+		if (p256_is_zero(r[i]) || p256_is_zero(s) || p256_cmp(r[i], p256_n.m) >= 0 || p256_cmp(s, p256_n.m) >= 0)
+			return 0;
+		p256_mont_mul(w[i], s, p256_n.rr, &p256_n);
+
+		p256_from_bytes(e[i], digests[i]);
+		if (p256_cmp(e[i], p256_n.m) >= 0)
+			p256_sub_raw(e[i], e[i], p256_n.m);
+
+		for (j = 0; j < keys; j++) {
+			if (public_keys[key_first[j]] == public_keys[i]
+			    || memcmp(public_keys[key_first[j]], public_keys[i], P256_PUBLIC_KEY_SIZE) == 0)
+				break;
+		}
+		if (j == keys) {
+			if (!p256_load_public_key(&q, public_keys[i]))
+				return 0;
+			p256_odd_multiples(q_table[keys], &q);
+			memset(u2_sum[keys], 0, sizeof(u2_sum[keys]));
+			key_first[keys++] = i;
+		}
+		key_index[i] = j;
+
+		// R with x = r and either y, then z * R
+		p256_fe_mul(rpt.x, r[i], p256_p.rr);
+		p256_curve_rhs(t, rpt.x);
+		if (!p256_fe_sqrt(rpt.y, t))
+			return 0;
+		if (i == 0) {
+			memcpy(zr[i].x, rpt.x, sizeof(rpt.x));
+			memcpy(zr[i].y, rpt.y, sizeof(rpt.y));
+			memcpy(zr[i].z, p256_one, sizeof(p256_one));
+		}else  {
+			p256_batch_multiplier(z, multipliers, i);
+			p256_point_mul(&zr[i], &rpt, z);
+		}
+		p256_point_double(&zr2[i], &zr[i]);
+	}
+
+	// All the s^-1 for the price of one inversion (Montgomery's trick)
+	memcpy(prod[0], w[0], sizeof(prod[0]));
+	for (i = 1; i < count; i++)
+		p256_mont_mul(prod[i], prod[i - 1], w[i], &p256_n);
+	p256_scalar_inv(inv, prod[count - 1]);
+	for (i = count - 1; i > 0; i--) {
+		p256_mont_mul(t, inv, prod[i - 1], &p256_n);
+		p256_mont_mul(inv, inv, w[i], &p256_n);
+		memcpy(w[i], t, sizeof(t));
+	}
+	memcpy(w[0], inv, sizeof(inv));
+
+	// u1_sum = sum z * e / s, and per key u2_sum = sum z * r / s, all plain form
+	memset(u1_sum, 0, sizeof(u1_sum));
+	for (i = 0; i < count; i++) {
+		p256_batch_multiplier(z, multipliers, i);
+		p256_mont_mul(z, z, p256_n.rr, &p256_n);
+		p256_mont_mul(t, e[i], w[i], &p256_n);
+		p256_mont_mul(t, t, z, &p256_n);
+		p256_mod_add(u1_sum, u1_sum, t, &p256_n);
+		p256_mont_mul(t, r[i], w[i], &p256_n);
+		p256_mont_mul(t, t, z, &p256_n);
+		p256_mod_add(u2_sum[key_index[i]], u2_sum[key_index[i]], t, &p256_n);
+	}
+
+	len_max = p256_wnaf(naf_g, u1_sum, P256_G_WINDOW);
+	for (j = 0; j < keys; j++) {
+		len = p256_wnaf(naf_q[j], u2_sum[j], P256_Q_WINDOW);
+		if (len > len_max)
+			len_max = len;
+	}
+
+	memset(&lhs, 0, sizeof(lhs));
+	for (len = len_max - 1; len >= 0; len--) {
+		p256_point_double(&lhs, &lhs);
+		if (naf_g[len] > 0)
+			p256_point_add_affine(&lhs, &lhs, &p256_g_table[naf_g[len] / 2], 0);
+		else if (naf_g[len] < 0)
+			p256_point_add_affine(&lhs, &lhs, &p256_g_table[-naf_g[len] / 2], 1);
+		for (j = 0; j < keys; j++)
+			p256_naf_add(&lhs, q_table[j], naf_q[j][len]);
+	}
+	if (p256_is_zero(lhs.z))
+		return 0;
+	p256_fe_sqr(zt2, lhs.z);
+
+	// Walk the sign patterns of R_1 .. R_(count-1) in Gray code order, one addition per step
+	memcpy(&rhs, &zr[0], sizeof(rhs));
+	for (i = 1; i < count; i++)
+		p256_point_add(&rhs, &rhs, &zr[i], 0);
+	memset(negated, 0, sizeof(negated));
+	for (k = 1;; k++) {
+		if (!p256_is_zero(rhs.z)) {
+			// x(lhs) == x(rhs): X1 * Z2^2 == X2 * Z1^2
+			p256_fe_sqr(zs2, rhs.z);
+			p256_fe_mul(zs2, zs2, lhs.x);
+			p256_fe_mul(t, rhs.x, zt2);
+			if (p256_cmp(t, zs2) == 0)
+				return 1;
+		}
+		if (k >= (1u << (count - 1)))
+			break;
+
+		for (i = 1; !(k & (1u << (i - 1))); i++)
+			;
+		p256_point_add(&rhs, &rhs, &zr2[i], !negated[i]);
+		negated[i] ^= 1;
+	}
+
+	return 0;
+}
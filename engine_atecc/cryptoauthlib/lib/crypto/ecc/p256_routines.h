@@ -0,0 +1,84 @@
+/** \brief Software implementation of ECDSA verification on the NIST P-256 curve.
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#ifndef P256_ROUTINES_H
+#define P256_ROUTINES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define P256_FIELD_SIZE      (32)
+#define P256_PUBLIC_KEY_SIZE (P256_FIELD_SIZE * 2)
+#define P256_SIGNATURE_SIZE  (P256_FIELD_SIZE * 2)
+
+#define P256_BATCH_MAX              (8)     //!< Most signatures sw_p256_ecdsa_verify_batch() takes at once
+#define P256_BATCH_MULTIPLIER_SIZE  (16)    //!< Random bytes per signature in a batch
+
+//! Fixed-base multiplication table for one point, see sw_p256_precomp_new()
+typedef struct p256_precomp p256_precomp;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int sw_p256_ecdsa_verify(const uint8_t digest[P256_FIELD_SIZE],
+                         const uint8_t signature[P256_SIGNATURE_SIZE],
+                         const uint8_t public_key[P256_PUBLIC_KEY_SIZE]);
+
+int sw_p256_public_key_valid(const uint8_t public_key[P256_PUBLIC_KEY_SIZE]);
+
+p256_precomp* sw_p256_precomp_new(const uint8_t public_key[P256_PUBLIC_KEY_SIZE]);
+void sw_p256_precomp_free(p256_precomp* precomp);
+
+int sw_p256_ecdsa_verify_precomp(const uint8_t digest[P256_FIELD_SIZE],
+                                 const uint8_t signature[P256_SIGNATURE_SIZE],
+                                 const p256_precomp* g_precomp,
+                                 const p256_precomp* q_precomp);
+
+int sw_p256_ecdsa_verify_batch(size_t count,
+                               const uint8_t* const digests[],
+                               const uint8_t* const signatures[],
+                               const uint8_t* const public_keys[],
+                               const uint8_t multipliers[][P256_BATCH_MULTIPLIER_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // P256_ROUTINES_H
@@ -39,37 +39,48 @@
 
 #include <string.h>
 #include "sha2_routines.h"
+#include "sha2_routines_accel.h"
 
 #define rotate_right(value, places) ((value >> places) | (value << (32 - places)))
 
+const uint32_t sw_sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t sw_sha256_h0[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static sw_sha256_process_fn sw_sha256_process_impl = NULL;
+static sw_sha256_impl_t sw_sha256_impl = SW_SHA256_IMPL_AUTO;
+
 /**
- * \brief Processes whole blocks (64 bytes) of data.
+ * \brief Processes whole blocks (64 bytes) of data. Portable C reference implementation, the
+ *        accelerated implementations must produce exactly the same state.
  *
- * \param[in] ctx          SAH256 hash context
- * \param[in] blocks       Raw blocks to be processed
- * \param[in] block_count  Number of 64-byte blocks to process
+ * \param[inout] hash         SHA256 hash state
+ * \param[in]    blocks       Raw blocks to be processed
+ * \param[in]    block_count  Number of 64-byte blocks to process
  */
-static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_t block_count)
+void sw_sha256_process_generic(uint32_t hash[8], const uint8_t* blocks, uint32_t block_count)
 {
 	int i = 0;
 	uint32_t block = 0;
+	const uint32_t* k = sw_sha256_k;
 
 	union {
 		uint32_t w_word[SHA256_BLOCK_SIZE];
 		uint8_t w_byte[SHA256_BLOCK_SIZE * sizeof(uint32_t)];
 	} w_union;
 
-	static const uint32_t k[] = {
-		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
-		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
-		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
-		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
-		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
-		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
-		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-	};
-
 	// Loop through all the blocks to process
 	for (block = 0; block < block_count; block++) {
 		uint32_t w_index;
@@ -104,7 +115,7 @@ static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_
 
 		// Initialize hash value for this chunk.
 		for (i = 0; i < 8; i++)
-			rotate_register[i] = ctx->hash[i];
+			rotate_register[i] = hash[i];
 
 		// hash calculation loop
 		for (i = 0; i < SHA256_BLOCK_SIZE; i++) {
@@ -134,21 +145,115 @@ static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_
 
 		// Add the hash of this block to current result.
 		for (i = 0; i < 8; i++)
-			ctx->hash[i] += rotate_register[i];
+			hash[i] += rotate_register[i];
+	}
+}
+
+int sw_sha256_impl_supported(sw_sha256_impl_t impl)
+{
+	switch (impl) {
+	case SW_SHA256_IMPL_AUTO:
+	case SW_SHA256_IMPL_GENERIC:
+		return 1;
+#ifdef SW_SHA256_HAVE_X86
+	case SW_SHA256_IMPL_SHANI:
+		return sw_sha256_cpu_has_shani();
+	case SW_SHA256_IMPL_AVX2:
+		return sw_sha256_cpu_has_avx2();
+#endif
+#ifdef SW_SHA256_HAVE_ARMV8
+	case SW_SHA256_IMPL_ARMV8:
+		return sw_sha256_cpu_has_armv8();
+#endif
+	default:
+		return 0;
+	}
+}
+
+int sw_sha256_set_impl(sw_sha256_impl_t impl)
+{
+	sw_sha256_process_fn fn = sw_sha256_process_generic;
+
+	if (impl == SW_SHA256_IMPL_AUTO) {
+		// Fastest first
+		if (sw_sha256_impl_supported(SW_SHA256_IMPL_SHANI))
+			impl = SW_SHA256_IMPL_SHANI;
+		else if (sw_sha256_impl_supported(SW_SHA256_IMPL_ARMV8))
+			impl = SW_SHA256_IMPL_ARMV8;
+		else if (sw_sha256_impl_supported(SW_SHA256_IMPL_AVX2))
+			impl = SW_SHA256_IMPL_AVX2;
+		else
+			impl = SW_SHA256_IMPL_GENERIC;
+	}
+	if (!sw_sha256_impl_supported(impl))
+		return 0;
+
+	switch (impl) {
+#ifdef SW_SHA256_HAVE_X86
+	case SW_SHA256_IMPL_SHANI:
+		fn = sw_sha256_process_shani;
+		break;
+	case SW_SHA256_IMPL_AVX2:
+		fn = sw_sha256_process_avx2;
+		break;
+#endif
+#ifdef SW_SHA256_HAVE_ARMV8
+	case SW_SHA256_IMPL_ARMV8:
+		fn = sw_sha256_process_armv8;
+		break;
+#endif
+	default:
+		fn = sw_sha256_process_generic;
+		break;
+	}
+
+	sw_sha256_impl = impl;
+	sw_sha256_process_impl = fn;
+	return 1;
+}
+
+sw_sha256_impl_t sw_sha256_get_impl(void)
+{
+	if (sw_sha256_process_impl == NULL)
+		sw_sha256_set_impl(SW_SHA256_IMPL_AUTO);
+	return sw_sha256_impl;
+}
+
+const char* sw_sha256_impl_name(sw_sha256_impl_t impl)
+{
+	switch (impl) {
+	case SW_SHA256_IMPL_AUTO:    return "auto";
+	case SW_SHA256_IMPL_GENERIC: return "generic";
+	case SW_SHA256_IMPL_SHANI:   return "sha-ni";
+	case SW_SHA256_IMPL_AVX2:    return "avx2";
+	case SW_SHA256_IMPL_ARMV8:   return "armv8-ce";
+	default:                     return "unknown";
 	}
 }
 
+/**
+ * \brief Processes whole blocks (64 bytes) of data with the implementation selected for this CPU.
+ *
+ * \param[in] ctx          SAH256 hash context
+ * \param[in] blocks       Raw blocks to be processed
+ * \param[in] block_count  Number of 64-byte blocks to process
+ */
+static void sw_sha256_process(sw_sha256_ctx* ctx, const uint8_t* blocks, uint32_t block_count)
+{
+	if (block_count == 0)
+		return;
+	if (sw_sha256_process_impl == NULL)
+		sw_sha256_set_impl(SW_SHA256_IMPL_AUTO);
+	sw_sha256_process_impl(ctx->hash, blocks, block_count);
+}
+
 void sw_sha256_init(sw_sha256_ctx* ctx)
 {
-	static const uint32_t hash_init[] = {
-		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
-		0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
-	};
 	int i;
 
 	memset(ctx, 0, sizeof(*ctx));
 	for (i = 0; i < 8; i++)
-		ctx->hash[i] = hash_init[i];
+		ctx->hash[i] = sw_sha256_h0[i];
 }
 
 void sw_sha256_update(sw_sha256_ctx* ctx, const uint8_t* msg, uint32_t msg_size)
@@ -223,4 +328,150 @@ void sw_sha256(const uint8_t* message, unsigned int len, uint8_t digest[SHA256_D
 	sw_sha256_init(&ctx);
 	sw_sha256_update(&ctx, message, len);
 	sw_sha256_final(&ctx, digest);
-}
\ No newline at end of file
+}
+
+#define SW_SHA256_MB_NO_JOB (0xFFFFFFFF)
+
+/**
+ * \brief State of one lane of the multi-buffer hash. Whole blocks are read straight from the
+ *        message; the last partial block and the padding come from the tail buffer.
+ */
+typedef struct {
+	const uint8_t* data;                    //!< Next whole message block
+	uint32_t full_blocks;                   //!< Whole message blocks left
+	uint32_t tail_blocks;                   //!< Padded tail blocks left
+	uint32_t tail_index;                    //!< Next tail block
+	uint32_t job;                           //!< Index of the message in this lane, SW_SHA256_MB_NO_JOB when idle
+	uint8_t tail[SHA256_BLOCK_SIZE * 2];    //!< Last partial block plus padding
+} sw_sha256_mb_lane;
+
+static void sw_sha256_mb_lane_start(sw_sha256_mb_lane* lane, uint32_t state[8][SW_SHA256_MB_LANES], uint32_t lane_index,
+                                    uint32_t job, const uint8_t* message, uint32_t len)
+{
+	uint32_t rem_size = len % SHA256_BLOCK_SIZE;
+	uint64_t msg_size_bits = (uint64_t)len * 8;
+	uint32_t tail_size;
+	int i;
+
+	lane->data = message;
+	lane->full_blocks = len / SHA256_BLOCK_SIZE;
+	lane->tail_blocks = (rem_size + 9 > SHA256_BLOCK_SIZE) ? 2 : 1;
+	lane->tail_index = 0;
+	lane->job = job;
+
+	// Same padding as sw_sha256_final(), but with the full 64 bit message size
+	tail_size = lane->tail_blocks * SHA256_BLOCK_SIZE;
+	if (rem_size > 0)
+		memcpy(lane->tail, &message[len - rem_size], rem_size);
+	lane->tail[rem_size] = 0x80;
+	memset(&lane->tail[rem_size + 1], 0, tail_size - rem_size - 1 - 8);
+	for (i = 0; i < 8; i++)
+		lane->tail[tail_size - 1 - i] = (uint8_t)(msg_size_bits >> (8 * i));
+
+	for (i = 0; i < 8; i++)
+		state[i][lane_index] = sw_sha256_h0[i];
+}
+
+static const uint8_t* sw_sha256_mb_lane_next(sw_sha256_mb_lane* lane)
+{
+	const uint8_t* block;
+
+	if (lane->full_blocks > 0) {
+		block = lane->data;
+		lane->data += SHA256_BLOCK_SIZE;
+		lane->full_blocks--;
+	}else  {
+		block = &lane->tail[lane->tail_index++ * SHA256_BLOCK_SIZE];
+		lane->tail_blocks--;
+	}
+	return block;
+}
+
+/**
+ * \brief Returns the multi-buffer block function for this CPU, NULL if there is none or if
+ *        hashing the messages one after the other is faster anyway.
+ *
+ * \param[in] count  Number of messages to hash
+ */
+static sw_sha256_process_mb_fn sw_sha256_select_mb(uint32_t count)
+{
+#ifdef SW_SHA256_HAVE_X86
+	sw_sha256_impl_t impl = sw_sha256_get_impl();
+
+	// Pinning the generic implementation disables the multi-buffer path too. With SHA-NI a
+	// single message is hashed faster than 8 lanes can share, so only use the lanes when full.
+	if (impl == SW_SHA256_IMPL_GENERIC || (impl == SW_SHA256_IMPL_SHANI && count < SW_SHA256_MB_LANES))
+		return NULL;
+	if (sw_sha256_cpu_has_avx2())
+		return sw_sha256_process_x8_avx2;
+#else
+	(void)count;
+#endif
+	return NULL;
+}
+
+/**
+ * \brief Hashes a number of independent messages. Up to SW_SHA256_MB_LANES messages are processed
+ *        side by side in SIMD lanes when the CPU supports it; a lane that finishes is refilled with
+ *        the next message, so messages of different lengths can be mixed freely.
+ *
+ * \param[in]  messages  Messages to hash
+ * \param[in]  lens      Size of each message in bytes
+ * \param[in]  count     Number of messages
+ * \param[out] digests   Digest of each message
+ */
+void sw_sha256_mb(const uint8_t* const messages[], const uint32_t lens[], uint32_t count, uint8_t digests[][SHA256_DIGEST_SIZE])
+{
+	static const uint8_t idle_block[SHA256_BLOCK_SIZE] = { 0 };
+	sw_sha256_process_mb_fn process_mb = sw_sha256_select_mb(count);
+	sw_sha256_mb_lane lanes[SW_SHA256_MB_LANES];
+	uint32_t state[8][SW_SHA256_MB_LANES];
+	const uint8_t* blocks[SW_SHA256_MB_LANES];
+	uint32_t next_job = 0;
+	uint32_t active = 0;
+	uint32_t i, j;
+
+	if (process_mb == NULL || count < 2) {
+		for (i = 0; i < count; i++)
+			sw_sha256(messages[i], lens[i], digests[i]);
+		return;
+	}
+
+	for (i = 0; i < SW_SHA256_MB_LANES; i++) {
+		lanes[i].job = SW_SHA256_MB_NO_JOB;
+		if (next_job < count) {
+			sw_sha256_mb_lane_start(&lanes[i], state, i, next_job, messages[next_job], lens[next_job]);
+			next_job++;
+			active++;
+		}
+	}
+
+	while (active > 0) {
+		for (i = 0; i < SW_SHA256_MB_LANES; i++)
+			blocks[i] = lanes[i].job == SW_SHA256_MB_NO_JOB ? idle_block : sw_sha256_mb_lane_next(&lanes[i]);
+
+		process_mb(state, blocks);
+
+		for (i = 0; i < SW_SHA256_MB_LANES; i++) {
+			if (lanes[i].job == SW_SHA256_MB_NO_JOB || lanes[i].full_blocks > 0 || lanes[i].tail_blocks > 0)
+				continue;
+			// Lane is done, output its digest and start the next message
+			for (j = 0; j < 8; j++) {
+				digests[lanes[i].job][j * 4 + 0] = (uint8_t)(state[j][i] >> 24);
+				digests[lanes[i].job][j * 4 + 1] = (uint8_t)(state[j][i] >> 16);
+				digests[lanes[i].job][j * 4 + 2] = (uint8_t)(state[j][i] >> 8);
+				digests[lanes[i].job][j * 4 + 3] = (uint8_t)(state[j][i] >> 0);
+			}
+			if (next_job < count) {
+				sw_sha256_mb_lane_start(&lanes[i], state, i, next_job, messages[next_job], lens[next_job]);
+				next_job++;
+			}else  {
+				lanes[i].job = SW_SHA256_MB_NO_JOB;
+				active--;
+			}
+		}
+	}
+
+	memset(lanes, 0, sizeof(lanes));
+	memset(state, 0, sizeof(state));
+}
@@ -56,6 +56,29 @@ typedef struct {
 	uint32_t hash[8];                       //!< Hash state
 } sw_sha256_ctx;
 
+/**
+ * \brief Block processing implementations. The fastest one supported by the CPU is picked at
+ *        first use; the portable C implementation is always available and is the reference.
+ */
+typedef enum {
+	SW_SHA256_IMPL_AUTO = 0,    //!< Pick the fastest implementation supported by the CPU
+	SW_SHA256_IMPL_GENERIC,     //!< Portable C implementation
+	SW_SHA256_IMPL_SHANI,       //!< x86 SHA extensions (SHA-NI)
+	SW_SHA256_IMPL_AVX2,        //!< x86 AVX2 message schedule with BMI2 rounds
+	SW_SHA256_IMPL_ARMV8,       //!< ARMv8 cryptography extensions
+} sw_sha256_impl_t;
+
+//! Number of messages hashed side by side by sw_sha256_mb()
+#define SW_SHA256_MB_LANES (8)
+
+int sw_sha256_impl_supported(sw_sha256_impl_t impl);
+
+int sw_sha256_set_impl(sw_sha256_impl_t impl);
+
+sw_sha256_impl_t sw_sha256_get_impl(void);
+
+const char* sw_sha256_impl_name(sw_sha256_impl_t impl);
+
 void sw_sha256_init(sw_sha256_ctx* ctx);
 
 void sw_sha256_update(sw_sha256_ctx* ctx, const uint8_t* message, uint32_t len);
@@ -64,6 +87,8 @@ void sw_sha256_final(sw_sha256_ctx * ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
 
 void sw_sha256(const uint8_t * message, unsigned int len, uint8_t digest[SHA256_DIGEST_SIZE]);
 
+void sw_sha256_mb(const uint8_t* const messages[], const uint32_t lens[], uint32_t count, uint8_t digests[][SHA256_DIGEST_SIZE]);
+
 #ifdef __cplusplus
 }
 #endif
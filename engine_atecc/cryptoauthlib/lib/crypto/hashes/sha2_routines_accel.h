@@ -0,0 +1,81 @@
+/** \brief Internal interface between the SHA256 dispatcher and its CPU specific implementations.
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#ifndef SHA2_ROUTINES_ACCEL_H
+#define SHA2_ROUTINES_ACCEL_H
+
+#include <stdint.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(ATCA_NO_SHA256_ACCEL)
+#define SW_SHA256_HAVE_X86
+#endif
+
+#if defined(__aarch64__) && defined(__linux__) && defined(__GNUC__) && !defined(ATCA_NO_SHA256_ACCEL)
+#define SW_SHA256_HAVE_ARMV8
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*sw_sha256_process_fn)(uint32_t hash[8], const uint8_t* blocks, uint32_t block_count);
+typedef void (*sw_sha256_process_mb_fn)(uint32_t state[8][SW_SHA256_MB_LANES], const uint8_t* blocks[SW_SHA256_MB_LANES]);
+
+extern const uint32_t sw_sha256_k[64];
+
+void sw_sha256_process_generic(uint32_t hash[8], const uint8_t* blocks, uint32_t block_count);
+
+#ifdef SW_SHA256_HAVE_X86
+int sw_sha256_cpu_has_shani(void);
+int sw_sha256_cpu_has_avx2(void);
+void sw_sha256_process_shani(uint32_t hash[8], const uint8_t* blocks, uint32_t block_count);
+void sw_sha256_process_avx2(uint32_t hash[8], const uint8_t* blocks, uint32_t block_count);
+void sw_sha256_process_x8_avx2(uint32_t state[8][SW_SHA256_MB_LANES], const uint8_t* blocks[SW_SHA256_MB_LANES]);
+#endif
+
+#ifdef SW_SHA256_HAVE_ARMV8
+int sw_sha256_cpu_has_armv8(void);
+void sw_sha256_process_armv8(uint32_t hash[8], const uint8_t* blocks, uint32_t block_count);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHA2_ROUTINES_ACCEL_H
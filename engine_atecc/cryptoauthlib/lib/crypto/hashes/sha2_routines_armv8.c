@@ -0,0 +1,96 @@
+/** \brief SHA256 block processing using the ARMv8 cryptography extensions.
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#include "sha2_routines.h"
+#include "sha2_routines_accel.h"
+
+#ifdef SW_SHA256_HAVE_ARMV8
+
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#include <arm_neon.h>
+
+int sw_sha256_cpu_has_armv8(void)
+{
+	return (getauxval(AT_HWCAP) & HWCAP_SHA2) != 0;
+}
+
+/**
+ * \brief Processes whole blocks using the SHA256H/SHA256H2/SHA256SU0/SHA256SU1 instructions,
+ *        4 rounds per iteration.
+ */
+__attribute__((target("+crypto")))
+void sw_sha256_process_armv8(uint32_t hash[8], const uint8_t* blocks, uint32_t block_count)
+{
+	uint32x4_t state0, state1, abef_save, cdgh_save;
+	uint32x4_t wk, tmp;
+	uint32x4_t w[4];
+	uint32_t block, g;
+
+	state0 = vld1q_u32(&hash[0]);
+	state1 = vld1q_u32(&hash[4]);
+
+	for (block = 0; block < block_count; block++, blocks += SHA256_BLOCK_SIZE) {
+		abef_save = state0;
+		cdgh_save = state1;
+
+		for (g = 0; g < 4; g++)
+			w[g] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(&blocks[g * 16])));
+
+		for (g = 0; g < 16; g++) {
+			wk = vaddq_u32(w[g & 3], vld1q_u32(&sw_sha256_k[g * 4]));
+			// Words for group g + 4 replace the ones consumed here
+			if (g < 12)
+				w[g & 3] = vsha256su0q_u32(w[g & 3], w[(g + 1) & 3]);
+			tmp = state0;
+			state0 = vsha256hq_u32(state0, state1, wk);
+			state1 = vsha256h2q_u32(state1, tmp, wk);
+			if (g < 12)
+				w[g & 3] = vsha256su1q_u32(w[g & 3], w[(g + 2) & 3], w[(g + 3) & 3]);
+		}
+
+		state0 = vaddq_u32(state0, abef_save);
+		state1 = vaddq_u32(state1, cdgh_save);
+	}
+
+	vst1q_u32(&hash[0], state0);
+	vst1q_u32(&hash[4], state1);
+}
+
+#endif // SW_SHA256_HAVE_ARMV8
@@ -0,0 +1,327 @@
+/** \brief SHA256 block processing using the x86 SHA extensions and AVX2.
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+
+#include "sha2_routines.h"
+#include "sha2_routines_accel.h"
+
+#ifdef SW_SHA256_HAVE_X86
+
+#include <string.h>
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define CPUID1_ECX_SSSE3    (1u << 9)
+#define CPUID1_ECX_SSE41    (1u << 19)
+#define CPUID1_ECX_OSXSAVE  (1u << 27)
+#define CPUID1_ECX_AVX      (1u << 28)
+#define CPUID7_EBX_AVX2     (1u << 5)
+#define CPUID7_EBX_BMI2     (1u << 8)
+#define CPUID7_EBX_SHA      (1u << 29)
+
+static int cpu_features_read = 0;
+static uint32_t cpuid1_ecx = 0;
+static uint32_t cpuid7_ebx = 0;
+static int os_saves_ymm = 0;
+
+static void sw_sha256_read_cpu_features(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+	uint32_t xcr0_lo, xcr0_hi;
+
+	if (cpu_features_read)
+		return;
+
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		cpuid1_ecx = ecx;
+	if (__get_cpuid_max(0, NULL) >= 7) {
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+		cpuid7_ebx = ebx;
+	}
+	if ((cpuid1_ecx & (CPUID1_ECX_OSXSAVE | CPUID1_ECX_AVX)) == (CPUID1_ECX_OSXSAVE | CPUID1_ECX_AVX)) {
+		// XCR0 must have both the SSE and AVX state enabled by the OS
+		__asm__ volatile ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+		os_saves_ymm = (xcr0_lo & 0x6) == 0x6;
+	}
+	cpu_features_read = 1;
+}
+
+int sw_sha256_cpu_has_shani(void)
+{
+	sw_sha256_read_cpu_features();
+	return (cpuid7_ebx & CPUID7_EBX_SHA)
+	       && (cpuid1_ecx & CPUID1_ECX_SSSE3)
+	       && (cpuid1_ecx & CPUID1_ECX_SSE41);
+}
+
+int sw_sha256_cpu_has_avx2(void)
+{
+	sw_sha256_read_cpu_features();
+	return os_saves_ymm
+	       && (cpuid7_ebx & CPUID7_EBX_AVX2)
+	       && (cpuid7_ebx & CPUID7_EBX_BMI2);
+}
+
+/**
+ * \brief Processes whole blocks using the SHA-NI instructions. The state is kept as the ABEF/CDGH
+ *        register pair the instructions expect; 4 rounds are done per iteration.
+ */
+__attribute__((target("sha,sse4.1,ssse3")))
+void sw_sha256_process_shani(uint32_t hash[8], const uint8_t* blocks, uint32_t block_count)
+{
+	const __m128i bswap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i state0, state1, abef_save, cdgh_save;
+	__m128i msg, tmp;
+	__m128i w[4];
+	uint32_t block, g;
+
+	tmp    = _mm_loadu_si128((const __m128i*)&hash[0]);
+	state1 = _mm_loadu_si128((const __m128i*)&hash[4]);
+	tmp    = _mm_shuffle_epi32(tmp, 0xB1);          // CDAB
+	state1 = _mm_shuffle_epi32(state1, 0x1B);       // EFGH
+	state0 = _mm_alignr_epi8(tmp, state1, 8);       // ABEF
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);    // CDGH
+
+	for (block = 0; block < block_count; block++, blocks += SHA256_BLOCK_SIZE) {
+		abef_save = state0;
+		cdgh_save = state1;
+
+		for (g = 0; g < 16; g++) {
+			if (g < 4)
+				w[g] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)&blocks[g * 16]), bswap_mask);
+
+			msg = _mm_add_epi32(w[g & 3], _mm_loadu_si128((const __m128i*)&sw_sha256_k[g * 4]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+
+			// Finish the schedule of the words needed 4 rounds from now
+			if (g >= 3 && g <= 14) {
+				tmp = _mm_alignr_epi8(w[g & 3], w[(g - 1) & 3], 4);
+				w[(g + 1) & 3] = _mm_add_epi32(w[(g + 1) & 3], tmp);
+				w[(g + 1) & 3] = _mm_sha256msg2_epu32(w[(g + 1) & 3], w[g & 3]);
+			}
+
+			msg = _mm_shuffle_epi32(msg, 0x0E);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+			// Start the schedule of the words needed 12 rounds from now
+			if (g >= 1 && g <= 12)
+				w[(g - 1) & 3] = _mm_sha256msg1_epu32(w[(g - 1) & 3], w[g & 3]);
+		}
+
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+
+	tmp    = _mm_shuffle_epi32(state0, 0x1B);       // FEBA
+	state1 = _mm_shuffle_epi32(state1, 0xB1);       // DCHG
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);    // DCBA
+	state1 = _mm_alignr_epi8(state1, tmp, 8);       // ABEF
+
+	_mm_storeu_si128((__m128i*)&hash[0], state0);
+	_mm_storeu_si128((__m128i*)&hash[4], state1);
+}
+
+#define AVX2_ROR(x, n)      _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define AVX2_SIGMA0(x)      _mm256_xor_si256(_mm256_xor_si256(AVX2_ROR(x, 7), AVX2_ROR(x, 18)), _mm256_srli_epi32(x, 3))
+#define AVX2_SIGMA1(x)      _mm256_xor_si256(_mm256_xor_si256(AVX2_ROR(x, 17), AVX2_ROR(x, 19)), _mm256_srli_epi32(x, 10))
+
+#define ROR32(x, n)         (((x) >> (n)) | ((x) << (32 - (n))))
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, wk) \
+	do { \
+		uint32_t t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25)) + ((e & f) ^ (~e & g)) + (wk); \
+		uint32_t t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c)); \
+		d += t1; \
+		h = t1 + t2; \
+	} while (0)
+
+/**
+ * \brief Runs the 64 rounds of one block on precomputed W+K values. Scalar, but built for BMI2
+ *        so the rotates become RORX and do not touch the flags.
+ */
+__attribute__((target("avx2,bmi2")))
+static void sw_sha256_rounds_avx2(uint32_t hash[8], const uint32_t* wk, uint32_t stride)
+{
+	uint32_t a = hash[0], b = hash[1], c = hash[2], d = hash[3];
+	uint32_t e = hash[4], f = hash[5], g = hash[6], h = hash[7];
+	uint32_t i;
+
+	for (i = 0; i < 64; i += 8) {
+		SHA256_ROUND(a, b, c, d, e, f, g, h, wk[((i + 0) / 4) * stride + ((i + 0) & 3)]);
+		SHA256_ROUND(h, a, b, c, d, e, f, g, wk[((i + 1) / 4) * stride + ((i + 1) & 3)]);
+		SHA256_ROUND(g, h, a, b, c, d, e, f, wk[((i + 2) / 4) * stride + ((i + 2) & 3)]);
+		SHA256_ROUND(f, g, h, a, b, c, d, e, wk[((i + 3) / 4) * stride + ((i + 3) & 3)]);
+		SHA256_ROUND(e, f, g, h, a, b, c, d, wk[((i + 4) / 4) * stride + ((i + 4) & 3)]);
+		SHA256_ROUND(d, e, f, g, h, a, b, c, wk[((i + 5) / 4) * stride + ((i + 5) & 3)]);
+		SHA256_ROUND(c, d, e, f, g, h, a, b, wk[((i + 6) / 4) * stride + ((i + 6) & 3)]);
+		SHA256_ROUND(b, c, d, e, f, g, h, a, wk[((i + 7) / 4) * stride + ((i + 7) & 3)]);
+	}
+
+	hash[0] += a; hash[1] += b; hash[2] += c; hash[3] += d;
+	hash[4] += e; hash[5] += f; hash[6] += g; hash[7] += h;
+}
+
+/**
+ * \brief Processes whole blocks with the message schedule of two consecutive blocks computed
+ *        side by side in the two 128-bit lanes of the AVX2 registers. The rounds themselves are
+ *        inherently serial and are done by sw_sha256_rounds_avx2().
+ */
+__attribute__((target("avx2,bmi2")))
+void sw_sha256_process_avx2(uint32_t hash[8], const uint8_t* blocks, uint32_t block_count)
+{
+	const __m256i bswap_mask = _mm256_set_epi64x(
+		0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+		0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	const __m256i mask_lo = _mm256_set_epi32(0, 0, -1, -1, 0, 0, -1, -1);
+	const __m256i mask_hi = _mm256_set_epi32(-1, -1, 0, 0, -1, -1, 0, 0);
+	__m256i x[4], t, k;
+	uint32_t wk[16 * 8] __attribute__((aligned(32)));
+	uint32_t g;
+
+	while (block_count > 0) {
+		// Second lane gets the next block, or a copy of this one when it is the last
+		const uint8_t* next = block_count > 1 ? blocks + SHA256_BLOCK_SIZE : blocks;
+
+		for (g = 0; g < 16; g++) {
+			if (g < 4) {
+				t = _mm256_inserti128_si256(
+					_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)&blocks[g * 16])),
+					_mm_loadu_si128((const __m128i*)&next[g * 16]), 1);
+				x[g] = _mm256_shuffle_epi8(t, bswap_mask);
+			} else {
+				// x[0..3] hold W[t-16..t-1]
+				t = _mm256_add_epi32(x[0], AVX2_SIGMA0(_mm256_alignr_epi8(x[1], x[0], 4)));
+				t = _mm256_add_epi32(t, _mm256_alignr_epi8(x[3], x[2], 4));
+				// W[t], W[t+1] depend on W[t-2], W[t-1]
+				k = _mm256_shuffle_epi32(x[3], 0xFE);
+				t = _mm256_add_epi32(t, _mm256_and_si256(AVX2_SIGMA1(k), mask_lo));
+				// W[t+2], W[t+3] depend on the W[t], W[t+1] just computed
+				k = _mm256_shuffle_epi32(t, 0x40);
+				t = _mm256_add_epi32(t, _mm256_and_si256(AVX2_SIGMA1(k), mask_hi));
+				x[0] = x[1];
+				x[1] = x[2];
+				x[2] = x[3];
+				x[3] = t;
+			}
+			k = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)&sw_sha256_k[g * 4]));
+			_mm256_store_si256((__m256i*)&wk[g * 8], _mm256_add_epi32(g < 4 ? x[g] : x[3], k));
+		}
+
+		sw_sha256_rounds_avx2(hash, &wk[0], 8);
+		if (block_count == 1)
+			break;
+		sw_sha256_rounds_avx2(hash, &wk[4], 8);
+		blocks += 2 * SHA256_BLOCK_SIZE;
+		block_count -= 2;
+	}
+	memset(wk, 0, sizeof(wk));
+}
+
+#define X8_ROR(x, n)        _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define X8_XOR3(a, b, c)    _mm256_xor_si256(_mm256_xor_si256(a, b), c)
+#define X8_ADD3(a, b, c)    _mm256_add_epi32(_mm256_add_epi32(a, b), c)
+
+/**
+ * \brief Processes one block of each of 8 independent messages, one message per 32-bit lane.
+ *
+ * \param[inout] state   Hash states, state[word][lane]
+ * \param[in]    blocks  One 64-byte block per lane
+ */
+__attribute__((target("avx2")))
+void sw_sha256_process_x8_avx2(uint32_t state[8][SW_SHA256_MB_LANES], const uint8_t* blocks[SW_SHA256_MB_LANES])
+{
+	uint32_t wt[16][SW_SHA256_MB_LANES] __attribute__((aligned(32)));
+	__m256i w[16];
+	__m256i a, b, c, d, e, f, g, h, t1, t2;
+	uint32_t i, lane;
+
+	// Gather and byte swap the message words so w[t] holds word t of every lane
+	for (lane = 0; lane < SW_SHA256_MB_LANES; lane++) {
+		for (i = 0; i < 16; i++) {
+			const uint8_t* p = &blocks[lane][i * 4];
+			wt[i][lane] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+		}
+	}
+	for (i = 0; i < 16; i++)
+		w[i] = _mm256_load_si256((const __m256i*)wt[i]);
+
+	a = _mm256_loadu_si256((const __m256i*)state[0]);
+	b = _mm256_loadu_si256((const __m256i*)state[1]);
+	c = _mm256_loadu_si256((const __m256i*)state[2]);
+	d = _mm256_loadu_si256((const __m256i*)state[3]);
+	e = _mm256_loadu_si256((const __m256i*)state[4]);
+	f = _mm256_loadu_si256((const __m256i*)state[5]);
+	g = _mm256_loadu_si256((const __m256i*)state[6]);
+	h = _mm256_loadu_si256((const __m256i*)state[7]);
+
+	for (i = 0; i < 64; i++) {
+		if (i >= 16) {
+			// Message schedule kept in a 16 entry ring
+			__m256i w15 = w[(i - 15) & 15];
+			__m256i w2 = w[(i - 2) & 15];
+			__m256i s0 = X8_XOR3(X8_ROR(w15, 7), X8_ROR(w15, 18), _mm256_srli_epi32(w15, 3));
+			__m256i s1 = X8_XOR3(X8_ROR(w2, 17), X8_ROR(w2, 19), _mm256_srli_epi32(w2, 10));
+			w[i & 15] = _mm256_add_epi32(X8_ADD3(w[i & 15], s0, w[(i - 7) & 15]), s1);
+		}
+
+		t1 = X8_ADD3(h, X8_XOR3(X8_ROR(e, 6), X8_ROR(e, 11), X8_ROR(e, 25)),
+		             _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g)));
+		t1 = X8_ADD3(t1, _mm256_set1_epi32((int)sw_sha256_k[i]), w[i & 15]);
+		t2 = _mm256_add_epi32(X8_XOR3(X8_ROR(a, 2), X8_ROR(a, 13), X8_ROR(a, 22)),
+		                      X8_XOR3(_mm256_and_si256(a, b), _mm256_and_si256(a, c), _mm256_and_si256(b, c)));
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi32(d, t1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi32(t1, t2);
+	}
+
+	_mm256_storeu_si256((__m256i*)state[0], _mm256_add_epi32(a, _mm256_loadu_si256((const __m256i*)state[0])));
+	_mm256_storeu_si256((__m256i*)state[1], _mm256_add_epi32(b, _mm256_loadu_si256((const __m256i*)state[1])));
+	_mm256_storeu_si256((__m256i*)state[2], _mm256_add_epi32(c, _mm256_loadu_si256((const __m256i*)state[2])));
+	_mm256_storeu_si256((__m256i*)state[3], _mm256_add_epi32(d, _mm256_loadu_si256((const __m256i*)state[3])));
+	_mm256_storeu_si256((__m256i*)state[4], _mm256_add_epi32(e, _mm256_loadu_si256((const __m256i*)state[4])));
+	_mm256_storeu_si256((__m256i*)state[5], _mm256_add_epi32(f, _mm256_loadu_si256((const __m256i*)state[5])));
+	_mm256_storeu_si256((__m256i*)state[6], _mm256_add_epi32(g, _mm256_loadu_si256((const __m256i*)state[6])));
+	_mm256_storeu_si256((__m256i*)state[7], _mm256_add_epi32(h, _mm256_loadu_si256((const __m256i*)state[7])));
+	memset(wt, 0, sizeof(wt));
+}
+
+#endif // SW_SHA256_HAVE_X86
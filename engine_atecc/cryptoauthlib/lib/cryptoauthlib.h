@@ -48,6 +48,10 @@
 #include "atca_device.h"
 #include "atca_command.h"
 #include "atca_cfgs.h"
+#include "atca_stats.h"
+#include "atca_trace.h"
+#include "atca_deadline.h"
+#include "atca_log.h"
 #include "basic/atca_basic.h"
 #include "basic/atca_helpers.h"
 
@@ -42,6 +42,7 @@
 #include "kit_phy.h"
 #include "hal_linux_kit_cdc.h"
 #include "kit_protocol.h"
+#include "atca_log.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -50,6 +51,8 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <poll.h>
+#include <errno.h>
 
 /** \defgroup hal_ Hardware abstraction layer (hal_)
  *
@@ -64,8 +67,8 @@
 #define min(a, b)    (((a) < (b)) ? (a) : (b))
 #endif
 
-// File scope globals
-atcacdc_t _gCdc;
+// File scope globals, one per kit port so several kits can be opened at the same time
+atcacdc_t _gCdc[CDC_DEVICES_MAX];
 
 
 /** \brief HAL implementation of Kit USB CDC init
@@ -75,6 +78,8 @@ atcacdc_t _gCdc;
  *
  *  SUBSYSTEMS=="usb", ATTRS{idVendor}=="03eb", ATTRS{idProduct}=="2122", MODE:="0777", SYMLINK+="ttyATCA%n"
  *
+ *  Port 0 of the configuration opens dev, port n opens /dev/ttyACMn.
+ *
  *  \param[in] hal pointer to HAL specific data that is maintained by this HAL
  *  \param[in] cfg pointer to HAL specific configuration data that is used to initialize this HAL
  * \return ATCA_STATUS
@@ -113,36 +118,43 @@ ATCA_STATUS hal_kit_cdc_init(void* hal, ATCAIfaceCfg* cfg)
 	ATCAHAL_t *phal = NULL;
 	struct termios serialTermios;
 	uint32_t i = 0;
-	uint32_t index = 0;
+	int port;
+	char port_dev[32];
+	atcacdc_t* pCdc = NULL;
 	int fd;
 
 	// Check the input variables
 	if ((hal == NULL) || (cfg == NULL))
 		return ATCA_BAD_PARAM;
+	port = cfg->atcauart.port;
+	if (port < 0 || port >= CDC_DEVICES_MAX)
+		return ATCA_BAD_PARAM;
 
 	// Cast the hal to the ATCAHAL_t structure
 	phal = (ATCAHAL_t*)hal;
 
-	// Initialize the _gCdc structure
-	memset(&_gCdc, 0, sizeof(_gCdc));
+	// Initialize the _gCdc structure of this port
+	pCdc = &_gCdc[port];
+	memset(pCdc, 0, sizeof(*pCdc));
 	for (i = 0; i < CDC_DEVICES_MAX; i++) {
-		_gCdc.kits[i].read_handle = INVALID_HANDLE_VALUE;
-		_gCdc.kits[i].write_handle = INVALID_HANDLE_VALUE;
+		pCdc->kits[i].read_handle = INVALID_HANDLE_VALUE;
+		pCdc->kits[i].write_handle = INVALID_HANDLE_VALUE;
 	}
-	_gCdc.num_kits_found = 0;
+	pCdc->num_kits_found = 0;
 
 	// Get the read & write handles
 	// todo: perform an actual discovery here...
-	if ( (fd = open( dev, O_RDWR | O_NOCTTY  )) < 0 ) {
-		printf("Failed to open %s ret:%02X\n", dev, fd);
+	if (port == 0)
+		snprintf(port_dev, sizeof(port_dev), "%s", dev);
+	else
+		snprintf(port_dev, sizeof(port_dev), "/dev/ttyACM%d", port);
+	if ( (fd = open( port_dev, O_RDWR | O_NOCTTY  )) < 0 ) {
+		ATCA_LOG_E(ATCA_LOG_HAL, "Failed to open %s ret:%02X\n", port_dev, fd);
 		return ATCA_COMM_FAIL;
 	}
-	index++;
-	// Save the results of this discovery of CDC
-	if (index > 0) {
-		_gCdc.num_kits_found = 1;
-		phal->hal_data = &_gCdc;
-	}
+	// Save the results of this discovery of CDC, the kit sits at the index of its port
+	pCdc->num_kits_found = (int8_t)(port + 1);
+	phal->hal_data = pCdc;
 
 	tcgetattr(fd, &serialTermios);
 	cfsetispeed(&serialTermios, speed);
@@ -158,8 +170,8 @@ ATCA_STATUS hal_kit_cdc_init(void* hal, ATCAIfaceCfg* cfg)
 
 	tcsetattr(fd, TCSANOW, &serialTermios);
 
-	_gCdc.kits[0].read_handle = fd;
-	_gCdc.kits[0].write_handle = fd;
+	pCdc->kits[port].read_handle = fd;
+	pCdc->kits[port].write_handle = fd;
 
 	return ATCA_SUCCESS;
 }
@@ -170,23 +182,41 @@ ATCA_STATUS hal_kit_cdc_init(void* hal, ATCAIfaceCfg* cfg)
  */
 ATCA_STATUS hal_kit_cdc_post_init(ATCAIface iface)
 {
-	ATCA_STATUS status = ATCA_SUCCESS;
 	atcacdc_t* phaldat = atgetifacehaldat(iface);
-	ATCAIfaceCfg *cfg = atgetifacecfg(iface);
-	int cdcid = cfg->atcauart.port;
-	int i = 0;
 
-	// Init all kit USB devices
-	for (i = 0; i < phaldat->num_kits_found; i++) {
-		// Set the port
-		cfg->atcauart.port = i;
-		// Perform the kit protocol init
-		status = kit_init(iface);
-		if (status != ATCA_SUCCESS)
-			return status;
-	}
+	if (phaldat == NULL)
+		return ATCA_BAD_PARAM;
 
-	return status;
+	// Perform the kit protocol init of the kit on this port
+	return kit_init(iface);
+}
+
+/** \brief waits until the port can be read or written, no later than
+ *         end_ms (see atca_deadline.h)
+ *  \param[in] fd port handle
+ *  \param[in] events POLLIN or POLLOUT
+ *  \param[in] end_ms atca_deadline_now_ms() time to give up at
+ *  \return ATCA_SUCCESS, ATCA_TIMEOUT or ATCA_COMM_FAIL
+ */
+static ATCA_STATUS kit_phy_wait(int fd, short events, uint64_t end_ms)
+{
+	struct pollfd pfd;
+	uint64_t now_ms;
+	int ret;
+
+	pfd.fd = fd;
+	pfd.events = events;
+	for (;;) {
+		now_ms = atca_deadline_now_ms();
+		if (now_ms >= end_ms)
+			return ATCA_TIMEOUT;
+		pfd.revents = 0;
+		ret = poll(&pfd, 1, (int)(end_ms - now_ms));
+		if (ret > 0)
+			return (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) ? ATCA_COMM_FAIL : ATCA_SUCCESS;
+		if (ret < 0 && errno != EINTR)
+			return ATCA_COMM_FAIL;
+	}
 }
 
 /** \brief HAL implementation of send over USB CDC
@@ -201,21 +231,40 @@ ATCA_STATUS kit_phy_send(ATCAIface iface, uint8_t* txdata, int txlength)
 	ATCAIfaceCfg *cfg = atgetifacecfg(iface);
 	int cdcid = cfg->atcauart.port;
 	atcacdc_t* pCdc = (atcacdc_t*)atgetifacehaldat(iface);
-	size_t bytesWritten = 0;
+	uint64_t end_ms = atca_deadline_now_ms() + atca_deadline_remaining_ms();
+	ssize_t bytesWritten = 0;
+	int fd;
 
-#ifdef KIT_DEBUG
-	printf("--> %s", txdata );
-#endif
+	ATCA_LOG_D(ATCA_LOG_HAL, "--> %s", txdata);
 	// Verify the input parameters
 	if ((txdata == NULL) || (pCdc == NULL))
 		return ATCA_BAD_PARAM;
 
 	// Verify the write handle
-	if (pCdc->kits[cdcid].write_handle == INVALID_HANDLE_VALUE)
+	fd = pCdc->kits[cdcid].write_handle;
+	if (fd == INVALID_HANDLE_VALUE)
 		return ATCA_COMM_FAIL;
 
-	// Write the bytes to the specified com port
-	bytesWritten = write(pCdc->kits[cdcid].write_handle, txdata, txlength);
+	// The kit may still be sending the response that timed out, it would be taken for this one
+	if (pCdc->kits[cdcid].stale) {
+		tcflush(pCdc->kits[cdcid].read_handle, TCIFLUSH);
+		pCdc->kits[cdcid].stale = 0;
+	}
+
+	// Write the bytes to the specified com port, within the deadline
+	while (txlength > 0) {
+		status = kit_phy_wait(fd, POLLOUT, end_ms);
+		if (status != ATCA_SUCCESS)
+			return status == ATCA_TIMEOUT ? ATCA_TX_TIMEOUT : status;
+		bytesWritten = write(fd, txdata, txlength);
+		if (bytesWritten < 0) {
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+			return ATCA_TX_FAIL;
+		}
+		txdata += bytesWritten;
+		txlength -= (int)bytesWritten;
+	}
 
 	return status;
 }
@@ -234,7 +283,8 @@ ATCA_STATUS kit_phy_receive(ATCAIface iface, uint8_t* rxdata, int* rxsize)
 	atcacdc_t* pCdc = (atcacdc_t*)atgetifacehaldat(iface);
 	uint8_t buffer[CDC_BUFFER_MAX] = { 0 };
 	bool continue_read = true;
-	int bytes_read = 0;
+	uint64_t end_ms = atca_deadline_now_ms() + atca_deadline_remaining_ms();
+	ssize_t bytes_read = 0;
 	uint16_t total_bytes = 0;
 	char* location = NULL;
 	int bytes_remain = 0;
@@ -251,19 +301,28 @@ ATCA_STATUS kit_phy_receive(ATCAIface iface, uint8_t* rxdata, int* rxsize)
 			status = ATCA_COMM_FAIL;
 			break;
 		}
-		// Read all of the bytes
+		// Read all of the bytes, a kit that stops answering fails the read at the deadline
 		while (continue_read == true) {
+			status = kit_phy_wait(pCdc->kits[cdcid].read_handle, POLLIN, end_ms);
+			if (status != ATCA_SUCCESS)
+				break;
 			bytes_read = read(pCdc->kits[cdcid].read_handle, buffer, CDC_BUFFER_MAX);
+			if (bytes_read < 0 && (errno == EINTR || errno == EAGAIN))
+				continue;
+			if (bytes_read <= 0) {
+				status = ATCA_COMM_FAIL;
+				break;
+			}
 
 			// Find the location of the '\n' character in read buffer
 			// todo: generalize this read...  it only applies if there is an ascii protocol with an <eom> of \n and if the <eom> exists
-			location = strchr((char*)&buffer[0], '\n');
+			location = memchr(buffer, '\n', bytes_read);
 			if (location == NULL)
 				// Copy all of the bytes
-				bytes_to_cpy = bytes_read;
+				bytes_to_cpy = (int)bytes_read;
 			else{
 				// Copy only the bytes remaining in the read buffer to the <eom>
-				bytes_to_cpy = (uint8_t)(location - (char*)buffer) + 1;
+				bytes_to_cpy = (int)(location - (char*)buffer) + 1;
 				// The response has been received, stop receiving more data
 				continue_read = false;
 			}
@@ -277,13 +336,17 @@ ATCA_STATUS kit_phy_receive(ATCAIface iface, uint8_t* rxdata, int* rxsize)
 			memcpy(&rxdata[total_bytes], &buffer[0], bytes_to_cpy);
 			total_bytes += bytes_to_cpy;
 		}
+		if (status == ATCA_TIMEOUT) {
+			pCdc->kits[cdcid].stale = 1;
+			// Part of the response came in, the kit did not finish it
+			if (total_bytes > 0)
+				status = ATCA_RX_FAIL;
+		}
 
 	} while (0);
 
 	*rxsize = total_bytes;
-#ifdef KIT_DEBUG
-	printf("<-- %s", rxdata );
-#endif
+	ATCA_LOG_D(ATCA_LOG_HAL, "<-- %s", rxdata);
 	return status;
 }
 
@@ -293,7 +356,12 @@ ATCA_STATUS kit_phy_receive(ATCAIface iface, uint8_t* rxdata, int* rxsize)
  */
 ATCA_STATUS hal_kit_phy_num_found(int8_t* num_found)
 {
-	*num_found = _gCdc.num_kits_found;
+	int i = 0;
+
+	*num_found = 0;
+	for (i = 0; i < CDC_DEVICES_MAX; i++)
+		if (_gCdc[i].kits[i].read_handle != INVALID_HANDLE_VALUE && _gCdc[i].num_kits_found > 0)
+			(*num_found)++;
 	return ATCA_SUCCESS;
 }
 
@@ -59,6 +59,7 @@ typedef int HANDLE;
 typedef struct cdc_device {
 	HANDLE read_handle;         //! The kit USB read file handle
 	HANDLE write_handle;        //! The kit USB write file handle
+	int stale;                  //! A response timed out, its rest is dropped before the next command
 } cdc_device_t;
 
 
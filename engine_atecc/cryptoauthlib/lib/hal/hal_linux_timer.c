@@ -45,6 +45,7 @@
 #include <stdio.h>
 #include <time.h>
 #include "atca_hal.h"
+#include "atca_trace.h"
 
 /** \defgroup hal_ Hardware abstraction layer (hal_)
  *
@@ -89,7 +90,9 @@ void atca_delay_10us(uint32_t delay)
 /* ASF already has delay_ms - see delay.h */
 void atca_delay_ms(uint32_t delay)
 {
+	ATCA_TRACE_BEGIN("hal", "delay", delay);
 	atca_delay_us(round(delay / 1.0e3));
+	ATCA_TRACE_END("hal", "delay", delay);
 }
 
 /** @} */
@@ -46,6 +46,8 @@
 #include "kit_phy.h"
 #include "kit_protocol.h"
 #include "basic/atca_helpers.h"
+#include "atca_trace.h"
+#include "atca_log.h"
 
 /** \defgroup hal_ Hardware abstraction layer (hal_)
  *
@@ -78,11 +80,12 @@ ATCA_STATUS kit_init(ATCAIface iface)
 
 	// Send the address bytes
 	status = kit_phy_send(iface, address, addresssize);
+	if (status != ATCA_SUCCESS) return status;
 
 	// Receive the reply to address "...(C0)\n"
 	memset(reply, 0, replysize);
 	status = kit_phy_receive(iface, reply, &replysize);
-	if (status != ATCA_SUCCESS) return ATCA_GEN_FAIL;
+	if (status != ATCA_SUCCESS) return status;
 
 	if (replysize == 4) {
 		// Probably an error
@@ -104,11 +107,12 @@ ATCA_STATUS kit_init(ATCAIface iface)
 	memcpy(&selectaddress[(copysize - 1)], selectaddresspost, sizeof(selectaddresspost));
 	copysize = (sizeof(selectaddresspre) + rxsize + sizeof(selectaddresspost));
 	status = kit_phy_send(iface, selectaddress, copysize);
+	if (status != ATCA_SUCCESS) return status;
 
 	// Receive the reply to select address "00()\n"
 	memset(reply, 0, replysize);
 	status = kit_phy_receive(iface, reply, &replysize);
-	if (status != ATCA_SUCCESS) return ATCA_GEN_FAIL;
+	if (status != ATCA_SUCCESS) return status;
 
 	return status;
 }
@@ -121,6 +125,7 @@ ATCA_STATUS kit_init(ATCAIface iface)
  */
 ATCA_STATUS kit_send(ATCAIface iface, uint8_t* txdata, int txlength)
 {
+	ATCA_TRACE_SCOPE("kit", "send");
 	ATCA_STATUS status = ATCA_SUCCESS;
 	int nkitbuf = txlength * 2 + KIT_TX_WRAP_SIZE;
 	char* pkitbuf = NULL;
@@ -139,10 +144,7 @@ ATCA_STATUS kit_send(ATCAIface iface, uint8_t* txdata, int txlength)
 	// Send the bytes
 	status = kit_phy_send(iface, pkitbuf, nkitbuf);
 
-#ifdef KIT_DEBUG
-	// Print the bytes
-	printf("\nKit Write: %s", pkitbuf);
-#endif
+	ATCA_LOG_D(ATCA_LOG_HAL, "Kit Write: %s", pkitbuf);
 
 	// Free the bytes
 	free(pkitbuf);
@@ -158,6 +160,7 @@ ATCA_STATUS kit_send(ATCAIface iface, uint8_t* txdata, int txlength)
  */
 ATCA_STATUS kit_receive(ATCAIface iface, uint8_t* rxdata, uint16_t* rxsize)
 {
+	ATCA_TRACE_SCOPE("kit", "receive");
 	ATCA_STATUS status = ATCA_SUCCESS;
 	uint8_t kitstatus = 0;
 	int nkitbuf = 0;
@@ -178,13 +181,10 @@ ATCA_STATUS kit_receive(ATCAIface iface, uint8_t* rxdata, uint16_t* rxsize)
 	status = kit_phy_receive(iface, pkitbuf, &nkitbuf);
 	if (status != ATCA_SUCCESS) {
 		free(pkitbuf);
-		return ATCA_GEN_FAIL;
+		return status;
 	}
 
-#ifdef KIT_DEBUG
-	// Print the bytes
-	printf("Kit Read: %s\r", pkitbuf);
-#endif
+	ATCA_LOG_D(ATCA_LOG_HAL, "Kit Read: %s", pkitbuf);
 
 	// Unwrap from kit protocol
 	memset(rxdata, 0, *rxsize);
@@ -214,21 +214,16 @@ ATCA_STATUS kit_wake(ATCAIface iface)
 
 	// Send the bytes
 	status = kit_phy_send(iface, wake, wakesize);
+	if (status != ATCA_SUCCESS) return status;
 
-#ifdef KIT_DEBUG
-	// Print the bytes
-	printf("\nKit Write: %s", wake);
-#endif
+	ATCA_LOG_D(ATCA_LOG_HAL, "Kit Write: %s", wake);
 
 	// Receive the reply to wake "00(04...)\n"
 	memset(reply, 0, replysize);
 	status = kit_phy_receive(iface, reply, &replysize);
-	if (status != ATCA_SUCCESS) return ATCA_GEN_FAIL;
+	if (status != ATCA_SUCCESS) return status;
 
-#ifdef KIT_DEBUG
-	// Print the bytes
-	printf("Kit Read: %s\n", reply);
-#endif
+	ATCA_LOG_D(ATCA_LOG_HAL, "Kit Read: %s", reply);
 
 	// Unwrap from kit protocol
 	memset(rxdata, 0, rxsize);
@@ -254,21 +249,16 @@ ATCA_STATUS kit_idle(ATCAIface iface)
 
 	// Send the bytes
 	status = kit_phy_send(iface, idle, idlesize);
+	if (status != ATCA_SUCCESS) return status;
 
-#ifdef KIT_DEBUG
-	// Print the bytes
-	printf("\nKit Write: %s", idle);
-#endif
+	ATCA_LOG_D(ATCA_LOG_HAL, "Kit Write: %s", idle);
 
 	// Receive the reply to sleep "00()\n"
 	memset(reply, 0, replysize);
 	status = kit_phy_receive(iface, reply, &replysize);
-	if (status != ATCA_SUCCESS) return ATCA_GEN_FAIL;
+	if (status != ATCA_SUCCESS) return status;
 
-#ifdef KIT_DEBUG
-	// Print the bytes
-	printf("Kit Read: %s\r", reply);
-#endif
+	ATCA_LOG_D(ATCA_LOG_HAL, "Kit Read: %s", reply);
 
 	// Unwrap from kit protocol
 	memset(rxdata, 0, rxsize);
@@ -294,21 +284,16 @@ ATCA_STATUS kit_sleep(ATCAIface iface)
 
 	// Send the bytes
 	status = kit_phy_send(iface, sleep, sleepsize);
+	if (status != ATCA_SUCCESS) return status;
 
-#ifdef KIT_DEBUG
-	// Print the bytes
-	printf("\nKit Write: %s", sleep);
-#endif
+	ATCA_LOG_D(ATCA_LOG_HAL, "Kit Write: %s", sleep);
 
 	// Receive the reply to sleep "00()\n"
 	memset(reply, 0, replysize);
 	status = kit_phy_receive(iface, reply, &replysize);
-	if (status != ATCA_SUCCESS) return ATCA_GEN_FAIL;
+	if (status != ATCA_SUCCESS) return status;
 
-#ifdef KIT_DEBUG
-	// Print the bytes
-	printf("Kit Read: %s\r", reply);
-#endif
+	ATCA_LOG_D(ATCA_LOG_HAL, "Kit Read: %s", reply);
 
 	// Unwrap from kit protocol
 	memset(rxdata, 0, rxsize);
@@ -86,20 +86,14 @@ uint8_t *atcah_include_data(struct atca_include_data_in_out *param)
 	return param->p_temp;
 }
 
-/** \brief This function calculates a 32-byte nonce based on a 20-byte input value (param->num_in) and 32-byte random number (param->rand_out).
-
-   This nonce will match with the nonce generated in the device when executing a Nonce command.
-   To use this function, an application first sends a Nonce command with a chosen param->num_in to the device.
-   Nonce Mode parameter must be set to use random nonce (mode 0 or 1).\n
-   The device generates a nonce, stores it in its TempKey, and outputs the random number param->rand_out it used in the hash calculation to the host.
-   The values of param->rand_out and param->num_in are passed to this nonce calculation function. The function calculates the nonce and returns it.
-   This function can also be used to fill in the nonce directly to TempKey (pass-through mode). The flags will automatically be set according to the mode used.
-    \param[in, out] param pointer to parameter structure
-    \return status of the operation
+/** \brief Checks the Nonce parameters and builds the message hashed by a random Nonce.
+ * \param[in]  param    pointer to parameter structure
+ * \param[out] message  ATCA_MSG_SIZE_NONCE byte buffer for the message
+ * \param[out] digest   where the hash of message must go, NULL when no hash is required
+ * \return status of the operation
  */
-ATCA_STATUS atcah_nonce(struct atca_nonce_in_out *param)
+static ATCA_STATUS atcah_nonce_prepare(struct atca_nonce_in_out *param, uint8_t *message, uint8_t **digest)
 {
-	uint8_t temporary[ATCA_MSG_SIZE_NONCE];
 	uint8_t *p_temp;
 
 	// Check parameters
@@ -107,10 +101,10 @@ ATCA_STATUS atcah_nonce(struct atca_nonce_in_out *param)
 	    || (((param->mode == NONCE_MODE_SEED_UPDATE || (param->mode == NONCE_MODE_NO_SEED_UPDATE)) && !param->rand_out)))
 		return ATCA_BAD_PARAM;
 
-	// Calculate or pass-through the nonce to TempKey->Value
+	*digest = NULL;
 	if ((param->mode == NONCE_MODE_SEED_UPDATE) || (param->mode == NONCE_MODE_NO_SEED_UPDATE)) {
 		// Calculate nonce using SHA-256 (refer to data sheet)
-		p_temp = temporary;
+		p_temp = message;
 
 		memcpy(p_temp, param->rand_out, NONCE_RSP_SIZE_LONG - ATCA_PACKET_OVERHEAD);
 		p_temp += NONCE_RSP_SIZE_LONG - ATCA_PACKET_OVERHEAD;
@@ -122,9 +116,18 @@ ATCA_STATUS atcah_nonce(struct atca_nonce_in_out *param)
 		*p_temp++ = param->mode;
 		*p_temp++ = 0x00;
 
-		// Calculate SHA256 to get the nonce
-		atcah_sha256(ATCA_MSG_SIZE_NONCE, temporary, param->temp_key->value);
+		*digest = param->temp_key->value;
+	}
+
+	return ATCA_SUCCESS;
+}
 
+/** \brief Updates TempKey once the Nonce digest (if any) has been stored.
+ * \param[in, out] param pointer to parameter structure
+ */
+static void atcah_nonce_finish(struct atca_nonce_in_out *param)
+{
+	if ((param->mode == NONCE_MODE_SEED_UPDATE) || (param->mode == NONCE_MODE_NO_SEED_UPDATE)) {
 		// Update TempKey->SourceFlag to 0 (random)
 		param->temp_key->source_flag = 0;
 	}else if (param->mode == NONCE_MODE_PASSTHROUGH) {
@@ -140,22 +143,46 @@ ATCA_STATUS atcah_nonce(struct atca_nonce_in_out *param)
 	param->temp_key->gen_data = 0;
 	param->temp_key->check_flag = 0;
 	param->temp_key->valid = 1;
-
-	return ATCA_SUCCESS;
 }
 
+/** \brief This function calculates a 32-byte nonce based on a 20-byte input value (param->num_in) and 32-byte random number (param->rand_out).
 
-/** \brief This function generates an SHA-256 digest (MAC) of a key, challenge, and other information.
+   This nonce will match with the nonce generated in the device when executing a Nonce command.
+   To use this function, an application first sends a Nonce command with a chosen param->num_in to the device.
+   Nonce Mode parameter must be set to use random nonce (mode 0 or 1).\n
+   The device generates a nonce, stores it in its TempKey, and outputs the random number param->rand_out it used in the hash calculation to the host.
+   The values of param->rand_out and param->num_in are passed to this nonce calculation function. The function calculates the nonce and returns it.
+   This function can also be used to fill in the nonce directly to TempKey (pass-through mode). The flags will automatically be set according to the mode used.
+    \param[in, out] param pointer to parameter structure
+    \return status of the operation
+ */
+ATCA_STATUS atcah_nonce(struct atca_nonce_in_out *param)
+{
+	uint8_t temporary[ATCA_MSG_SIZE_NONCE];
+	uint8_t *digest;
+	ATCA_STATUS status;
 
-   The resulting digest will match with the one generated by the device when executing a MAC command.
-   The TempKey (if used) should be valid (temp_key.valid = 1) before executing this function.
+	if ((status = atcah_nonce_prepare(param, temporary, &digest)) != ATCA_SUCCESS)
+		return status;
 
- * \param[in, out] param pointer to parameter structure
+	// Calculate SHA256 to get the nonce
+	if (digest)
+		atcah_sha256(ATCA_MSG_SIZE_NONCE, temporary, digest);
+
+	atcah_nonce_finish(param);
+
+	return ATCA_SUCCESS;
+}
+
+
+/** \brief Checks the MAC parameters and TempKey state, then builds the message to be hashed.
+ * \param[in, out] param    pointer to parameter structure
+ * \param[out]     message  ATCA_MSG_SIZE_MAC byte buffer for the message
+ * \param[out]     digest   where the hash of message must go
  * \return status of the operation
  */
-ATCA_STATUS atcah_mac(struct atca_mac_in_out *param)
+static ATCA_STATUS atcah_mac_prepare(struct atca_mac_in_out *param, uint8_t *message, uint8_t **digest)
 {
-	uint8_t temporary[ATCA_MSG_SIZE_MAC];
 	uint8_t *p_temp;
 	struct atca_include_data_in_out include_data;
 
@@ -189,7 +216,7 @@ ATCA_STATUS atcah_mac(struct atca_mac_in_out *param)
 	}
 
 	// Start calculation
-	p_temp = temporary;
+	p_temp = message;
 
 	// (1) first 32 bytes
 	memcpy(p_temp, param->mode & MAC_MODE_BLOCK1_TEMPKEY ? param->temp_key->value : param->key, ATCA_KEY_SIZE);                // use Key[KeyID]
@@ -212,12 +239,42 @@ ATCA_STATUS atcah_mac(struct atca_mac_in_out *param)
 	include_data.p_temp = p_temp;
 	atcah_include_data(&include_data);
 
-	// Calculate SHA256 to get the MAC digest
-	atcah_sha256(ATCA_MSG_SIZE_MAC, temporary, param->response);
+	*digest = param->response;
 
+	return ATCA_SUCCESS;
+}
+
+/** \brief Updates TempKey once the MAC digest has been stored.
+ * \param[in, out] param pointer to parameter structure
+ */
+static void atcah_mac_finish(struct atca_mac_in_out *param)
+{
 	// Update TempKey fields
 	if (param->temp_key)
 		param->temp_key->valid = 0;
+}
+
+/** \brief This function generates an SHA-256 digest (MAC) of a key, challenge, and other information.
+
+   The resulting digest will match with the one generated by the device when executing a MAC command.
+   The TempKey (if used) should be valid (temp_key.valid = 1) before executing this function.
+
+ * \param[in, out] param pointer to parameter structure
+ * \return status of the operation
+ */
+ATCA_STATUS atcah_mac(struct atca_mac_in_out *param)
+{
+	uint8_t temporary[ATCA_MSG_SIZE_MAC];
+	uint8_t *digest;
+	ATCA_STATUS status;
+
+	if ((status = atcah_mac_prepare(param, temporary, &digest)) != ATCA_SUCCESS)
+		return status;
+
+	// Calculate SHA256 to get the MAC digest
+	atcah_sha256(ATCA_MSG_SIZE_MAC, temporary, digest);
+
+	atcah_mac_finish(param);
 
 	return ATCA_SUCCESS;
 }
@@ -425,22 +482,14 @@ ATCA_STATUS atcah_hmac(struct atca_hmac_in_out *param)
 }
 
 
-/** \brief This function combines the current TempKey with a stored value.
-
-   The stored value can be a data slot, OTP page, configuration zone, or hardware transport key.
-   The TempKey generated by this function will match with the TempKey in the device generated
-   when executing a GenDig command.
-   The TempKey should be valid (temp_key.valid = 1) before executing this function.
-   To use this function, an application first sends a GenDig command with a chosen stored value to the device.
-   This stored value must be known by the application and is passed to this GenDig calculation function.
-   The function calculates a new TempKey and returns it.
-
- * \param[in, out] param pointer to parameter structure
+/** \brief Checks the GenDig parameters and TempKey state, then builds the message to be hashed.
+ * \param[in, out] param    pointer to parameter structure
+ * \param[out]     message  ATCA_MSG_SIZE_GEN_DIG byte buffer for the message
+ * \param[out]     digest   where the hash of message must go
  * \return status of the operation
  */
-ATCA_STATUS atcah_gen_dig(struct atca_gen_dig_in_out *param)
+static ATCA_STATUS atcah_gen_dig_prepare(struct atca_gen_dig_in_out *param, uint8_t *message, uint8_t **digest)
 {
-	uint8_t temporary[ATCA_MSG_SIZE_GEN_DIG];
 	uint8_t *p_temp;
 
 	// Check parameters
@@ -461,7 +510,7 @@ ATCA_STATUS atcah_gen_dig(struct atca_gen_dig_in_out *param)
 	}
 
 	// Start calculation
-	p_temp = temporary;
+	p_temp = message;
 
 	// (1) 32 bytes inputKey
 	//     (Config[KeyID] or OTP[KeyID] or Data.slot[KeyID] or TransportKey[KeyID])
@@ -492,9 +541,16 @@ ATCA_STATUS atcah_gen_dig(struct atca_gen_dig_in_out *param)
 	// (8) 32 bytes TempKey
 	memcpy(p_temp, param->temp_key->value, ATCA_KEY_SIZE);
 
-	// Calculate SHA256 to get the new TempKey
-	atcah_sha256(ATCA_MSG_SIZE_GEN_DIG, temporary, param->temp_key->value);
+	*digest = param->temp_key->value;
+
+	return ATCA_SUCCESS;
+}
 
+/** \brief Updates TempKey once the new GenDig TempKey value has been stored.
+ * \param[in, out] param pointer to parameter structure
+ */
+static void atcah_gen_dig_finish(struct atca_gen_dig_in_out *param)
+{
 	// Update TempKey fields
 	param->temp_key->valid = 1;
 
@@ -505,6 +561,34 @@ ATCA_STATUS atcah_gen_dig(struct atca_gen_dig_in_out *param)
 		param->temp_key->gen_data = 0;
 		param->temp_key->key_id = 0;
 	}
+}
+
+/** \brief This function combines the current TempKey with a stored value.
+
+   The stored value can be a data slot, OTP page, configuration zone, or hardware transport key.
+   The TempKey generated by this function will match with the TempKey in the device generated
+   when executing a GenDig command.
+   The TempKey should be valid (temp_key.valid = 1) before executing this function.
+   To use this function, an application first sends a GenDig command with a chosen stored value to the device.
+   This stored value must be known by the application and is passed to this GenDig calculation function.
+   The function calculates a new TempKey and returns it.
+
+ * \param[in, out] param pointer to parameter structure
+ * \return status of the operation
+ */
+ATCA_STATUS atcah_gen_dig(struct atca_gen_dig_in_out *param)
+{
+	uint8_t temporary[ATCA_MSG_SIZE_GEN_DIG];
+	uint8_t *digest;
+	ATCA_STATUS status;
+
+	if ((status = atcah_gen_dig_prepare(param, temporary, &digest)) != ATCA_SUCCESS)
+		return status;
+
+	// Calculate SHA256 to get the new TempKey
+	atcah_sha256(ATCA_MSG_SIZE_GEN_DIG, temporary, digest);
+
+	atcah_gen_dig_finish(param);
 
 	return ATCA_SUCCESS;
 }
@@ -580,19 +664,16 @@ ATCA_STATUS atcah_gen_mac(struct atca_gen_dig_in_out *param)
 	return ATCA_SUCCESS;
 }
 
-/** \brief This function calculates the input MAC for the PrivWrite command.
-
-   The PrivWrite command will need an input MAC if SlotConfig.WriteConfig.Encrypt is set.
-
- * \param[in, out] param pointer to parameter structure
+/** \brief Checks the PrivWrite parameters and TempKey state, encrypts the data and builds the input MAC message.
+ * \param[in, out] param    pointer to parameter structure
+ * \param[out]     message  ATCA_MSG_SIZE_PRIVWRITE_MAC byte buffer for the message
+ * \param[out]     digest   where the hash of message must go, NULL when no input MAC was requested
  * \return status of the operation
  */
-ATCA_STATUS atcah_write_auth_mac(struct atca_write_mac_in_out *param)
+static ATCA_STATUS atcah_write_auth_mac_prepare(struct atca_write_mac_in_out *param, uint8_t *message, uint8_t **digest)
 {
-	uint8_t temporary[ATCA_MSG_SIZE_PRIVWRITE_MAC];
 	uint8_t i;
 	uint8_t *p_temp;
-	uint8_t session_key2[32];
 
 	// Check parameters
 	if (!param->input_data || !param->temp_key)
@@ -610,13 +691,12 @@ ATCA_STATUS atcah_write_auth_mac(struct atca_write_mac_in_out *param)
 	for (i = 0; i < 32; i++)
 		param->encrypted_data[i] = param->encryption_key[i] ^ param->temp_key->value[i];
 
-	// Calculate the new tempkey
-	atcah_sha256(32, param->temp_key->value, session_key2);
+	*digest = NULL;
 
 	// If the pointer *mac is provided by the caller then calculate input MAC
 	if (param->auth_mac) {
 		// Start calculation
-		p_temp = temporary;
+		p_temp = message;
 
 		// (1) 32 bytes TempKey
 		memcpy(p_temp, param->temp_key->value, ATCA_KEY_SIZE);
@@ -646,11 +726,42 @@ ATCA_STATUS atcah_write_auth_mac(struct atca_write_mac_in_out *param)
 		// (8) 36 bytes PlainText : 0 0 0 0 (4bytes) | private_key (32bytes)
 		memcpy(p_temp, param->input_data, ATCA_PLAIN_TEXT_SIZE);
 
-		// Calculate SHA256 to get the new TempKey
-		atcah_sha256(ATCA_MSG_SIZE_PRIVWRITE_MAC, temporary, param->auth_mac);
+		*digest = param->auth_mac;
 	}
+
+	return ATCA_SUCCESS;
+}
+
+/** \brief Updates TempKey once the input MAC (if any) has been stored.
+ * \param[in, out] param pointer to parameter structure
+ */
+static void atcah_write_auth_mac_finish(struct atca_write_mac_in_out *param)
+{
 	// Update TempKey fields
 	param->temp_key->valid = 1;
+}
+
+/** \brief This function calculates the input MAC for the PrivWrite command.
+
+   The PrivWrite command will need an input MAC if SlotConfig.WriteConfig.Encrypt is set.
+
+ * \param[in, out] param pointer to parameter structure
+ * \return status of the operation
+ */
+ATCA_STATUS atcah_write_auth_mac(struct atca_write_mac_in_out *param)
+{
+	uint8_t temporary[ATCA_MSG_SIZE_PRIVWRITE_MAC];
+	uint8_t *digest;
+	ATCA_STATUS status;
+
+	if ((status = atcah_write_auth_mac_prepare(param, temporary, &digest)) != ATCA_SUCCESS)
+		return status;
+
+	// Calculate SHA256 to get the input MAC
+	if (digest)
+		atcah_sha256(ATCA_MSG_SIZE_PRIVWRITE_MAC, temporary, digest);
+
+	atcah_write_auth_mac_finish(param);
 
 	return ATCA_SUCCESS;
 }
@@ -1034,3 +1145,158 @@ ATCA_STATUS atcah_sha256(int32_t len, const uint8_t *message, uint8_t *digest)
 	return atcac_sw_sha2_256(message, len, digest);
 }
 
+
+/** \brief This function creates the SHA256 digests of several independent messages at once.
+ *
+ * \param[in] messages array of pointers to the messages
+ * \param[in] lens byte length of each message
+ * \param[in] count number of messages
+ * \param[out] digests SHA256 of each message, in the same order
+ */
+ATCA_STATUS atcah_sha256_mb(const uint8_t * const messages[], const size_t lens[], size_t count, uint8_t digests[][ATCA_SHA_DIGEST_SIZE])
+{
+	return atcac_sw_sha2_256_mb(messages, lens, count, digests);
+}
+
+//! Number of parameter structures whose messages are hashed together by the atcah_*_batch() functions
+#define ATCAH_BATCH_SIZE    (16)
+
+//! Largest message built by a batchable calculation
+#define ATCAH_BATCH_MSG_MAX (ATCA_MSG_SIZE_GEN_DIG)
+
+typedef ATCA_STATUS (*atcah_batch_prepare_fn)(void *param, uint8_t *message, uint8_t **digest);
+typedef void (*atcah_batch_finish_fn)(void *param);
+
+/** \brief Runs a host side calculation over an array of parameter structures, hashing the
+ *         messages of up to ATCAH_BATCH_SIZE structures together.
+ *
+ * The structures are processed as if the single call had been made on each of them in turn,
+ * except that all messages of a batch are built before any digest is stored. The structures
+ * must therefore not share a TempKey or output buffer.
+ *
+ * \param[in, out] params      array of parameter structures
+ * \param[in]      param_size  size of one parameter structure
+ * \param[in]      count       number of parameter structures
+ * \param[in]      msg_size    size of the message built by prepare
+ * \param[in]      prepare     checks one structure and builds its message
+ * \param[in]      finish      updates one structure once its digest was stored
+ * \return ATCA_SUCCESS, or the status of the first structure that failed
+ */
+static ATCA_STATUS atcah_batch(void *params, size_t param_size, size_t count, size_t msg_size,
+                               atcah_batch_prepare_fn prepare, atcah_batch_finish_fn finish)
+{
+	uint8_t messages[ATCAH_BATCH_SIZE][ATCAH_BATCH_MSG_MAX];
+	uint8_t digests[ATCAH_BATCH_SIZE][ATCA_SHA_DIGEST_SIZE];
+	const uint8_t *msg_ptrs[ATCAH_BATCH_SIZE];
+	size_t msg_sizes[ATCAH_BATCH_SIZE];
+	uint8_t *outputs[ATCAH_BATCH_SIZE];
+	void *prepared[ATCAH_BATCH_SIZE];
+	ATCA_STATUS status = ATCA_SUCCESS;
+	ATCA_STATUS ret;
+	size_t start, i, hashes, ready;
+	void *param;
+
+	if (!params || msg_size > ATCAH_BATCH_MSG_MAX)
+		return ATCA_BAD_PARAM;
+
+	for (start = 0; start < count; start += ATCAH_BATCH_SIZE) {
+		hashes = 0;
+		ready = 0;
+		for (i = start; i < count && i < start + ATCAH_BATCH_SIZE; i++) {
+			param = (uint8_t*)params + i * param_size;
+			ret = prepare(param, messages[hashes], &outputs[hashes]);
+			if (ret != ATCA_SUCCESS) {
+				if (status == ATCA_SUCCESS)
+					status = ret;
+				continue;
+			}
+			if (outputs[hashes]) {
+				msg_ptrs[hashes] = messages[hashes];
+				msg_sizes[hashes] = msg_size;
+				hashes++;
+			}
+			prepared[ready++] = param;
+		}
+
+		if (hashes > 0) {
+			ret = atcah_sha256_mb(msg_ptrs, msg_sizes, hashes, digests);
+			if (ret != ATCA_SUCCESS)
+				return ret;
+			for (i = 0; i < hashes; i++)
+				memcpy(outputs[i], digests[i], ATCA_SHA_DIGEST_SIZE);
+		}
+
+		for (i = 0; i < ready; i++)
+			finish(prepared[i]);
+	}
+
+	// Messages and digests hold key material
+	memset(messages, 0, sizeof(messages));
+	memset(digests, 0, sizeof(digests));
+
+	return status;
+}
+
+/** \brief Batch version of atcah_nonce().
+ *
+ * Gives the same results as calling atcah_nonce() on each structure in turn. All messages of a
+ * batch are built before any TempKey is updated, so no two structures may point to the same
+ * temp_key, and their output buffers must not overlap.
+ *
+ * \param[in, out] params array of parameter structures, each with its own TempKey
+ * \param[in]      count  number of parameter structures
+ * \return ATCA_SUCCESS, or the status of the first structure that failed
+ */
+ATCA_STATUS atcah_nonce_batch(struct atca_nonce_in_out *params, size_t count)
+{
+	return atcah_batch(params, sizeof(*params), count, ATCA_MSG_SIZE_NONCE,
+	                   (atcah_batch_prepare_fn)atcah_nonce_prepare, (atcah_batch_finish_fn)atcah_nonce_finish);
+}
+
+/** \brief Batch version of atcah_mac().
+ *
+ * Gives the same results as calling atcah_mac() on each structure in turn. All messages of a
+ * batch are built before any TempKey is updated, so no two structures may point to the same
+ * temp_key, and their output buffers must not overlap.
+ *
+ * \param[in, out] params array of parameter structures, each with its own TempKey
+ * \param[in]      count  number of parameter structures
+ * \return ATCA_SUCCESS, or the status of the first structure that failed
+ */
+ATCA_STATUS atcah_mac_batch(struct atca_mac_in_out *params, size_t count)
+{
+	return atcah_batch(params, sizeof(*params), count, ATCA_MSG_SIZE_MAC,
+	                   (atcah_batch_prepare_fn)atcah_mac_prepare, (atcah_batch_finish_fn)atcah_mac_finish);
+}
+
+/** \brief Batch version of atcah_gen_dig().
+ *
+ * Gives the same results as calling atcah_gen_dig() on each structure in turn. All messages of a
+ * batch are built before any TempKey is updated, so no two structures may point to the same
+ * temp_key, and their output buffers must not overlap.
+ *
+ * \param[in, out] params array of parameter structures, each with its own TempKey
+ * \param[in]      count  number of parameter structures
+ * \return ATCA_SUCCESS, or the status of the first structure that failed
+ */
+ATCA_STATUS atcah_gen_dig_batch(struct atca_gen_dig_in_out *params, size_t count)
+{
+	return atcah_batch(params, sizeof(*params), count, ATCA_MSG_SIZE_GEN_DIG,
+	                   (atcah_batch_prepare_fn)atcah_gen_dig_prepare, (atcah_batch_finish_fn)atcah_gen_dig_finish);
+}
+
+/** \brief Batch version of atcah_write_auth_mac().
+ *
+ * Gives the same results as calling atcah_write_auth_mac() on each structure in turn. All messages of a
+ * batch are built before any TempKey is updated, so no two structures may point to the same
+ * temp_key, and their output buffers must not overlap.
+ *
+ * \param[in, out] params array of parameter structures, each with its own TempKey
+ * \param[in]      count  number of parameter structures
+ * \return ATCA_SUCCESS, or the status of the first structure that failed
+ */
+ATCA_STATUS atcah_write_auth_mac_batch(struct atca_write_mac_in_out *params, size_t count)
+{
+	return atcah_batch(params, sizeof(*params), count, ATCA_MSG_SIZE_PRIVWRITE_MAC,
+	                   (atcah_batch_prepare_fn)atcah_write_auth_mac_prepare, (atcah_batch_finish_fn)atcah_write_auth_mac_finish);
+}
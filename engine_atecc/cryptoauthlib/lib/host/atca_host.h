@@ -443,6 +443,11 @@ ATCA_STATUS atcah_derive_key_mac(struct atca_derive_key_mac_in_out *param);
 ATCA_STATUS atcah_encrypt(struct atca_encrypt_in_out *param);
 ATCA_STATUS atcah_decrypt(struct atca_decrypt_in_out *param);
 ATCA_STATUS atcah_sha256(int32_t len, const uint8_t *message, uint8_t *digest);
+ATCA_STATUS atcah_sha256_mb(const uint8_t * const messages[], const size_t lens[], size_t count, uint8_t digests[][ATCA_SHA_DIGEST_SIZE]);
+ATCA_STATUS atcah_nonce_batch(struct atca_nonce_in_out *params, size_t count);
+ATCA_STATUS atcah_mac_batch(struct atca_mac_in_out *params, size_t count);
+ATCA_STATUS atcah_gen_dig_batch(struct atca_gen_dig_in_out *params, size_t count);
+ATCA_STATUS atcah_write_auth_mac_batch(struct atca_write_mac_in_out *params, size_t count);
 uint8_t *atcah_include_data(struct atca_include_data_in_out *param);
 
 #ifdef __cplusplus
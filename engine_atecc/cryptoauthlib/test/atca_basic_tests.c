@@ -323,8 +323,6 @@ void atca_ecc508a_basic_tests(ATCADeviceType deviceType)
 	RUN_TEST(test_basic_ecdh);
 }
 
-extern ATCADevice _gDevice;
-
 void test_basic_version(void)
 {
 	char verstr[20];
@@ -344,10 +342,10 @@ void test_basic_init(void)
 	status = atcab_init( gCfg );
 
 	TEST_ASSERT_EQUAL( ATCA_SUCCESS, status );
-	TEST_ASSERT_NOT_EQUAL( NULL, _gDevice );
+	TEST_ASSERT_NOT_EQUAL( NULL, atcab_getDevice() );
 
 	status = atcab_release();
-	TEST_ASSERT_EQUAL( NULL, _gDevice );
+	TEST_ASSERT_EQUAL( NULL, atcab_getDevice() );
 }
 
 
@@ -358,15 +356,15 @@ void test_basic_doubleinit(void)
 	// a double init should be benign
 	status = atcab_init( gCfg );
 	TEST_ASSERT_EQUAL( ATCA_SUCCESS, status );
-	TEST_ASSERT_NOT_EQUAL( NULL, _gDevice );
+	TEST_ASSERT_NOT_EQUAL( NULL, atcab_getDevice() );
 
 	status = atcab_init( gCfg );
 
 	TEST_ASSERT_EQUAL( ATCA_SUCCESS, status );
-	TEST_ASSERT_NOT_EQUAL( NULL, _gDevice );
+	TEST_ASSERT_NOT_EQUAL( NULL, atcab_getDevice() );
 
 	status = atcab_release();
-	TEST_ASSERT_EQUAL( NULL, _gDevice );
+	TEST_ASSERT_EQUAL( NULL, atcab_getDevice() );
 }
 
 void test_basic_info(void)
@@ -41,6 +41,11 @@
 #include "atca_crypto_sw_tests.h"
 #include "crypto/atca_crypto_sw_sha1.h"
 #include "crypto/atca_crypto_sw_sha2.h"
+#include "crypto/atca_crypto_sw_ecdsa.h"
+#include "crypto/atca_crypto_sw_rand.h"
+#include "crypto/hashes/sha2_routines.h"
+#include "host/atca_host.h"
+#include <string.h>
 #ifdef WIN32
 #include <stdio.h>
 #include <stdlib.h>
@@ -67,6 +72,15 @@ void atca_crypto_sw_tests(void)
     RUN_TEST(test_atcac_sw_sha2_256_nist_short);
     RUN_TEST(test_atcac_sw_sha2_256_nist_long);
     RUN_TEST(test_atcac_sw_sha2_256_nist_monte);
+    RUN_TEST(test_atcac_sw_sha2_256_impls);
+    RUN_TEST(test_atcac_sw_sha2_256_mb);
+    RUN_TEST(test_atcah_batch);
+
+    RUN_TEST(test_atcac_sw_ecdsa_verify_p256);
+    RUN_TEST(test_atcac_sw_ecdsa_verify_p256_pinned);
+    RUN_TEST(test_atcac_sw_ecdsa_verify_p256_batch);
+
+    RUN_TEST(test_atcac_sw_random);
 }
 
 void test_atcac_sw_sha1_nist1(void)
@@ -448,4 +462,604 @@ void test_atcac_sw_sha2_256_nist_monte(void)
         memcpy(seed, &md[2], sizeof(seed));
     }
 #endif
-}
\ No newline at end of file
+}
+
+void test_atcac_sw_sha2_256_impls(void)
+{
+	static const sw_sha256_impl_t impls[] = {
+		SW_SHA256_IMPL_SHANI, SW_SHA256_IMPL_AVX2, SW_SHA256_IMPL_ARMV8
+	};
+	uint8_t msg[3 * 64 + 7];
+	uint8_t digest_ref[ATCA_SHA2_256_DIGEST_SIZE];
+	uint8_t digest[ATCA_SHA2_256_DIGEST_SIZE];
+	sw_sha256_impl_t saved_impl = sw_sha256_get_impl();
+	size_t i, msg_size;
+
+	for (i = 0; i < sizeof(msg); i++)
+		msg[i] = (uint8_t)(i * 151 + 7);
+
+	// Every accelerated implementation must match the generic one for all message sizes that
+	// exercise the partial, single and multiple block paths
+	for (i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+		if (!sw_sha256_impl_supported(impls[i]))
+			continue;
+		for (msg_size = 0; msg_size <= sizeof(msg); msg_size++) {
+			TEST_ASSERT(sw_sha256_set_impl(SW_SHA256_IMPL_GENERIC));
+			sw_sha256(msg, (unsigned int)msg_size, digest_ref);
+			TEST_ASSERT(sw_sha256_set_impl(impls[i]));
+			sw_sha256(msg, (unsigned int)msg_size, digest);
+			TEST_ASSERT_EQUAL_MEMORY_MESSAGE(digest_ref, digest, sizeof(digest), sw_sha256_impl_name(impls[i]));
+		}
+	}
+
+	sw_sha256_set_impl(saved_impl);
+}
+
+void test_atcac_sw_sha2_256_mb(void)
+{
+	static const sw_sha256_impl_t impls[] = {
+		SW_SHA256_IMPL_GENERIC, SW_SHA256_IMPL_SHANI, SW_SHA256_IMPL_AVX2, SW_SHA256_IMPL_ARMV8
+	};
+	uint8_t msg[300];
+	const uint8_t* messages[37];
+	size_t sizes[37];
+	uint8_t digests[37][ATCA_SHA2_256_DIGEST_SIZE];
+	uint8_t digest_ref[ATCA_SHA2_256_DIGEST_SIZE];
+	sw_sha256_impl_t saved_impl = sw_sha256_get_impl();
+	size_t i, j, count;
+	int ret;
+
+	for (i = 0; i < sizeof(msg); i++)
+		msg[i] = (uint8_t)(i * 151 + 7);
+
+	// Mixed lengths so lanes finish at different times and get refilled, including lengths
+	// around the padding boundary (55, 56, 64)
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		sizes[i] = (i * 37 + 55) % (sizeof(msg) - 20);
+		messages[i] = &msg[i % 20];
+	}
+
+	for (i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+		if (!sw_sha256_impl_supported(impls[i]))
+			continue;
+		TEST_ASSERT(sw_sha256_set_impl(impls[i]));
+		for (count = 0; count <= sizeof(sizes) / sizeof(sizes[0]); count += 9) {
+			memset(digests, 0, sizeof(digests));
+			ret = atcac_sw_sha2_256_mb(messages, sizes, count, digests);
+			TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+			for (j = 0; j < count; j++) {
+				ret = atcac_sw_sha2_256(messages[j], sizes[j], digest_ref);
+				TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+				TEST_ASSERT_EQUAL_MEMORY_MESSAGE(digest_ref, digests[j], sizeof(digest_ref), sw_sha256_impl_name(impls[i]));
+			}
+		}
+	}
+
+	sw_sha256_set_impl(saved_impl);
+}
+
+//! More parameter structures than one atcah_*_batch() hashing round takes
+#define HOST_BATCH_COUNT    (21)
+
+static void host_batch_temp_keys(atca_temp_key_t *keys, size_t count)
+{
+	size_t i, j;
+
+	memset(keys, 0, count * sizeof(*keys));
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < sizeof(keys[i].value); j++)
+			keys[i].value[j] = (uint8_t)(i * 31 + j * 7 + 1);
+		keys[i].valid = 1;
+	}
+}
+
+static void host_batch_assert_temp_key(const atca_temp_key_t *expected, const atca_temp_key_t *actual)
+{
+	TEST_ASSERT_EQUAL_MEMORY(expected->value, actual->value, sizeof(expected->value));
+	TEST_ASSERT_EQUAL(expected->key_id, actual->key_id);
+	TEST_ASSERT_EQUAL(expected->source_flag, actual->source_flag);
+	TEST_ASSERT_EQUAL(expected->gen_data, actual->gen_data);
+	TEST_ASSERT_EQUAL(expected->check_flag, actual->check_flag);
+	TEST_ASSERT_EQUAL(expected->valid, actual->valid);
+}
+
+void test_atcah_batch(void)
+{
+	atca_temp_key_t keys_single[HOST_BATCH_COUNT];
+	atca_temp_key_t keys_batch[HOST_BATCH_COUNT];
+	struct atca_nonce_in_out nonce_single[HOST_BATCH_COUNT];
+	struct atca_nonce_in_out nonce_batch[HOST_BATCH_COUNT];
+	struct atca_mac_in_out mac_single[HOST_BATCH_COUNT];
+	struct atca_mac_in_out mac_batch[HOST_BATCH_COUNT];
+	struct atca_gen_dig_in_out gen_dig_single[HOST_BATCH_COUNT];
+	struct atca_gen_dig_in_out gen_dig_batch[HOST_BATCH_COUNT];
+	struct atca_write_mac_in_out write_single[HOST_BATCH_COUNT];
+	struct atca_write_mac_in_out write_batch[HOST_BATCH_COUNT];
+	uint8_t data[HOST_BATCH_COUNT][ATCA_PLAIN_TEXT_SIZE];
+	uint8_t out_single[HOST_BATCH_COUNT][2][ATCA_KEY_SIZE];
+	uint8_t out_batch[HOST_BATCH_COUNT][2][ATCA_KEY_SIZE];
+	ATCA_STATUS expected, ret;
+	size_t i, j;
+
+	for (i = 0; i < HOST_BATCH_COUNT; i++)
+		for (j = 0; j < ATCA_PLAIN_TEXT_SIZE; j++)
+			data[i][j] = (uint8_t)(i * 13 + j * 3);
+
+	// Nonce, random and pass-through modes mixed, with one bad structure that must not stop the others
+	host_batch_temp_keys(keys_single, HOST_BATCH_COUNT);
+	host_batch_temp_keys(keys_batch, HOST_BATCH_COUNT);
+	for (i = 0; i < HOST_BATCH_COUNT; i++) {
+		nonce_single[i].mode = (i % 3) ? NONCE_MODE_SEED_UPDATE : NONCE_MODE_PASSTHROUGH;
+		nonce_single[i].num_in = (i == 5) ? NULL : data[i];
+		nonce_single[i].rand_out = data[(i + 1) % HOST_BATCH_COUNT];
+		nonce_single[i].temp_key = &keys_single[i];
+		nonce_batch[i] = nonce_single[i];
+		nonce_batch[i].temp_key = &keys_batch[i];
+	}
+	expected = ATCA_SUCCESS;
+	for (i = 0; i < HOST_BATCH_COUNT; i++) {
+		ret = atcah_nonce(&nonce_single[i]);
+		if (expected == ATCA_SUCCESS)
+			expected = ret;
+	}
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, expected);
+	ret = atcah_nonce_batch(nonce_batch, HOST_BATCH_COUNT);
+	TEST_ASSERT_EQUAL(expected, ret);
+	for (i = 0; i < HOST_BATCH_COUNT; i++)
+		host_batch_assert_temp_key(&keys_single[i], &keys_batch[i]);
+
+	// MAC over key and challenge, or over key and the random TempKey left by the nonces
+	memset(out_single, 0, sizeof(out_single));
+	memset(out_batch, 0, sizeof(out_batch));
+	for (i = 0; i < HOST_BATCH_COUNT; i++) {
+		memset(&mac_single[i], 0, sizeof(mac_single[i]));
+		mac_single[i].mode = (i % 3) ? MAC_MODE_BLOCK2_TEMPKEY : 0;
+		mac_single[i].key_id = (uint16_t)i;
+		mac_single[i].key = data[i];
+		mac_single[i].challenge = data[(i + 2) % HOST_BATCH_COUNT];
+		mac_single[i].response = out_single[i][0];
+		mac_single[i].temp_key = &keys_single[i];
+		mac_batch[i] = mac_single[i];
+		mac_batch[i].response = out_batch[i][0];
+		mac_batch[i].temp_key = &keys_batch[i];
+	}
+	for (i = 0; i < HOST_BATCH_COUNT; i++) {
+		ret = atcah_mac(&mac_single[i]);
+		TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	}
+	ret = atcah_mac_batch(mac_batch, HOST_BATCH_COUNT);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	TEST_ASSERT_EQUAL_MEMORY(out_single, out_batch, sizeof(out_single));
+	for (i = 0; i < HOST_BATCH_COUNT; i++)
+		host_batch_assert_temp_key(&keys_single[i], &keys_batch[i]);
+
+	// GenDig over data and config zones
+	host_batch_temp_keys(keys_single, HOST_BATCH_COUNT);
+	host_batch_temp_keys(keys_batch, HOST_BATCH_COUNT);
+	for (i = 0; i < HOST_BATCH_COUNT; i++) {
+		gen_dig_single[i].zone = (i % 2) ? GENDIG_ZONE_DATA : GENDIG_ZONE_CONFIG;
+		gen_dig_single[i].key_id = (uint16_t)i;
+		gen_dig_single[i].stored_value = data[i];
+		gen_dig_single[i].temp_key = &keys_single[i];
+		gen_dig_batch[i] = gen_dig_single[i];
+		gen_dig_batch[i].temp_key = &keys_batch[i];
+	}
+	for (i = 0; i < HOST_BATCH_COUNT; i++) {
+		ret = atcah_gen_dig(&gen_dig_single[i]);
+		TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	}
+	ret = atcah_gen_dig_batch(gen_dig_batch, HOST_BATCH_COUNT);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	for (i = 0; i < HOST_BATCH_COUNT; i++)
+		host_batch_assert_temp_key(&keys_single[i], &keys_batch[i]);
+
+	// PrivWrite encryption, with and without the input MAC
+	memset(out_single, 0, sizeof(out_single));
+	memset(out_batch, 0, sizeof(out_batch));
+	for (i = 0; i < HOST_BATCH_COUNT; i++) {
+		write_single[i].zone = 0x40;
+		write_single[i].key_id = (uint16_t)i;
+		write_single[i].encryption_key = data[(i + 3) % HOST_BATCH_COUNT];
+		write_single[i].input_data = data[i];
+		write_single[i].encrypted_data = out_single[i][0];
+		write_single[i].auth_mac = (i % 4) ? out_single[i][1] : NULL;
+		write_single[i].temp_key = &keys_single[i];
+		write_batch[i] = write_single[i];
+		write_batch[i].encrypted_data = out_batch[i][0];
+		write_batch[i].auth_mac = (i % 4) ? out_batch[i][1] : NULL;
+		write_batch[i].temp_key = &keys_batch[i];
+	}
+	for (i = 0; i < HOST_BATCH_COUNT; i++) {
+		ret = atcah_write_auth_mac(&write_single[i]);
+		TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	}
+	ret = atcah_write_auth_mac_batch(write_batch, HOST_BATCH_COUNT);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	TEST_ASSERT_EQUAL_MEMORY(out_single, out_batch, sizeof(out_single));
+	for (i = 0; i < HOST_BATCH_COUNT; i++)
+		host_batch_assert_temp_key(&keys_single[i], &keys_batch[i]);
+
+	ret = atcah_mac_batch(NULL, 1);
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, ret);
+}
+
+// RFC 6979 A.2.5, P-256 key pair with SHA-256 signatures
+static const uint8_t ecdsa_p256_public_key[] = {
+		0x60, 0xfe, 0xd4, 0xba, 0x25, 0x5a, 0x9d, 0x31, 0xc9, 0x61, 0xeb, 0x74, 0xc6, 0x35, 0x6d, 0x68,
+		0xc0, 0x49, 0xb8, 0x92, 0x3b, 0x61, 0xfa, 0x6c, 0xe6, 0x69, 0x62, 0x2e, 0x60, 0xf2, 0x9f, 0xb6,
+		0x79, 0x03, 0xfe, 0x10, 0x08, 0xb8, 0xbc, 0x99, 0xa4, 0x1a, 0xe9, 0xe9, 0x56, 0x28, 0xbc, 0x64,
+		0xf2, 0xf1, 0xb2, 0x0c, 0x2d, 0x7e, 0x9f, 0x51, 0x77, 0xa3, 0xc2, 0x94, 0xd4, 0x46, 0x22, 0x99
+};
+
+static const uint8_t ecdsa_p256_sig_sample[] = {
+		0xef, 0xd4, 0x8b, 0x2a, 0xac, 0xb6, 0xa8, 0xfd, 0x11, 0x40, 0xdd, 0x9c, 0xd4, 0x5e, 0x81, 0xd6,
+		0x9d, 0x2c, 0x87, 0x7b, 0x56, 0xaa, 0xf9, 0x91, 0xc3, 0x4d, 0x0e, 0xa8, 0x4e, 0xaf, 0x37, 0x16,
+		0xf7, 0xcb, 0x1c, 0x94, 0x2d, 0x65, 0x7c, 0x41, 0xd4, 0x36, 0xc7, 0xa1, 0xb6, 0xe2, 0x9f, 0x65,
+		0xf3, 0xe9, 0x00, 0xdb, 0xb9, 0xaf, 0xf4, 0x06, 0x4d, 0xc4, 0xab, 0x2f, 0x84, 0x3a, 0xcd, 0xa8
+};
+
+static const uint8_t ecdsa_p256_sig_test[] = {
+		0xf1, 0xab, 0xb0, 0x23, 0x51, 0x83, 0x51, 0xcd, 0x71, 0xd8, 0x81, 0x56, 0x7b, 0x1e, 0xa6, 0x63,
+		0xed, 0x3e, 0xfc, 0xf6, 0xc5, 0x13, 0x2b, 0x35, 0x4f, 0x28, 0xd3, 0xb0, 0xb7, 0xd3, 0x83, 0x67,
+		0x01, 0x9f, 0x41, 0x13, 0x74, 0x2a, 0x2b, 0x14, 0xbd, 0x25, 0x92, 0x6b, 0x49, 0xc6, 0x49, 0x15,
+		0x5f, 0x26, 0x7e, 0x60, 0xd3, 0x81, 0x4b, 0x4c, 0x0c, 0xc8, 0x42, 0x50, 0xe4, 0x6f, 0x00, 0x83
+};
+
+//! Signature over "sample" with a 31-byte R, zero padded on the left
+static const uint8_t ecdsa_p256_sig_short_r[] = {
+		0x00, 0x1b, 0x97, 0xfe, 0xee, 0x26, 0xf7, 0x46, 0x84, 0x18, 0x4f, 0x78, 0x3b, 0xce, 0xb2, 0x6d,
+		0xbf, 0x68, 0x46, 0xbf, 0x6b, 0xb5, 0x3f, 0x65, 0xbd, 0xf6, 0x26, 0x21, 0x42, 0xca, 0xb7, 0x07,
+		0xd2, 0x1e, 0x2a, 0x58, 0x50, 0xdf, 0xd3, 0x61, 0x5f, 0x9a, 0x61, 0x84, 0x8f, 0xf4, 0xfd, 0x2d,
+		0xd6, 0x00, 0x40, 0x43, 0xb2, 0xa6, 0x53, 0x1e, 0x6d, 0xa2, 0x7e, 0xff, 0x53, 0x25, 0x84, 0xe6
+};
+
+static const uint8_t ecdsa_p256_order[] = {
+		0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xbc, 0xe6, 0xfa, 0xad, 0xa7, 0x17, 0x9e, 0x84, 0xf3, 0xb9, 0xca, 0xc2, 0xfc, 0x63, 0x25, 0x51
+};
+
+//! Signatures by ecdsa_p256_public_key over SHA-256 of the single byte i
+static const uint8_t ecdsa_p256_sig_bytes[][ATCA_ECC_P256_SIGNATURE_SIZE] = {
+	{
+		0xc8, 0xab, 0x1d, 0x05, 0x8a, 0xc2, 0x51, 0x93, 0xff, 0xf0, 0xa5, 0xb8, 0xe0, 0x4a, 0x05, 0x38,
+		0x33, 0x62, 0xc0, 0xfa, 0x76, 0x72, 0x1c, 0x25, 0x05, 0x7e, 0x32, 0xa7, 0xdd, 0xa6, 0x36, 0xf7,
+		0xda, 0x63, 0xa4, 0x80, 0x9f, 0x1a, 0x35, 0xb1, 0x8d, 0x43, 0x06, 0x09, 0x52, 0x9a, 0x4e, 0x6c,
+		0x4b, 0xa1, 0x71, 0xdf, 0xea, 0x00, 0x13, 0xc0, 0x6e, 0x50, 0x0b, 0x8e, 0xc2, 0x43, 0xb9, 0xcc
+	},
+	{
+		0x6a, 0x46, 0x36, 0x5c, 0x33, 0xfc, 0xde, 0xc8, 0x48, 0xa7, 0x2b, 0x68, 0xf5, 0x76, 0x5b, 0xb0,
+		0xb2, 0x95, 0x5d, 0x59, 0x8c, 0x6a, 0x50, 0x44, 0x9b, 0xdf, 0x10, 0x2c, 0x4e, 0x0b, 0x21, 0x5f,
+		0xe2, 0x5f, 0x03, 0x72, 0xf4, 0x28, 0x15, 0x38, 0x51, 0xc9, 0xf4, 0xbe, 0x08, 0x39, 0xef, 0xc0,
+		0xa9, 0xd1, 0x67, 0x59, 0x4f, 0xe6, 0x81, 0x54, 0xb4, 0x89, 0xd1, 0x57, 0x99, 0x22, 0xda, 0xc5
+	},
+	{
+		0xe3, 0xdb, 0x74, 0x8b, 0x81, 0x96, 0x04, 0x0b, 0xc1, 0xdf, 0xe5, 0xe1, 0x16, 0xe2, 0x9d, 0x20,
+		0x0d, 0xb3, 0x9a, 0x8d, 0x7c, 0x6d, 0x3c, 0x44, 0x0a, 0x26, 0x34, 0x03, 0xf6, 0xc5, 0xa6, 0x9a,
+		0x46, 0x00, 0xa0, 0xf7, 0xe0, 0x30, 0x7d, 0x07, 0x0a, 0x02, 0xb3, 0x34, 0xa6, 0xd8, 0x86, 0xf2,
+		0xd1, 0x3f, 0xa1, 0x28, 0xae, 0xec, 0x13, 0x7a, 0x09, 0x64, 0x52, 0x13, 0x7c, 0x21, 0x7b, 0x56
+	},
+	{
+		0x77, 0xaa, 0x3d, 0x9d, 0x00, 0x32, 0x99, 0xbd, 0x5d, 0x6e, 0x80, 0x08, 0x03, 0x94, 0x66, 0x60,
+		0xa4, 0xcd, 0xa4, 0xa3, 0x43, 0x7a, 0xa9, 0xf2, 0x3d, 0x92, 0xd7, 0xa8, 0xab, 0xc2, 0xc7, 0x7f,
+		0xe4, 0xaf, 0x7d, 0xcd, 0x19, 0xa7, 0x5a, 0xcf, 0xc0, 0xd9, 0x4d, 0xeb, 0xc3, 0xfd, 0xf1, 0x9e,
+		0x92, 0x00, 0xbc, 0xcd, 0x2a, 0xa5, 0x5d, 0xe7, 0x50, 0x67, 0x3e, 0x5f, 0x38, 0x50, 0x44, 0xf8
+	},
+	{
+		0xa6, 0xbf, 0xb1, 0xd3, 0xab, 0xd5, 0x2e, 0xcd, 0x1b, 0x69, 0x64, 0x71, 0xeb, 0xb7, 0x87, 0x48,
+		0x62, 0x3a, 0x7a, 0x63, 0x86, 0xf9, 0xc8, 0x73, 0xf0, 0xf5, 0x56, 0x7c, 0x3f, 0x13, 0x75, 0x4a,
+		0x1b, 0x11, 0x5e, 0x62, 0x06, 0x88, 0x04, 0xaf, 0xa3, 0x8c, 0x5a, 0x62, 0x1e, 0x3e, 0xbc, 0xd9,
+		0x63, 0x71, 0x6b, 0x5e, 0x32, 0x72, 0xf3, 0x4a, 0xc2, 0xde, 0x06, 0x5a, 0x4f, 0xba, 0xa5, 0x53
+	},
+	{
+		0xf3, 0x08, 0x8e, 0x5c, 0x89, 0x53, 0xe9, 0xdd, 0x07, 0x9e, 0x3d, 0x90, 0x9b, 0xee, 0x6b, 0x99,
+		0x65, 0x98, 0x0c, 0xe6, 0xa5, 0xde, 0xd6, 0x22, 0x98, 0x0e, 0x86, 0x2d, 0xaa, 0x50, 0x83, 0x5c,
+		0xd2, 0x0c, 0x8b, 0xc2, 0x68, 0xd9, 0x61, 0xb5, 0x96, 0xf1, 0x12, 0x95, 0x00, 0x72, 0x66, 0x39,
+		0xc3, 0x45, 0xdd, 0x39, 0x6b, 0xe2, 0xe4, 0xa8, 0x7e, 0x46, 0xc5, 0x2c, 0x47, 0x75, 0x65, 0x37
+	},
+	{
+		0xb5, 0x78, 0xec, 0x44, 0xa4, 0x2b, 0xe3, 0xbc, 0x0a, 0x40, 0x0a, 0x3f, 0x18, 0xfc, 0xc9, 0xfb,
+		0xef, 0xf9, 0xb3, 0xa1, 0x30, 0x4c, 0xf4, 0x35, 0x5e, 0xb0, 0xff, 0x09, 0xe9, 0x44, 0x2d, 0x11,
+		0x9f, 0xce, 0xa5, 0x36, 0xee, 0xf4, 0xf6, 0x81, 0x54, 0x12, 0x28, 0x27, 0xce, 0x00, 0x52, 0x26,
+		0xba, 0xde, 0x87, 0x81, 0x43, 0xd9, 0xf1, 0x8e, 0x1c, 0xe3, 0xf9, 0xc3, 0xe2, 0x3a, 0xb9, 0x4d
+	},
+	{
+		0x77, 0x2a, 0x84, 0x21, 0x52, 0x56, 0x21, 0xbf, 0x90, 0xf1, 0x5f, 0xe9, 0x68, 0xe7, 0xdb, 0xbe,
+		0x0e, 0x21, 0x20, 0x3d, 0xdf, 0xdf, 0x89, 0xe4, 0xc0, 0x48, 0xde, 0x4c, 0x8d, 0xdb, 0xdf, 0xfd,
+		0x26, 0xb6, 0x29, 0x2a, 0xc3, 0x55, 0x14, 0xbd, 0x0b, 0x52, 0xd2, 0x62, 0x85, 0x25, 0x1a, 0xa1,
+		0xf5, 0xfe, 0x25, 0x74, 0xbc, 0x1a, 0x82, 0xb6, 0xe7, 0xb9, 0x9b, 0xfa, 0x43, 0xef, 0xaf, 0xab
+	},
+	{
+		0x23, 0xe2, 0x5d, 0xb9, 0xfc, 0xf0, 0x55, 0xd7, 0xab, 0xab, 0x4c, 0x36, 0x38, 0x38, 0x70, 0x7c,
+		0xa8, 0x9c, 0xe6, 0x46, 0x12, 0x27, 0xc4, 0xad, 0x42, 0x8b, 0x45, 0x5d, 0x22, 0x38, 0x96, 0x3e,
+		0x1c, 0xb1, 0x51, 0x31, 0xee, 0x1a, 0xe9, 0x7b, 0x8f, 0x68, 0x26, 0x4c, 0x9e, 0xf0, 0x63, 0x2e,
+		0x48, 0xfc, 0x53, 0x3c, 0xb2, 0x8d, 0x23, 0x03, 0xd7, 0x0d, 0x5d, 0x4a, 0xbd, 0xa1, 0x65, 0x27
+	},
+	{
+		0x25, 0x4b, 0xf5, 0x8f, 0xf8, 0x7b, 0x0f, 0xfa, 0xc7, 0x38, 0x54, 0x9c, 0xf3, 0xb1, 0xfa, 0x7a,
+		0x84, 0xe6, 0xc4, 0xbc, 0x40, 0xb0, 0xc9, 0x98, 0xb1, 0x4d, 0xd4, 0x44, 0x73, 0x22, 0x6e, 0xd6,
+		0xd3, 0xe9, 0xfc, 0xcb, 0xc2, 0x5a, 0x12, 0x7d, 0xf2, 0x91, 0xb2, 0x14, 0x71, 0x58, 0x12, 0xe5,
+		0xb8, 0xc9, 0x5c, 0x41, 0x5b, 0x87, 0x92, 0x11, 0x7c, 0x08, 0xcf, 0x37, 0x4d, 0x1f, 0xc6, 0x08
+	},
+	{
+		0x0e, 0xd4, 0x5f, 0xb3, 0x77, 0x76, 0x1b, 0x08, 0x7d, 0xaf, 0x0f, 0x06, 0x30, 0x4e, 0xf8, 0x6f,
+		0x00, 0xbf, 0xef, 0x48, 0xc5, 0x44, 0x71, 0xfa, 0x60, 0x78, 0x28, 0x3a, 0xd6, 0x43, 0x50, 0xb0,
+		0x45, 0xfd, 0x57, 0xfe, 0x83, 0xfa, 0x92, 0xbe, 0xf5, 0x6c, 0xa1, 0xf3, 0x0a, 0x48, 0x23, 0xeb,
+		0x78, 0x60, 0x7d, 0x24, 0x4f, 0x9b, 0x30, 0x1f, 0xbf, 0x36, 0x49, 0x3e, 0x06, 0xe4, 0xa0, 0x17
+	},
+	{
+		0xea, 0x98, 0xc7, 0x83, 0x4a, 0x6a, 0x41, 0x62, 0xb2, 0x64, 0xdb, 0x54, 0x24, 0xc4, 0xb5, 0xd1,
+		0x4f, 0x05, 0x8b, 0x99, 0x3b, 0x34, 0x9e, 0x8e, 0xe1, 0x10, 0x30, 0x5a, 0x14, 0xc3, 0xdd, 0xda,
+		0x23, 0x07, 0x28, 0x12, 0xb8, 0x46, 0xf5, 0x8b, 0xfb, 0x0d, 0x10, 0x86, 0xc3, 0x56, 0x80, 0xaa,
+		0xc7, 0x98, 0xf5, 0xe6, 0xf8, 0x5d, 0x59, 0x27, 0xd1, 0x81, 0x70, 0x42, 0x1d, 0x79, 0xe4, 0xa1
+	},
+	{
+		0xb0, 0x94, 0xdd, 0x7e, 0x3b, 0x27, 0x10, 0x99, 0xa8, 0x85, 0x54, 0xd8, 0xb9, 0xb3, 0xf5, 0x50,
+		0x28, 0xa9, 0x3f, 0x2d, 0x87, 0x6e, 0xfa, 0x24, 0x71, 0x4c, 0xb2, 0x47, 0xdc, 0x7e, 0xeb, 0x59,
+		0x8a, 0x80, 0x78, 0x91, 0xdc, 0xdb, 0xb3, 0x6b, 0x1c, 0xf3, 0x10, 0xd4, 0xb4, 0x44, 0x86, 0x90,
+		0x5d, 0x23, 0x64, 0x2c, 0x92, 0x45, 0x69, 0xf3, 0x09, 0x95, 0x58, 0xb4, 0x6e, 0x8b, 0xfc, 0x74
+	},
+	{
+		0x43, 0x39, 0x36, 0x08, 0xcb, 0x24, 0xb3, 0x99, 0x94, 0xd8, 0x97, 0x93, 0x47, 0x61, 0xb1, 0x6c,
+		0x32, 0xa7, 0x82, 0x25, 0x66, 0x3d, 0x39, 0x22, 0xa7, 0xed, 0xbd, 0xda, 0xd2, 0xa0, 0x1e, 0x7f,
+		0xaa, 0x53, 0xf8, 0x17, 0x79, 0x4f, 0x5b, 0x84, 0x02, 0x85, 0xb5, 0x9c, 0xfc, 0xe8, 0x33, 0xc2,
+		0x58, 0xc5, 0xce, 0x75, 0x2a, 0x76, 0xbe, 0x9c, 0xdb, 0x35, 0xe4, 0x29, 0xaf, 0x60, 0x28, 0x29
+	},
+	{
+		0x20, 0xb1, 0xd8, 0x19, 0xa5, 0x36, 0xc3, 0xe6, 0xc8, 0x67, 0xa2, 0x79, 0x35, 0x01, 0xac, 0xe3,
+		0x53, 0xa1, 0xcd, 0x1c, 0x39, 0xed, 0x0f, 0x57, 0x31, 0xd9, 0x94, 0x49, 0x2c, 0x84, 0x54, 0xaf,
+		0x65, 0x35, 0x61, 0x89, 0x77, 0x77, 0x86, 0x3b, 0x34, 0x32, 0x81, 0x75, 0xc5, 0xe6, 0x95, 0x30,
+		0xb4, 0xad, 0xb5, 0x05, 0x4a, 0xf8, 0xda, 0x38, 0x97, 0xd4, 0x60, 0x52, 0xd2, 0x0e, 0x27, 0x85
+	},
+	{
+		0xbb, 0x38, 0x5a, 0x87, 0x76, 0xdd, 0x9d, 0xd5, 0xb3, 0x13, 0x54, 0xcc, 0x55, 0x07, 0xc3, 0xfd,
+		0x93, 0x6e, 0xf1, 0x7c, 0xea, 0xf3, 0x71, 0x69, 0x49, 0x09, 0x23, 0xa2, 0x66, 0x08, 0x57, 0xbb,
+		0x01, 0xcc, 0xfc, 0xdd, 0x73, 0xaf, 0x70, 0xc3, 0x23, 0x48, 0xb8, 0xb8, 0xc3, 0xf2, 0x6b, 0xc6,
+		0x07, 0x1c, 0x7a, 0x38, 0xcb, 0xc6, 0x48, 0xdc, 0x7a, 0x51, 0x54, 0xdc, 0xe8, 0x45, 0x0c, 0x80
+	}
+};
+
+static const uint8_t ecdsa_p256_public_key2[] = {
+		0x38, 0x06, 0xd0, 0x5d, 0x67, 0xb9, 0x3e, 0x73, 0xd8, 0xa7, 0x98, 0x92, 0x2a, 0x60, 0xa0, 0x22,
+		0xbd, 0x1c, 0xbb, 0x5b, 0x4e, 0x0b, 0xfb, 0xf7, 0xc7, 0x10, 0xc7, 0x92, 0x88, 0x88, 0x43, 0xf2,
+		0xb1, 0x54, 0x41, 0xa2, 0x9f, 0x01, 0x8e, 0xa8, 0x52, 0x4a, 0x15, 0x1a, 0xfb, 0x1c, 0xc6, 0xd6,
+		0x5c, 0x31, 0x3e, 0x85, 0x7d, 0x1b, 0x1e, 0xfc, 0x92, 0xae, 0x63, 0x9d, 0x4b, 0x07, 0x5f, 0x2a
+};
+
+//! Signatures by ecdsa_p256_public_key2 over SHA-256 of the single byte i
+static const uint8_t ecdsa_p256_sig_bytes2[][ATCA_ECC_P256_SIGNATURE_SIZE] = {
+	{
+		0x13, 0x6a, 0x56, 0xe3, 0xc2, 0x1b, 0x23, 0x8c, 0x6d, 0x6f, 0x08, 0x4f, 0x3c, 0x2e, 0x6d, 0x82,
+		0x96, 0x4a, 0xa3, 0x83, 0x09, 0xa5, 0xbe, 0x39, 0x6f, 0xc5, 0x34, 0x34, 0xf1, 0x5f, 0xb3, 0x74,
+		0xde, 0x99, 0x58, 0xa8, 0x95, 0x72, 0xf3, 0x34, 0xd0, 0x13, 0x18, 0xe5, 0xc7, 0xb5, 0x9f, 0xd3,
+		0x83, 0x2a, 0x1f, 0x66, 0x99, 0xf2, 0x26, 0x2a, 0x3a, 0x00, 0x62, 0xdc, 0x5f, 0x01, 0x98, 0xb4
+	},
+	{
+		0xf6, 0xa9, 0x46, 0x4f, 0x4b, 0xff, 0x1c, 0xd9, 0x18, 0x30, 0x8d, 0x85, 0xd9, 0x71, 0xaa, 0x39,
+		0xc7, 0x75, 0x65, 0xd1, 0x8f, 0x6e, 0x6b, 0x3e, 0x82, 0x53, 0x6c, 0x46, 0x68, 0x78, 0x30, 0x51,
+		0xff, 0xab, 0x1f, 0x79, 0x0e, 0x70, 0xaa, 0xb2, 0x0a, 0xb8, 0xa9, 0x59, 0x4e, 0x28, 0x3e, 0x43,
+		0x0e, 0x83, 0xd0, 0xbc, 0x0d, 0xc5, 0x4f, 0x9b, 0x40, 0x20, 0x1d, 0xc2, 0x90, 0xfd, 0x79, 0xbc
+	},
+	{
+		0x8a, 0x4d, 0x14, 0xa7, 0x05, 0x4d, 0x52, 0xfe, 0xc1, 0x27, 0xc1, 0xb3, 0xb4, 0x96, 0x78, 0x50,
+		0xf7, 0xa8, 0x9c, 0xef, 0x7b, 0x93, 0x14, 0xfe, 0x4f, 0xba, 0x70, 0x2b, 0x28, 0xf6, 0x2e, 0x27,
+		0xe3, 0xed, 0x57, 0x2c, 0x54, 0x7a, 0xac, 0x68, 0xed, 0xff, 0xda, 0x87, 0x64, 0x9d, 0xc1, 0x24,
+		0x2a, 0xc7, 0x9b, 0x55, 0x34, 0xc7, 0x2e, 0x4f, 0x2e, 0x5c, 0x2f, 0xe7, 0xec, 0x89, 0xb0, 0x09
+	},
+	{
+		0x2d, 0x90, 0x18, 0x17, 0x91, 0x58, 0x03, 0x76, 0xd5, 0xbc, 0x71, 0x91, 0x87, 0xd1, 0xd4, 0x1f,
+		0x7f, 0xf0, 0x3d, 0x1f, 0x2d, 0x84, 0x8b, 0xd8, 0x69, 0x2c, 0xc0, 0xc2, 0xa5, 0x3e, 0x3e, 0x5a,
+		0x13, 0xa5, 0x2c, 0x86, 0x72, 0x55, 0x3b, 0xd7, 0xc7, 0xf3, 0xf0, 0xd8, 0x3e, 0xe2, 0xe6, 0x0c,
+		0x4b, 0x25, 0xe1, 0xef, 0x15, 0x62, 0x0d, 0x11, 0x9a, 0x3b, 0x1e, 0x8b, 0x8d, 0xd7, 0x2e, 0xa4
+	}
+};
+
+static void ecdsa_verify_p256_checks(void)
+{
+	uint8_t digest[ATCA_SHA2_256_DIGEST_SIZE];
+	uint8_t signature[ATCA_ECC_P256_SIGNATURE_SIZE];
+	uint8_t public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE];
+	uint8_t msg;
+	int ret;
+
+	ret = atcac_sw_sha2_256((const uint8_t*)"sample", 6, digest);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	ret = atcac_sw_ecdsa_verify_p256(digest, ecdsa_p256_sig_sample, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+
+	// Signature over a different message
+	ret = atcac_sw_ecdsa_verify_p256(digest, ecdsa_p256_sig_test, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+
+	// A short R only verifies right aligned in its half
+	ret = atcac_sw_ecdsa_verify_p256(digest, ecdsa_p256_sig_short_r, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	memset(signature, 0, sizeof(signature));
+	memcpy(signature, &ecdsa_p256_sig_short_r[1], ATCA_ECC_P256_FIELD_SIZE - 1);
+	memcpy(&signature[ATCA_ECC_P256_FIELD_SIZE], &ecdsa_p256_sig_short_r[ATCA_ECC_P256_FIELD_SIZE], ATCA_ECC_P256_FIELD_SIZE);
+	ret = atcac_sw_ecdsa_verify_p256(digest, signature, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+
+	ret = atcac_sw_sha2_256((const uint8_t*)"test", 4, digest);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	ret = atcac_sw_ecdsa_verify_p256(digest, ecdsa_p256_sig_test, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+
+	// Modified digest
+	digest[31] ^= 0x01;
+	ret = atcac_sw_ecdsa_verify_p256(digest, ecdsa_p256_sig_test, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+	digest[31] ^= 0x01;
+
+	// Modified R, then S
+	memcpy(signature, ecdsa_p256_sig_test, sizeof(signature));
+	signature[5] ^= 0x40;
+	ret = atcac_sw_ecdsa_verify_p256(digest, signature, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+	memcpy(signature, ecdsa_p256_sig_test, sizeof(signature));
+	signature[40] ^= 0x02;
+	ret = atcac_sw_ecdsa_verify_p256(digest, signature, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+
+	// R = 0 and S = n are out of range
+	memcpy(signature, ecdsa_p256_sig_test, sizeof(signature));
+	memset(signature, 0, ATCA_ECC_P256_FIELD_SIZE);
+	ret = atcac_sw_ecdsa_verify_p256(digest, signature, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+	memcpy(signature, ecdsa_p256_sig_test, sizeof(signature));
+	memcpy(&signature[ATCA_ECC_P256_FIELD_SIZE], ecdsa_p256_order, ATCA_ECC_P256_FIELD_SIZE);
+	ret = atcac_sw_ecdsa_verify_p256(digest, signature, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+
+	// Public key not on the curve
+	memcpy(public_key, ecdsa_p256_public_key, sizeof(public_key));
+	public_key[63] ^= 0x01;
+	ret = atcac_sw_ecdsa_verify_p256(digest, ecdsa_p256_sig_test, public_key);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+
+	ret = atcac_sw_ecdsa_verify_p256(NULL, ecdsa_p256_sig_test, ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, ret);
+
+	for (msg = 0; msg < sizeof(ecdsa_p256_sig_bytes) / sizeof(ecdsa_p256_sig_bytes[0]); msg++) {
+		ret = atcac_sw_sha2_256(&msg, 1, digest);
+		TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+		ret = atcac_sw_ecdsa_verify_p256(digest, ecdsa_p256_sig_bytes[msg], ecdsa_p256_public_key);
+		TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+
+		memcpy(signature, ecdsa_p256_sig_bytes[msg], sizeof(signature));
+		signature[msg * 4] ^= 0x10;
+		ret = atcac_sw_ecdsa_verify_p256(digest, signature, ecdsa_p256_public_key);
+		TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+	}
+}
+
+void test_atcac_sw_ecdsa_verify_p256(void)
+{
+	ecdsa_verify_p256_checks();
+}
+
+void test_atcac_sw_ecdsa_verify_p256_pinned(void)
+{
+	uint8_t public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE];
+	int ret;
+
+	ret = atcac_sw_ecdsa_pin_key(ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	ret = atcac_sw_ecdsa_pin_key(ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+
+	// Same results through the tables
+	ecdsa_verify_p256_checks();
+
+	// Two pins, so the table survives the first unpin
+	ret = atcac_sw_ecdsa_unpin_key(ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	ecdsa_verify_p256_checks();
+	ret = atcac_sw_ecdsa_unpin_key(ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	ret = atcac_sw_ecdsa_unpin_key(ecdsa_p256_public_key);
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, ret);
+
+	memcpy(public_key, ecdsa_p256_public_key, sizeof(public_key));
+	public_key[63] ^= 0x01;
+	ret = atcac_sw_ecdsa_pin_key(public_key);
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, ret);
+	ret = atcac_sw_ecdsa_pin_key(NULL);
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, ret);
+}
+
+void test_atcac_sw_ecdsa_verify_p256_batch(void)
+{
+	const size_t count1 = sizeof(ecdsa_p256_sig_bytes) / sizeof(ecdsa_p256_sig_bytes[0]);
+	const size_t count2 = sizeof(ecdsa_p256_sig_bytes2) / sizeof(ecdsa_p256_sig_bytes2[0]);
+	uint8_t digests[32][ATCA_SHA2_256_DIGEST_SIZE];
+	uint8_t signatures[32][ATCA_ECC_P256_SIGNATURE_SIZE];
+	const uint8_t* msgs[32];
+	const uint8_t* sigs[32];
+	const uint8_t* public_keys[32];
+	int results[32];
+	uint8_t msg;
+	size_t count = 0;
+	size_t i;
+	int ret;
+
+	// Both keys interleaved, so batches mix keys
+	for (i = 0; i < count1 + count2; i++) {
+		msg = (uint8_t)(i < 2 * count2 ? i / 2 : i - count2);
+		if (i < 2 * count2 && (i & 1)) {
+			memcpy(signatures[count], ecdsa_p256_sig_bytes2[msg], ATCA_ECC_P256_SIGNATURE_SIZE);
+			public_keys[count] = ecdsa_p256_public_key2;
+		}else  {
+			memcpy(signatures[count], ecdsa_p256_sig_bytes[msg], ATCA_ECC_P256_SIGNATURE_SIZE);
+			public_keys[count] = ecdsa_p256_public_key;
+		}
+		ret = atcac_sw_sha2_256(&msg, 1, digests[count]);
+		TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+		msgs[count] = digests[count];
+		sigs[count] = signatures[count];
+		count++;
+	}
+
+	ret = atcac_sw_ecdsa_verify_p256_batch(count, msgs, sigs, public_keys, results);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	for (i = 0; i < count; i++)
+		TEST_ASSERT_EQUAL(ATCA_SUCCESS, results[i]);
+
+	// Bad signatures are singled out, whichever batch they land in
+	signatures[0][10] ^= 0x01;
+	signatures[5][40] ^= 0x80;
+	signatures[6][3] ^= 0x20;
+	digests[count - 1][0] ^= 0x01;
+	ret = atcac_sw_ecdsa_verify_p256_batch(count, msgs, sigs, public_keys, results);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+	for (i = 0; i < count; i++)
+		TEST_ASSERT_EQUAL(atcac_sw_ecdsa_verify_p256(msgs[i], sigs[i], public_keys[i]), results[i]);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, results[0]);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, results[5]);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, results[6]);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, results[count - 1]);
+
+	// Pinned keys go through their tables, the rest is still batched
+	ret = atcac_sw_ecdsa_pin_key(ecdsa_p256_public_key2);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	ret = atcac_sw_ecdsa_verify_p256_batch(count, msgs, sigs, public_keys, results);
+	TEST_ASSERT_EQUAL(ATCA_FUNC_FAIL, ret);
+	for (i = 0; i < count; i++)
+		TEST_ASSERT_EQUAL(atcac_sw_ecdsa_verify_p256(msgs[i], sigs[i], public_keys[i]), results[i]);
+	ret = atcac_sw_ecdsa_unpin_key(ecdsa_p256_public_key2);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+
+	ret = atcac_sw_ecdsa_verify_p256_batch(0, NULL, NULL, NULL, NULL);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	public_keys[3] = NULL;
+	ret = atcac_sw_ecdsa_verify_p256_batch(count, msgs, sigs, public_keys, results);
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, ret);
+}
+
+void test_atcac_sw_random(void)
+{
+	uint8_t zeros[600];
+	uint8_t rand1[600];
+	uint8_t rand2[600];
+	int ret;
+
+	memset(zeros, 0, sizeof(zeros));
+
+	// Small requests come from the cache, large ones straight from the OS. Either way two reads
+	// must not repeat and must not be left empty.
+	ret = atcac_sw_random(rand1, 20);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	ret = atcac_sw_random(rand2, 20);
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	TEST_ASSERT(memcmp(rand1, rand2, 20) != 0);
+	TEST_ASSERT(memcmp(rand1, zeros, 20) != 0);
+
+	ret = atcac_sw_random(rand1, sizeof(rand1));
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	ret = atcac_sw_random(rand2, sizeof(rand2));
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, ret);
+	TEST_ASSERT(memcmp(rand1, rand2, sizeof(rand1)) != 0);
+	TEST_ASSERT(memcmp(rand2, zeros, sizeof(rand2)) != 0);
+
+	ret = atcac_sw_random(NULL, 1);
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, ret);
+}
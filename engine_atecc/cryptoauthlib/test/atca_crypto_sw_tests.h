@@ -57,6 +57,15 @@ void test_atcac_sw_sha2_256_nist3(void);
 void test_atcac_sw_sha2_256_nist_short(void);
 void test_atcac_sw_sha2_256_nist_long(void);
 void test_atcac_sw_sha2_256_nist_monte(void);
+void test_atcac_sw_sha2_256_impls(void);
+void test_atcac_sw_sha2_256_mb(void);
+void test_atcah_batch(void);
+
+void test_atcac_sw_ecdsa_verify_p256(void);
+void test_atcac_sw_ecdsa_verify_p256_pinned(void);
+void test_atcac_sw_ecdsa_verify_p256_batch(void);
+
+void test_atcac_sw_random(void);
 
 
 #endif
\ No newline at end of file
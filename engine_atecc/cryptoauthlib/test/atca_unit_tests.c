@@ -37,6 +37,7 @@
  * \atmel_crypto_device_library_license_stop
  */
 
+#include <unistd.h>
 #include "unity.h"
 #include "cryptoauthlib.h"
 #include "basic/atca_basic.h"
@@ -56,6 +57,10 @@ int atca_unit_tests(ATCADeviceType deviceType)
 
 	RUN_TEST(test_objectNew);
 	RUN_TEST(test_objectDelete);
+	RUN_TEST(test_stats);
+	RUN_TEST(test_trace);
+	RUN_TEST(test_log);
+	RUN_TEST(test_deadline);
 
 	switch ( deviceType ) {
 	case ATSHA204A:
@@ -215,6 +220,213 @@ void test_objectDelete(void)
 	TEST_ASSERT_NULL( device );
 }
 
+void test_stats(void)
+{
+	atca_stats stats;
+	uint8_t sign_rsp[ATCA_SIG_SIZE + 3] = { ATCA_SIG_SIZE + 3 };
+	uint8_t verify_rsp[4] = { 4, 0x01 };
+	char text[4096];
+	char small[16];
+	uint64_t hist = 0;
+	int i, len;
+
+	atca_stats_reset();
+
+	// a sign that spent at least 1 ms in transport
+	atca_stats_sent(ATCA_SIGN, atca_stats_now_us() - 1000, ATCA_SUCCESS);
+	atca_stats_received(sign_rsp, atca_stats_now_us(), ATCA_SUCCESS);
+	// a verify the device answered with a miscompare
+	atca_stats_sent(ATCA_VERIFY, atca_stats_now_us(), ATCA_SUCCESS);
+	atca_stats_received(verify_rsp, atca_stats_now_us(), ATCA_SUCCESS);
+	// a read that failed to send, and a response without a command
+	atca_stats_sent(ATCA_READ, atca_stats_now_us(), ATCA_COMM_FAIL);
+	atca_stats_received(sign_rsp, atca_stats_now_us(), ATCA_SUCCESS);
+	atca_stats_sent(0x7F, atca_stats_now_us(), ATCA_SUCCESS);
+	atca_stats_received(NULL, atca_stats_now_us(), ATCA_RX_TIMEOUT);
+	atca_stats_wake(ATCA_SUCCESS);
+	atca_stats_wake(ATCA_WAKE_FAILED);
+	atca_stats_idle();
+	atca_stats_sleep();
+
+	atca_stats_get(&stats);
+	TEST_ASSERT_EQUAL(1, stats.command[ATCA_STATS_SIGN].count);
+	TEST_ASSERT_EQUAL(0, stats.command[ATCA_STATS_SIGN].errors);
+	TEST_ASSERT_TRUE(stats.command[ATCA_STATS_SIGN].transport_us >= 1000);
+	for (i = 10; i < ATCA_STATS_BUCKETS; i++)
+		hist += stats.command[ATCA_STATS_SIGN].transport_hist[i];
+	TEST_ASSERT_EQUAL(1, hist);
+	TEST_ASSERT_EQUAL(1, stats.command[ATCA_STATS_VERIFY].count);
+	TEST_ASSERT_EQUAL(1, stats.command[ATCA_STATS_VERIFY].errors);
+	TEST_ASSERT_EQUAL(1, stats.command[ATCA_STATS_READ].count);
+	TEST_ASSERT_EQUAL(1, stats.command[ATCA_STATS_READ].errors);
+	TEST_ASSERT_EQUAL(1, stats.command[ATCA_STATS_OTHER].errors);
+	TEST_ASSERT_EQUAL(1, stats.command[ATCA_STATS_OTHER].timeouts);
+	TEST_ASSERT_EQUAL(0, stats.command[ATCA_STATS_READ].timeouts);
+	TEST_ASSERT_EQUAL(0, stats.command[ATCA_STATS_RANDOM].count);
+	TEST_ASSERT_EQUAL(2, stats.wakes);
+	TEST_ASSERT_EQUAL(1, stats.wake_errors);
+	TEST_ASSERT_EQUAL(1, stats.idles);
+	TEST_ASSERT_EQUAL(1, stats.sleeps);
+
+	len = atca_stats_print(&stats, text, sizeof(text));
+	TEST_ASSERT_TRUE(len > 0 && len < (int)sizeof(text));
+	TEST_ASSERT_NOT_NULL(strstr(text, "sign.count 1\n"));
+	TEST_ASSERT_NOT_NULL(strstr(text, "verify.errors 1\n"));
+	TEST_ASSERT_NOT_NULL(strstr(text, "wake.errors 1\n"));
+	TEST_ASSERT_NULL(strstr(text, "random."));
+	// cut short but terminated, with the full length returned
+	TEST_ASSERT_EQUAL(len, atca_stats_print(&stats, small, sizeof(small)));
+	TEST_ASSERT_EQUAL(sizeof(small) - 1, strlen(small));
+
+	atca_stats_reset();
+	atca_stats_get(&stats);
+	TEST_ASSERT_EQUAL(0, stats.command[ATCA_STATS_SIGN].count);
+	TEST_ASSERT_EQUAL(0, stats.wakes);
+}
+
+static void trace_scoped(void)
+{
+	ATCA_TRACE_SCOPE("test", "scoped");
+}
+
+static int trace_dump(char *text, size_t size)
+{
+	FILE *fp = tmpfile();
+	int count;
+	size_t len;
+
+	TEST_ASSERT_NOT_NULL(fp);
+	count = atca_trace_write_chrome(fp);
+	rewind(fp);
+	len = fread(text, 1, size - 1, fp);
+	text[len] = '\0';
+	fclose(fp);
+	return count;
+}
+
+void test_trace(void)
+{
+	static char text[1024 * 1024];
+	int i;
+
+	atca_trace_enable(0);
+	atca_trace_clear();
+
+	// nothing is recorded while tracing is off
+	ATCA_TRACE_BEGIN("test", "off", 1);
+	trace_scoped();
+	TEST_ASSERT_EQUAL(0, trace_dump(text, sizeof(text)));
+	TEST_ASSERT_NOT_NULL(strstr(text, "\"traceEvents\":["));
+
+	atca_trace_enable(1);
+	ATCA_TRACE_BEGIN("atcab", "sign", ATCA_SIGN);
+	trace_scoped();
+	ATCA_TRACE_END("atcab", "sign", ATCA_SIGN);
+	TEST_ASSERT_EQUAL(4, trace_dump(text, sizeof(text)));
+	TEST_ASSERT_NOT_NULL(strstr(text, "{\"name\":\"sign\",\"cat\":\"atcab\",\"ph\":\"B\""));
+	TEST_ASSERT_NOT_NULL(strstr(text, "\"args\":{\"arg\":65}"));
+	TEST_ASSERT_NOT_NULL(strstr(text, "{\"name\":\"scoped\",\"cat\":\"test\",\"ph\":\"E\""));
+	TEST_ASSERT_NULL(strstr(text, "\"off\""));
+
+	// a full ring keeps the newest events only
+	for (i = 0; i < ATCA_TRACE_RING_SIZE + 10; i++)
+		ATCA_TRACE_BEGIN("test", "wrap", i);
+	TEST_ASSERT_EQUAL(ATCA_TRACE_RING_SIZE, trace_dump(text, sizeof(text)));
+	TEST_ASSERT_NULL(strstr(text, "\"sign\""));
+	TEST_ASSERT_NOT_NULL(strstr(text, "\"arg\":10}"));
+	TEST_ASSERT_NULL(strstr(text, "\"arg\":9}"));
+
+	atca_trace_clear();
+	TEST_ASSERT_EQUAL(0, trace_dump(text, sizeof(text)));
+	atca_trace_enable(0);
+}
+
+void test_log(void)
+{
+	atca_log_stats before, after;
+	char text[4096];
+	int fds[2];
+	int i, len, lines;
+	char *line;
+
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, atca_log_configure("warn,hal=debug atcab=1"));
+	TEST_ASSERT_EQUAL(ATCA_LOG_WARN, atca_log_levels[ATCA_LOG_ENGINE]);
+	TEST_ASSERT_EQUAL(ATCA_LOG_DEBUG, atca_log_levels[ATCA_LOG_HAL]);
+	TEST_ASSERT_EQUAL(ATCA_LOG_ERROR, atca_log_levels[ATCA_LOG_ATCAB]);
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, atca_log_configure("loud"));
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, atca_log_configure("engine=loud"));
+	TEST_ASSERT_EQUAL(ATCA_BAD_PARAM, atca_log_configure("kit=debug"));
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, atca_log_configure(NULL));
+
+	TEST_ASSERT_EQUAL(0, pipe(fds));
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, atca_log_start(fds[1]));
+	atca_log_get_stats(&before);
+
+	// off at runtime: no output
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, atca_log_configure("none"));
+	ATCA_LOG_E(ATCA_LOG_ENGINE, "hidden\n");
+	// an error storm from one call site is cut to ATCA_LOG_BURST lines
+	TEST_ASSERT_EQUAL(ATCA_SUCCESS, atca_log_configure("error"));
+	for (i = 0; i < ATCA_LOG_BURST + 15; i++)
+		ATCA_LOG_E(ATCA_LOG_ENGINE, "storm %d\n", i);
+	ATCA_LOG_E(ATCA_LOG_CERT, "other site");
+
+	atca_log_stop();
+	atca_log_get_stats(&after);
+	close(fds[1]);
+	len = read(fds[0], text, sizeof(text) - 1);
+	close(fds[0]);
+	TEST_ASSERT_TRUE(len > 0);
+	text[len] = '\0';
+
+	TEST_ASSERT_EQUAL(ATCA_LOG_BURST + 1, after.written - before.written);
+	TEST_ASSERT_EQUAL(15, after.suppressed - before.suppressed);
+	TEST_ASSERT_EQUAL(0, after.dropped - before.dropped);
+	TEST_ASSERT_NULL(strstr(text, "hidden"));
+	TEST_ASSERT_NOT_NULL(strstr(text, "ATECCX08 engine error: storm 0\n"));
+	TEST_ASSERT_NULL(strstr(text, "storm 10\n"));
+	TEST_ASSERT_NOT_NULL(strstr(text, "ATECCX08 cert error: other site\n"));
+	for (lines = 0, line = text; (line = strchr(line, '\n')) != NULL; line++)
+		lines++;
+	TEST_ASSERT_EQUAL(ATCA_LOG_BURST + 1, lines);
+
+	atca_log_configure("warn");
+}
+
+void test_deadline(void)
+{
+	uint64_t outer, inner;
+	uint32_t left;
+
+	// no deadline: one transfer may take the default, nothing expires
+	atca_deadline_restore(0);
+	TEST_ASSERT_EQUAL(ATCA_DEADLINE_DEFAULT_MS, atca_deadline_remaining_ms());
+	TEST_ASSERT_FALSE(atca_deadline_expired());
+
+	outer = atca_deadline_set(1000);
+	TEST_ASSERT_EQUAL(0, outer);
+	left = atca_deadline_remaining_ms();
+	TEST_ASSERT_TRUE(left > 900 && left <= 1000);
+
+	// a nested deadline replaces the outer one until it is restored
+	inner = atca_deadline_set(1);
+	usleep(3000);
+	TEST_ASSERT_TRUE(atca_deadline_expired());
+	TEST_ASSERT_EQUAL(0, atca_deadline_remaining_ms());
+	atca_deadline_restore(inner);
+	TEST_ASSERT_FALSE(atca_deadline_expired());
+	TEST_ASSERT_TRUE(atca_deadline_remaining_ms() > 900);
+
+	atca_deadline_restore(outer);
+	TEST_ASSERT_EQUAL(ATCA_DEADLINE_DEFAULT_MS, atca_deadline_remaining_ms());
+
+	TEST_ASSERT_TRUE(atca_status_is_timeout(ATCA_TIMEOUT));
+	TEST_ASSERT_TRUE(atca_status_is_timeout(ATCA_RX_FAIL));
+	TEST_ASSERT_TRUE(atca_status_is_timeout(ATCA_TX_TIMEOUT));
+	TEST_ASSERT_FALSE(atca_status_is_timeout(ATCA_COMM_FAIL));
+	TEST_ASSERT_FALSE(atca_status_is_timeout(ATCA_SUCCESS));
+}
+
 void test_wake_sleep(void)
 {
 	ATCADevice device;
@@ -63,6 +63,10 @@ void test_lock_zone(void);
 
 void test_objectNew(void);
 void test_objectDelete(void);
+void test_stats(void);
+void test_trace(void);
+void test_log(void);
+void test_deadline(void);
 
 // basic command tests
 void test_wake_sleep(void);
@@ -55,6 +55,9 @@ void RunAllCertDataTests(void)
 
 	RUN_TEST_GROUP(atcacert_der_enc_ecdsa_sig_value);
 	RUN_TEST_GROUP(atcacert_der_dec_ecdsa_sig_value);
+	RUN_TEST_GROUP(atcacert_der_enc_ecdsa_sig);
+	RUN_TEST_GROUP(atcacert_der_dec_ecdsa_sig);
+	RUN_TEST_GROUP(atcacert_der_public_key);
 
 	RUN_TEST_GROUP(atcacert_date_enc_iso8601_sep);
 	RUN_TEST_GROUP(atcacert_date_enc_rfc5280_utc);
@@ -72,8 +75,12 @@ void RunAllCertDataTests(void)
     RUN_TEST_GROUP(atcacert_date_get_max_date);
 	RUN_TEST_GROUP(atcacert_date_dec_compcert);
 	RUN_TEST_GROUP(atcacert_date_dec);
+	RUN_TEST_GROUP(atcacert_date_batch);
+	RUN_TEST_GROUP(atcacert_date_round_trip);
 
 	RUN_TEST_GROUP(atcacert_def);
+
+	RUN_TEST_GROUP(atcacert_host_auth);
 }
 
 void RunAllCertIOTests(void)
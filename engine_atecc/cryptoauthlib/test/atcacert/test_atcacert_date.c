@@ -2011,7 +2011,7 @@ TEST(atcacert_date_dec, atcacert_date__atcacert_date_dec_small_buf)
 TEST(atcacert_date_dec, atcacert_date__atcacert_date_dec_bad_format)
 {
 	int ret = 0;
-	const uint8_t ts_str[DATEFMT_RFC5280_GEN_SIZE + 1];
+	const uint8_t ts_str[DATEFMT_RFC5280_GEN_SIZE + 1] = "20131110090807Z";
 	size_t ts_str_size = sizeof(ts_str);
 	atcacert_tm_utc_t ts;
 
@@ -2040,4 +2040,223 @@ TEST(atcacert_date_dec, atcacert_date__atcacert_date_dec_bad_params)
 	ts_str_size = sizeof(ts_str);
 	ret = atcacert_date_dec(DATEFMT_RFC5280_GEN, NULL, ts_str_size, NULL);
 	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
-}
\ No newline at end of file
+}
+
+static int days_in_month(int year, int month)
+{
+	static const int month_days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+	if (month == 2 && ((year % 400 == 0) || ((year % 4 == 0) && (year % 100 != 0))))
+		return 29;
+	return month_days[month - 1];
+}
+
+static void test_round_trip_range(atcacert_date_format_t format, int year_min, int year_max)
+{
+	int ret = 0;
+	int year, month, day;
+	uint8_t ts_str[DATEFMT_MAX_SIZE];
+	atcacert_tm_utc_t ts;
+	atcacert_tm_utc_t ts_dec;
+
+	for (year = year_min; year <= year_max; year++) {
+		for (month = 1; month <= 12; month++) {
+			for (day = 1; day <= days_in_month(year, month); day++) {
+				// Vary the time of day so every two digit value gets exercised
+				set_tm(&ts, year, month, day, day % 24, (year + day) % 60, (month * day) % 60);
+
+				ret = atcacert_date_enc_batch(format, &ts, 1, ts_str);
+				TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+
+				ret = atcacert_date_dec(format, ts_str, ATCACERT_DATE_FORMAT_SIZES[format], &ts_dec);
+				TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+				TEST_ASSERT_EQUAL_MEMORY(&ts, &ts_dec, sizeof(ts));
+			}
+		}
+	}
+}
+
+TEST_GROUP(atcacert_date_round_trip);
+
+TEST_SETUP(atcacert_date_round_trip)
+{
+}
+
+TEST_TEAR_DOWN(atcacert_date_round_trip)
+{
+}
+
+TEST(atcacert_date_round_trip, atcacert_date__round_trip_iso8601_sep)
+{
+	test_round_trip_range(DATEFMT_ISO8601_SEP, 0, 9999);
+}
+
+TEST(atcacert_date_round_trip, atcacert_date__round_trip_rfc5280_utc)
+{
+	test_round_trip_range(DATEFMT_RFC5280_UTC, 1950, 2049);
+}
+
+TEST(atcacert_date_round_trip, atcacert_date__round_trip_rfc5280_gen)
+{
+	test_round_trip_range(DATEFMT_RFC5280_GEN, 0, 9999);
+}
+
+TEST(atcacert_date_round_trip, atcacert_date__round_trip_posix_uint32)
+{
+	int ret = 0;
+	int year, month, day;
+	uint32_t days = 0;
+	uint32_t posix_uint32 = 0;
+	uint8_t ts_str[DATEFMT_POSIX_UINT32_BE_SIZE];
+	uint8_t ts_str_le[DATEFMT_POSIX_UINT32_LE_SIZE];
+	atcacert_tm_utc_t ts;
+	atcacert_tm_utc_t ts_dec;
+
+	// Walk every day the format can hold and check it against a simple day count from the epoch
+	for (year = 1970; year <= 2106; year++) {
+		for (month = 1; month <= 12; month++) {
+			for (day = 1; day <= days_in_month(year, month); day++, days++) {
+				if (year == 2106 && (month > 2 || (month == 2 && day > 7)))
+					return;
+
+				set_tm(&ts, year, month, day, day % 24, (year + day) % 60, (month * day) % 60);
+				if (year == 2106 && month == 2 && day == 7)
+					set_tm(&ts, year, month, day, 6, 28, 14); // Last encodable second
+				posix_uint32 = days * 86400 + ts.tm_hour * 3600 + ts.tm_min * 60 + ts.tm_sec;
+
+				ret = atcacert_date_enc_posix_uint32_be(&ts, ts_str);
+				TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+				TEST_ASSERT_EQUAL_HEX32(posix_uint32,
+				                        ((uint32_t)ts_str[0] << 24) | ((uint32_t)ts_str[1] << 16) | ((uint32_t)ts_str[2] << 8) | ts_str[3]);
+
+				ret = atcacert_date_dec_posix_uint32_be(ts_str, &ts_dec);
+				TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+				TEST_ASSERT_EQUAL_MEMORY(&ts, &ts_dec, sizeof(ts));
+
+				ret = atcacert_date_enc_posix_uint32_le(&ts, ts_str_le);
+				TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+				TEST_ASSERT_EQUAL(ts_str[0], ts_str_le[3]);
+				TEST_ASSERT_EQUAL(ts_str[3], ts_str_le[0]);
+
+				ret = atcacert_date_dec_posix_uint32_le(ts_str_le, &ts_dec);
+				TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+				TEST_ASSERT_EQUAL_MEMORY(&ts, &ts_dec, sizeof(ts));
+			}
+		}
+	}
+}
+
+TEST(atcacert_date_round_trip, atcacert_date__round_trip_compcert)
+{
+	int ret = 0;
+	int year, month, day, hour;
+	uint8_t expire_years = 0;
+	uint8_t enc_dates[3];
+	atcacert_tm_utc_t issue_date;
+	atcacert_tm_utc_t issue_date_dec;
+	atcacert_tm_utc_t expire_date;
+
+	for (year = 2000; year <= 2031; year++) {
+		for (month = 1; month <= 12; month++) {
+			for (day = 1; day <= 31; day++) {
+				for (hour = 0; hour <= 23; hour++) {
+					expire_years = (uint8_t)((year + day + hour) % 32);
+					set_tm(&issue_date, year, month, day, hour, 0, 0);
+
+					ret = atcacert_date_enc_compcert(&issue_date, expire_years, enc_dates);
+					TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+
+					ret = atcacert_date_dec_compcert(enc_dates, DATEFMT_RFC5280_GEN, &issue_date_dec, &expire_date);
+					TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+					TEST_ASSERT_EQUAL_MEMORY(&issue_date, &issue_date_dec, sizeof(issue_date));
+					if (expire_years == 0)
+						TEST_ASSERT_EQUAL(9999 - 1900, expire_date.tm_year);
+					else
+						TEST_ASSERT_EQUAL(issue_date.tm_year + expire_years, expire_date.tm_year);
+				}
+			}
+		}
+	}
+}
+
+TEST_GROUP(atcacert_date_batch);
+
+TEST_SETUP(atcacert_date_batch)
+{
+}
+
+TEST_TEAR_DOWN(atcacert_date_batch)
+{
+}
+
+TEST(atcacert_date_batch, atcacert_date__atcacert_date_enc_batch_good)
+{
+	int ret = 0;
+	atcacert_tm_utc_t ts[3];
+	uint8_t ts_str[3 * DATEFMT_RFC5280_UTC_SIZE];
+	const char ts_str_ref[sizeof(ts_str) + 1] = "131110090807Z" "500101000000Z" "491231235959Z";
+
+	set_tm(&ts[0], 2013, 11, 10, 9, 8, 7);
+	set_tm(&ts[1], 1950, 1, 1, 0, 0, 0);
+	set_tm(&ts[2], 2049, 12, 31, 23, 59, 59);
+
+	ret = atcacert_date_enc_batch(DATEFMT_RFC5280_UTC, ts, 3, ts_str);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL_MEMORY(ts_str_ref, ts_str, sizeof(ts_str));
+}
+
+TEST(atcacert_date_batch, atcacert_date__atcacert_date_dec_batch_good)
+{
+	int ret = 0;
+	const uint8_t ts_str[] = { 0x52, 0x7F, 0x4C, 0xF7, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF };
+	atcacert_tm_utc_t ts[3];
+	atcacert_tm_utc_t ts_ref[3];
+
+	set_tm(&ts_ref[0], 2013, 11, 10, 9, 8, 7);
+	set_tm(&ts_ref[1], 1970, 1, 1, 0, 0, 0);
+	set_tm(&ts_ref[2], 2106, 2, 7, 6, 28, 15);
+
+	ret = atcacert_date_dec_batch(DATEFMT_POSIX_UINT32_BE, ts_str, 3, ts);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL_MEMORY(ts_ref, ts, sizeof(ts));
+}
+
+TEST(atcacert_date_batch, atcacert_date__atcacert_date_enc_batch_bad_date)
+{
+	int ret = 0;
+	atcacert_tm_utc_t ts[2];
+	uint8_t ts_str[2 * DATEFMT_RFC5280_UTC_SIZE];
+
+	set_tm(&ts[0], 2013, 11, 10, 9, 8, 7);
+	set_tm(&ts[1], 2050, 1, 1, 0, 0, 0);
+
+	ret = atcacert_date_enc_batch(DATEFMT_RFC5280_UTC, ts, 2, ts_str);
+	TEST_ASSERT_EQUAL(ATCACERT_E_INVALID_DATE, ret);
+}
+
+TEST(atcacert_date_batch, atcacert_date__atcacert_date_batch_bad_params)
+{
+	int ret = 0;
+	atcacert_tm_utc_t ts;
+	uint8_t ts_str[DATEFMT_MAX_SIZE];
+
+	set_tm(&ts, 2013, 11, 10, 9, 8, 7);
+
+	ret = atcacert_date_enc_batch(DATEFMT_RFC5280_GEN + 1, &ts, 1, ts_str);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_date_enc_batch(DATEFMT_RFC5280_GEN, NULL, 1, ts_str);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_date_enc_batch(DATEFMT_RFC5280_GEN, &ts, 1, NULL);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_date_dec_batch(-1, ts_str, 1, &ts);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_date_dec_batch(DATEFMT_RFC5280_GEN, NULL, 1, &ts);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_date_dec_batch(DATEFMT_RFC5280_GEN, ts_str, 1, NULL);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+}
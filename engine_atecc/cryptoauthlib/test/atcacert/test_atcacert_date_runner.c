@@ -214,4 +214,21 @@ TEST_GROUP_RUNNER(atcacert_date_dec)
 	RUN_TEST_CASE(atcacert_date_dec, atcacert_date__atcacert_date_dec_small_buf);
 	RUN_TEST_CASE(atcacert_date_dec, atcacert_date__atcacert_date_dec_bad_format);
 	RUN_TEST_CASE(atcacert_date_dec, atcacert_date__atcacert_date_dec_bad_params);
-}
\ No newline at end of file
+}
+
+TEST_GROUP_RUNNER(atcacert_date_round_trip)
+{
+	RUN_TEST_CASE(atcacert_date_round_trip, atcacert_date__round_trip_iso8601_sep);
+	RUN_TEST_CASE(atcacert_date_round_trip, atcacert_date__round_trip_rfc5280_utc);
+	RUN_TEST_CASE(atcacert_date_round_trip, atcacert_date__round_trip_rfc5280_gen);
+	RUN_TEST_CASE(atcacert_date_round_trip, atcacert_date__round_trip_posix_uint32);
+	RUN_TEST_CASE(atcacert_date_round_trip, atcacert_date__round_trip_compcert);
+}
+
+TEST_GROUP_RUNNER(atcacert_date_batch)
+{
+	RUN_TEST_CASE(atcacert_date_batch, atcacert_date__atcacert_date_enc_batch_good);
+	RUN_TEST_CASE(atcacert_date_batch, atcacert_date__atcacert_date_dec_batch_good);
+	RUN_TEST_CASE(atcacert_date_batch, atcacert_date__atcacert_date_enc_batch_bad_date);
+	RUN_TEST_CASE(atcacert_date_batch, atcacert_date__atcacert_date_batch_bad_params);
+}
@@ -4976,6 +4976,56 @@ TEST(atcacert_def, atcacert_def__atcacert_get_device_locs_bad_params)
 	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
 }
 
+TEST(atcacert_def, atcacert_def__atcacert_plan_device_reads)
+{
+	int ret = 0;
+	static const atcacert_device_loc_t device_locs_in[] = {
+		{ .zone = DEVZONE_DATA,   .slot = 8,  .is_genkey = FALSE, .offset = 64,  .count = 10  },
+		{ .zone = DEVZONE_DATA,   .slot = 0,  .is_genkey = TRUE,  .offset = 0,   .count = 64  },
+		{ .zone = DEVZONE_CONFIG, .slot = 0,  .is_genkey = FALSE, .offset = 0,   .count = 13  },
+		{ .zone = DEVZONE_DATA,   .slot = 8,  .is_genkey = FALSE, .offset = 0,   .count = 20  },
+		{ .zone = DEVZONE_NONE,   .slot = 0,  .is_genkey = FALSE, .offset = 0,   .count = 0   },
+		{ .zone = DEVZONE_DATA,   .slot = 10, .is_genkey = FALSE, .offset = 0,   .count = 72  },
+		{ .zone = DEVZONE_DATA,   .slot = 8,  .is_genkey = FALSE, .offset = 20,  .count = 50  },
+		{ .zone = DEVZONE_OTP,    .slot = 0,  .is_genkey = FALSE, .offset = 40,  .count = 8   },
+		{ .zone = DEVZONE_DATA,   .slot = 8,  .is_genkey = FALSE, .offset = 200, .count = 10  },
+		{ .zone = DEVZONE_DATA,   .slot = 0,  .is_genkey = FALSE, .offset = 0,   .count = 32  },
+	};
+	static const atcacert_device_loc_t device_locs_ref[] = {
+		{ .zone = DEVZONE_CONFIG, .slot = 0,  .is_genkey = FALSE, .offset = 0,   .count = 32  },
+		{ .zone = DEVZONE_OTP,    .slot = 0,  .is_genkey = FALSE, .offset = 32,  .count = 32  },
+		{ .zone = DEVZONE_DATA,   .slot = 0,  .is_genkey = FALSE, .offset = 0,   .count = 32  },
+		{ .zone = DEVZONE_DATA,   .slot = 0,  .is_genkey = TRUE,  .offset = 0,   .count = 64  },
+		{ .zone = DEVZONE_DATA,   .slot = 8,  .is_genkey = FALSE, .offset = 0,   .count = 96  },
+		{ .zone = DEVZONE_DATA,   .slot = 8,  .is_genkey = FALSE, .offset = 192, .count = 32  },
+		{ .zone = DEVZONE_DATA,   .slot = 10, .is_genkey = FALSE, .offset = 0,   .count = 96  },
+	};
+	atcacert_device_loc_t device_locs[sizeof(device_locs_in) / sizeof(device_locs_in[0])];
+	size_t device_locs_count = sizeof(device_locs) / sizeof(device_locs[0]);
+
+	memcpy(device_locs, device_locs_in, sizeof(device_locs));
+	ret = atcacert_plan_device_reads(device_locs, &device_locs_count, 32);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL(sizeof(device_locs_ref) / sizeof(device_locs_ref[0]), device_locs_count);
+	TEST_ASSERT_EQUAL_MEMORY(device_locs_ref, device_locs, sizeof(device_locs_ref));
+}
+
+TEST(atcacert_def, atcacert_def__atcacert_plan_device_reads_bad_params)
+{
+	int ret = 0;
+	atcacert_device_loc_t device_locs[4];
+	size_t device_locs_count = 0;
+
+	ret = atcacert_plan_device_reads(NULL, &device_locs_count, 32);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_plan_device_reads(device_locs, NULL, 32);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_plan_device_reads(device_locs, &device_locs_count, 0);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+}
+
 TEST(atcacert_def, atcacert_def__atcacert_cert_build_start_signer)
 {
 	int ret = 0;
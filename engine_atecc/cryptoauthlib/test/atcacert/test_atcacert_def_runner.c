@@ -202,6 +202,9 @@ TEST_GROUP_RUNNER(atcacert_def)
 	RUN_TEST_CASE(atcacert_def, atcacert_def__atcacert_get_device_locs_small_buf);
 	RUN_TEST_CASE(atcacert_def, atcacert_def__atcacert_get_device_locs_bad_params);
 
+	RUN_TEST_CASE(atcacert_def, atcacert_def__atcacert_plan_device_reads);
+	RUN_TEST_CASE(atcacert_def, atcacert_def__atcacert_plan_device_reads_bad_params);
+
 	RUN_TEST_CASE(atcacert_def, atcacert_def__atcacert_cert_build_start_signer);
 	RUN_TEST_CASE(atcacert_def, atcacert_def__atcacert_cert_build_process_signer_public_key);
 	RUN_TEST_CASE(atcacert_def, atcacert_def__atcacert_cert_build_process_signer_comp_cert);
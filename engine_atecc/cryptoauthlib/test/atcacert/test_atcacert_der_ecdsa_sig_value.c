@@ -42,6 +42,7 @@
 #include "atcacert/atcacert_der.h"
 #include "test/unity.h"
 #include "test/unity_fixture.h"
+#include <string.h>
 
 TEST_GROUP(atcacert_der_enc_ecdsa_sig_value);
 
@@ -688,4 +689,282 @@ TEST(atcacert_der_dec_ecdsa_sig_value, atcacert_der_dec_ecdsa_sig_value__bad_sin
 
 	ret = atcacert_der_dec_ecdsa_sig_value(der_sig, &der_sig_size, raw_sig);
 	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_DECODING_ERROR, ret, "Expected ATCACERT_E_DECODING_ERROR");
-}
\ No newline at end of file
+}
+TEST_GROUP(atcacert_der_enc_ecdsa_sig);
+
+TEST_SETUP(atcacert_der_enc_ecdsa_sig)
+{
+}
+
+TEST_TEAR_DOWN(atcacert_der_enc_ecdsa_sig)
+{
+}
+
+TEST(atcacert_der_enc_ecdsa_sig, atcacert_der_enc_ecdsa_sig__trim)
+{
+	int ret;
+	uint8_t der_sig[ATCACERT_DER_ECDSA_SIG_MAX_SIZE];
+	size_t der_sig_size = sizeof(der_sig);
+	uint8_t raw_sig[] = {
+		0x00, 0x01, 0xEE, 0x14, 0x70, 0xE4, 0x08, 0xF0, 0x66, 0x0D, 0x9B, 0xED, 0xB0, 0x7B, 0x8C, 0x5B,
+		0xCB, 0x1A, 0x1A, 0xB1, 0x61, 0x21, 0xB0, 0xE9, 0x4D, 0x4D, 0x37, 0x7E, 0x9A, 0x12, 0x8F, 0x9A,
+		0x00, 0x00, 0x00, 0x02, 0x0F, 0x9C, 0xCE, 0xF6, 0x45, 0xCC, 0xD1, 0x29, 0x97, 0x76, 0xBC, 0x3B,
+		0xF4, 0x9D, 0xBC, 0x34, 0x7C, 0x22, 0x96, 0xEA, 0xAF, 0x0C, 0x96, 0x6B, 0xEC, 0x6E, 0xA7, 0x98
+	};
+	uint8_t der_sig_ref[] = {
+		0x30, 0x40, 0x02, 0x1F, 0x01, 0xEE, 0x14, 0x70, 0xE4, 0x08, 0xF0, 0x66, 0x0D, 0x9B, 0xED, 0xB0,
+		0x7B, 0x8C, 0x5B, 0xCB, 0x1A, 0x1A, 0xB1, 0x61, 0x21, 0xB0, 0xE9, 0x4D, 0x4D, 0x37, 0x7E, 0x9A,
+		0x12, 0x8F, 0x9A, 0x02, 0x1D, 0x02, 0x0F, 0x9C, 0xCE, 0xF6, 0x45, 0xCC, 0xD1, 0x29, 0x97, 0x76,
+		0xBC, 0x3B, 0xF4, 0x9D, 0xBC, 0x34, 0x7C, 0x22, 0x96, 0xEA, 0xAF, 0x0C, 0x96, 0x6B, 0xEC, 0x6E,
+		0xA7, 0x98
+	};
+
+	ret = atcacert_der_enc_ecdsa_sig(raw_sig, der_sig, &der_sig_size);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_SUCCESS, ret, "Expected ATCACERT_E_SUCCESS");
+	TEST_ASSERT_EQUAL_MESSAGE(sizeof(der_sig_ref), der_sig_size, "Unexpected der_sig_size");
+	TEST_ASSERT_EQUAL_MEMORY_MESSAGE(der_sig_ref, der_sig, der_sig_size, "Unexpected der_sig");
+
+	// Size only
+	der_sig_size = 0;
+	ret = atcacert_der_enc_ecdsa_sig(raw_sig, NULL, &der_sig_size);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_SUCCESS, ret, "Expected ATCACERT_E_SUCCESS");
+	TEST_ASSERT_EQUAL_MESSAGE(sizeof(der_sig_ref), der_sig_size, "Unexpected der_sig_size");
+}
+
+TEST(atcacert_der_enc_ecdsa_sig, atcacert_der_enc_ecdsa_sig__rs_padding)
+{
+	int ret;
+	uint8_t der_sig[ATCACERT_DER_ECDSA_SIG_MAX_SIZE];
+	size_t der_sig_size = sizeof(der_sig);
+	uint8_t raw_sig[64];
+
+	// Largest encoding, both integers need a padding byte
+	memset(raw_sig, 0xFF, sizeof(raw_sig));
+
+	ret = atcacert_der_enc_ecdsa_sig(raw_sig, der_sig, &der_sig_size);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_SUCCESS, ret, "Expected ATCACERT_E_SUCCESS");
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_DER_ECDSA_SIG_MAX_SIZE, der_sig_size, "Unexpected der_sig_size");
+	TEST_ASSERT_EQUAL(0x30, der_sig[0]);
+	TEST_ASSERT_EQUAL(0x46, der_sig[1]);
+	TEST_ASSERT_EQUAL(0x02, der_sig[2]);
+	TEST_ASSERT_EQUAL(0x21, der_sig[3]);
+	TEST_ASSERT_EQUAL(0x00, der_sig[4]);
+	TEST_ASSERT_EQUAL_MEMORY(&raw_sig[0], &der_sig[5], 32);
+	TEST_ASSERT_EQUAL(0x02, der_sig[37]);
+	TEST_ASSERT_EQUAL(0x21, der_sig[38]);
+	TEST_ASSERT_EQUAL(0x00, der_sig[39]);
+	TEST_ASSERT_EQUAL_MEMORY(&raw_sig[32], &der_sig[40], 32);
+}
+
+TEST(atcacert_der_enc_ecdsa_sig, atcacert_der_enc_ecdsa_sig__small_buf)
+{
+	int ret;
+	uint8_t der_sig[ATCACERT_DER_ECDSA_SIG_MAX_SIZE - 1];
+	size_t der_sig_size = sizeof(der_sig);
+	uint8_t raw_sig[64];
+
+	memset(raw_sig, 0xFF, sizeof(raw_sig));
+
+	ret = atcacert_der_enc_ecdsa_sig(raw_sig, der_sig, &der_sig_size);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_BUFFER_TOO_SMALL, ret, "Expected ATCACERT_E_BUFFER_TOO_SMALL");
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_DER_ECDSA_SIG_MAX_SIZE, der_sig_size, "Unexpected der_sig_size");
+}
+
+TEST(atcacert_der_enc_ecdsa_sig, atcacert_der_enc_ecdsa_sig__bad_params)
+{
+	int ret;
+	uint8_t der_sig[ATCACERT_DER_ECDSA_SIG_MAX_SIZE];
+	size_t der_sig_size = sizeof(der_sig);
+	uint8_t raw_sig[64];
+
+	memset(raw_sig, 0x11, sizeof(raw_sig));
+
+	ret = atcacert_der_enc_ecdsa_sig(NULL, der_sig, &der_sig_size);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_BAD_PARAMS, ret, "Expected ATCACERT_E_BAD_PARAMS");
+
+	ret = atcacert_der_enc_ecdsa_sig(raw_sig, der_sig, NULL);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_BAD_PARAMS, ret, "Expected ATCACERT_E_BAD_PARAMS");
+
+	ret = atcacert_der_enc_ecdsa_sig(NULL, NULL, NULL);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_BAD_PARAMS, ret, "Expected ATCACERT_E_BAD_PARAMS");
+}
+
+TEST_GROUP(atcacert_der_dec_ecdsa_sig);
+
+TEST_SETUP(atcacert_der_dec_ecdsa_sig)
+{
+}
+
+TEST_TEAR_DOWN(atcacert_der_dec_ecdsa_sig)
+{
+}
+
+TEST(atcacert_der_dec_ecdsa_sig, atcacert_der_dec_ecdsa_sig__trim)
+{
+	int ret;
+	uint8_t raw_sig[64];
+	uint8_t der_sig[] = {
+		0x30, 0x40, 0x02, 0x1F, 0x01, 0xEE, 0x14, 0x70, 0xE4, 0x08, 0xF0, 0x66, 0x0D, 0x9B, 0xED, 0xB0,
+		0x7B, 0x8C, 0x5B, 0xCB, 0x1A, 0x1A, 0xB1, 0x61, 0x21, 0xB0, 0xE9, 0x4D, 0x4D, 0x37, 0x7E, 0x9A,
+		0x12, 0x8F, 0x9A, 0x02, 0x1D, 0x02, 0x0F, 0x9C, 0xCE, 0xF6, 0x45, 0xCC, 0xD1, 0x29, 0x97, 0x76,
+		0xBC, 0x3B, 0xF4, 0x9D, 0xBC, 0x34, 0x7C, 0x22, 0x96, 0xEA, 0xAF, 0x0C, 0x96, 0x6B, 0xEC, 0x6E,
+		0xA7, 0x98, 0xAA, 0xAA
+	};
+	uint8_t raw_sig_ref[] = {
+		0x00, 0x01, 0xEE, 0x14, 0x70, 0xE4, 0x08, 0xF0, 0x66, 0x0D, 0x9B, 0xED, 0xB0, 0x7B, 0x8C, 0x5B,
+		0xCB, 0x1A, 0x1A, 0xB1, 0x61, 0x21, 0xB0, 0xE9, 0x4D, 0x4D, 0x37, 0x7E, 0x9A, 0x12, 0x8F, 0x9A,
+		0x00, 0x00, 0x00, 0x02, 0x0F, 0x9C, 0xCE, 0xF6, 0x45, 0xCC, 0xD1, 0x29, 0x97, 0x76, 0xBC, 0x3B,
+		0xF4, 0x9D, 0xBC, 0x34, 0x7C, 0x22, 0x96, 0xEA, 0xAF, 0x0C, 0x96, 0x6B, 0xEC, 0x6E, 0xA7, 0x98
+	};
+	size_t der_sig_size = sizeof(der_sig);
+
+	// Trailing data after the sequence isn't part of the signature
+	memset(raw_sig, 0xAA, sizeof(raw_sig));
+	ret = atcacert_der_dec_ecdsa_sig(der_sig, &der_sig_size, raw_sig);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_SUCCESS, ret, "Expected ATCACERT_E_SUCCESS");
+	TEST_ASSERT_EQUAL_MESSAGE(sizeof(der_sig) - 2, der_sig_size, "Unexpected der_sig_size");
+	TEST_ASSERT_EQUAL_MEMORY_MESSAGE(raw_sig_ref, raw_sig, 64, "Unexpected raw_sig");
+
+	// Size only
+	der_sig_size = sizeof(der_sig);
+	ret = atcacert_der_dec_ecdsa_sig(der_sig, &der_sig_size, NULL);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_SUCCESS, ret, "Expected ATCACERT_E_SUCCESS");
+	TEST_ASSERT_EQUAL_MESSAGE(sizeof(der_sig) - 2, der_sig_size, "Unexpected der_sig_size");
+}
+
+TEST(atcacert_der_dec_ecdsa_sig, atcacert_der_dec_ecdsa_sig__round_trip)
+{
+	int ret;
+	size_t i;
+	uint8_t raw_sig[64];
+	uint8_t raw_sig_dec[64];
+	uint8_t der_sig[ATCACERT_DER_ECDSA_SIG_MAX_SIZE];
+	size_t der_sig_size;
+
+	// Walk the leading zero bytes through every trim and padding length
+	for (i = 0; i <= 32; i++) {
+		memset(raw_sig, 0x00, i);
+		memset(&raw_sig[i], 0x80 >> (i % 8), 32 - i);
+		memcpy(&raw_sig[32], raw_sig, 32);
+		der_sig_size = sizeof(der_sig);
+		ret = atcacert_der_enc_ecdsa_sig(raw_sig, der_sig, &der_sig_size);
+		TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_SUCCESS, ret, "Expected ATCACERT_E_SUCCESS");
+		ret = atcacert_der_dec_ecdsa_sig(der_sig, &der_sig_size, raw_sig_dec);
+		TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_SUCCESS, ret, "Expected ATCACERT_E_SUCCESS");
+		TEST_ASSERT_EQUAL_MEMORY_MESSAGE(raw_sig, raw_sig_dec, 64, "Unexpected raw_sig");
+	}
+}
+
+TEST(atcacert_der_dec_ecdsa_sig, atcacert_der_dec_ecdsa_sig__bad_seq_length)
+{
+	int ret;
+	uint8_t raw_sig[64];
+	uint8_t der_sig[] = {
+		0x30, 0x06, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00
+	};
+	size_t der_sig_size = sizeof(der_sig);
+
+	der_sig[1]++; // Sequence length no longer matches the integers
+
+	ret = atcacert_der_dec_ecdsa_sig(der_sig, &der_sig_size, raw_sig);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_DECODING_ERROR, ret, "Expected ATCACERT_E_DECODING_ERROR");
+}
+
+TEST(atcacert_der_dec_ecdsa_sig, atcacert_der_dec_ecdsa_sig__bad_int_too_large)
+{
+	int ret;
+	uint8_t raw_sig[64];
+	uint8_t der_sig[2 + 2 + 34 + 3] = { 0x30, 2 + 34 + 3, 0x02, 34 };
+	size_t der_sig_size = sizeof(der_sig);
+
+	memset(&der_sig[4], 0x00, 34);
+	der_sig[38] = 0x02;
+	der_sig[39] = 0x01;
+	der_sig[40] = 0x00;
+
+	ret = atcacert_der_dec_ecdsa_sig(der_sig, &der_sig_size, raw_sig);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_DECODING_ERROR, ret, "Expected ATCACERT_E_DECODING_ERROR");
+}
+
+TEST(atcacert_der_dec_ecdsa_sig, atcacert_der_dec_ecdsa_sig__bad_params)
+{
+	int ret;
+	uint8_t raw_sig[64];
+	uint8_t der_sig[] = {
+		0x30, 0x06, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00
+	};
+	size_t der_sig_size = sizeof(der_sig);
+
+	ret = atcacert_der_dec_ecdsa_sig(NULL, &der_sig_size, raw_sig);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_BAD_PARAMS, ret, "Expected ATCACERT_E_BAD_PARAMS");
+
+	ret = atcacert_der_dec_ecdsa_sig(der_sig, NULL, raw_sig);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_BAD_PARAMS, ret, "Expected ATCACERT_E_BAD_PARAMS");
+}
+
+TEST_GROUP(atcacert_der_public_key);
+
+TEST_SETUP(atcacert_der_public_key)
+{
+}
+
+TEST_TEAR_DOWN(atcacert_der_public_key)
+{
+}
+
+TEST(atcacert_der_public_key, atcacert_der_public_key__round_trip)
+{
+	int ret;
+	size_t i;
+	uint8_t public_key[64];
+	uint8_t public_key_dec[64];
+	uint8_t der_key[ATCACERT_DER_PUBLIC_KEY_SIZE];
+	size_t der_key_size = sizeof(der_key);
+	static const uint8_t der_key_hdr[] = { 0x03, 0x42, 0x00, 0x04 };
+
+	for (i = 0; i < sizeof(public_key); i++)
+		public_key[i] = (uint8_t)i;
+
+	ret = atcacert_der_enc_public_key(public_key, der_key, &der_key_size);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_SUCCESS, ret, "Expected ATCACERT_E_SUCCESS");
+	TEST_ASSERT_EQUAL(ATCACERT_DER_PUBLIC_KEY_SIZE, der_key_size);
+	TEST_ASSERT_EQUAL_MEMORY(der_key_hdr, der_key, sizeof(der_key_hdr));
+	TEST_ASSERT_EQUAL_MEMORY(public_key, &der_key[4], 64);
+
+	ret = atcacert_der_dec_public_key(der_key, &der_key_size, public_key_dec);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_SUCCESS, ret, "Expected ATCACERT_E_SUCCESS");
+	TEST_ASSERT_EQUAL(ATCACERT_DER_PUBLIC_KEY_SIZE, der_key_size);
+	TEST_ASSERT_EQUAL_MEMORY(public_key, public_key_dec, 64);
+
+	der_key_size = sizeof(der_key) - 1;
+	ret = atcacert_der_enc_public_key(public_key, der_key, &der_key_size);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_BUFFER_TOO_SMALL, ret, "Expected ATCACERT_E_BUFFER_TOO_SMALL");
+	TEST_ASSERT_EQUAL(ATCACERT_DER_PUBLIC_KEY_SIZE, der_key_size);
+}
+
+TEST(atcacert_der_public_key, atcacert_der_public_key__bad_encoding)
+{
+	int ret;
+	uint8_t public_key[64];
+	uint8_t der_key[ATCACERT_DER_PUBLIC_KEY_SIZE];
+	size_t der_key_size = sizeof(der_key);
+
+	memset(public_key, 0x5A, sizeof(public_key));
+	ret = atcacert_der_enc_public_key(public_key, der_key, &der_key_size);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_SUCCESS, ret, "Expected ATCACERT_E_SUCCESS");
+
+	der_key[3] = 0x02; // Compressed point
+	ret = atcacert_der_dec_public_key(der_key, &der_key_size, public_key);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_DECODING_ERROR, ret, "Expected ATCACERT_E_DECODING_ERROR");
+
+	der_key[3] = 0x04;
+	der_key_size = sizeof(der_key) - 1;
+	ret = atcacert_der_dec_public_key(der_key, &der_key_size, public_key);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_DECODING_ERROR, ret, "Expected ATCACERT_E_DECODING_ERROR");
+
+	ret = atcacert_der_dec_public_key(NULL, &der_key_size, public_key);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_BAD_PARAMS, ret, "Expected ATCACERT_E_BAD_PARAMS");
+
+	ret = atcacert_der_enc_public_key(NULL, der_key, &der_key_size);
+	TEST_ASSERT_EQUAL_MESSAGE(ATCACERT_E_BAD_PARAMS, ret, "Expected ATCACERT_E_BAD_PARAMS");
+}
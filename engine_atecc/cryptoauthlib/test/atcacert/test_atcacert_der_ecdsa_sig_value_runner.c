@@ -82,4 +82,27 @@ TEST_GROUP_RUNNER(atcacert_der_dec_ecdsa_sig_value)
 	RUN_TEST_CASE(atcacert_der_dec_ecdsa_sig_value, atcacert_der_dec_ecdsa_sig_value__bad_sint_length_high);
 	RUN_TEST_CASE(atcacert_der_dec_ecdsa_sig_value, atcacert_der_dec_ecdsa_sig_value__bad_rint_too_large);
 	RUN_TEST_CASE(atcacert_der_dec_ecdsa_sig_value, atcacert_der_dec_ecdsa_sig_value__bad_sint_too_large);
-}
\ No newline at end of file
+}
+
+TEST_GROUP_RUNNER(atcacert_der_enc_ecdsa_sig)
+{
+	RUN_TEST_CASE(atcacert_der_enc_ecdsa_sig, atcacert_der_enc_ecdsa_sig__trim);
+	RUN_TEST_CASE(atcacert_der_enc_ecdsa_sig, atcacert_der_enc_ecdsa_sig__rs_padding);
+	RUN_TEST_CASE(atcacert_der_enc_ecdsa_sig, atcacert_der_enc_ecdsa_sig__small_buf);
+	RUN_TEST_CASE(atcacert_der_enc_ecdsa_sig, atcacert_der_enc_ecdsa_sig__bad_params);
+}
+
+TEST_GROUP_RUNNER(atcacert_der_dec_ecdsa_sig)
+{
+	RUN_TEST_CASE(atcacert_der_dec_ecdsa_sig, atcacert_der_dec_ecdsa_sig__trim);
+	RUN_TEST_CASE(atcacert_der_dec_ecdsa_sig, atcacert_der_dec_ecdsa_sig__round_trip);
+	RUN_TEST_CASE(atcacert_der_dec_ecdsa_sig, atcacert_der_dec_ecdsa_sig__bad_seq_length);
+	RUN_TEST_CASE(atcacert_der_dec_ecdsa_sig, atcacert_der_dec_ecdsa_sig__bad_int_too_large);
+	RUN_TEST_CASE(atcacert_der_dec_ecdsa_sig, atcacert_der_dec_ecdsa_sig__bad_params);
+}
+
+TEST_GROUP_RUNNER(atcacert_der_public_key)
+{
+	RUN_TEST_CASE(atcacert_der_public_key, atcacert_der_public_key__round_trip);
+	RUN_TEST_CASE(atcacert_der_public_key, atcacert_der_public_key__bad_encoding);
+}
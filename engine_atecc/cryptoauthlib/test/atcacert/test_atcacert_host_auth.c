@@ -0,0 +1,483 @@
+/**
+ *
+ * \copyright Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The name of Atmel may not be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * EXPRESSLY AND SPECIFICALLY DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \atmel_crypto_device_library_license_stop
+ */
+ 
+#include "atcacert/atcacert_host_auth.h"
+#include "atca_status.h"
+#include "test/unity.h"
+#include "test/unity_fixture.h"
+#include "test_cert_def_0_device.h"
+#include "test_cert_def_1_signer.h"
+#include <string.h>
+
+// Test chain and response generated from the test certificate templates with throw-away keys
+static const uint8_t g_ca_public_key[64] = {
+	0x73, 0xA2, 0xB0, 0x27, 0x3C, 0xE6, 0xBC, 0x96, 0x75, 0x79, 0xCF, 0x21, 0x77, 0xF2, 0xA7, 0x72, 
+	0xE8, 0x46, 0x49, 0xA7, 0x88, 0xE0, 0x3C, 0xC4, 0x90, 0xB9, 0xF9, 0xB2, 0x44, 0x2E, 0x6B, 0x9F, 
+	0x44, 0xFE, 0xF7, 0xEC, 0xE7, 0x96, 0x05, 0x72, 0x30, 0x1B, 0x89, 0x7F, 0x8E, 0x44, 0x1E, 0x19, 
+	0x96, 0xF5, 0x42, 0x8E, 0x2E, 0x66, 0xE5, 0x06, 0x5C, 0xE9, 0x38, 0x1C, 0xB2, 0xF6, 0x88, 0x64
+};
+static const uint8_t g_signer_cert[] = {
+	0x30, 0x82, 0x01, 0xB2, 0x30, 0x82, 0x01, 0x57, 0xA0, 0x03, 0x02, 0x01, 0x02, 0x02, 0x03, 0x40, 
+	0x01, 0x02, 0x30, 0x0A, 0x06, 0x08, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x04, 0x03, 0x02, 0x30, 0x36, 
+	0x31, 0x10, 0x30, 0x0E, 0x06, 0x03, 0x55, 0x04, 0x0A, 0x0C, 0x07, 0x45, 0x78, 0x61, 0x6D, 0x70, 
+	0x6C, 0x65, 0x31, 0x22, 0x30, 0x20, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0C, 0x19, 0x45, 0x78, 0x61, 
+	0x6D, 0x70, 0x6C, 0x65, 0x20, 0x41, 0x54, 0x45, 0x43, 0x43, 0x35, 0x30, 0x38, 0x41, 0x20, 0x52, 
+	0x6F, 0x6F, 0x74, 0x20, 0x43, 0x41, 0x30, 0x1E, 0x17, 0x0D, 0x31, 0x35, 0x30, 0x37, 0x33, 0x31, 
+	0x30, 0x30, 0x31, 0x32, 0x31, 0x35, 0x5A, 0x17, 0x0D, 0x33, 0x35, 0x30, 0x37, 0x33, 0x31, 0x30, 
+	0x30, 0x31, 0x32, 0x31, 0x35, 0x5A, 0x30, 0x3A, 0x31, 0x10, 0x30, 0x0E, 0x06, 0x03, 0x55, 0x04, 
+	0x0A, 0x0C, 0x07, 0x45, 0x78, 0x61, 0x6D, 0x70, 0x6C, 0x65, 0x31, 0x26, 0x30, 0x24, 0x06, 0x03, 
+	0x55, 0x04, 0x03, 0x0C, 0x1D, 0x45, 0x78, 0x61, 0x6D, 0x70, 0x6C, 0x65, 0x20, 0x41, 0x54, 0x45, 
+	0x43, 0x43, 0x35, 0x30, 0x38, 0x41, 0x20, 0x53, 0x69, 0x67, 0x6E, 0x65, 0x72, 0x20, 0x58, 0x58, 
+	0x58, 0x58, 0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x02, 0x01, 0x06, 
+	0x08, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0x3C, 0xA1, 0xE8, 
+	0xD1, 0xA1, 0xFE, 0xF5, 0x00, 0xA0, 0xB8, 0xAD, 0x35, 0xE0, 0xCE, 0x37, 0x5B, 0x96, 0x4A, 0x49, 
+	0xE7, 0x61, 0xDE, 0x5D, 0xD5, 0xA8, 0xCE, 0x40, 0xA1, 0x95, 0xA1, 0x04, 0x42, 0x8E, 0xAB, 0x41, 
+	0x59, 0x8C, 0x75, 0xB9, 0xF5, 0xC6, 0x7F, 0x4F, 0x43, 0x03, 0x17, 0x91, 0x4B, 0x67, 0x35, 0x2B, 
+	0x7A, 0x85, 0x42, 0xA6, 0xF1, 0x6E, 0xD0, 0xF0, 0x0B, 0x5B, 0x13, 0xDB, 0xEA, 0xA3, 0x50, 0x30, 
+	0x4E, 0x30, 0x0C, 0x06, 0x03, 0x55, 0x1D, 0x13, 0x04, 0x05, 0x30, 0x03, 0x01, 0x01, 0xFF, 0x30, 
+	0x1D, 0x06, 0x03, 0x55, 0x1D, 0x0E, 0x04, 0x16, 0x04, 0x14, 0xF7, 0x33, 0x4E, 0x43, 0xA8, 0x2A, 
+	0xB4, 0xFE, 0x73, 0x5C, 0xBF, 0x35, 0xB5, 0x13, 0x7F, 0x31, 0x85, 0x57, 0xEC, 0x69, 0x30, 0x1F, 
+	0x06, 0x03, 0x55, 0x1D, 0x23, 0x04, 0x18, 0x30, 0x16, 0x80, 0x14, 0x95, 0x9E, 0x8F, 0x85, 0x01, 
+	0x2C, 0x8C, 0x1C, 0x03, 0xE9, 0x9F, 0x8C, 0x24, 0x7F, 0x48, 0x32, 0xEE, 0x15, 0xAB, 0x9A, 0x30, 
+	0x0A, 0x06, 0x08, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x04, 0x03, 0x02, 0x03, 0x49, 0x00, 0x30, 0x46, 
+	0x02, 0x21, 0x00, 0xB6, 0x6A, 0x90, 0x89, 0x0B, 0xC2, 0xC3, 0xD3, 0x8C, 0x35, 0xF2, 0x16, 0x5F, 
+	0x3E, 0xE5, 0x6B, 0x98, 0x6A, 0x3E, 0x9B, 0x98, 0xB8, 0xB7, 0x37, 0x55, 0x29, 0x40, 0xCD, 0xD0, 
+	0x8C, 0x4E, 0xE1, 0x02, 0x21, 0x00, 0xF4, 0xE3, 0xC6, 0x08, 0x6F, 0xBE, 0x3E, 0x14, 0xD7, 0x47, 
+	0xEC, 0xBF, 0xC9, 0xDB, 0x4B, 0x42, 0xEC, 0xE6, 0x37, 0x0F, 0x33, 0x3A, 0x7B, 0x0D, 0x39, 0xE3, 
+	0x80, 0xBA, 0xC7, 0x1B, 0x81, 0x6B
+};
+static const uint8_t g_device_cert[] = {
+	0x30, 0x82, 0x01, 0x8A, 0x30, 0x82, 0x01, 0x30, 0xA0, 0x03, 0x02, 0x01, 0x02, 0x02, 0x0A, 0x40, 
+	0x01, 0x23, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xEE, 0x30, 0x0A, 0x06, 0x08, 0x2A, 0x86, 0x48, 
+	0xCE, 0x3D, 0x04, 0x03, 0x02, 0x30, 0x3A, 0x31, 0x10, 0x30, 0x0E, 0x06, 0x03, 0x55, 0x04, 0x0A, 
+	0x0C, 0x07, 0x45, 0x78, 0x61, 0x6D, 0x70, 0x6C, 0x65, 0x31, 0x26, 0x30, 0x24, 0x06, 0x03, 0x55, 
+	0x04, 0x03, 0x0C, 0x1D, 0x45, 0x78, 0x61, 0x6D, 0x70, 0x6C, 0x65, 0x20, 0x41, 0x54, 0x45, 0x43, 
+	0x43, 0x35, 0x30, 0x38, 0x41, 0x20, 0x53, 0x69, 0x67, 0x6E, 0x65, 0x72, 0x20, 0x58, 0x58, 0x58, 
+	0x58, 0x30, 0x1E, 0x17, 0x0D, 0x31, 0x35, 0x30, 0x37, 0x33, 0x31, 0x30, 0x30, 0x31, 0x32, 0x31, 
+	0x36, 0x5A, 0x17, 0x0D, 0x33, 0x35, 0x30, 0x37, 0x33, 0x31, 0x30, 0x30, 0x31, 0x32, 0x31, 0x36, 
+	0x5A, 0x30, 0x35, 0x31, 0x10, 0x30, 0x0E, 0x06, 0x03, 0x55, 0x04, 0x0A, 0x0C, 0x07, 0x45, 0x78, 
+	0x61, 0x6D, 0x70, 0x6C, 0x65, 0x31, 0x21, 0x30, 0x1F, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0C, 0x18, 
+	0x45, 0x78, 0x61, 0x6D, 0x70, 0x6C, 0x65, 0x20, 0x41, 0x54, 0x45, 0x43, 0x43, 0x35, 0x30, 0x38, 
+	0x41, 0x20, 0x44, 0x65, 0x76, 0x69, 0x63, 0x65, 0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2A, 0x86, 
+	0x48, 0xCE, 0x3D, 0x02, 0x01, 0x06, 0x08, 0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x03, 0x01, 0x07, 0x03, 
+	0x42, 0x00, 0x04, 0xEE, 0x7B, 0xBA, 0x48, 0x63, 0x93, 0xFA, 0x53, 0x14, 0x54, 0xD7, 0xD1, 0xC4, 
+	0x8C, 0xE1, 0xD1, 0x7E, 0xEF, 0x77, 0xA9, 0x38, 0x07, 0x2E, 0x12, 0x0D, 0x37, 0xDD, 0x9E, 0x17, 
+	0xC8, 0x7A, 0x68, 0x06, 0x7E, 0xE9, 0x84, 0xD7, 0xDA, 0x3B, 0x08, 0x36, 0x47, 0xF4, 0xD2, 0x8F, 
+	0xCF, 0x27, 0x19, 0xFF, 0xD2, 0xEF, 0x77, 0x0D, 0xE3, 0x05, 0x9C, 0xCE, 0x40, 0x3A, 0x4F, 0x7C, 
+	0x0E, 0xCD, 0x84, 0xA3, 0x23, 0x30, 0x21, 0x30, 0x1F, 0x06, 0x03, 0x55, 0x1D, 0x23, 0x04, 0x18, 
+	0x30, 0x16, 0x80, 0x14, 0xF7, 0x33, 0x4E, 0x43, 0xA8, 0x2A, 0xB4, 0xFE, 0x73, 0x5C, 0xBF, 0x35, 
+	0xB5, 0x13, 0x7F, 0x31, 0x85, 0x57, 0xEC, 0x69, 0x30, 0x0A, 0x06, 0x08, 0x2A, 0x86, 0x48, 0xCE, 
+	0x3D, 0x04, 0x03, 0x02, 0x03, 0x48, 0x00, 0x30, 0x45, 0x02, 0x21, 0x00, 0xBB, 0x59, 0x08, 0xA0, 
+	0xDB, 0xBF, 0x10, 0xF3, 0x1B, 0xE7, 0x33, 0xBE, 0xE0, 0x4C, 0x3F, 0x82, 0xB0, 0xF5, 0xEF, 0xC3, 
+	0xDE, 0x4C, 0xC4, 0x20, 0x13, 0x34, 0x76, 0xFC, 0xFC, 0xF6, 0x6F, 0x91, 0x02, 0x20, 0x7B, 0xF9, 
+	0x0C, 0xD9, 0xE6, 0xF1, 0xCB, 0xA7, 0xAF, 0x9B, 0x07, 0xE2, 0xCB, 0x79, 0x17, 0x04, 0x4D, 0x7B, 
+	0x4C, 0x7F, 0x7F, 0x1A, 0xC4, 0x4E, 0xD4, 0x7E, 0x9E, 0x21, 0x7C, 0x5E, 0xF6, 0x93
+};
+static const uint8_t g_challenge[32] = {
+	0x0C, 0xA6, 0x34, 0xC8, 0x37, 0x2F, 0x87, 0x99, 0x99, 0x7E, 0x9E, 0xE9, 0xD5, 0xBC, 0x72, 0x71, 
+	0x84, 0xD1, 0x97, 0x0A, 0xEA, 0xFE, 0xAC, 0x60, 0x7E, 0xD1, 0x3E, 0x12, 0xB7, 0x32, 0x25, 0xF1
+};
+static const uint8_t g_response[64] = {
+	0xEF, 0x4E, 0x2E, 0xB7, 0xDD, 0x66, 0x9F, 0x6E, 0x3C, 0x41, 0xCF, 0x24, 0x74, 0x84, 0x70, 0xF9, 
+	0xCD, 0xDB, 0x0B, 0xD2, 0x8A, 0x74, 0xED, 0x97, 0x46, 0x81, 0xAE, 0xE2, 0x02, 0x35, 0xC1, 0x35, 
+	0xCF, 0xFB, 0x6C, 0x01, 0x49, 0x85, 0x75, 0x5F, 0xC8, 0xB4, 0x69, 0xC5, 0x42, 0xD5, 0xF2, 0x0A, 
+	0x7D, 0x8B, 0x7F, 0x63, 0x9C, 0x85, 0xA5, 0x98, 0x34, 0x1D, 0xAC, 0xAA, 0x03, 0xCD, 0xDC, 0x65
+};
+static const uint8_t g_device_public_key[64] = {
+	0xEE, 0x7B, 0xBA, 0x48, 0x63, 0x93, 0xFA, 0x53, 0x14, 0x54, 0xD7, 0xD1, 0xC4, 0x8C, 0xE1, 0xD1, 
+	0x7E, 0xEF, 0x77, 0xA9, 0x38, 0x07, 0x2E, 0x12, 0x0D, 0x37, 0xDD, 0x9E, 0x17, 0xC8, 0x7A, 0x68, 
+	0x06, 0x7E, 0xE9, 0x84, 0xD7, 0xDA, 0x3B, 0x08, 0x36, 0x47, 0xF4, 0xD2, 0x8F, 0xCF, 0x27, 0x19, 
+	0xFF, 0xD2, 0xEF, 0x77, 0x0D, 0xE3, 0x05, 0x9C, 0xCE, 0x40, 0x3A, 0x4F, 0x7C, 0x0E, 0xCD, 0x84
+};
+
+static atcacert_auth_ctx_t g_auth;
+static uint32_t g_now_ms;
+static uint8_t g_next_challenge[32];
+
+static uint32_t test_now_ms(void)
+{
+	return g_now_ms;
+}
+
+static int test_random(uint8_t* data, size_t data_size)
+{
+	memcpy(data, g_next_challenge, data_size);
+	return ATCA_SUCCESS;
+}
+
+TEST_GROUP(atcacert_host_auth);
+
+TEST_SETUP(atcacert_host_auth)
+{
+	int ret = atcacert_auth_init(&g_auth, &g_test_cert_def_1_signer, &g_test_cert_def_0_device, g_ca_public_key, 1000);
+
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	g_auth.random = test_random;
+	g_auth.now_ms = test_now_ms;
+	g_now_ms = 5000;
+	memcpy(g_next_challenge, g_challenge, sizeof(g_next_challenge));
+}
+
+TEST_TEAR_DOWN(atcacert_host_auth)
+{
+	atcacert_auth_release(&g_auth);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_device)
+{
+	int ret = 0;
+	uint8_t challenge[32];
+	atcacert_auth_stats_t stats;
+
+	ret = atcacert_auth_gen_challenge(&g_auth, challenge);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL_MEMORY(g_challenge, challenge, sizeof(challenge));
+
+	ret = atcacert_auth_device(&g_auth, g_signer_cert, sizeof(g_signer_cert), g_device_cert, sizeof(g_device_cert), challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+
+	ret = atcacert_auth_get_stats(&g_auth, &stats);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL(1, stats.challenges);
+	TEST_ASSERT_EQUAL(0, stats.key_hits);
+	TEST_ASSERT_EQUAL(2, stats.key_misses);
+	TEST_ASSERT_EQUAL(1, stats.verified);
+	TEST_ASSERT_EQUAL(0, stats.failed);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_get_device_key_cached)
+{
+	int ret = 0;
+	uint8_t public_key[64];
+	atcacert_auth_stats_t stats;
+
+	// Signer certificate isn't needed until the device certificate has been validated
+	ret = atcacert_auth_get_device_key(&g_auth, NULL, 0, g_device_cert, sizeof(g_device_cert), public_key);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_get_device_key(&g_auth, g_signer_cert, sizeof(g_signer_cert), g_device_cert, sizeof(g_device_cert), public_key);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL_MEMORY(g_device_public_key, public_key, sizeof(public_key));
+
+	memset(public_key, 0, sizeof(public_key));
+	ret = atcacert_auth_get_device_key(&g_auth, NULL, 0, g_device_cert, sizeof(g_device_cert), public_key);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL_MEMORY(g_device_public_key, public_key, sizeof(public_key));
+
+	ret = atcacert_auth_get_stats(&g_auth, &stats);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL(1, stats.key_hits);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_get_device_key_bad_signer)
+{
+	int ret = 0;
+	uint8_t public_key[64];
+	uint8_t bad_cert[sizeof(g_signer_cert)];
+
+	memcpy(bad_cert, g_signer_cert, sizeof(bad_cert));
+	bad_cert[g_test_cert_def_1_signer.std_cert_elements[STDCERT_PUBLIC_KEY].offset]++;
+
+	ret = atcacert_auth_get_device_key(&g_auth, bad_cert, sizeof(bad_cert), g_device_cert, sizeof(g_device_cert), public_key);
+	TEST_ASSERT_EQUAL(ATCACERT_E_VERIFY_FAILED, ret);
+
+	// Nothing from the failed chain may be cached
+	ret = atcacert_auth_get_device_key(&g_auth, NULL, 0, g_device_cert, sizeof(g_device_cert), public_key);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_get_device_key_device_as_signer)
+{
+	int ret = 0;
+	uint8_t public_key[64];
+	uint8_t forged_cert[sizeof(g_device_cert)];
+	uint8_t challenge[32];
+	atcacert_auth_request_t request;
+	int result = 0;
+	atcacert_auth_stats_t stats;
+
+	ret = atcacert_auth_get_device_key(&g_auth, g_signer_cert, sizeof(g_signer_cert), g_device_cert, sizeof(g_device_cert), public_key);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+
+	// A device could sign a certificate of its own. Its validated device certificate must not be
+	// taken from the key cache as a trusted signer.
+	memcpy(forged_cert, g_device_cert, sizeof(forged_cert));
+	forged_cert[g_test_cert_def_0_device.std_cert_elements[STDCERT_PUBLIC_KEY].offset]++;
+
+	ret = atcacert_auth_get_device_key(&g_auth, g_device_cert, sizeof(g_device_cert), forged_cert, sizeof(forged_cert), public_key);
+	TEST_ASSERT_NOT_EQUAL(ATCACERT_E_SUCCESS, ret);
+
+	ret = atcacert_auth_gen_challenge(&g_auth, challenge);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	request.signer_cert = g_device_cert;
+	request.signer_cert_size = sizeof(g_device_cert);
+	request.device_cert = forged_cert;
+	request.device_cert_size = sizeof(forged_cert);
+	request.challenge = challenge;
+	request.response = g_response;
+	ret = atcacert_auth_device_batch(&g_auth, 1, &request, &result);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_NOT_EQUAL(ATCACERT_E_SUCCESS, result);
+
+	// Both signer lookups missed, so the device certificate had to pass as a signer certificate
+	ret = atcacert_auth_get_stats(&g_auth, &stats);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL(0, stats.key_hits);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_verify_response_replay)
+{
+	int ret = 0;
+	uint8_t challenge[32];
+	atcacert_auth_stats_t stats;
+
+	ret = atcacert_auth_gen_challenge(&g_auth, challenge);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+
+	ret = atcacert_auth_verify_response(&g_auth, g_device_public_key, challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+
+	ret = atcacert_auth_verify_response(&g_auth, g_device_public_key, challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_CHALLENGE, ret);
+
+	ret = atcacert_auth_get_stats(&g_auth, &stats);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL(1, stats.verified);
+	TEST_ASSERT_EQUAL(1, stats.bad_challenges);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_verify_response_expired)
+{
+	int ret = 0;
+	uint8_t challenge[32];
+
+	ret = atcacert_auth_gen_challenge(&g_auth, challenge);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	g_now_ms += 1001;
+
+	ret = atcacert_auth_verify_response(&g_auth, g_device_public_key, challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_CHALLENGE, ret);
+
+	ret = atcacert_auth_gen_challenge(&g_auth, challenge);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	g_now_ms += 1000;
+
+	ret = atcacert_auth_verify_response(&g_auth, g_device_public_key, challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_verify_response_unknown)
+{
+	int ret = 0;
+
+	ret = atcacert_auth_verify_response(&g_auth, g_device_public_key, g_challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_CHALLENGE, ret);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_verify_response_bad_response)
+{
+	int ret = 0;
+	uint8_t challenge[32];
+	uint8_t bad_response[64];
+
+	memcpy(bad_response, g_response, sizeof(bad_response));
+	bad_response[0]++;
+
+	ret = atcacert_auth_gen_challenge(&g_auth, challenge);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+
+	ret = atcacert_auth_verify_response(&g_auth, g_device_public_key, challenge, bad_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_VERIFY_FAILED, ret);
+
+	// A failed attempt still uses up the challenge
+	ret = atcacert_auth_verify_response(&g_auth, g_device_public_key, challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_CHALLENGE, ret);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_gen_challenge_evict)
+{
+	int ret = 0;
+	int i = 0;
+	uint8_t challenge[32];
+	atcacert_auth_stats_t stats;
+
+	// Every challenge lands on the same slot, so the table runs out of probes
+	for (i = 0; i <= ATCACERT_AUTH_PROBES; i++) {
+		g_next_challenge[31] = (uint8_t)i;
+		ret = atcacert_auth_gen_challenge(&g_auth, challenge);
+		TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+		g_now_ms++;
+	}
+
+	ret = atcacert_auth_get_stats(&g_auth, &stats);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL(ATCACERT_AUTH_PROBES + 1, stats.challenges);
+	TEST_ASSERT_EQUAL(1, stats.evicted);
+
+	// The oldest challenge was dropped, the newest is still pending
+	g_next_challenge[31] = 0;
+	ret = atcacert_auth_verify_response(&g_auth, g_device_public_key, g_next_challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_CHALLENGE, ret);
+
+	g_next_challenge[31] = ATCACERT_AUTH_PROBES;
+	ret = atcacert_auth_verify_response(&g_auth, g_device_public_key, g_next_challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_VERIFY_FAILED, ret);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_bad_params)
+{
+	int ret = 0;
+	uint8_t challenge[32];
+	uint8_t public_key[64];
+	atcacert_auth_ctx_t* ctx = &g_auth;
+
+	ret = atcacert_auth_init(NULL, &g_test_cert_def_1_signer, &g_test_cert_def_0_device, g_ca_public_key, 1000);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_init(ctx, NULL, &g_test_cert_def_0_device, g_ca_public_key, 1000);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_init(ctx, &g_test_cert_def_1_signer, NULL, g_ca_public_key, 1000);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_init(ctx, &g_test_cert_def_1_signer, &g_test_cert_def_0_device, NULL, 1000);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_init(ctx, &g_test_cert_def_1_signer, &g_test_cert_def_0_device, g_ca_public_key, 0);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_gen_challenge(NULL, challenge);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_gen_challenge(ctx, NULL);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_get_device_key(NULL, g_signer_cert, sizeof(g_signer_cert), g_device_cert, sizeof(g_device_cert), public_key);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_get_device_key(ctx, g_signer_cert, sizeof(g_signer_cert), NULL, sizeof(g_device_cert), public_key);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_get_device_key(ctx, g_signer_cert, sizeof(g_signer_cert), g_device_cert, sizeof(g_device_cert), NULL);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_verify_response(NULL, g_device_public_key, g_challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_verify_response(ctx, NULL, g_challenge, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_verify_response(ctx, g_device_public_key, NULL, g_response);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_verify_response(ctx, g_device_public_key, g_challenge, NULL);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+
+	ret = atcacert_auth_get_stats(ctx, NULL);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+}
+
+TEST(atcacert_host_auth, atcacert_host_auth__atcacert_auth_device_batch)
+{
+	int ret = 0;
+	uint8_t challenge[32];
+	uint8_t other_challenge[32];
+	uint8_t bad_signer_cert[sizeof(g_signer_cert)];
+	atcacert_auth_request_t requests[5];
+	int results[5];
+	atcacert_auth_stats_t stats;
+	size_t i;
+
+	ret = atcacert_auth_gen_challenge(&g_auth, challenge);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	g_next_challenge[0] ^= 0x01;
+	ret = atcacert_auth_gen_challenge(&g_auth, other_challenge);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+
+	memcpy(bad_signer_cert, g_signer_cert, sizeof(bad_signer_cert));
+	bad_signer_cert[sizeof(bad_signer_cert) - 5] ^= 0x01;
+
+	for (i = 0; i < 5; i++) {
+		requests[i].signer_cert = g_signer_cert;
+		requests[i].signer_cert_size = sizeof(g_signer_cert);
+		requests[i].device_cert = g_device_cert;
+		requests[i].device_cert_size = sizeof(g_device_cert);
+		requests[i].challenge = challenge;
+		requests[i].response = g_response;
+	}
+	// 0 is good, 1 replays its challenge, 2 answers the wrong challenge, 3 has no device certificate,
+	// and 4 comes with a corrupted signer certificate, which is reported before its replayed challenge
+	requests[2].challenge = other_challenge;
+	requests[3].device_cert = NULL;
+	requests[4].signer_cert = bad_signer_cert;
+
+	ret = atcacert_auth_device_batch(&g_auth, 5, requests, results);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, results[0]);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_CHALLENGE, results[1]);
+	TEST_ASSERT_EQUAL(ATCACERT_E_VERIFY_FAILED, results[2]);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, results[3]);
+	TEST_ASSERT_EQUAL(ATCACERT_E_VERIFY_FAILED, results[4]);
+
+	ret = atcacert_auth_get_stats(&g_auth, &stats);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL(0, stats.key_hits);
+	TEST_ASSERT_EQUAL(8, stats.key_misses);
+	TEST_ASSERT_EQUAL(1, stats.verified);
+	TEST_ASSERT_EQUAL(2, stats.failed);
+	TEST_ASSERT_EQUAL(2, stats.bad_challenges);
+
+	// The good chain went into the key cache
+	memcpy(g_next_challenge, g_challenge, sizeof(g_next_challenge));
+	ret = atcacert_auth_gen_challenge(&g_auth, challenge);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	ret = atcacert_auth_device_batch(&g_auth, 1, requests, results);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, results[0]);
+
+	ret = atcacert_auth_get_stats(&g_auth, &stats);
+	TEST_ASSERT_EQUAL(ATCACERT_E_SUCCESS, ret);
+	TEST_ASSERT_EQUAL(1, stats.key_hits);
+	TEST_ASSERT_EQUAL(2, stats.verified);
+
+	ret = atcacert_auth_device_batch(&g_auth, ATCACERT_AUTH_BATCH_MAX + 1, requests, results);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+	ret = atcacert_auth_device_batch(NULL, 1, requests, results);
+	TEST_ASSERT_EQUAL(ATCACERT_E_BAD_PARAMS, ret);
+}
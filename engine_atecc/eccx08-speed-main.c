@@ -0,0 +1,958 @@
+/** \file eccx08-speed-main.c
+ * \brief Per primitive throughput and latency of the ateccx08 engine, in the manner of
+ * "openssl speed". Every primitive is run through OpenSSL with the engine set as the default, so
+ * the numbers include the engine and HAL overhead the applications see.
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Atmel nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <openssl/crypto.h>
+#include <openssl/engine.h>
+#include <openssl/ec.h>
+#include <openssl/ecdsa.h>
+#include <openssl/ecdh.h>
+#include <openssl/rsa.h>
+#include <openssl/rand.h>
+#include <openssl/obj_mac.h>
+#include <openssl/evp.h>
+#include "cryptoauthlib.h"
+#include "atcacert/atcacert_date.h"
+#include "atcacert/atcacert_def.h"
+#include "atcacert/atcacert_host_auth.h"
+#include "crypto/atca_crypto_sw_ecdsa.h"
+#include "engine_meth/ecc_meth.h"
+#include "engine_meth/platform.h"
+
+/*
+ * Each primitive runs on every thread for the same fixed time. A thread times every operation
+ * on its own and keeps the latencies in a log-linear histogram, so a run costs the same memory
+ * however many operations fit in it. Keys and other inputs are made before the clock starts.
+ *
+ * The engine build decides what is measured: with USE_ECCX08 the primitives go to the device
+ * over the HAL the engine was built for, without it the engine is its own software stand-in.
+ * "-e none" measures plain OpenSSL on the same host for reference. The cert-*, sw-* and
+ * auth-device primitives time cryptoauthlib on the host. OpenSSL only issues their certificates and
+ * signatures, with software keys, before the clock starts. A sw-batch op is a whole batch, divide
+ * by its size to compare with sw-verify.
+ */
+
+#define SPEED_DEFAULT_SECONDS   (3)
+#define SPEED_MAX_THREADS       (64)
+#define SPEED_RAND_MAX_SIZE     (8192)
+#define SPEED_RSA_BITS          (2048)
+#define SPEED_DATES             (64)
+#define SPEED_DEVICE_LOCS       (16)
+#define SPEED_BATCH_MAX         (32)
+
+// Latencies below 2^SPEED_HIST_SUB_BITS ns are exact, above they are kept to 1/32 of their size
+#define SPEED_HIST_SUB_BITS     (5)
+#define SPEED_HIST_SUB          (1 << SPEED_HIST_SUB_BITS)
+#define SPEED_HIST_BUCKETS      ((64 - SPEED_HIST_SUB_BITS) * SPEED_HIST_SUB)
+
+typedef struct speed_state_s speed_state;
+
+typedef struct {
+	const char* name;                               //!< Name on the command line and in the report
+	size_t size;                                    //!< Input size for sized primitives, 0 otherwise
+	int (*setup)(speed_state* state);               //!< Makes the inputs of one thread, 1 for success
+	int (*op)(speed_state* state);                  //!< One timed operation, 1 for success
+	void (*cleanup)(speed_state* state);
+} speed_test;
+
+struct speed_state_s {
+	const speed_test* test;
+	EC_KEY* key;
+	EC_KEY* peer;
+	ECDSA_SIG* sig;
+	RSA* rsa;
+	uint8_t digest[32];
+	uint8_t buf[SPEED_RAND_MAX_SIZE];
+	unsigned int sig_len;
+	uint8_t rsa_sig[SPEED_RSA_BITS / 8];
+	uint8_t certs[3][ECCX08_CERT_CACHE_MAX_CERT];
+	eccx08_extract_result_t* results;
+	atcacert_tm_utc_t dates[SPEED_DATES];
+	size_t date_index;
+	atcacert_device_loc_t device_locs[SPEED_DEVICE_LOCS];
+	size_t device_locs_count;
+	size_t cert_size;
+	atcacert_auth_ctx_t* auth;
+	int pinned;                                     //!< The CA key is pinned by this thread
+};
+
+/* A signer and a device certificate of the engine's definitions, shared read-only by the threads */
+typedef struct {
+	int ready;
+	uint8_t ca_public_key[64];
+	uint8_t signer_public_key[64];
+	uint8_t signer_cert[ECCX08_CERT_CACHE_MAX_CERT];
+	size_t signer_cert_size;
+	uint8_t device_cert[ECCX08_CERT_CACHE_MAX_CERT];
+	size_t device_cert_size;
+	uint8_t config[ATCA_CONFIG_SIZE];               //!< Config zone with the device SN of device_cert
+	uint8_t challenge[ATCACERT_AUTH_CHALLENGE_SIZE];
+	uint8_t response[64];                           //!< The device's answer to challenge
+	uint8_t digest[32];
+	uint8_t signer_sig[64];                         //!< digest signed by the signer key
+	uint8_t ca_sig[64];                             //!< digest signed by the CA key
+	uint8_t batch_digests[SPEED_BATCH_MAX][32];
+	uint8_t batch_sigs[SPEED_BATCH_MAX][64];        //!< batch_digests signed by the signer key
+	const uint8_t* batch_msgs[SPEED_BATCH_MAX];
+	const uint8_t* batch_signatures[SPEED_BATCH_MAX];
+	const uint8_t* batch_public_keys[SPEED_BATCH_MAX];
+} speed_host_inputs;
+
+typedef struct {
+	pthread_t thread;
+	speed_state state;
+	int ready;                                      //!< Setup succeeded
+	uint64_t ops;
+	uint64_t errors;
+	uint64_t max_ns;
+	uint64_t end_ns;                                //!< When the last operation of the thread returned
+	uint64_t hist[SPEED_HIST_BUCKETS];
+} speed_thread;
+
+static ENGINE* g_engine;
+static const char* g_key_file;
+static int g_devices = 1;
+static ATCAIfaceCfg g_cfgs[ECCX08_EXTRACT_POOL_MAX];
+static ATCAIfaceCfg* g_pcfgs[ECCX08_EXTRACT_POOL_MAX];
+
+static pthread_barrier_t g_start;
+static volatile int g_stop;
+
+static pthread_mutex_t* g_locks;
+
+static speed_host_inputs g_host;
+static pthread_once_t g_host_once = PTHREAD_ONCE_INIT;
+
+static uint64_t speed_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static size_t speed_hist_index(uint64_t ns)
+{
+	int e;
+
+	if (ns < 2 * SPEED_HIST_SUB)
+		return (size_t)ns;
+	e = 63 - __builtin_clzll(ns);
+	return (size_t)(e - SPEED_HIST_SUB_BITS) * SPEED_HIST_SUB + (size_t)(ns >> (e - SPEED_HIST_SUB_BITS));
+}
+
+/** \brief Largest latency that falls in a histogram bucket, so reported percentiles are never low.
+ */
+static uint64_t speed_hist_value(size_t index)
+{
+	int e;
+
+	if (index < 2 * SPEED_HIST_SUB)
+		return index;
+	e = (int)(index / SPEED_HIST_SUB) + SPEED_HIST_SUB_BITS - 1;
+	return (((uint64_t)(index % SPEED_HIST_SUB + SPEED_HIST_SUB) + 1) << (e - SPEED_HIST_SUB_BITS)) - 1;
+}
+
+static uint64_t speed_hist_percentile(const uint64_t* hist, uint64_t total, unsigned int percent)
+{
+	uint64_t rank = (total * percent + 99) / 100;
+	uint64_t seen = 0;
+	size_t i;
+
+	if (rank == 0)
+		rank = 1;
+	for (i = 0; i < SPEED_HIST_BUCKETS; i++) {
+		seen += hist[i];
+		if (seen >= rank)
+			return speed_hist_value(i);
+	}
+
+	return 0;
+}
+
+/* OpenSSL 1.0.2 is only thread safe with these callbacks installed */
+static void speed_locking_cb(int mode, int n, const char* file, int line)
+{
+	(void)file;
+	(void)line;
+	if (mode & CRYPTO_LOCK)
+		pthread_mutex_lock(&g_locks[n]);
+	else
+		pthread_mutex_unlock(&g_locks[n]);
+}
+
+static void speed_threadid_cb(CRYPTO_THREADID* id)
+{
+	CRYPTO_THREADID_set_numeric(id, (unsigned long)pthread_self());
+}
+
+static int speed_init_locking(void)
+{
+	int i;
+
+	g_locks = OPENSSL_malloc(CRYPTO_num_locks() * sizeof(*g_locks));
+	if (g_locks == NULL)
+		return 0;
+	for (i = 0; i < CRYPTO_num_locks(); i++)
+		pthread_mutex_init(&g_locks[i], NULL);
+	CRYPTO_THREADID_set_callback(speed_threadid_cb);
+	CRYPTO_set_locking_callback(speed_locking_cb);
+
+	return 1;
+}
+
+static EC_KEY* speed_new_p256_key(void)
+{
+	EC_KEY* key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+
+	if (key != NULL && !EC_KEY_generate_key(key)) {
+		EC_KEY_free(key);
+		key = NULL;
+	}
+
+	return key;
+}
+
+static int speed_ecdsa_sign_setup(speed_state* state)
+{
+	state->key = speed_new_p256_key();
+	return state->key != NULL && RAND_bytes(state->digest, sizeof(state->digest)) == 1;
+}
+
+static int speed_ecdsa_sign(speed_state* state)
+{
+	ECDSA_SIG* sig = ECDSA_do_sign(state->digest, sizeof(state->digest), state->key);
+
+	if (sig == NULL)
+		return 0;
+	ECDSA_SIG_free(sig);
+
+	return 1;
+}
+
+static int speed_ecdsa_verify_setup(speed_state* state)
+{
+	// Signed in software, the device would sign with its own key
+	EC_KEY* soft = speed_new_p256_key();
+
+	if (soft == NULL || RAND_bytes(state->digest, sizeof(state->digest)) != 1 || !ECDSA_set_method(soft, ECDSA_OpenSSL()))
+		goto done;
+	state->sig = ECDSA_do_sign(state->digest, sizeof(state->digest), soft);
+	state->key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+	if (state->key != NULL && !EC_KEY_set_public_key(state->key, EC_KEY_get0_public_key(soft))) {
+		EC_KEY_free(state->key);
+		state->key = NULL;
+	}
+
+done:
+	EC_KEY_free(soft);
+	return state->sig != NULL && state->key != NULL;
+}
+
+static int speed_ecdsa_verify(speed_state* state)
+{
+	return ECDSA_do_verify(state->digest, sizeof(state->digest), state->sig, state->key) == 1;
+}
+
+static int speed_ecdh_setup(speed_state* state)
+{
+	state->key = speed_new_p256_key();
+	state->peer = speed_new_p256_key();
+	return state->key != NULL && state->peer != NULL;
+}
+
+static int speed_ecdh(speed_state* state)
+{
+	return ECDH_compute_key(state->buf, 32, EC_KEY_get0_public_key(state->peer), state->key, NULL) > 0;
+}
+
+static int speed_rand(speed_state* state)
+{
+	return RAND_bytes(state->buf, (int)state->test->size) == 1;
+}
+
+static int speed_keyload_setup(speed_state* state)
+{
+	(void)state;
+	return g_engine != NULL && g_key_file != NULL;
+}
+
+static int speed_keyload(speed_state* state)
+{
+	EVP_PKEY* pkey = ENGINE_load_private_key(g_engine, g_key_file, NULL, NULL);
+
+	(void)state;
+	if (pkey == NULL)
+		return 0;
+	EVP_PKEY_free(pkey);
+
+	return 1;
+}
+
+static int speed_extract_setup(speed_state* state)
+{
+	if (g_engine == NULL)
+		return 0;
+	if (g_devices > 1) {
+		state->results = OPENSSL_malloc(g_devices * sizeof(*state->results));
+		if (state->results == NULL)
+			return 0;
+	}
+
+	return 1;
+}
+
+static int speed_extract(speed_state* state)
+{
+	eccx08_cert_chain_der_t chain;
+	eccx08_extract_pool_t pool;
+	int i;
+
+	if (g_devices > 1) {
+		pool.cfgs = g_pcfgs;
+		pool.count = (size_t)g_devices;
+		pool.results = state->results;
+		pool.wall_us = 0;
+		if (!ENGINE_ctrl(g_engine, ECCX08_CMD_EXTRACT_POOL, 0, &pool, 0))
+			return 0;
+		for (i = 0; i < g_devices; i++) {
+			if (state->results[i].status != ATCA_SUCCESS)
+				return 0;
+		}
+		return 1;
+	}
+
+	chain.device.der = state->certs[0];
+	chain.device.size = sizeof(state->certs[0]);
+	chain.signer.der = state->certs[1];
+	chain.signer.size = sizeof(state->certs[1]);
+	chain.root.der = state->certs[2];
+	chain.root.size = sizeof(state->certs[2]);
+
+	return ENGINE_ctrl(g_engine, ECCX08_CMD_GET_CERT_CHAIN_DER, 0, &chain, 0);
+}
+
+static int speed_rsa_setup(speed_state* state)
+{
+	RSA* soft = RSA_new();
+	BIGNUM* e = BN_new();
+	unsigned char* der = NULL;
+	const unsigned char* p;
+	int der_len = 0;
+
+	/* Generated in software and reloaded, so the private operations go through the default
+	 * method but the key itself is an ordinary one */
+	if (soft != NULL && e != NULL && BN_set_word(e, RSA_F4) && RSA_set_method(soft, RSA_PKCS1_SSLeay())
+	    && RSA_generate_key_ex(soft, SPEED_RSA_BITS, e, NULL))
+		der_len = i2d_RSAPrivateKey(soft, &der);
+	if (der_len > 0) {
+		p = der;
+		state->rsa = d2i_RSAPrivateKey(NULL, &p, der_len);
+	}
+	OPENSSL_free(der);
+	BN_free(e);
+	RSA_free(soft);
+
+	return state->rsa != NULL && RAND_bytes(state->digest, sizeof(state->digest)) == 1;
+}
+
+static int speed_rsa_sign(speed_state* state)
+{
+	return RSA_sign(NID_sha256, state->digest, sizeof(state->digest), state->rsa_sig, &state->sig_len, state->rsa);
+}
+
+/* Certificate validity dates are X.509 UTCTime */
+static int speed_date_setup(speed_state* state)
+{
+	size_t size;
+	int i;
+
+	for (i = 0; i < SPEED_DATES; i++) {
+		state->dates[i].tm_year = 100 + i % 50;
+		state->dates[i].tm_mon = i % 12;
+		state->dates[i].tm_mday = 1 + i % 28;
+		state->dates[i].tm_hour = i % 24;
+		state->dates[i].tm_min = i % 60;
+		state->dates[i].tm_sec = (i * 7) % 60;
+		size = DATEFMT_RFC5280_UTC_SIZE;
+		if (atcacert_date_enc(DATEFMT_RFC5280_UTC, &state->dates[i], &state->buf[i * DATEFMT_RFC5280_UTC_SIZE], &size) != ATCACERT_E_SUCCESS)
+			return 0;
+	}
+
+	return 1;
+}
+
+static int speed_date_enc(speed_state* state)
+{
+	size_t i = state->date_index++ % SPEED_DATES;
+	size_t size = DATEFMT_RFC5280_UTC_SIZE;
+
+	return atcacert_date_enc(DATEFMT_RFC5280_UTC, &state->dates[i], &state->buf[i * DATEFMT_RFC5280_UTC_SIZE], &size) == ATCACERT_E_SUCCESS;
+}
+
+static int speed_date_dec(speed_state* state)
+{
+	size_t i = state->date_index++ % SPEED_DATES;
+	atcacert_tm_utc_t date;
+
+	return atcacert_date_dec(DATEFMT_RFC5280_UTC, &state->buf[i * DATEFMT_RFC5280_UTC_SIZE], DATEFMT_RFC5280_UTC_SIZE, &date) == ATCACERT_E_SUCCESS;
+}
+
+/* Signs with OpenSSL, the engine is not the one issuing the certificates */
+static EC_KEY* speed_new_soft_p256_key(void)
+{
+	EC_KEY* key = speed_new_p256_key();
+
+	if (key != NULL && !ECDSA_set_method(key, ECDSA_OpenSSL())) {
+		EC_KEY_free(key);
+		key = NULL;
+	}
+
+	return key;
+}
+
+static int speed_raw_public_key(const EC_KEY* key, uint8_t public_key[64])
+{
+	uint8_t point[65];
+
+	if (EC_POINT_point2oct(EC_KEY_get0_group(key), EC_KEY_get0_public_key(key), POINT_CONVERSION_UNCOMPRESSED,
+	                       point, sizeof(point), NULL) != sizeof(point))
+		return 0;
+	memcpy(public_key, &point[1], 64);
+
+	return 1;
+}
+
+static int speed_raw_sign(EC_KEY* key, const uint8_t digest[32], uint8_t signature[64])
+{
+	ECDSA_SIG* sig = ECDSA_do_sign(digest, 32, key);
+	int ok;
+
+	if (sig == NULL)
+		return 0;
+	ok = BN_num_bytes(sig->r) <= 32 && BN_num_bytes(sig->s) <= 32;
+	if (ok) {
+		memset(signature, 0, 64);
+		BN_bn2bin(sig->r, &signature[32 - BN_num_bytes(sig->r)]);
+		BN_bn2bin(sig->s, &signature[64 - BN_num_bytes(sig->s)]);
+	}
+	ECDSA_SIG_free(sig);
+
+	return ok;
+}
+
+static int speed_issue_cert(const atcacert_def_t* cert_def, const uint8_t subject_public_key[64], const uint8_t* device_sn,
+                            EC_KEY* issuer, const uint8_t issuer_public_key[64], uint8_t* cert, size_t* cert_size)
+{
+	atcacert_tm_utc_t issue_date;
+	uint8_t tbs_digest[32];
+	uint8_t signature[64];
+	size_t max_cert_size = *cert_size;
+
+	if (cert_def->cert_template_size > max_cert_size)
+		return 0;
+	memcpy(cert, cert_def->cert_template, cert_def->cert_template_size);
+	*cert_size = cert_def->cert_template_size;
+
+	// Compressed certificates keep the issue date to the hour
+	if (atcacert_get_issue_date(cert_def, cert, *cert_size, &issue_date) != ATCACERT_E_SUCCESS)
+		return 0;
+	issue_date.tm_min = 0;
+	issue_date.tm_sec = 0;
+
+	return atcacert_set_issue_date(cert_def, cert, *cert_size, &issue_date) == ATCACERT_E_SUCCESS
+	       && atcacert_set_subj_public_key(cert_def, cert, *cert_size, subject_public_key) == ATCACERT_E_SUCCESS
+	       && atcacert_set_auth_key_id(cert_def, cert, *cert_size, issuer_public_key) == ATCACERT_E_SUCCESS
+	       && atcacert_gen_cert_sn(cert_def, cert, *cert_size, device_sn) == ATCACERT_E_SUCCESS
+	       && atcacert_get_tbs_digest(cert_def, cert, *cert_size, tbs_digest) == ATCACERT_E_SUCCESS
+	       && speed_raw_sign(issuer, tbs_digest, signature)
+	       && atcacert_set_signature(cert_def, cert, cert_size, max_cert_size, signature) == ATCACERT_E_SUCCESS;
+}
+
+static void speed_host_init(void)
+{
+	static const uint8_t device_sn[9] = { 0x01, 0x23, 0x5A, 0x3C, 0x11, 0x22, 0x33, 0x44, 0xEE };
+	EC_KEY* ca = speed_new_soft_p256_key();
+	EC_KEY* signer = speed_new_soft_p256_key();
+	EC_KEY* device = speed_new_soft_p256_key();
+	uint8_t device_public_key[64];
+	int i;
+
+	if (ca == NULL || signer == NULL || device == NULL)
+		goto done;
+	if (!speed_raw_public_key(ca, g_host.ca_public_key) || !speed_raw_public_key(signer, g_host.signer_public_key)
+	    || !speed_raw_public_key(device, device_public_key))
+		goto done;
+
+	g_host.signer_cert_size = sizeof(g_host.signer_cert);
+	g_host.device_cert_size = sizeof(g_host.device_cert);
+	if (!speed_issue_cert(&g_cert_def_1_signer_t, g_host.signer_public_key, NULL, ca, g_host.ca_public_key,
+	                      g_host.signer_cert, &g_host.signer_cert_size)
+	    || !speed_issue_cert(&g_cert_def_0_device_t, device_public_key, device_sn, signer, g_host.signer_public_key,
+	                         g_host.device_cert, &g_host.device_cert_size))
+		goto done;
+	if (RAND_bytes(g_host.challenge, sizeof(g_host.challenge)) != 1
+	    || !speed_raw_sign(device, g_host.challenge, g_host.response))
+		goto done;
+	if (RAND_bytes(g_host.digest, sizeof(g_host.digest)) != 1 || !speed_raw_sign(signer, g_host.digest, g_host.signer_sig)
+	    || !speed_raw_sign(ca, g_host.digest, g_host.ca_sig))
+		goto done;
+
+	// One signer for many messages, as for the device certificates of a reconnect storm
+	if (RAND_bytes(&g_host.batch_digests[0][0], sizeof(g_host.batch_digests)) != 1)
+		goto done;
+	for (i = 0; i < SPEED_BATCH_MAX; i++) {
+		if (!speed_raw_sign(signer, g_host.batch_digests[i], g_host.batch_sigs[i]))
+			goto done;
+		g_host.batch_msgs[i] = g_host.batch_digests[i];
+		g_host.batch_signatures[i] = g_host.batch_sigs[i];
+		g_host.batch_public_keys[i] = g_host.signer_public_key;
+	}
+
+	// The device SN is bytes 0-3 and 8-12 of the config zone
+	memcpy(&g_host.config[0], &device_sn[0], 4);
+	memcpy(&g_host.config[8], &device_sn[4], 5);
+	g_host.ready = 1;
+
+done:
+	EC_KEY_free(ca);
+	EC_KEY_free(signer);
+	EC_KEY_free(device);
+}
+
+static int speed_host_setup(void)
+{
+	pthread_once(&g_host_once, speed_host_init);
+	return g_host.ready;
+}
+
+/* Rebuilds the device certificate from the data atcacert_read_cert() would read, minus the reads */
+static int speed_cert_rebuild(speed_state* state)
+{
+	atcacert_build_state_t build_state;
+	const uint8_t* data = state->buf;
+	size_t cert_size = sizeof(state->certs[0]);
+	size_t i;
+
+	if (atcacert_cert_build_start(&build_state, &g_cert_def_0_device_t, state->certs[0], &cert_size,
+	                              g_host.signer_public_key) != ATCACERT_E_SUCCESS)
+		return 0;
+	for (i = 0; i < state->device_locs_count; i++) {
+		if (atcacert_cert_build_process(&build_state, &state->device_locs[i], data) != ATCACERT_E_SUCCESS)
+			return 0;
+		data += state->device_locs[i].count;
+	}
+
+	if (atcacert_cert_build_finish(&build_state) != ATCACERT_E_SUCCESS)
+		return 0;
+	state->cert_size = cert_size;
+
+	return 1;
+}
+
+static int speed_cert_rebuild_setup(speed_state* state)
+{
+	uint8_t* data = state->buf;
+	size_t i;
+
+	if (!speed_host_setup())
+		return 0;
+	if (atcacert_get_device_locs(&g_cert_def_0_device_t, state->device_locs, &state->device_locs_count,
+	                             SPEED_DEVICE_LOCS, 32) != ATCACERT_E_SUCCESS
+	    || atcacert_plan_device_reads(state->device_locs, &state->device_locs_count, 32) != ATCACERT_E_SUCCESS)
+		return 0;
+
+	for (i = 0; i < state->device_locs_count; i++) {
+		if (data + state->device_locs[i].count > state->buf + sizeof(state->buf))
+			return 0;
+		if (state->device_locs[i].zone == DEVZONE_CONFIG) {
+			if (state->device_locs[i].offset + state->device_locs[i].count > sizeof(g_host.config))
+				return 0;
+			memcpy(data, &g_host.config[state->device_locs[i].offset], state->device_locs[i].count);
+		} else if (atcacert_get_device_data(&g_cert_def_0_device_t, g_host.device_cert, g_host.device_cert_size,
+		                                    &state->device_locs[i], data) != ATCACERT_E_SUCCESS) {
+			return 0;
+		}
+		data += state->device_locs[i].count;
+	}
+
+	// Only time a rebuild that gives back the certificate
+	return speed_cert_rebuild(state) && state->cert_size == g_host.device_cert_size
+	       && memcmp(state->certs[0], g_host.device_cert, g_host.device_cert_size) == 0;
+}
+
+/* Every challenge is the same one, so the response made once answers all of them */
+static int speed_auth_random(uint8_t* data, size_t data_size)
+{
+	memcpy(data, g_host.challenge, data_size);
+	return ATCA_SUCCESS;
+}
+
+static int speed_auth_device(speed_state* state)
+{
+	uint8_t challenge[ATCACERT_AUTH_CHALLENGE_SIZE];
+
+	return atcacert_auth_gen_challenge(state->auth, challenge) == ATCACERT_E_SUCCESS
+	       && atcacert_auth_device(state->auth, g_host.signer_cert, g_host.signer_cert_size, g_host.device_cert,
+	                               g_host.device_cert_size, challenge, g_host.response) == ATCACERT_E_SUCCESS;
+}
+
+static int speed_auth_device_setup(speed_state* state)
+{
+	if (!speed_host_setup())
+		return 0;
+	state->auth = OPENSSL_malloc(sizeof(*state->auth));
+	if (state->auth == NULL)
+		return 0;
+	if (atcacert_auth_init(state->auth, &g_cert_def_1_signer_t, &g_cert_def_0_device_t, g_host.ca_public_key,
+	                       60000) != ATCACERT_E_SUCCESS) {
+		OPENSSL_free(state->auth);
+		state->auth = NULL;
+		return 0;
+	}
+	state->auth->random = speed_auth_random;
+
+	// A gateway that has seen the device before finds its chain in the key cache
+	return speed_auth_device(state);
+}
+
+static int speed_sw_verify_setup(speed_state* state)
+{
+	(void)state;
+	return speed_host_setup();
+}
+
+static int speed_sw_verify(speed_state* state)
+{
+	(void)state;
+	return atcac_sw_ecdsa_verify_p256(g_host.digest, g_host.signer_sig, g_host.signer_public_key) == ATCA_SUCCESS;
+}
+
+/* Pinning builds the verification table of the key, it is not timed */
+static int speed_sw_verify_pinned_setup(speed_state* state)
+{
+	if (!speed_host_setup() || atcac_sw_ecdsa_pin_key(g_host.ca_public_key) != ATCA_SUCCESS)
+		return 0;
+	state->pinned = 1;
+
+	return 1;
+}
+
+static int speed_sw_verify_pinned(speed_state* state)
+{
+	(void)state;
+	return atcac_sw_ecdsa_verify_p256(g_host.digest, g_host.ca_sig, g_host.ca_public_key) == ATCA_SUCCESS;
+}
+
+/* One op verifies test->size signatures */
+static int speed_sw_batch(speed_state* state)
+{
+	int results[SPEED_BATCH_MAX];
+	size_t i;
+
+	if (atcac_sw_ecdsa_verify_p256_batch(state->test->size, g_host.batch_msgs, g_host.batch_signatures,
+	                                     g_host.batch_public_keys, results) != ATCA_SUCCESS)
+		return 0;
+	for (i = 0; i < state->test->size; i++) {
+		if (results[i] != ATCA_SUCCESS)
+			return 0;
+	}
+
+	return 1;
+}
+
+static void speed_cleanup(speed_state* state)
+{
+	if (state->pinned)
+		atcac_sw_ecdsa_unpin_key(g_host.ca_public_key);
+	if (state->auth != NULL) {
+		atcacert_auth_release(state->auth);
+		OPENSSL_free(state->auth);
+	}
+	EC_KEY_free(state->key);
+	EC_KEY_free(state->peer);
+	ECDSA_SIG_free(state->sig);
+	RSA_free(state->rsa);
+	OPENSSL_free(state->results);
+	memset(state, 0, sizeof(*state));
+}
+
+static const speed_test g_tests[] = {
+	{ "ecdsa-sign",       0,    speed_ecdsa_sign_setup,       speed_ecdsa_sign,       speed_cleanup },
+	{ "ecdsa-verify",     0,    speed_ecdsa_verify_setup,     speed_ecdsa_verify,     speed_cleanup },
+	{ "ecdh",             0,    speed_ecdh_setup,             speed_ecdh,             speed_cleanup },
+	{ "rand",             16,   NULL,                         speed_rand,             speed_cleanup },
+	{ "rand",             64,   NULL,                         speed_rand,             speed_cleanup },
+	{ "rand",             256,  NULL,                         speed_rand,             speed_cleanup },
+	{ "rand",             1024, NULL,                         speed_rand,             speed_cleanup },
+	{ "rand",             8192, NULL,                         speed_rand,             speed_cleanup },
+	{ "keyload",          0,    speed_keyload_setup,          speed_keyload,          speed_cleanup },
+	{ "extract",          0,    speed_extract_setup,          speed_extract,          speed_cleanup },
+	{ "rsa-sign",         0,    speed_rsa_setup,              speed_rsa_sign,         speed_cleanup },
+	{ "cert-date-enc",    0,    speed_date_setup,             speed_date_enc,         speed_cleanup },
+	{ "cert-date-dec",    0,    speed_date_setup,             speed_date_dec,         speed_cleanup },
+	{ "cert-rebuild",     0,    speed_cert_rebuild_setup,     speed_cert_rebuild,     speed_cleanup },
+	{ "sw-verify",        0,    speed_sw_verify_setup,        speed_sw_verify,        speed_cleanup },
+	{ "sw-verify-pinned", 0,    speed_sw_verify_pinned_setup, speed_sw_verify_pinned, speed_cleanup },
+	{ "sw-batch",         8,    speed_sw_verify_setup,        speed_sw_batch,         speed_cleanup },
+	{ "sw-batch",         32,   speed_sw_verify_setup,        speed_sw_batch,         speed_cleanup },
+	{ "auth-device",      0,    speed_auth_device_setup,      speed_auth_device,      speed_cleanup },
+};
+
+#define SPEED_TEST_COUNT (sizeof(g_tests) / sizeof(g_tests[0]))
+
+static void* speed_worker(void* arg)
+{
+	speed_thread* t = (speed_thread*)arg;
+	uint64_t start, end, ns;
+	int ok;
+
+	t->ready = t->state.test->setup == NULL || t->state.test->setup(&t->state);
+	pthread_barrier_wait(&g_start);
+
+	end = speed_now_ns();
+	while (t->ready && !g_stop) {
+		start = speed_now_ns();
+		ok = t->state.test->op(&t->state);
+		end = speed_now_ns();
+		ns = end - start;
+		t->hist[speed_hist_index(ns)]++;
+		if (ns > t->max_ns)
+			t->max_ns = ns;
+		t->ops++;
+		if (!ok)
+			t->errors++;
+	}
+	t->end_ns = end;
+	t->state.test->cleanup(&t->state);
+
+	return NULL;
+}
+
+/** \brief Runs one primitive on every thread for the given time and prints its line of the report.
+ * \return 0 if the primitive ran, -1 if it could not be set up
+ */
+static int speed_run(const speed_test* test, speed_thread* threads, int thread_count, unsigned int seconds)
+{
+	static uint64_t hist[SPEED_HIST_BUCKETS];
+	char label[32];
+	uint64_t start, end = 0, ops = 0, errors = 0, max_ns = 0;
+	double elapsed;
+	int ready = 0;
+	int i;
+	size_t j;
+
+	memset(threads, 0, thread_count * sizeof(*threads));
+	memset(hist, 0, sizeof(hist));
+	g_stop = 0;
+	for (i = 0; i < thread_count; i++) {
+		threads[i].state.test = test;
+		pthread_create(&threads[i].thread, NULL, speed_worker, &threads[i]);
+	}
+
+	pthread_barrier_wait(&g_start);
+	start = speed_now_ns();
+	sleep(seconds);
+	g_stop = 1;
+	for (i = 0; i < thread_count; i++)
+		pthread_join(threads[i].thread, NULL);
+
+	for (i = 0; i < thread_count; i++) {
+		if (!threads[i].ready)
+			continue;
+		ready++;
+		ops += threads[i].ops;
+		errors += threads[i].errors;
+		if (threads[i].max_ns > max_ns)
+			max_ns = threads[i].max_ns;
+		if (threads[i].end_ns > end)
+			end = threads[i].end_ns;
+		for (j = 0; j < SPEED_HIST_BUCKETS; j++)
+			hist[j] += threads[i].hist[j];
+	}
+
+	if (test->size != 0)
+		snprintf(label, sizeof(label), "%s %zu", test->name, test->size);
+	else if (test->op == speed_extract && g_devices > 1)
+		snprintf(label, sizeof(label), "%s x%d", test->name, g_devices);
+	else
+		snprintf(label, sizeof(label), "%s", test->name);
+
+	if (ready == 0 || ops == 0) {
+		printf("%-16s %12s\n", label, "n/a");
+		return -1;
+	}
+
+	elapsed = (double)(end - start) / 1e9;
+	printf("%-16s %12llu %12.1f %10.1f %10.1f %10.1f %10.1f %8llu\n", label, (unsigned long long)ops,
+	       (double)ops / elapsed,
+	       speed_hist_percentile(hist, ops, 50) / 1e3, speed_hist_percentile(hist, ops, 90) / 1e3,
+	       speed_hist_percentile(hist, ops, 99) / 1e3, max_ns / 1e3, (unsigned long long)errors);
+	fflush(stdout);
+
+	return 0;
+}
+
+static void speed_device_cfgs(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+#ifdef ATCA_HAL_KIT_CDC
+		g_cfgs[i] = cfg_ecc508_kitcdc_default;
+		g_cfgs[i].atcauart.port = i;
+#elif ATCA_HAL_KIT_HID
+		g_cfgs[i] = cfg_ecc508_kithid_default;
+		g_cfgs[i].atcahid.idx = i;
+#elif ATCA_HAL_I2C
+		g_cfgs[i] = cfg_ateccx08a_i2c_default;
+		g_cfgs[i].atcai2c.bus = (uint8_t)i;
+#endif
+		g_pcfgs[i] = &g_cfgs[i];
+	}
+}
+
+static void usage(const char* prog)
+{
+	size_t i;
+
+	fprintf(stderr, "usage: %s [-e engine] [-s seconds] [-t threads] [-d devices] [-k key_file] [primitive ...]\n"
+	        "  -e  engine to measure, \"none\" for plain OpenSSL (default ateccx08)\n"
+	        "  -s  seconds each primitive runs (default %d)\n"
+	        "  -t  threads running each primitive at once (default 1)\n"
+	        "  -d  devices to extract certificates from in parallel, on ports 0..n-1 (default 1)\n"
+	        "  -k  private key file for the keyload primitive\n"
+	        "primitives:", prog, SPEED_DEFAULT_SECONDS);
+	for (i = 0; i < SPEED_TEST_COUNT; i++) {
+		if (i == 0 || strcmp(g_tests[i].name, g_tests[i - 1].name) != 0)
+			fprintf(stderr, " %s", g_tests[i].name);
+	}
+	fprintf(stderr, " (default all)\n");
+}
+
+/** \brief Measures the throughput and latency of each engine primitive.
+ *
+ * \return For success return 0
+ */
+int main(int argc, char* argv[])
+{
+	speed_thread* threads = NULL;
+	const char* engine_id = "ateccx08";
+	unsigned int seconds = SPEED_DEFAULT_SECONDS;
+	int thread_count = 1;
+	int opt;
+	int ran = 0;
+	int failed = 0;
+	int i;
+	size_t j;
+
+	while ((opt = getopt(argc, argv, "e:s:t:d:k:h")) != -1) {
+		switch (opt) {
+		case 'e': engine_id = optarg; break;
+		case 's': seconds = (unsigned int)strtoul(optarg, NULL, 0); break;
+		case 't': thread_count = atoi(optarg); break;
+		case 'd': g_devices = atoi(optarg); break;
+		case 'k': g_key_file = optarg; break;
+		default: usage(argv[0]); return 1;
+		}
+	}
+	if (seconds == 0 || thread_count < 1 || thread_count > SPEED_MAX_THREADS
+	    || g_devices < 1 || g_devices > ECCX08_EXTRACT_POOL_MAX) {
+		usage(argv[0]);
+		return 1;
+	}
+	for (i = optind; i < argc; i++) {
+		for (j = 0; j < SPEED_TEST_COUNT; j++) {
+			if (strcmp(argv[i], g_tests[j].name) == 0)
+				break;
+		}
+		if (j == SPEED_TEST_COUNT) {
+			fprintf(stderr, "unknown primitive: %s\n", argv[i]);
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!speed_init_locking())
+		return 1;
+	speed_device_cfgs(g_devices);
+
+	if (strcmp(engine_id, "none") != 0) {
+		ENGINE_load_builtin_engines();
+		g_engine = ENGINE_by_id(engine_id);
+		if (g_engine == NULL || !ENGINE_set_default(g_engine, ENGINE_METHOD_ALL)) {
+			fprintf(stderr, "cannot load engine %s\n", engine_id);
+			return 1;
+		}
+	}
+
+	threads = OPENSSL_malloc(thread_count * sizeof(*threads));
+	if (threads == NULL || pthread_barrier_init(&g_start, NULL, (unsigned int)thread_count + 1) != 0)
+		return 1;
+
+	printf("engine %s, %d thread(s), %u s per primitive, latencies in us\n", engine_id, thread_count, seconds);
+	printf("%-16s %12s %12s %10s %10s %10s %10s %8s\n", "primitive", "ops", "ops/s", "p50", "p90", "p99", "max",
+	       "errors");
+	for (j = 0; j < SPEED_TEST_COUNT; j++) {
+		if (optind < argc) {
+			for (i = optind; i < argc; i++) {
+				if (strcmp(argv[i], g_tests[j].name) == 0)
+					break;
+			}
+			if (i == argc)
+				continue;
+		}
+		if (speed_run(&g_tests[j], threads, thread_count, seconds) != 0)
+			failed++;
+		ran++;
+	}
+
+	pthread_barrier_destroy(&g_start);
+	OPENSSL_free(threads);
+	if (g_engine != NULL)
+		ENGINE_free(g_engine);
+
+	return failed == ran ? 1 : 0;
+}
@@ -37,16 +37,23 @@
  */
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include <openssl/engine.h>
 #include <crypto/ecdh/ech_locl.h>
 #include <crypto/ecdsa/ecs_locl.h>
 #include <crypto/asn1/asn1_locl.h>
 #include "ecc_meth.h"
+#include "platform.h"
+#include "crypto/atca_crypto_sw_ecdsa.h"
 
 /* Constants used when creating the ENGINE */
 static const char *engine_eccx08_id = "ateccx08";
 static const char *engine_eccx08_name = "Atmel ECCx08 hardware engine support";
 
+/* Set while the CA public key holds a pinned verification table */
+static int ca_key_pinned = 0;
+
 /**
  *  \brief This internal function is used by ENGINE_zencod () and possibly by the
  * "dynamic" ENGINE support too
@@ -62,6 +69,10 @@ static int bind_helper(ENGINE *e)
     use_software_ecdh = 1;
 #endif
 
+    // Levels first, so ECCX08_LOG=debug shows the binding too
+    if (atca_log_configure(getenv(ECCX08_LOG_ENV)) != ATCA_SUCCESS) {
+        eccx08_warn("bind_helper(): bad %s value\n", ECCX08_LOG_ENV);
+    }
     eccx08_debug("ECCX08 bind_helper()\n");
 
 #ifndef OPENSSL_NO_ECDSA
@@ -94,7 +105,7 @@ static int bind_helper(ENGINE *e)
         !ENGINE_set_RSA(e, ECCX08_RSA_meth()) ||
 #endif // !OPENSSL_NO_RSA
         (0)) {
-        eccx08_debug("encountered trouble!()\n");
+        eccx08_error("encountered trouble!()\n");
         return 0;
     }
 
@@ -136,8 +147,11 @@ static int bind_fn(ENGINE *e, const char *id)
     return 1;
 }
 
+// OpenSSL looks these up by name, keep them visible under -fvisibility=hidden
+#pragma GCC visibility push(default)
 IMPLEMENT_DYNAMIC_CHECK_FN();
 IMPLEMENT_DYNAMIC_BIND_FN(bind_fn);
+#pragma GCC visibility pop
 #endif // ENGINE_DYNAMIC_SUPPORT
 
 /**
@@ -202,7 +216,25 @@ int eccx08_destroy(ENGINE *e)
 int eccx08_init(ENGINE *e)
 {
     eccx08_debug("eccx08_init()\n");
-    return 1;
+    // Messages are queued for a writer thread from here to eccx08_finish()
+    atca_log_start(STDERR_FILENO);
+    if (!eccx08_trace_init()) {
+        return 0;
+    }
+    if (!eccx08_certcache_init()) {
+        return 0;
+    }
+    // Before the harvester starts using the device pool
+    if (!eccx08_failover_init()) {
+        return 0;
+    }
+    // Every signer certificate chains to this key, so give it a verification table
+    if (atcac_sw_ecdsa_pin_key(g_signer_1_ca_public_key_t) == ATCA_SUCCESS) {
+        ca_key_pinned = 1;
+    } else {
+        eccx08_warn("eccx08_init(): CA key not pinned\n");
+    }
+    return eccx08_entropy_init();
 }
 
 /**
@@ -214,8 +246,19 @@ int eccx08_init(ENGINE *e)
  */
 int eccx08_finish(ENGINE *e)
 {
+    int ret;
+
     eccx08_debug("eccx08_finish()\n");
-    return 1;
+    if (ca_key_pinned) {
+        atcac_sw_ecdsa_unpin_key(g_signer_1_ca_public_key_t);
+        ca_key_pinned = 0;
+    }
+    eccx08_certcache_finish();
+    ret = eccx08_entropy_finish();
+    // Last, so the trace written out holds the whole shutdown
+    eccx08_trace_finish();
+    atca_log_stop();
+    return ret;
 }
 
 /**
@@ -44,6 +44,7 @@
 #include "atca_status.h"
 #include "atcatls_cfg.h"
 #include "atcatls.h"
+#include "atca_log.h"
 
 //The engine version number. Must be updated for each engine release
 #define ECCX08_ENGINE_VERSION            "01.00.00"
@@ -66,13 +67,134 @@
 #define ECCX08_CMD_GET_ROOT_CERT         (ENGINE_CMD_BASE + 6)
 #define ECCX08_CMD_EXTRACT_ALL_CERTS     (ENGINE_CMD_BASE + 7)
 #define ECCX08_CMD_GET_PRIV_KEY          (ENGINE_CMD_BASE + 8)
-#define ECCX08_CMD_MAX                   (ENGINE_CMD_BASE + 9)
+#define ECCX08_CMD_GET_ENTROPY_STATS     (ENGINE_CMD_BASE + 9)
+#define ECCX08_CMD_GET_CERT_CHAIN_DER    (ENGINE_CMD_BASE + 10)
+#define ECCX08_CMD_GET_CERT_CHAIN        (ENGINE_CMD_BASE + 11)
+#define ECCX08_CMD_EXTRACT_POOL          (ENGINE_CMD_BASE + 12)
+#define ECCX08_CMD_GET_STATS             (ENGINE_CMD_BASE + 13)
+#define ECCX08_CMD_TRACE_ENABLE          (ENGINE_CMD_BASE + 14)
+#define ECCX08_CMD_TRACE_DUMP            (ENGINE_CMD_BASE + 15)
+#define ECCX08_CMD_LOG_LEVEL             (ENGINE_CMD_BASE + 16)
+#define ECCX08_CMD_DEADLINE              (ENGINE_CMD_BASE + 17)
+#define ECCX08_CMD_SW_FALLBACK           (ENGINE_CMD_BASE + 18)
+#define ECCX08_CMD_GET_FAILOVER_STATS    (ENGINE_CMD_BASE + 19)
+#define ECCX08_CMD_MAX                   (ENGINE_CMD_BASE + 20)
 
 #define ECCX08_SLOT8_ENC_STORE_LEN       (416)
 
 //Max number of pseudo-random bytes - re-seed after this number
 #define MAX_RAND_BYTES                   (10037)
 
+//Entropy prefetch ring: number of blocks (power of two) and block size
+#define ECCX08_ENTROPY_RING_SLOTS        (16)
+#define ECCX08_ENTROPY_BLOCK_SIZE        (TLS_RANDOM_SIZE)
+//The device must be idle this long (ms) before the harvester touches it
+#define ECCX08_ENTROPY_IDLE_MS           (50)
+//Upper limit of the harvester back off (ms)
+#define ECCX08_ENTROPY_BACKOFF_MAX_MS    (1000)
+
+//Rebuilt certificate cache: number of certificates and max certificate size
+#define ECCX08_CERT_CACHE_ENTRIES        (8)
+#define ECCX08_CERT_CACHE_MAX_CERT       (1024)
+//Environment variable with the file the cache is saved to (optional)
+#define ECCX08_CERT_CACHE_ENV            "ECCX08_CERT_CACHE"
+
+//Environment variable with the log levels, e.g. "debug" or "warn,engine=debug,hal=info"
+#define ECCX08_LOG_ENV                   "ECCX08_LOG"
+
+//Environment variable with the file the event trace is dumped to on SIGUSR2 and
+//at engine finish (optional), tracing starts with the engine when it is set
+#define ECCX08_TRACE_ENV                 "ECCX08_TRACE"
+
+//Deadline of every device operation (ms), 0 leaves only the per transfer
+//bound of the HAL (ATCA_DEADLINE_DEFAULT_MS)
+#define ECCX08_DEADLINE_DEFAULT_MS       (2000)
+//A device that timed out or failed is skipped by public operations this long (ms)
+#define ECCX08_DEVICE_HOLDOFF_MS         (1000)
+//Environment variables: the deadline in ms, the ports of the extra devices
+//public operations fail over to (e.g. "1,2") and "0" to keep public
+//operations from completing in software when no device answers
+#define ECCX08_DEADLINE_ENV              "ECCX08_DEADLINE_MS"
+#define ECCX08_DEVICES_ENV               "ECCX08_DEVICES"
+#define ECCX08_SW_FALLBACK_ENV           "ECCX08_SW_FALLBACK"
+
+//Parallel certificate extraction: max number of devices and certificates per device
+#define ECCX08_EXTRACT_POOL_MAX          (8)
+#define ECCX08_EXTRACT_CERTS             (2)
+#define ECCX08_EXTRACT_SIGNER            (0)
+#define ECCX08_EXTRACT_DEVICE            (1)
+
+/**
+ * \brief Entropy ring counters returned by the
+ *        ECCX08_CMD_GET_ENTROPY_STATS ctrl command
+ */
+typedef struct eccx08_entropy_stats_s {
+    uint32_t capacity;      //!< Ring size in blocks
+    uint32_t occupancy;     //!< Blocks currently stored in the ring
+    uint64_t harvested;     //!< Blocks read by the background harvester
+    uint64_t consumed;      //!< Blocks served from the ring
+    uint64_t starved;       //!< Requests that found the ring empty and went to the device
+    uint64_t backoffs;      //!< Harvest attempts skipped because the device was busy
+    uint64_t errors;        //!< Harvest attempts failed by the device
+} eccx08_entropy_stats_t;
+
+/**
+ * \brief Deadline and failover counters returned by the
+ *        ECCX08_CMD_GET_FAILOVER_STATS ctrl command
+ */
+typedef struct eccx08_failover_stats_s {
+    uint64_t timeouts;      //!< Operations that ran past their deadline
+    uint64_t failovers;     //!< Public operations retried on another device
+    uint64_t fallbacks;     //!< Public operations completed in software
+    uint64_t held_off;      //!< Devices skipped because they timed out or failed recently
+} eccx08_failover_stats_t;
+
+/**
+ * \brief One DER encoded certificate in a caller owned buffer
+ */
+typedef struct eccx08_cert_der_s {
+    uint8_t *der;           //!< Caller owned buffer for the certificate
+    size_t size;            //!< Buffer size as input, certificate size as output
+} eccx08_cert_der_t;
+
+/**
+ * \brief Certificate chain returned by the
+ *        ECCX08_CMD_GET_CERT_CHAIN_DER ctrl command
+ */
+typedef struct eccx08_cert_chain_der_s {
+    eccx08_cert_der_t device;   //!< Device certificate
+    eccx08_cert_der_t signer;   //!< Signer certificate
+    eccx08_cert_der_t root;     //!< Root (CA) certificate
+} eccx08_cert_chain_der_t;
+
+/**
+ * \brief Certificates and per phase wall-clock times of one
+ *        device, times are indexed by ECCX08_EXTRACT_SIGNER and
+ *        ECCX08_EXTRACT_DEVICE
+ */
+typedef struct eccx08_extract_result_s {
+    ATCA_STATUS status;                                 //!< ATCA_SUCCESS if both certificates were extracted and verified
+    uint8_t serial[ATCA_SERIAL_NUM_SIZE];               //!< Device serial number
+    uint8_t signer_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    size_t signer_cert_size;
+    uint8_t device_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    size_t device_cert_size;
+    uint64_t read_us[ECCX08_EXTRACT_CERTS];             //!< Time spent reading the device data
+    uint64_t build_us[ECCX08_EXTRACT_CERTS];            //!< Time spent rebuilding the DER
+    uint64_t verify_us[ECCX08_EXTRACT_CERTS];           //!< Time spent verifying the signature
+    uint64_t total_us;                                  //!< From the start of the run to the last certificate
+} eccx08_extract_result_t;
+
+/**
+ * \brief Argument of the ECCX08_CMD_EXTRACT_POOL ctrl command
+ */
+typedef struct eccx08_extract_pool_s {
+    ATCAIfaceCfg **cfgs;                    //!< Interface configuration of each device
+    size_t count;                           //!< Number of devices, up to ECCX08_EXTRACT_POOL_MAX
+    eccx08_extract_result_t *results;       //!< count results, filled in by the command
+    uint64_t wall_us;                       //!< Wall-clock time of the whole run
+} eccx08_extract_pool_t;
+
 extern ECDH_METHOD eccx08_ecdh;
 extern RAND_METHOD eccx08_rand;
 extern EVP_PKEY_ASN1_METHOD eccx08_pkey_asn1_meth;
@@ -80,7 +202,16 @@ extern ECDSA_METHOD eccx08_ecdsa;
 
 extern ATCAIfaceCfg *pCfg;
 
-int eccx08_debug(const char *fmt, ...);
+/* Engine messages. A source file may log under another category by
+ * defining ECCX08_LOG_CATEGORY before it includes this file.
+ */
+#ifndef ECCX08_LOG_CATEGORY
+#define ECCX08_LOG_CATEGORY              ATCA_LOG_ENGINE
+#endif
+#define eccx08_error(...)                ATCA_LOG_E(ECCX08_LOG_CATEGORY, __VA_ARGS__)
+#define eccx08_warn(...)                 ATCA_LOG_W(ECCX08_LOG_CATEGORY, __VA_ARGS__)
+#define eccx08_info(...)                 ATCA_LOG_I(ECCX08_LOG_CATEGORY, __VA_ARGS__)
+#define eccx08_debug(...)                ATCA_LOG_D(ECCX08_LOG_CATEGORY, __VA_ARGS__)
 
 //static void ERR_ECCX08_error(int function, int reason, char *file, int line);
 //#define ECCX08err(f,r) ERR_ECCX08_error((f),(r),__FILE__,__LINE__)
@@ -89,6 +220,8 @@ ATCA_STATUS eccx08_get_enc_key(uint8_t *enckey, int16_t keysize);
 
 int eccx08_pkey_meth_f(ENGINE *e, EVP_PKEY_METHOD **pkey_meth,
                        const int **nids, int nid);
+int eccx08_ecdsa_sign_der(const unsigned char *dgst, int dgst_len, EC_KEY *eckey,
+                          unsigned char *der_sig, size_t *der_sig_len);
 int eccx08_pkey_asn1_meth_f(ENGINE *e, EVP_PKEY_ASN1_METHOD **pkey_meth,
                             const int **nids, int nid);
 EVP_PKEY* eccx08_load_privkey(ENGINE *e, const char *key_id,
@@ -103,6 +236,7 @@ int eccx08_finish(ENGINE *e);
 int eccx08_ctrl(ENGINE *e, int cmd, long i, void *p, void (*f)());
 
 int eccx08_rand_init(void);
+int eccx08_rand_reseed(void);
 int eccx08_pkey_meth_init(void);
 int eccx08_pkey_asn1_meth_init(void);
 int eccx08_ecdh_init(uint32_t use_software);
@@ -126,6 +260,39 @@ int eccx08_eckey_convert(EC_KEY **p_eckey, uint8_t *raw_pubkey,
 int eccx08_BN_encrypt(BIGNUM *number, uint8_t *iv, uint8_t *aes_key);
 int eccx08_BN_decrypt(BIGNUM *number, uint8_t *iv, uint8_t *aes_key);
 
+//eccx08_entropy.c
+void eccx08_device_acquire(void);
+void eccx08_device_release(void);
+int eccx08_entropy_init(void);
+int eccx08_entropy_finish(void);
+int eccx08_entropy_get(uint8_t *buf, size_t len);
+int eccx08_entropy_get_stats(eccx08_entropy_stats_t *stats);
+
+//eccx08_certcache.c
+int eccx08_certcache_init(void);
+int eccx08_certcache_finish(void);
+void eccx08_certcache_invalidate_slot(uint8_t slot);
+ATCA_STATUS eccx08_certcache_get_cert(const atcacert_def_t *cert_def, const uint8_t *ca_public_key,
+                                      uint8_t *cert, size_t *cert_size);
+
+//eccx08_extract.c
+int eccx08_extract_pool(eccx08_extract_pool_t *pool);
+
+//eccx08_trace.c
+int eccx08_trace_init(void);
+int eccx08_trace_finish(void);
+int eccx08_trace_ctrl(int cmd, long i, void *p);
+
+//eccx08_failover.c
+typedef ATCA_STATUS (*eccx08_device_op_f)(ATCAIfaceCfg *cfg, void *arg);
+int eccx08_failover_init(void);
+void eccx08_deadline_begin(void);
+void eccx08_deadline_end(void);
+int eccx08_device_failed(ATCA_STATUS status);
+ATCA_STATUS eccx08_failover_run(eccx08_device_op_f op, void *arg);
+int eccx08_failover_sw_fallback(void);
+int eccx08_failover_ctrl(int cmd, long i, void *p);
+
 //eccx08_rsa_meth.c
 const RSA_METHOD* ECCX08_RSA_meth(void);
 
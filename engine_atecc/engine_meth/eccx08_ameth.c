@@ -125,7 +125,7 @@ int eccx08_item_sign(EVP_MD_CTX *ctx, const ASN1_ITEM *it, void *asn,
     EVP_PKEY *pkey;
     uint8_t *buf_in = NULL, *buf_out = NULL;
     uint8_t *sig_in = NULL, *sig_out = NULL;
-    size_t inl = 0, outl = 0, outll = 0;
+    size_t inl = 0, outl = 0, outll = 0, dgstl = 0;
     int signid, paramtype;
     uint8_t slotid = TLS_SLOT_AUTH_PRIV;
     ATCA_STATUS status = ATCA_GEN_FAIL;
@@ -179,19 +179,13 @@ int eccx08_item_sign(EVP_MD_CTX *ctx, const ASN1_ITEM *it, void *asn,
         ASN1err(ASN1_F_ASN1_ITEM_SIGN_CTX, ERR_R_MALLOC_FAILURE);
         goto done;
     }
-    ECDSA_SIG *ecdsasig;
-    ecdsasig = eccx08_ecdsa.ecdsa_do_sign(buf_out, outl, NULL, NULL, pkey->pkey.ec);
-    if (ecdsasig == NULL) goto done;
-    outl = i2d_ECDSA_SIG(ecdsasig, &sig_in);
-    if (ecdsasig->r) {
-        BN_free(ecdsasig->r);
-        ecdsasig->r = NULL;
-    }
-    if (ecdsasig->s) {
-        BN_free(ecdsasig->s);
-        ecdsasig->s = NULL;
+    // The raw signature is DER encoded straight into sig_out
+    dgstl = outl;
+    outl = outll;
+    if (!eccx08_ecdsa_sign_der(buf_out, (int)dgstl, pkey->pkey.ec, sig_out, &outl)) {
+        outl = 0;
+        goto done;
     }
-    ECDSA_SIG_free(ecdsasig);
 
 #else // USE_ECCX08
     eccx08_debug("eccx08_item_sign() - SW\n");
@@ -0,0 +1,610 @@
+/**
+ *  \file eccx08_certcache.c
+ * \brief Cache of the certificates rebuilt from the compressed
+ *        data stored in the ATECCX08 slots
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Atmel nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <openssl/engine.h>
+#define ECCX08_LOG_CATEGORY ATCA_LOG_CERT
+#include "ecc_meth.h"
+#include "atcacert/atcacert_client.h"
+#include "atcacert/atcacert_host_sw.h"
+#include "crypto/atca_crypto_sw_sha2.h"
+
+#define CERTCACHE_MAGIC          "ECX8CC01"
+#define CERTCACHE_MAGIC_SIZE     (8)
+#define CERTCACHE_HASH_SIZE      (ATCA_SHA2_256_DIGEST_SIZE)
+#define CERTCACHE_MAX_LOCS       (16)
+#define CERTCACHE_BLOCK_SIZE     (32)
+// Serial number, cert def id, source hash, slot mask and cert size
+#define CERTCACHE_ENTRY_HDR_SIZE (ATCA_SERIAL_NUM_SIZE + 2 * CERTCACHE_HASH_SIZE + 4)
+#define CERTCACHE_FILE_MAX_SIZE  (CERTCACHE_MAGIC_SIZE + 4 + CERTCACHE_HASH_SIZE + \
+                                  ECCX08_CERT_CACHE_ENTRIES * (CERTCACHE_ENTRY_HDR_SIZE + ECCX08_CERT_CACHE_MAX_CERT))
+
+/**
+ * \brief One rebuilt certificate and the device state it was
+ *        rebuilt from
+ */
+typedef struct {
+    uint8_t used;
+    uint8_t trusted;                              //!< Matched against the device by this process
+    const atcacert_def_t *cert_def;               //!< Definition that last matched a trusted entry
+    const ATCAIfaceCfg *cfg;                      //!< Device that last matched a trusted entry
+    uint32_t last_use;                            //!< Tick for the LRU replacement
+    uint8_t serial[ATCA_SERIAL_NUM_SIZE];         //!< Device serial number
+    uint8_t def_id[CERTCACHE_HASH_SIZE];          //!< Hash of the cert definition and CA public key
+    uint8_t src_hash[CERTCACHE_HASH_SIZE];        //!< Hash of the slot data the cert was rebuilt from
+    uint16_t slot_mask;                           //!< Data slots the cert depends on
+    uint16_t cert_size;
+    uint8_t cert[ECCX08_CERT_CACHE_MAX_CERT];
+} certcache_entry_t;
+
+static certcache_entry_t certcache[ECCX08_CERT_CACHE_ENTRIES];
+static pthread_mutex_t certcache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t certcache_tick = 0;
+static char certcache_path[256] = { 0 };
+
+/**
+ *
+ * \brief Computes the identity of a certificate definition: the
+ *        template, the device locations it is rebuilt from and
+ *        the CA public key used for the authority key id
+ *
+ * \param[in] cert_def - certificate definition
+ * \param[in] ca_public_key - 64 bytes CA public key, can be NULL
+ * \param[in] device_locs - planned device locations of cert_def
+ * \param[in] device_locs_count - number of items in device_locs
+ * \param[out] def_id - CERTCACHE_HASH_SIZE bytes identity
+ */
+static void certcache_def_id(const atcacert_def_t *cert_def, const uint8_t *ca_public_key,
+                             const atcacert_device_loc_t *device_locs, size_t device_locs_count,
+                             uint8_t *def_id)
+{
+    atcac_sha2_256_ctx ctx;
+    uint8_t buf[7];
+    size_t i;
+
+    atcac_sw_sha2_256_init(&ctx);
+    buf[0] = (uint8_t)cert_def->type;
+    buf[1] = cert_def->template_id;
+    buf[2] = cert_def->chain_id;
+    buf[3] = (uint8_t)cert_def->sn_source;
+    atcac_sw_sha2_256_update(&ctx, buf, 4);
+    atcac_sw_sha2_256_update(&ctx, cert_def->cert_template, cert_def->cert_template_size);
+    // Hash the locations field by field, the struct has padding
+    for (i = 0; i < device_locs_count; i++) {
+        buf[0] = (uint8_t)device_locs[i].zone;
+        buf[1] = device_locs[i].slot;
+        buf[2] = device_locs[i].is_genkey;
+        buf[3] = (uint8_t)(device_locs[i].offset >> 8);
+        buf[4] = (uint8_t)device_locs[i].offset;
+        buf[5] = (uint8_t)(device_locs[i].count >> 8);
+        buf[6] = (uint8_t)device_locs[i].count;
+        atcac_sw_sha2_256_update(&ctx, buf, sizeof(buf));
+    }
+    if (ca_public_key) {
+        atcac_sw_sha2_256_update(&ctx, ca_public_key, 64);
+    }
+    atcac_sw_sha2_256_finish(&ctx, def_id);
+}
+
+/**
+ *
+ * \brief Hashes the slot data a certificate is rebuilt from,
+ *        including the public keys computed by GenKey, so a
+ *        key generated by another process is also noticed.
+ *
+ * \param[in] device_locs - planned device locations
+ * \param[in] device_locs_count - number of items in device_locs
+ * \param[out] src_hash - CERTCACHE_HASH_SIZE bytes hash
+ * \param[out] slot_mask - data slots the certificate depends on
+ * \return ATCA_SUCCESS for success
+ */
+static ATCA_STATUS certcache_src_hash(const atcacert_device_loc_t *device_locs, size_t device_locs_count,
+                                      uint8_t *src_hash, uint16_t *slot_mask)
+{
+    ATCA_STATUS status = ATCA_SUCCESS;
+    atcac_sha2_256_ctx ctx;
+    uint8_t data[CERTCACHE_BLOCK_SIZE];
+    uint8_t pubkey[ATCA_PUB_KEY_SIZE];
+    size_t i;
+    size_t block;
+
+    *slot_mask = 0;
+    atcac_sw_sha2_256_init(&ctx);
+    status = atcab_wake_hold();
+    if (status != ATCA_SUCCESS) {
+        return status;
+    }
+    for (i = 0; i < device_locs_count && status == ATCA_SUCCESS; i++) {
+        if (device_locs[i].zone == DEVZONE_DATA) {
+            *slot_mask |= (uint16_t)(1 << (device_locs[i].slot & 0x0F));
+            if (device_locs[i].is_genkey) {
+                status = atcab_get_pubkey(device_locs[i].slot, pubkey);
+                if (status != ATCA_SUCCESS) {
+                    eccx08_error("certcache_src_hash(): error in atcab_get_pubkey\n");
+                    break;
+                }
+                atcac_sw_sha2_256_update(&ctx, pubkey, sizeof(pubkey));
+                continue;
+            }
+        }
+        for (block = device_locs[i].offset / CERTCACHE_BLOCK_SIZE;
+             block < (size_t)(device_locs[i].offset + device_locs[i].count) / CERTCACHE_BLOCK_SIZE; block++) {
+            status = atcab_read_zone(device_locs[i].zone, device_locs[i].slot, (uint8_t)block, 0,
+                                     data, CERTCACHE_BLOCK_SIZE);
+            if (status != ATCA_SUCCESS) {
+                eccx08_error("certcache_src_hash(): error in atcab_read_zone\n");
+                break;
+            }
+            atcac_sw_sha2_256_update(&ctx, data, CERTCACHE_BLOCK_SIZE);
+        }
+    }
+    atcab_wake_release();
+    atcac_sw_sha2_256_finish(&ctx, src_hash);
+    return status;
+}
+
+/**
+ *
+ * \brief Returns the interface configuration of the device the
+ *        basic API of this thread is bound to
+ *
+ * \return a pointer to the configuration, NULL if there is none
+ */
+static const ATCAIfaceCfg* certcache_device_cfg(void)
+{
+    ATCADevice device = atcab_getDevice();
+
+    if (device == NULL) {
+        return NULL;
+    }
+    return atgetifacecfg(atGetIFace(device));
+}
+
+/**
+ *
+ * \brief Picks the entry to store a new certificate into: a free
+ *        one or else the least recently used one
+ *
+ * \return a pointer to the entry
+ */
+static certcache_entry_t* certcache_victim(void)
+{
+    certcache_entry_t *victim = &certcache[0];
+    int i;
+
+    for (i = 0; i < ECCX08_CERT_CACHE_ENTRIES; i++) {
+        if (!certcache[i].used) {
+            return &certcache[i];
+        }
+        if (certcache[i].last_use < victim->last_use) {
+            victim = &certcache[i];
+        }
+    }
+    return victim;
+}
+
+/**
+ *
+ * \brief Writes the cache to certcache_path. The file is written
+ *        next to the old one and renamed over it, and ends with a
+ *        SHA-256 of its contents. Must be called with
+ *        certcache_mutex held.
+ *
+ * \return 1 for success
+ */
+static int certcache_save(void)
+{
+    uint8_t *buf = NULL;
+    size_t len = 0;
+    uint32_t count = 0;
+    char tmp_path[sizeof(certcache_path) + 8];
+    FILE *fd = NULL;
+    int fdn = -1;
+    int ret = 0;
+    int i;
+
+    if (certcache_path[0] == '\0') {
+        return 1;
+    }
+    buf = (uint8_t *)OPENSSL_malloc(CERTCACHE_FILE_MAX_SIZE);
+    if (buf == NULL) {
+        return 0;
+    }
+    memcpy(buf, CERTCACHE_MAGIC, CERTCACHE_MAGIC_SIZE);
+    len = CERTCACHE_MAGIC_SIZE + 4;
+    for (i = 0; i < ECCX08_CERT_CACHE_ENTRIES; i++) {
+        certcache_entry_t *entry = &certcache[i];
+        if (!entry->used) {
+            continue;
+        }
+        memcpy(&buf[len], entry->serial, ATCA_SERIAL_NUM_SIZE);
+        len += ATCA_SERIAL_NUM_SIZE;
+        memcpy(&buf[len], entry->def_id, CERTCACHE_HASH_SIZE);
+        len += CERTCACHE_HASH_SIZE;
+        memcpy(&buf[len], entry->src_hash, CERTCACHE_HASH_SIZE);
+        len += CERTCACHE_HASH_SIZE;
+        buf[len++] = (uint8_t)(entry->slot_mask >> 8);
+        buf[len++] = (uint8_t)entry->slot_mask;
+        buf[len++] = (uint8_t)(entry->cert_size >> 8);
+        buf[len++] = (uint8_t)entry->cert_size;
+        memcpy(&buf[len], entry->cert, entry->cert_size);
+        len += entry->cert_size;
+        count++;
+    }
+    buf[CERTCACHE_MAGIC_SIZE + 0] = (uint8_t)(count >> 24);
+    buf[CERTCACHE_MAGIC_SIZE + 1] = (uint8_t)(count >> 16);
+    buf[CERTCACHE_MAGIC_SIZE + 2] = (uint8_t)(count >> 8);
+    buf[CERTCACHE_MAGIC_SIZE + 3] = (uint8_t)count;
+    atcac_sw_sha2_256(buf, len, &buf[len]);
+    len += CERTCACHE_HASH_SIZE;
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", certcache_path);
+    fdn = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fdn < 0 || (fd = fdopen(fdn, "wb")) == NULL) {
+        eccx08_error("certcache_save(): cannot open file %s\n", tmp_path);
+        goto done;
+    }
+    if (fwrite(buf, 1, len, fd) != len || fflush(fd) != 0 || fsync(fdn) != 0) {
+        eccx08_error("certcache_save(): cannot write file %s\n", tmp_path);
+        goto done;
+    }
+    fclose(fd);
+    fd = NULL;
+    fdn = -1;
+    if (rename(tmp_path, certcache_path) != 0) {
+        eccx08_error("certcache_save(): cannot rename %s\n", tmp_path);
+        goto done;
+    }
+    ret = 1;
+done:
+    if (fd) {
+        fclose(fd);
+    } else if (fdn >= 0) {
+        close(fdn);
+    }
+    if (!ret) {
+        unlink(tmp_path);
+    }
+    OPENSSL_free(buf);
+    return ret;
+}
+
+/**
+ *
+ * \brief Loads the cache from certcache_path. A file that is
+ *        truncated, malformed or fails its hash is ignored. The
+ *        loaded entries are not trusted until they are matched
+ *        against the device and their signature is verified.
+ *        Must be called with certcache_mutex held.
+ *
+ * \return 1 if the file was loaded
+ */
+static int certcache_load(void)
+{
+    uint8_t *buf = NULL;
+    uint8_t digest[CERTCACHE_HASH_SIZE];
+    size_t len = 0;
+    size_t pos = 0;
+    uint32_t count = 0;
+    uint32_t i;
+    FILE *fd = NULL;
+    int ret = 0;
+
+    fd = fopen(certcache_path, "rb");
+    if (fd == NULL) {
+        return 0;
+    }
+    buf = (uint8_t *)OPENSSL_malloc(CERTCACHE_FILE_MAX_SIZE + 1);
+    if (buf == NULL) {
+        goto done;
+    }
+    len = fread(buf, 1, CERTCACHE_FILE_MAX_SIZE + 1, fd);
+    if (len > CERTCACHE_FILE_MAX_SIZE || len < CERTCACHE_MAGIC_SIZE + 4 + CERTCACHE_HASH_SIZE) {
+        goto done;
+    }
+    len -= CERTCACHE_HASH_SIZE;
+    atcac_sw_sha2_256(buf, len, digest);
+    if (memcmp(buf, CERTCACHE_MAGIC, CERTCACHE_MAGIC_SIZE) != 0
+        || CRYPTO_memcmp(digest, &buf[len], CERTCACHE_HASH_SIZE) != 0) {
+        eccx08_debug("certcache_load(): %s is corrupted, ignored\n", certcache_path);
+        goto done;
+    }
+    pos = CERTCACHE_MAGIC_SIZE;
+    count = ((uint32_t)buf[pos] << 24) | ((uint32_t)buf[pos + 1] << 16) | ((uint32_t)buf[pos + 2] << 8) | buf[pos + 3];
+    pos += 4;
+    if (count > ECCX08_CERT_CACHE_ENTRIES) {
+        goto done;
+    }
+    for (i = 0; i < count; i++) {
+        certcache_entry_t *entry = &certcache[i];
+        if (len - pos < CERTCACHE_ENTRY_HDR_SIZE) {
+            goto done;
+        }
+        memcpy(entry->serial, &buf[pos], ATCA_SERIAL_NUM_SIZE);
+        pos += ATCA_SERIAL_NUM_SIZE;
+        memcpy(entry->def_id, &buf[pos], CERTCACHE_HASH_SIZE);
+        pos += CERTCACHE_HASH_SIZE;
+        memcpy(entry->src_hash, &buf[pos], CERTCACHE_HASH_SIZE);
+        pos += CERTCACHE_HASH_SIZE;
+        entry->slot_mask = (uint16_t)((buf[pos] << 8) | buf[pos + 1]);
+        entry->cert_size = (uint16_t)((buf[pos + 2] << 8) | buf[pos + 3]);
+        pos += 4;
+        if (entry->cert_size > ECCX08_CERT_CACHE_MAX_CERT || len - pos < entry->cert_size) {
+            goto done;
+        }
+        memcpy(entry->cert, &buf[pos], entry->cert_size);
+        pos += entry->cert_size;
+        entry->trusted = 0;
+        entry->cert_def = NULL;
+        entry->cfg = NULL;
+        entry->last_use = 0;
+    }
+    if (pos != len) {
+        goto done;
+    }
+    for (i = 0; i < count; i++) {
+        certcache[i].used = 1;
+    }
+    ret = 1;
+done:
+    if (!ret) {
+        memset(certcache, 0, sizeof(certcache));
+    }
+    if (buf) {
+        OPENSSL_free(buf);
+    }
+    fclose(fd);
+    return ret;
+}
+
+/**
+ *
+ * \brief Initializes the certificate cache. When the
+ *        ECCX08_CERT_CACHE_ENV environment variable names a file
+ *        the cache is loaded from and saved to that file.
+ *
+ * \return 1 for success
+ */
+int eccx08_certcache_init(void)
+{
+    const char *path = getenv(ECCX08_CERT_CACHE_ENV);
+
+    eccx08_debug("eccx08_certcache_init()\n");
+
+    pthread_mutex_lock(&certcache_mutex);
+    memset(certcache, 0, sizeof(certcache));
+    certcache_path[0] = '\0';
+    if (path && path[0] != '\0' && strlen(path) < sizeof(certcache_path)) {
+        strcpy(certcache_path, path);
+        if (certcache_load()) {
+            eccx08_debug("eccx08_certcache_init(): loaded %s\n", certcache_path);
+        }
+    }
+    pthread_mutex_unlock(&certcache_mutex);
+    return 1;
+}
+
+/**
+ *
+ * \brief Drops all cached certificates from memory. The file, if
+ *        any, is kept for the next process.
+ *
+ * \return 1 for success
+ */
+int eccx08_certcache_finish(void)
+{
+    eccx08_debug("eccx08_certcache_finish()\n");
+
+    pthread_mutex_lock(&certcache_mutex);
+    memset(certcache, 0, sizeof(certcache));
+    certcache_path[0] = '\0';
+    pthread_mutex_unlock(&certcache_mutex);
+    return 1;
+}
+
+/**
+ *
+ * \brief Drops the certificates that depend on a data slot. Must
+ *        be called after the slot is written or a new key is
+ *        generated in it.
+ *
+ * \param[in] slot - data slot that has changed
+ */
+void eccx08_certcache_invalidate_slot(uint8_t slot)
+{
+    int dirty = 0;
+    int i;
+
+    pthread_mutex_lock(&certcache_mutex);
+    for (i = 0; i < ECCX08_CERT_CACHE_ENTRIES; i++) {
+        if (certcache[i].used && (certcache[i].slot_mask & (1 << (slot & 0x0F)))) {
+            memset(&certcache[i], 0, sizeof(certcache[i]));
+            dirty = 1;
+        }
+    }
+    if (dirty) {
+        certcache_save();
+    }
+    pthread_mutex_unlock(&certcache_mutex);
+}
+
+/**
+ *
+ * \brief Returns a certificate rebuilt from the device, in the
+ *        same way as atcatls_get_cert(). Must be called between
+ *        atcatls_init() and atcatls_finish().
+ *
+ *        A certificate already matched against the same device
+ *        by this process is returned without any device access.
+ *        Otherwise the serial number and the slot data behind
+ *        the certificate are read and hashed: that is enough to
+ *        find the certificate in the cache (or the file) without
+ *        the full rebuild. Certificates from the file are also
+ *        verified against ca_public_key before they are used.
+ *
+ * \param[in] cert_def - certificate definition
+ * \param[in] ca_public_key - 64 bytes CA public key
+ * \param[out] cert - buffer for the certificate
+ * \param[in,out] cert_size - size of cert as input, certificate
+ *       size as output
+ * \return ATCA_SUCCESS for success
+ */
+ATCA_STATUS eccx08_certcache_get_cert(const atcacert_def_t *cert_def, const uint8_t *ca_public_key,
+                                      uint8_t *cert, size_t *cert_size)
+{
+    ATCA_STATUS status = ATCA_SUCCESS;
+    atcacert_device_loc_t device_locs[CERTCACHE_MAX_LOCS];
+    size_t device_locs_count = 0;
+    uint8_t def_id[CERTCACHE_HASH_SIZE];
+    uint8_t src_hash[CERTCACHE_HASH_SIZE];
+    uint8_t serial[ATCA_SERIAL_NUM_SIZE];
+    uint16_t slot_mask = 0;
+    certcache_entry_t *entry = NULL;
+    const ATCAIfaceCfg *cfg = certcache_device_cfg();
+    int i;
+
+    if (cert_def == NULL || cert == NULL || cert_size == NULL) {
+        return ATCA_BAD_PARAM;
+    }
+    status = atcacert_get_device_locs(cert_def, device_locs, &device_locs_count, CERTCACHE_MAX_LOCS,
+                                      CERTCACHE_BLOCK_SIZE);
+    if (status == ATCACERT_E_SUCCESS) {
+        status = atcacert_plan_device_reads(device_locs, &device_locs_count, CERTCACHE_BLOCK_SIZE);
+    }
+    if (status != ATCACERT_E_SUCCESS) {
+        eccx08_error("eccx08_certcache_get_cert(): cannot get device locations\n");
+        return atcatls_get_cert(cert_def, ca_public_key, cert, cert_size);
+    }
+    certcache_def_id(cert_def, ca_public_key, device_locs, device_locs_count, def_id);
+
+    // Fast path: already matched against the device
+    pthread_mutex_lock(&certcache_mutex);
+    for (i = 0; i < ECCX08_CERT_CACHE_ENTRIES; i++) {
+        entry = &certcache[i];
+        if (entry->used && entry->trusted && entry->cert_def == cert_def && entry->cfg == cfg
+            && memcmp(entry->def_id, def_id, CERTCACHE_HASH_SIZE) == 0) {
+            break;
+        }
+    }
+    if (i < ECCX08_CERT_CACHE_ENTRIES) {
+        status = ATCA_SUCCESS;
+        if (*cert_size < entry->cert_size) {
+            status = ATCA_BAD_PARAM;
+        } else {
+            memcpy(cert, entry->cert, entry->cert_size);
+            *cert_size = entry->cert_size;
+            entry->last_use = ++certcache_tick;
+        }
+        pthread_mutex_unlock(&certcache_mutex);
+        eccx08_debug("eccx08_certcache_get_cert(): hit\n");
+        return status;
+    }
+    pthread_mutex_unlock(&certcache_mutex);
+
+    status = atcatls_get_sn(serial);
+    if (status != ATCA_SUCCESS) {
+        return status;
+    }
+    status = certcache_src_hash(device_locs, device_locs_count, src_hash, &slot_mask);
+    if (status != ATCA_SUCCESS) {
+        return status;
+    }
+
+    pthread_mutex_lock(&certcache_mutex);
+    for (i = 0; i < ECCX08_CERT_CACHE_ENTRIES; i++) {
+        entry = &certcache[i];
+        if (!entry->used || memcmp(entry->serial, serial, ATCA_SERIAL_NUM_SIZE) != 0
+            || memcmp(entry->def_id, def_id, CERTCACHE_HASH_SIZE) != 0) {
+            continue;
+        }
+        if (memcmp(entry->src_hash, src_hash, CERTCACHE_HASH_SIZE) != 0
+            || (!entry->trusted && ca_public_key
+                && atcacert_verify_cert_sw(cert_def, entry->cert, entry->cert_size, ca_public_key) != ATCACERT_E_SUCCESS)) {
+            // The slots were rewritten or the stored copy is bad
+            eccx08_debug("eccx08_certcache_get_cert(): stale entry dropped\n");
+            memset(entry, 0, sizeof(*entry));
+            continue;
+        }
+        if (*cert_size < entry->cert_size) {
+            pthread_mutex_unlock(&certcache_mutex);
+            return ATCA_BAD_PARAM;
+        }
+        entry->trusted = 1;
+        entry->cert_def = cert_def;
+        entry->cfg = cfg;
+        entry->last_use = ++certcache_tick;
+        memcpy(cert, entry->cert, entry->cert_size);
+        *cert_size = entry->cert_size;
+        pthread_mutex_unlock(&certcache_mutex);
+        eccx08_debug("eccx08_certcache_get_cert(): hit after device check\n");
+        return ATCA_SUCCESS;
+    }
+    pthread_mutex_unlock(&certcache_mutex);
+
+    eccx08_debug("eccx08_certcache_get_cert(): miss\n");
+    status = atcatls_get_cert(cert_def, ca_public_key, cert, cert_size);
+    if (status != ATCA_SUCCESS || *cert_size > ECCX08_CERT_CACHE_MAX_CERT) {
+        return status;
+    }
+
+    pthread_mutex_lock(&certcache_mutex);
+    entry = certcache_victim();
+    entry->used = 1;
+    entry->trusted = 1;
+    entry->cert_def = cert_def;
+    entry->cfg = cfg;
+    entry->last_use = ++certcache_tick;
+    memcpy(entry->serial, serial, ATCA_SERIAL_NUM_SIZE);
+    memcpy(entry->def_id, def_id, CERTCACHE_HASH_SIZE);
+    memcpy(entry->src_hash, src_hash, CERTCACHE_HASH_SIZE);
+    entry->slot_mask = slot_mask;
+    entry->cert_size = (uint16_t)*cert_size;
+    memcpy(entry->cert, cert, *cert_size);
+    if (!certcache_save()) {
+        eccx08_error("eccx08_certcache_get_cert(): cannot save %s\n", certcache_path);
+    }
+    pthread_mutex_unlock(&certcache_mutex);
+    return status;
+}
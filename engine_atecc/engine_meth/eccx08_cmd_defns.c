@@ -79,21 +79,56 @@ static const ENGINE_CMD_DEFN eccx08_cmd_defns[] = {
         "device_verify",
         "Verify device certificate using hardware",
         ENGINE_CMD_FLAG_NO_INPUT },
+    { ECCX08_CMD_GET_ENTROPY_STATS,
+        "entropy_stats",
+        "Get entropy prefetch ring occupancy and starvation counters",
+        ENGINE_CMD_FLAG_INTERNAL },
+    { ECCX08_CMD_GET_CERT_CHAIN_DER,
+        "cert_chain_der",
+        "Get device, signer and root certificates into caller DER buffers",
+        ENGINE_CMD_FLAG_INTERNAL },
+    { ECCX08_CMD_GET_CERT_CHAIN,
+        "cert_chain",
+        "Get device, signer and root certificates as a STACK_OF(X509)",
+        ENGINE_CMD_FLAG_INTERNAL },
+    { ECCX08_CMD_EXTRACT_POOL,
+        "extract_pool",
+        "Extract certificates from several devices in parallel with per phase timing",
+        ENGINE_CMD_FLAG_INTERNAL },
+    { ECCX08_CMD_GET_STATS,
+        "device_stats",
+        "Get per command device latency histograms, as text (i = buffer size) or an atca_stats (i = 0)",
+        ENGINE_CMD_FLAG_INTERNAL },
+    { ECCX08_CMD_TRACE_ENABLE,
+        "trace",
+        "Stop (0), start (1) or clear and start (2) the device event trace",
+        ENGINE_CMD_FLAG_NUMERIC },
+    { ECCX08_CMD_TRACE_DUMP,
+        "trace_dump",
+        "Write the device event trace to a file as Chrome trace JSON",
+        ENGINE_CMD_FLAG_STRING },
+    { ECCX08_CMD_LOG_LEVEL,
+        "log_level",
+        "Set the log levels, e.g. \"debug\" or \"warn,engine=debug,hal=info\"",
+        ENGINE_CMD_FLAG_STRING },
+    { ECCX08_CMD_DEADLINE,
+        "deadline",
+        "Set the deadline of every device operation in ms, 0 for none",
+        ENGINE_CMD_FLAG_NUMERIC },
+    { ECCX08_CMD_SW_FALLBACK,
+        "sw_fallback",
+        "Allow (1) or forbid (0) completing public operations in software when no device answers",
+        ENGINE_CMD_FLAG_NUMERIC },
+    { ECCX08_CMD_GET_FAILOVER_STATS,
+        "failover_stats",
+        "Get deadline, failover and software fallback counters",
+        ENGINE_CMD_FLAG_INTERNAL },
 
     { 0, NULL, NULL, 0 }
 };
 
 #include "platform.h"
 
-uint8_t signerPubkey[64] = { 0 };
-uint8_t caPubkey[64] = { 0 };
-uint8_t rootCert[1024] = { 0 };
-uint8_t signerCert[1024] = { 0 };
-uint8_t deviceCert[1024] = { 0 };
-size_t rootCertSize = 1024;
-size_t signerCertSize = 1024;
-size_t deviceCertSize = 1024;
-
 int get_device_cert(char *path);
 int get_public_key(void);
 int get_signer_cert(char *path);
@@ -104,72 +139,199 @@ int extract_all_certs(char *path);
 
 /**
  *
- * \brief Retrieves pre-programmed certificates from ATECCX08
- *        chip and saves them into temporary files as defined in
- *        the dev_cert_fname, signer_cert_fname, and
- *        root_cert_fname variables.
+ * \brief Saves a DER encoded certificate into a file
  *
- * \param[in] path a pointer to a buffer with a path to the
- *       certstore
+ * \param[in] fname the file name
+ * \param[in] der a pointer to the certificate
+ * \param[in] der_size the certificate size
  * \return ATCA_SUCCESS for success
  */
-int get_device_cert(char *path)
+static ATCA_STATUS save_der_cert(const char *fname, const uint8_t *der, size_t der_size)
 {
     ATCA_STATUS status = ATCA_GEN_FAIL;
-    int len = 0;
-    char dev_cert_fname[300];
+    size_t len = 0;
+    FILE *fd = fopen(fname, "wb");
 
-    snprintf(dev_cert_fname, 300, "%s/personal/AT_device.der", path);
+    if (fd == NULL) {
+        fprintf(stderr, "save_der_cert(): cannot open file %s\n", fname);
+        goto err;
+    }
+    len = fwrite(der, 1, der_size, fd);
+    if (len != der_size) {
+        fprintf(stderr, "save_der_cert(): cannot write file %s; len = %d\n", fname, (int)len);
+        goto err;
+    }
+    status = ATCA_SUCCESS;
+err:
+    if (fd) {
+        fclose(fd);
+    }
+    return status;
+}
 
-    eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_GET_DEVICE_CERT)\n");
-    // Get the device certificate
-    status = atcatls_get_cert(&g_cert_def_0_device_t, signerPubkey, deviceCert, &deviceCertSize);
+/**
+ *
+ * \brief Reads the signer certificate from the ATECCX08 chip
+ *        (or the certificate cache) into a caller buffer
+ *
+ * \param[out] cert a pointer to the buffer for the certificate
+ * \param[in,out] cert_size the buffer size as input, the
+ *       certificate size as output
+ * \return ATCA_SUCCESS for success
+ */
+static ATCA_STATUS read_signer_cert(uint8_t *cert, size_t *cert_size)
+{
+    ATCA_STATUS status = ATCA_GEN_FAIL;
+
+    status = eccx08_certcache_get_cert(&g_cert_def_1_signer_t, g_signer_1_ca_public_key_t, cert, cert_size);
+    if (status != ATCA_SUCCESS) {
+        eccx08_error("read_signer_cert(): error in eccx08_certcache_get_cert\n");
+    }
+    return status;
+}
+
+/**
+ *
+ * \brief Reads the signer public key out of the signer
+ *        certificate
+ *
+ * \param[out] signer_pubkey 64 bytes buffer for the public key
+ * \return ATCA_SUCCESS for success
+ */
+static ATCA_STATUS read_signer_pubkey(uint8_t *signer_pubkey)
+{
+    ATCA_STATUS status = ATCA_GEN_FAIL;
+    uint8_t signer_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    size_t signer_cert_size = sizeof(signer_cert);
+
+    status = read_signer_cert(signer_cert, &signer_cert_size);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_cmd_ctrl(): error in atcatls_get_cert\n");
         goto err;
     }
-    FILE *fd = fopen(dev_cert_fname, "wb");
-    if (fd == NULL) {
-        fprintf(stderr, "get_device_cert(): cannot open file %s\n", dev_cert_fname);
+    status = atcacert_get_subj_public_key(&g_cert_def_1_signer_t, signer_cert, signer_cert_size, signer_pubkey);
+    if (status != ATCA_SUCCESS) {
+        eccx08_error("read_signer_pubkey(): error in atcacert_get_subj_public_key\n");
+        goto err;
+    }
+err:
+    return status;
+}
+
+/**
+ *
+ * \brief Reads the device certificate from the ATECCX08 chip
+ *        (or the certificate cache) into a caller buffer
+ *
+ * \param[in] signer_pubkey 64 bytes signer public key
+ * \param[out] cert a pointer to the buffer for the certificate
+ * \param[in,out] cert_size the buffer size as input, the
+ *       certificate size as output
+ * \return ATCA_SUCCESS for success
+ */
+static ATCA_STATUS read_device_cert(const uint8_t *signer_pubkey, uint8_t *cert, size_t *cert_size)
+{
+    ATCA_STATUS status = ATCA_GEN_FAIL;
+
+    status = eccx08_certcache_get_cert(&g_cert_def_0_device_t, signer_pubkey, cert, cert_size);
+    if (status != ATCA_SUCCESS) {
+        eccx08_error("read_device_cert(): error in eccx08_certcache_get_cert\n");
+    }
+    return status;
+}
+
+/**
+ *
+ * \brief Reads the whole certificate chain into caller
+ *        buffers
+ *
+ * \param[in,out] chain buffers for the device, signer and root
+ *       certificates
+ * \return ATCA_SUCCESS for success
+ */
+static ATCA_STATUS read_cert_chain(eccx08_cert_chain_der_t *chain)
+{
+    ATCA_STATUS status = ATCA_GEN_FAIL;
+    uint8_t signer_pubkey[64];
+
+    status = read_signer_cert(chain->signer.der, &chain->signer.size);
+    if (status != ATCA_SUCCESS) {
         goto err;
     }
-    len = fwrite(deviceCert, 1, deviceCertSize, fd);
-    if (len != deviceCertSize) {
-        fprintf(stderr, "get_device_cert(): cannot write file %s; len = %d\n", dev_cert_fname, len);
+    status = atcacert_get_subj_public_key(&g_cert_def_1_signer_t, chain->signer.der, chain->signer.size,
+                                          signer_pubkey);
+    if (status != ATCA_SUCCESS) {
+        eccx08_error("read_cert_chain(): error in atcacert_get_subj_public_key\n");
+        goto err;
+    }
+    status = read_device_cert(signer_pubkey, chain->device.der, &chain->device.size);
+    if (status != ATCA_SUCCESS) {
+        goto err;
+    }
+    status = atcatls_get_ca_cert(chain->root.der, &chain->root.size);
+    if (status != ATCA_SUCCESS) {
+        eccx08_error("read_cert_chain(): error in atcatls_get_ca_cert\n");
         goto err;
     }
-    fclose(fd);
 err:
     return status;
 }
 
 /**
  *
- * \brief Retrieves the signer public key from ATECCX08 chip and
- *        saves them into a global signerPubkey buffer.
+ * \brief Retrieves pre-programmed device certificate from
+ *        ATECCX08 chip and saves it into a file in the
+ *        certstore
  *
+ * \param[in] path a pointer to a buffer with a path to the
+ *       certstore
  * \return ATCA_SUCCESS for success
  */
-int get_public_key(void)
+int get_device_cert(char *path)
 {
     ATCA_STATUS status = ATCA_GEN_FAIL;
+    char dev_cert_fname[300];
+    uint8_t signer_pubkey[64];
+    uint8_t device_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    size_t device_cert_size = sizeof(device_cert);
 
-    eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_GET_PUB_KEY)\n");
-    // Get the signer public key from the signer certificate
-    status = atcacert_get_subj_public_key(&g_cert_def_1_signer_t, signerCert, signerCertSize, signerPubkey);
+    snprintf(dev_cert_fname, 300, "%s/personal/AT_device.der", path);
+
+    eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_GET_DEVICE_CERT)\n");
+    status = read_signer_pubkey(signer_pubkey);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_cmd_ctrl(): error in atcacert_get_subj_public_key\n");
         goto err;
     }
+    // Get the device certificate
+    status = read_device_cert(signer_pubkey, device_cert, &device_cert_size);
+    if (status != ATCA_SUCCESS) {
+        goto err;
+    }
+    status = save_der_cert(dev_cert_fname, device_cert, device_cert_size);
 err:
     return status;
 }
 
+/**
+ *
+ * \brief Retrieves the signer public key from ATECCX08 chip to
+ *        check that it can be extracted from the signer
+ *        certificate
+ *
+ * \return ATCA_SUCCESS for success
+ */
+int get_public_key(void)
+{
+    uint8_t signer_pubkey[64];
+
+    eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_GET_PUB_KEY)\n");
+    return read_signer_pubkey(signer_pubkey);
+}
+
 /**
  *
  * \brief Retrieves pre-programmed signer certificate from
- *        ATECCX08 chip and saves it into a global signerCert
- *        buffer.
+ *        ATECCX08 chip and saves it into a file in the
+ *        certstore
  *
  * \param[in] path a pointer to a buffer with a path to the
  *       certstore
@@ -178,29 +340,19 @@ err:
 int get_signer_cert(char *path)
 {
     ATCA_STATUS status = ATCA_GEN_FAIL;
-    int len = 0;
     char signer_cert_fname[300];
+    uint8_t signer_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    size_t signer_cert_size = sizeof(signer_cert);
 
     snprintf(signer_cert_fname, 300, "%s/trusted/AT_signer.der", path);
 
     eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_GET_SIGNER_CERT)\n");
     // Get the signer certificate
-    status = atcatls_get_cert(&g_cert_def_1_signer_t, g_signer_1_ca_public_key_t, signerCert, &signerCertSize);
+    status = read_signer_cert(signer_cert, &signer_cert_size);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_cmd_ctrl(): error in atcatls_get_cert\n");
-        goto err;
-    }
-    FILE *fd = fopen(signer_cert_fname, "wb");
-    if (fd == NULL) {
-        fprintf(stderr, "get_signer_cert(): cannot open file %s\n", signer_cert_fname);
         goto err;
     }
-    len = fwrite(signerCert, 1, signerCertSize, fd);
-    if (len != signerCertSize) {
-        fprintf(stderr, "get_signer_cert(): cannot write file %s; len = %d\n", signer_cert_fname, len);
-        goto err;
-    }
-    fclose(fd);
+    status = save_der_cert(signer_cert_fname, signer_cert, signer_cert_size);
 err:
     return status;
 }
@@ -208,20 +360,26 @@ err:
 /**
  *
  * \brief Verifies the signer certificate using the ATECCX08
- *        chip hardware and data in caPubkey buffer (CA root
- *        key).
+ *        chip hardware and the CA root key.
  *
  * \return ATCA_SUCCESS for success
  */
 int verify_signer_cert(void)
 {
     ATCA_STATUS status = ATCA_GEN_FAIL;
+    uint8_t signer_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    size_t signer_cert_size = sizeof(signer_cert);
 
     eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_VERIFY_SIGNER_CERT)\n");
+    status = read_signer_cert(signer_cert, &signer_cert_size);
+    if (status != ATCA_SUCCESS) {
+        goto err;
+    }
     // Verify the signer certificate
-    status = atcacert_verify_cert_hw(&g_cert_def_1_signer_t, signerCert, signerCertSize, caPubkey);
+    status = atcacert_verify_cert_hw(&g_cert_def_1_signer_t, signer_cert, signer_cert_size,
+                                     g_signer_1_ca_public_key_t);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_cmd_ctrl(): error in atcacert_verify_cert_hw\n");
+        eccx08_error("eccx08_cmd_ctrl(): error in atcacert_verify_cert_hw\n");
         goto err;
     }
 err:
@@ -231,19 +389,30 @@ err:
 /**
  *
  * \brief Verifies the device certificate using the ATECCX08
- *        chip hardware and data in signerPubkey buffer.
+ *        chip hardware and the signer public key.
  *
  * \return ATCA_SUCCESS for success
  */
 int verify_device_cert(void)
 {
     ATCA_STATUS status = ATCA_GEN_FAIL;
+    uint8_t signer_pubkey[64];
+    uint8_t device_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    size_t device_cert_size = sizeof(device_cert);
 
     eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_VERIFY_DEVICE_CERT)\n");
+    status = read_signer_pubkey(signer_pubkey);
+    if (status != ATCA_SUCCESS) {
+        goto err;
+    }
+    status = read_device_cert(signer_pubkey, device_cert, &device_cert_size);
+    if (status != ATCA_SUCCESS) {
+        goto err;
+    }
     // Verify the device certificate
-    status = atcacert_verify_cert_hw(&g_cert_def_0_device_t, deviceCert, deviceCertSize, signerPubkey);
+    status = atcacert_verify_cert_hw(&g_cert_def_0_device_t, device_cert, device_cert_size, signer_pubkey);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_cmd_ctrl(): error in atcacert_verify_cert_hw\n");
+        eccx08_error("eccx08_cmd_ctrl(): error in atcacert_verify_cert_hw\n");
         goto err;
     }
 err:
@@ -253,8 +422,7 @@ err:
 /**
  *
  * \brief Retrieves pre-programmed CA certificate (the root)
- *        from ATECCX08 chip and saves it into a global rootCert
- *        buffer.
+ *        and saves it into a file in the certstore
  *
  * \param[in] path a pointer to a buffer with a path to the
  *       certstore
@@ -263,29 +431,20 @@ err:
 int get_root_cert(char *path)
 {
     ATCA_STATUS status = ATCA_GEN_FAIL;
-    int len = 0;
     char root_cert_fname[300];
+    uint8_t root_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    size_t root_cert_size = sizeof(root_cert);
 
     snprintf(root_cert_fname, 300, "%s/trusted/AT_root.der", path);
 
     eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_GET_ROOT_CERT)\n");
     // Get root certificate
-    status = atcatls_get_ca_cert(rootCert, &rootCertSize);
+    status = atcatls_get_ca_cert(root_cert, &root_cert_size);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_cmd_ctrl(): error in atcacert_verify_cert_hw\n");
-        goto err;
-    }
-    FILE *fd = fopen(root_cert_fname, "wb");
-    if (fd == NULL) {
-        fprintf(stderr, "get_root_cert(): cannot open file %s\n", root_cert_fname);
+        eccx08_error("eccx08_cmd_ctrl(): error in atcatls_get_ca_cert\n");
         goto err;
     }
-    len = fwrite(rootCert, 1, rootCertSize, fd);
-    if (len != rootCertSize) {
-        fprintf(stderr, "get_root_cert(): cannot write file %s; len = %d\n", root_cert_fname, len);
-        goto err;
-    }
-    fclose(fd);
+    status = save_der_cert(root_cert_fname, root_cert, root_cert_size);
 err:
     return status;
 }
@@ -293,8 +452,8 @@ err:
 /**
  *
  * \brief Retrieves all pre-programmed certificates from
- *        ATECCX08 chip and saves it into a global buffers.
- *        Calls functions to verify them.
+ *        ATECCX08 chip, verifies them and saves them into
+ *        files in the certstore.
  *
  * \param[in] path a pointer to a buffer with a path to the
  *       certstore
@@ -305,8 +464,6 @@ int extract_all_certs(char *path)
     ATCA_STATUS status = ATCA_GEN_FAIL;
 
     eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_EXTRACT_ALL_CERTS)\n");
-    // Get the CA public key
-    memcpy(caPubkey, g_signer_1_ca_public_key_t, sizeof(caPubkey));
 
     status = get_signer_cert(path);
     if (status != ATCA_SUCCESS) {
@@ -336,6 +493,156 @@ err:
     return status;
 }
 
+/**
+ *
+ * \brief Converts the certificate chain into a stack of X509
+ *        certificates: device, signer and root in this order
+ *
+ * \param[in] chain the DER encoded certificate chain
+ * \return a pointer to the new stack for success, NULL for
+ *         error
+ */
+static STACK_OF(X509)* cert_chain_to_x509(const eccx08_cert_chain_der_t *chain)
+{
+    STACK_OF(X509) *certs = NULL;
+    const eccx08_cert_der_t *der[3];
+    const unsigned char *ptr = NULL;
+    X509 *x509 = NULL;
+    int i;
+
+    der[0] = &chain->device;
+    der[1] = &chain->signer;
+    der[2] = &chain->root;
+
+    certs = sk_X509_new_null();
+    if (certs == NULL) {
+        goto err;
+    }
+    for (i = 0; i < 3; i++) {
+        ptr = der[i]->der;
+        x509 = d2i_X509(NULL, &ptr, (long)der[i]->size);
+        if (x509 == NULL || !sk_X509_push(certs, x509)) {
+            eccx08_error("cert_chain_to_x509(): cannot decode certificate %d\n", i);
+            X509_free(x509);
+            goto err;
+        }
+    }
+    return certs;
+err:
+    sk_X509_pop_free(certs, X509_free);
+    return NULL;
+}
+
+/**
+ *
+ * \brief Returns the per command device counters. Handles the
+ *        ECCX08_CMD_GET_STATS command. The text ends with the
+ *        failover counters (see ECCX08_CMD_GET_FAILOVER_STATS).
+ *
+ * \param[in] i size of the text buffer p, or 0 to copy the
+ *       counters into the atca_stats p points to
+ * \param[out] p text buffer or atca_stats
+ * \return 1 for success, 0 for error (including a text buffer
+ *         too small for the whole text)
+ */
+static int eccx08_cmd_stats(long i, void *p)
+{
+    atca_stats stats;
+    eccx08_failover_stats_t failover;
+    int len;
+
+    if (p == NULL || i < 0) {
+        return 0;
+    }
+    if (i == 0) {
+        atca_stats_get((atca_stats *)p);
+        return 1;
+    }
+    atca_stats_get(&stats);
+    len = atca_stats_print(&stats, (char *)p, i);
+    if (len >= i) {
+        return 0;
+    }
+    eccx08_failover_ctrl(ECCX08_CMD_GET_FAILOVER_STATS, 0, &failover);
+    len += snprintf((char *)p + len, i - len,
+                    "engine.timeouts %llu\nengine.failovers %llu\nengine.fallbacks %llu\nengine.held_off %llu\n",
+                    (unsigned long long)failover.timeouts, (unsigned long long)failover.failovers,
+                    (unsigned long long)failover.fallbacks, (unsigned long long)failover.held_off);
+    return len < i;
+}
+
+/**
+ *
+ * \brief Returns the certificate chain in memory. Handles the
+ *        ECCX08_CMD_GET_CERT_CHAIN_DER and
+ *        ECCX08_CMD_GET_CERT_CHAIN commands.
+ *
+ * \param[in] cmd the command
+ * \param[in,out] p a pointer to an eccx08_cert_chain_der_t
+ *       with caller owned buffers for
+ *       ECCX08_CMD_GET_CERT_CHAIN_DER, a pointer to a
+ *       STACK_OF(X509) * the new stack is returned into for
+ *       ECCX08_CMD_GET_CERT_CHAIN (free it with
+ *       sk_X509_pop_free(certs, X509_free))
+ * \return 1 for success, 0 for error
+ */
+static int eccx08_cmd_cert_chain(int cmd, void *p)
+{
+    ATCA_STATUS status = ATCA_GEN_FAIL;
+    eccx08_cert_chain_der_t local_chain;
+    eccx08_cert_chain_der_t *chain = NULL;
+    uint8_t device_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    uint8_t signer_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    uint8_t root_cert[ECCX08_CERT_CACHE_MAX_CERT];
+    STACK_OF(X509) *certs = NULL;
+
+    if (p == NULL) {
+        return 0;
+    }
+    if (cmd == ECCX08_CMD_GET_CERT_CHAIN_DER) {
+        eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_GET_CERT_CHAIN_DER)\n");
+        chain = (eccx08_cert_chain_der_t *)p;
+        if (chain->device.der == NULL || chain->signer.der == NULL || chain->root.der == NULL) {
+            return 0;
+        }
+    } else {
+        eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_GET_CERT_CHAIN)\n");
+        *(STACK_OF(X509) **)p = NULL;
+        local_chain.device.der = device_cert;
+        local_chain.device.size = sizeof(device_cert);
+        local_chain.signer.der = signer_cert;
+        local_chain.signer.size = sizeof(signer_cert);
+        local_chain.root.der = root_cert;
+        local_chain.root.size = sizeof(root_cert);
+        chain = &local_chain;
+    }
+
+    eccx08_device_acquire();
+    status = atcatls_init(pCfg);
+    if (status != ATCA_SUCCESS) {
+        eccx08_error("eccx08_cmd_ctrl(): error in atcatls_init\n");
+        eccx08_device_release();
+        return 0;
+    }
+    status = read_cert_chain(chain);
+    if (atcatls_finish() != ATCA_SUCCESS) {
+        eccx08_error("eccx08_cmd_ctrl(): error in atcatls_finish\n");
+    }
+    eccx08_device_release();
+    if (status != ATCA_SUCCESS) {
+        return 0;
+    }
+
+    if (cmd == ECCX08_CMD_GET_CERT_CHAIN) {
+        certs = cert_chain_to_x509(chain);
+        if (certs == NULL) {
+            return 0;
+        }
+        *(STACK_OF(X509) **)p = certs;
+    }
+    return 1;
+}
+
 /**
  *
  * \brief Call a function of the ateccx08 engine depending on
@@ -360,11 +667,42 @@ int eccx08_cmd_ctrl(ENGINE *e, int cmd, long i, void *p, void (*f)(void))
     char path[256];
     char *cmd_buf = (char *)p;
 
+    if (cmd == ECCX08_CMD_GET_ENTROPY_STATS) {
+        // Served from host memory, no need to wake the device
+        return eccx08_entropy_get_stats((eccx08_entropy_stats_t *)p);
+    }
+    if (cmd == ECCX08_CMD_GET_STATS) {
+        // Served from host memory, no need to wake the device
+        return eccx08_cmd_stats(i, p);
+    }
+    if (cmd == ECCX08_CMD_TRACE_ENABLE || cmd == ECCX08_CMD_TRACE_DUMP) {
+        // Served from host memory, no need to wake the device
+        return eccx08_trace_ctrl(cmd, i, p);
+    }
+    if (cmd == ECCX08_CMD_LOG_LEVEL) {
+        return p != NULL && atca_log_configure((const char *)p) == ATCA_SUCCESS;
+    }
+    if (cmd == ECCX08_CMD_DEADLINE || cmd == ECCX08_CMD_SW_FALLBACK || cmd == ECCX08_CMD_GET_FAILOVER_STATS) {
+        // Served from host memory, no need to wake the device
+        return eccx08_failover_ctrl(cmd, i, p);
+    }
+    if (cmd == ECCX08_CMD_EXTRACT_POOL) {
+        // Takes the device lock and binds every device itself
+        eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_EXTRACT_POOL)\n");
+        return eccx08_extract_pool((eccx08_extract_pool_t *)p);
+    }
+    if (cmd == ECCX08_CMD_GET_CERT_CHAIN_DER || cmd == ECCX08_CMD_GET_CERT_CHAIN) {
+        // p is not a certstore path for these
+        return eccx08_cmd_cert_chain(cmd, p);
+    }
+
     strncpy(path, p, 256);
     //ctx = ENGINE_get_ex_data(e, capi_idx);
+    eccx08_device_acquire();
     status = atcatls_init(&cfg_ecc508_kitcdc_default);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_cmd_ctrl(): error in atcatls_init\n");
+        eccx08_error("eccx08_cmd_ctrl(): error in atcatls_init\n");
+        eccx08_device_release();
         return ret;
     }
     if (cmd_buf) {
@@ -413,8 +751,9 @@ int eccx08_cmd_ctrl(ENGINE *e, int cmd, long i, void *p, void (*f)(void))
 err:
     status = atcatls_finish();
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_cmd_ctrl(): error in atcatls_finish\n");
+        eccx08_error("eccx08_cmd_ctrl(): error in atcatls_finish\n");
     }
+    eccx08_device_release();
     return ret;
 }
 
@@ -39,7 +39,6 @@
 
 #include <stdint.h>
 #include <assert.h>
-#include <stdarg.h>
 #include <openssl/engine.h>
 #include <openssl/ec.h>
 #include <crypto/ec/ec_lcl.h>
@@ -297,6 +296,9 @@ int eccx08_generate_key(EC_KEY *eckey, uint8_t *serial_number, int serial_len)
 
     if (!EC_GROUP_get_order(eckey->group, order, ctx)) goto err;
 
+    // Fresh hardware entropy for the key, taken from the prefetch ring
+    if (!eccx08_rand_reseed()) goto err;
+
     do if (!BN_rand_range(priv_key, order)) goto err;
     while (BN_is_zero(priv_key));
 
@@ -425,7 +427,7 @@ int eccx08_BN_encrypt(BIGNUM *number, uint8_t *iv, uint8_t *aes_key)
 
     /* Create and initialise the context */
     if (!(ctx = EVP_CIPHER_CTX_new())) {
-        eccx08_debug("eccx08_BN_encrypt() context init failed\n");
+        eccx08_error("eccx08_BN_encrypt() context init failed\n");
         goto err;
     }
 
@@ -435,18 +437,18 @@ int eccx08_BN_encrypt(BIGNUM *number, uint8_t *iv, uint8_t *aes_key)
      * The IV size for *most* modes is the same as the block size. For AES this
      * is 128 bits */
     if (1 != EVP_EncryptInit_ex(ctx, EVP_aes_256_ofb(), NULL, aes_key, iv)) {
-        eccx08_debug("eccx08_BN_encrypt() encrypt init failed\n");
+        eccx08_error("eccx08_BN_encrypt() encrypt init failed\n");
         goto err;
     }
 
     if (1 != EVP_EncryptUpdate(ctx, ciphertext, &len, plaintext, len)) {
-        eccx08_debug("eccx08_BN_encrypt() encrypt update failed\n");
+        eccx08_error("eccx08_BN_encrypt() encrypt update failed\n");
         goto err;
     }
     cipher_len = len;
 
     if (1 != EVP_EncryptFinal_ex(ctx, ciphertext + len, &len)) {
-        eccx08_debug("eccx08_BN_encrypt() encrypt final failed\n");
+        eccx08_error("eccx08_BN_encrypt() encrypt final failed\n");
         goto err;
     }
     cipher_len += len;
@@ -505,7 +507,7 @@ int eccx08_BN_decrypt(BIGNUM *number, uint8_t *iv, uint8_t *aes_key)
 
     /* Create and initialise the context */
     if (!(ctx = EVP_CIPHER_CTX_new())) {
-        eccx08_debug("eccx08_BN_decrypt() context init failed\n");
+        eccx08_error("eccx08_BN_decrypt() context init failed\n");
         goto err;
     }
 
@@ -515,18 +517,18 @@ int eccx08_BN_decrypt(BIGNUM *number, uint8_t *iv, uint8_t *aes_key)
      * The IV size for *most* modes is the same as the block size. For AES this
      * is 128 bits */
     if (1 != EVP_DecryptInit_ex(ctx, EVP_aes_256_ofb(), NULL, aes_key, iv)) {
-        eccx08_debug("eccx08_BN_decrypt() decrypt init failed\n");
+        eccx08_error("eccx08_BN_decrypt() decrypt init failed\n");
         goto err;
     }
 
     if (1 != EVP_DecryptUpdate(ctx, plaintext, &len, ciphertext, len)) {
-        eccx08_debug("eccx08_BN_decrypt() decrypt update failed\n");
+        eccx08_error("eccx08_BN_decrypt() decrypt update failed\n");
         goto err;
     }
     plain_len = len;
 
     if (1 != EVP_DecryptFinal_ex(ctx, plaintext + len, &len)) {
-        eccx08_debug("eccx08_BN_decrypt() decrypt final failed\n");
+        eccx08_error("eccx08_BN_decrypt() decrypt final failed\n");
         goto err;
     }
     plain_len += len;
@@ -546,28 +548,3 @@ err:
 
     return ret;
 }
-
-#ifdef ECC_DEBUG
-/**
- *
- * \brief Debugging function to print out ateccx08 messages. For
- *        detail see help on a standard printf() function
- *
- * \param[in] fmt the format string
- * \return 1 for success
- */
-int eccx08_debug(const char *fmt, ...)
-{
-    va_list args;
-    va_start(args, fmt);
-    fprintf(stderr, "ATECCX08: ");
-    vfprintf(stderr, fmt, args);
-    va_end(args);
-    return (1);
-}
-#else
-int eccx08_debug(const char *fmt, ...)
-{
-    return (1);
-}
-#endif
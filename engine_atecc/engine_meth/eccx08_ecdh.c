@@ -81,6 +81,7 @@ static int ECDH_eccx08_get_pubkey(EC_POINT *pub_key, uint8_t *serial_number, int
     int asn1_flag = OPENSSL_EC_NAMED_CURVE;
     point_conversion_form_t form = POINT_CONVERSION_UNCOMPRESSED;
     char tmp_buf[MEM_BLOCK_SIZE * 2 + 1];
+    int device_owned = 0;
 
     /* Openssl raw key has a leading byte with conversion form id */
     tmp_buf[0] = POINT_CONVERSION_UNCOMPRESSED;
@@ -94,28 +95,34 @@ static int ECDH_eccx08_get_pubkey(EC_POINT *pub_key, uint8_t *serial_number, int
 
 #ifdef USE_ECCX08
     eccx08_debug("ECDH_eccx08_get_pubkey() - hw\n");
+    eccx08_device_acquire();
+    device_owned = 1;
     status = atcatls_init(pCfg);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDH_eccx08_get_pubkey() - error in atcatls_init \n");
+        eccx08_error("ECDH_eccx08_get_pubkey() - error in atcatls_init \n");
         goto done;
     }
     //read serial number here
     status = atcatls_get_sn(serial_number);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDH_eccx08_get_pubkey() - error in atcatls_get_sn \n");
+        eccx08_error("ECDH_eccx08_get_pubkey() - error in atcatls_get_sn \n");
         goto done;
     }
     //Generate private key then get public key
     status = atcatls_create_key(slotid, raw_pubkey);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDH_eccx08_get_pubkey() - error in atcatls_get_pubkey \n");
+        eccx08_error("ECDH_eccx08_get_pubkey() - error in atcatls_get_pubkey \n");
         goto done;
     }
+    // A certificate rebuilt with the old key of this slot is stale now
+    eccx08_certcache_invalidate_slot(slotid);
     status = atcatls_finish();
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDH_eccx08_get_pubkey() - error in atcatls_finish \n");
+        eccx08_error("ECDH_eccx08_get_pubkey() - error in atcatls_finish \n");
         goto done;
     }
+    eccx08_device_release();
+    device_owned = 0;
 #else // USE_ECCX08
     eccx08_debug("ECDH_eccx08_get_pubkey() - NO HW \n");
     memcpy(raw_pubkey, test_pub_key, MEM_BLOCK_SIZE * 2);
@@ -123,11 +130,14 @@ static int ECDH_eccx08_get_pubkey(EC_POINT *pub_key, uint8_t *serial_number, int
     memcpy(&tmp_buf[1], raw_pubkey, MEM_BLOCK_SIZE * 2);
     ret = EC_POINT_oct2point(ecgroup, pub_key, tmp_buf, MEM_BLOCK_SIZE * 2 + 1, NULL);
     if (!ret) {
-        eccx08_debug("ECDH_eccx08_get_pubkey() - error in EC_POINT_oct2point \n");
+        eccx08_error("ECDH_eccx08_get_pubkey() - error in EC_POINT_oct2point \n");
         goto done;
     }
     rc = 1;
 done:
+    if (device_owned) {
+        eccx08_device_release();
+    }
     return (rc);
 }
 
@@ -169,6 +179,7 @@ static int ECDH_eccx08_compute_key(void *out, size_t outlen, const EC_POINT *pub
                                                               size_t inlen, void *out,
                                                               size_t *outlen))
 {
+    ATCA_TRACE_SCOPE("engine", "ecdh_compute_key");
     BN_CTX *ctx;
     EC_POINT *tmp = NULL;
     BIGNUM *x = NULL, *y = NULL;
@@ -187,6 +198,7 @@ static int ECDH_eccx08_compute_key(void *out, size_t outlen, const EC_POINT *pub
     bool lock = false;
     uint8_t encKey[ATCA_KEY_SIZE];
     uint8_t enckeyId = TLS_SLOT_ENC_PARENT;
+    int device_owned = 0;
 
     if (ecdh->flags & SSL_kECDHe) {
         slotid = TLS_SLOT_AUTH_PRIV;
@@ -238,43 +250,47 @@ static int ECDH_eccx08_compute_key(void *out, size_t outlen, const EC_POINT *pub
             ECDH_eccx08_get_pubkey(ecdh->pub_key, serial_number, ATCA_SERIAL_NUM_SIZE);
         }
 
+        eccx08_device_acquire();
+        device_owned = 1;
         status = atcatls_init(pCfg);
         if (status != ATCA_SUCCESS) {
-            eccx08_debug("ECDH_eccx08_compute_key(): error in atcatls_init\n");
+            eccx08_error("ECDH_eccx08_compute_key(): error in atcatls_init\n");
             goto err;
         }
         //set encryption key
         status = atcatlsfn_set_get_enckey(&eccx08_get_enc_key);
         if (status != ATCA_SUCCESS) {
-            eccx08_debug("ECDH_eccx08_compute_key() - error in atcatlsfn_set_get_enckey \n");
+            eccx08_error("ECDH_eccx08_compute_key() - error in atcatlsfn_set_get_enckey \n");
             goto err;
         }
         status = eccx08_get_enc_key(encKey, ATCA_KEY_SIZE);
         if (status != ATCA_SUCCESS) {
-            eccx08_debug("ECDH_eccx08_compute_key() - error in eccx08_get_enc_key \n");
+            eccx08_error("ECDH_eccx08_compute_key() - error in eccx08_get_enc_key \n");
             goto err;
         }
         status = atcatls_set_enckey(encKey, enckeyId, lock);
         if (status != ATCA_SUCCESS) {
-            eccx08_debug("ECDH_eccx08_compute_key() - error in atcatls_init_enckey \n");
+            eccx08_error("ECDH_eccx08_compute_key() - error in atcatls_init_enckey \n");
             goto err;
         }
         //read serial number here
         status = atcatls_get_sn(serial_number);
         if (status != ATCA_SUCCESS) {
-            eccx08_debug("ECDH_eccx08_compute_key() - error in atcatls_get_sn \n");
+            eccx08_error("ECDH_eccx08_compute_key() - error in atcatls_get_sn \n");
             goto err;
         }
         status = atcatls_ecdh(slotid, &raw_key[1], shared_secret);
         if (status != ATCA_SUCCESS) {
-            eccx08_debug("ECDH_eccx08_compute_key(): error in atcatls_ecdh\n");
+            eccx08_error("ECDH_eccx08_compute_key(): error in atcatls_ecdh\n");
             goto err;
         }
         status = atcatls_finish();
         if (status != ATCA_SUCCESS) {
-            eccx08_debug("ECDH_eccx08_compute_key(): error in atcatls_finish\n");
+            eccx08_error("ECDH_eccx08_compute_key(): error in atcatls_finish\n");
             goto err;
         }
+        eccx08_device_release();
+        device_owned = 0;
         if ((buf = OPENSSL_malloc(buflen)) == NULL) {
             ECDHerr(ECDH_F_ECDH_COMPUTE_KEY, ERR_R_MALLOC_FAILURE);
             goto err;
@@ -356,6 +372,7 @@ else {
     }
 
 err:
+    if (device_owned) eccx08_device_release();
     if (tmp) EC_POINT_free(tmp);
     if (ctx) BN_CTX_end(ctx);
     if (ctx) BN_CTX_free(ctx);
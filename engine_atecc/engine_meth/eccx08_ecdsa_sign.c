@@ -36,7 +36,9 @@
  * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
+#include <unistd.h>
 #include <openssl/engine.h>
 #include <crypto/ecdh/ech_locl.h>
 #include <crypto/ecdsa/ecs_locl.h>
@@ -45,9 +47,16 @@
 
 #include <bn.h>
 #include "ecc_meth.h"
+#include "atcacert/atcacert_der.h"
+#ifndef USE_ECCX08
+#include <pthread.h>
+#include <openssl/obj_mac.h>
+#include "crypto/atca_crypto_sw_ecdsa.h"
+#endif
 
 #ifndef OPENSSL_NO_ECDSA
 
+#ifdef USE_ECCX08
 /**
  *
  * \brief Sends a digest to the ATECCX08 chip to generate an
@@ -56,82 +65,107 @@
  *        stays in the chip: OpenSSL (nor any other software)
  *        has no way to read it.
  *
- * \param[in] dgst - a pointer to the buffer with a message
- *       digest (just SHA-256 is expected)
- * \param[in] dgst_len - the digest size (must be 32 bytes for
- *       ateccx08 engine)
- * \param[in] inv - a pointer to the BIGNUM structure (not used
- *       by ateccx08 engine)
- * \param[in] rp - a pointer to the BIGNUM structure (not used
- *       by ateccx08 engine)
+ * \param[in] dgst - a pointer to the 32 bytes message digest
  * \param[in] eckey - a pointer to EC_KEY structure with public
  *       ECC key and the private key token describing the
  *       private key in the ATECCX08 chip
- * \return a pointer to the ECDSA_SIG structure for success,
- *         NULL otherwise
+ * \param[out] raw_sig - the signature as R and S concatenated
+ *       together (64 bytes)
+ * \return 1 for success
  */
-static ECDSA_SIG* ECDSA_eccx08_do_sign(const unsigned char *dgst, int dgst_len,
-                                       const BIGNUM *inv, const BIGNUM *rp,
-                                       EC_KEY *eckey)
+static int eccx08_ecdsa_sign_raw(const unsigned char *dgst, EC_KEY *eckey, uint8_t *raw_sig)
 {
     int ret = 0;
     uint8_t slotid = TLS_SLOT_AUTH_PRIV;
     uint8_t serial_number[ATCA_SERIAL_NUM_SIZE];
-    uint8_t *raw_sig = NULL;
-    uint16_t sig_len = MEM_BLOCK_SIZE * 2;
-    ECDSA_SIG *sig = NULL;
     ATCA_STATUS status = ATCA_GEN_FAIL;
+    int device_owned = 0;
 
-    const ECDSA_METHOD *std_meth = ECDSA_get_default_method();
-
-#ifdef USE_ECCX08
-    if (dgst_len != MEM_BLOCK_SIZE) {
-        eccx08_debug("ECDSA_eccx08_do_sign(): ERROR dgst_len\n");
-        goto done;
-    }
-
-    eccx08_debug("ECDSA_eccx08_do_sign(): int eckey HW\n");
-    raw_sig = (uint8_t *)OPENSSL_malloc(sig_len);
-    if (raw_sig == NULL) {
-        goto done;
-    }
+    eccx08_device_acquire();
+    device_owned = 1;
     status = atcatls_init(pCfg);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDSA_eccx08_do_sign(): error in atcatls_init\n");
+        eccx08_error("eccx08_ecdsa_sign_raw(): error in atcatls_init\n");
         goto done;
     }
     //read serial number here
     status = atcatls_get_sn(serial_number);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDSA_eccx08_do_sign() - error in atcatls_get_sn \n");
+        eccx08_error("eccx08_ecdsa_sign_raw() - error in atcatls_get_sn \n");
         goto done;
     }
     status = atcatls_sign(slotid, dgst, raw_sig);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDSA_eccx08_do_sign(): error in atcatls_sign\n");
+        eccx08_error("eccx08_ecdsa_sign_raw(): error in atcatls_sign\n");
         goto done;
     }
     status = atcatls_finish();
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDSA_eccx08_do_sign(): error in atcatls_finish\n");
+        eccx08_error("eccx08_ecdsa_sign_raw(): error in atcatls_finish\n");
         goto done;
     }
+    eccx08_device_release();
+    device_owned = 0;
 
     ret = eccx08_eckey_compare_privkey(eckey, slotid, serial_number, ATCA_SERIAL_NUM_SIZE);
     if (ret == 0) {
-        eccx08_debug("ECDSA_eccx08_do_sign(): private key file mismatch\n");
+        eccx08_debug("eccx08_ecdsa_sign_raw(): private key file mismatch\n");
         goto done;
     }
+done:
+    if (device_owned) {
+        eccx08_device_release();
+    }
+    return (ret);
+}
+#endif // USE_ECCX08
+
+/**
+ *
+ * \brief Signs a digest with the ATECCX08 chip, see
+ *        eccx08_ecdsa_sign_raw() for the details
+ *
+ * \param[in] dgst - a pointer to the buffer with a message
+ *       digest (just SHA-256 is expected)
+ * \param[in] dgst_len - the digest size (must be 32 bytes for
+ *       ateccx08 engine)
+ * \param[in] inv - a pointer to the BIGNUM structure (not used
+ *       by ateccx08 engine)
+ * \param[in] rp - a pointer to the BIGNUM structure (not used
+ *       by ateccx08 engine)
+ * \param[in] eckey - a pointer to EC_KEY structure with public
+ *       ECC key and the private key token describing the
+ *       private key in the ATECCX08 chip
+ * \return a pointer to the ECDSA_SIG structure for success,
+ *         NULL otherwise
+ */
+static ECDSA_SIG* ECDSA_eccx08_do_sign(const unsigned char *dgst, int dgst_len,
+                                       const BIGNUM *inv, const BIGNUM *rp,
+                                       EC_KEY *eckey)
+{
+    ATCA_TRACE_SCOPE("engine", "ecdsa_sign");
+    ECDSA_SIG *sig = NULL;
+
+    const ECDSA_METHOD *std_meth = ECDSA_get_default_method();
+
+#ifdef USE_ECCX08
+    uint8_t raw_sig[MEM_BLOCK_SIZE * 2];
+
+    if (dgst_len != MEM_BLOCK_SIZE) {
+        eccx08_error("ECDSA_eccx08_do_sign(): ERROR dgst_len\n");
+        return (NULL);
+    }
+
+    eccx08_debug("ECDSA_eccx08_do_sign(): int eckey HW\n");
+    if (!eccx08_ecdsa_sign_raw(dgst, eckey, raw_sig)) {
+        return (NULL);
+    }
     sig = (ECDSA_SIG *)OPENSSL_malloc(sizeof(ECDSA_SIG));
     if (sig == NULL) {
-        goto done;
-    }
-    sig->r = BN_bin2bn(raw_sig, sig_len / 2, NULL);
-    sig->s = BN_bin2bn(&raw_sig[sig_len / 2], sig_len / 2, NULL);
-done:
-    if (raw_sig) {
-        OPENSSL_free(raw_sig);
+        return (NULL);
     }
+    sig->r = BN_bin2bn(raw_sig, MEM_BLOCK_SIZE, NULL);
+    sig->s = BN_bin2bn(&raw_sig[MEM_BLOCK_SIZE], MEM_BLOCK_SIZE, NULL);
 #else // USE_ECCX08
     eccx08_debug("ECDSA_eccx08_do_sign(): ext eckey SW\n");
     sig = std_meth->ecdsa_do_sign(dgst, dgst_len, inv, rp, eckey);
@@ -139,6 +173,62 @@ done:
     return (sig);
 }
 
+/**
+ *
+ * \brief Signs a digest and returns the DER encoded
+ *        ECDSA-Sig-Value, the same output as ECDSA_sign(). The
+ *        raw signature from the chip is encoded straight into
+ *        der_sig, without going through BIGNUMs and ECDSA_SIG.
+ *
+ * \param[in] dgst - a pointer to the buffer with a message
+ *       digest (just SHA-256 is expected)
+ * \param[in] dgst_len - the digest size (must be 32 bytes for
+ *       ateccx08 engine)
+ * \param[in] eckey - a pointer to EC_KEY structure with public
+ *       ECC key and the private key token describing the
+ *       private key in the ATECCX08 chip
+ * \param[out] der_sig - a pointer to the buffer for the DER
+ *       signature
+ * \param[in,out] der_sig_len - size of der_sig as input (at
+ *       least ECDSA_size()), signature size as output
+ * \return 1 for success
+ */
+int eccx08_ecdsa_sign_der(const unsigned char *dgst, int dgst_len, EC_KEY *eckey,
+                          unsigned char *der_sig, size_t *der_sig_len)
+{
+    ATCA_TRACE_SCOPE("engine", "ecdsa_sign_der");
+#ifdef USE_ECCX08
+    uint8_t raw_sig[MEM_BLOCK_SIZE * 2];
+
+    if (dgst_len != MEM_BLOCK_SIZE) {
+        eccx08_error("eccx08_ecdsa_sign_der(): ERROR dgst_len\n");
+        return (0);
+    }
+
+    eccx08_debug("eccx08_ecdsa_sign_der(): int eckey HW\n");
+    if (!eccx08_ecdsa_sign_raw(dgst, eckey, raw_sig)) {
+        return (0);
+    }
+    if (atcacert_der_enc_ecdsa_sig(raw_sig, der_sig, der_sig_len) != ATCACERT_E_SUCCESS) {
+        eccx08_debug("eccx08_ecdsa_sign_der(): signature buffer too small\n");
+        return (0);
+    }
+    return (1);
+#else // USE_ECCX08
+    unsigned int len = 0;
+
+    eccx08_debug("eccx08_ecdsa_sign_der(): ext eckey SW\n");
+    if (*der_sig_len < (size_t)ECDSA_size(eckey)) {
+        return (0);
+    }
+    if (!ECDSA_sign(0, dgst, dgst_len, der_sig, &len, eckey)) {
+        return (0);
+    }
+    *der_sig_len = len;
+    return (1);
+#endif // USE_ECCX08
+}
+
 /**
  *
  * \brief Setup the signing method.
@@ -156,10 +246,225 @@ static int ECDSA_eccx08_sign_setup(EC_KEY *eckey, BN_CTX *ctx, BIGNUM **kinv,
     const ECDSA_METHOD *std_meth = ECDSA_get_default_method();
 
     eccx08_debug("ECDSA_eccx08_sign_setup()\n");
+    // Seed the nonce generation from the entropy prefetch ring
+    eccx08_rand_reseed();
     std_meth->ecdsa_sign_setup(eckey, ctx, kinv, r);
     return (1);
 }
 
+#ifndef USE_ECCX08
+#define ECCX08_VERIFY_BATCH_MAX (32)
+
+/*
+ * Up to one P-256 verify per online core runs at a time. A verify that finds a free
+ * core and an empty queue goes straight to OpenSSL, one that finds all cores busy or
+ * others already queued joins the queue. Whenever a core frees up, one of the queued
+ * threads takes the queue and checks it as one batch, which is cheaper per signature.
+ */
+typedef struct eccx08_verify_req_s {
+    uint8_t digest[ATCA_ECC_P256_FIELD_SIZE];
+    uint8_t signature[ATCA_ECC_P256_SIGNATURE_SIZE];
+    uint8_t public_key[ATCA_ECC_P256_PUBLIC_KEY_SIZE + 1];
+    int result;
+    int done;
+    struct eccx08_verify_req_s *next;
+} eccx08_verify_req;
+
+static pthread_mutex_t verify_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t verify_cond = PTHREAD_COND_INITIALIZER;
+static eccx08_verify_req *verify_pending = NULL;
+static int verify_running = 0;
+static int verify_max_running = 0;
+
+/**
+ *
+ * \brief Returns how many verifies may run at once, one per
+ *        online core. Called with verify_mutex held.
+ */
+static int eccx08_verify_max_running(void)
+{
+    long cores;
+
+    if (verify_max_running == 0) {
+        cores = sysconf(_SC_NPROCESSORS_ONLN);
+        verify_max_running = (cores > 0) ? (int)cores : 1;
+    }
+    return verify_max_running;
+}
+
+/**
+ *
+ * \brief Converts a P-256 verify request to the raw form
+ *        cryptoauthlib takes.
+ *
+ * \return 1 if the request can be combined, 0 if it has to go
+ *         to OpenSSL
+ */
+static int eccx08_verify_req_init(eccx08_verify_req *req, const unsigned char *dgst, int dgst_len,
+                                  const ECDSA_SIG *sig, EC_KEY *eckey)
+{
+    const EC_GROUP *group = EC_KEY_get0_group(eckey);
+    const EC_POINT *pub_key = EC_KEY_get0_public_key(eckey);
+    int r_len, s_len;
+
+    if (group == NULL || pub_key == NULL || dgst_len != ATCA_ECC_P256_FIELD_SIZE
+        || EC_GROUP_get_curve_name(group) != NID_X9_62_prime256v1) {
+        return 0;
+    }
+    r_len = BN_num_bytes(sig->r);
+    s_len = BN_num_bytes(sig->s);
+    if (BN_is_negative(sig->r) || BN_is_negative(sig->s)
+        || r_len > ATCA_ECC_P256_FIELD_SIZE || s_len > ATCA_ECC_P256_FIELD_SIZE) {
+        return 0;
+    }
+    if (EC_POINT_point2oct(group, pub_key, POINT_CONVERSION_UNCOMPRESSED, req->public_key,
+                           sizeof(req->public_key), NULL) != sizeof(req->public_key)) {
+        return 0;
+    }
+
+    memcpy(req->digest, dgst, ATCA_ECC_P256_FIELD_SIZE);
+    memset(req->signature, 0, sizeof(req->signature));
+    BN_bn2bin(sig->r, &req->signature[ATCA_ECC_P256_FIELD_SIZE - r_len]);
+    BN_bn2bin(sig->s, &req->signature[ATCA_ECC_P256_SIGNATURE_SIZE - s_len]);
+    req->result = 0;
+    req->done = 0;
+    req->next = NULL;
+
+    return 1;
+}
+
+/**
+ *
+ * \brief Verifies everything queued so far as one batch. Called
+ *        with verify_mutex held and the caller counted in
+ *        verify_running, returns the same way.
+ */
+static void eccx08_verify_run_batch(void)
+{
+    eccx08_verify_req *batch[ECCX08_VERIFY_BATCH_MAX];
+    const uint8_t *msgs[ECCX08_VERIFY_BATCH_MAX];
+    const uint8_t *signatures[ECCX08_VERIFY_BATCH_MAX];
+    const uint8_t *public_keys[ECCX08_VERIFY_BATCH_MAX];
+    int results[ECCX08_VERIFY_BATCH_MAX];
+    size_t count = 0;
+    size_t i;
+
+    while (verify_pending != NULL && count < ECCX08_VERIFY_BATCH_MAX) {
+        batch[count] = verify_pending;
+        verify_pending = verify_pending->next;
+        msgs[count] = batch[count]->digest;
+        signatures[count] = batch[count]->signature;
+        public_keys[count] = &batch[count]->public_key[1];
+        count++;
+    }
+    pthread_mutex_unlock(&verify_mutex);
+
+    eccx08_debug("ECDSA_eccx08_do_verify(): SW batch of %u\n", (unsigned)count);
+    if (atcac_sw_ecdsa_verify_p256_batch(count, msgs, signatures, public_keys, results) == ATCA_BAD_PARAM) {
+        for (i = 0; i < count; i++) {
+            results[i] = ATCA_BAD_PARAM;
+        }
+    }
+
+    pthread_mutex_lock(&verify_mutex);
+    for (i = 0; i < count; i++) {
+        batch[i]->result = (results[i] == ATCA_SUCCESS);
+        batch[i]->done = 1;
+    }
+}
+
+/**
+ *
+ * \brief Software verify that combines with verifies from
+ *        other threads when they queue up for a core.
+ *
+ * \return 1 for a valid signature, 0 for an invalid one and -1
+ *         on error, as the OpenSSL method does
+ */
+static int eccx08_verify_combined(const ECDSA_METHOD *std_meth, const unsigned char *dgst, int dgst_len,
+                                  const ECDSA_SIG *sig, EC_KEY *eckey)
+{
+    eccx08_verify_req req;
+    int ret;
+
+    if (!eccx08_verify_req_init(&req, dgst, dgst_len, sig, eckey)) {
+        return std_meth->ecdsa_do_verify(dgst, dgst_len, sig, eckey);
+    }
+
+    pthread_mutex_lock(&verify_mutex);
+    if (verify_pending == NULL && verify_running < eccx08_verify_max_running()) {
+        // A free core and nobody queued ahead, nothing to combine with
+        verify_running++;
+        pthread_mutex_unlock(&verify_mutex);
+        ret = std_meth->ecdsa_do_verify(dgst, dgst_len, sig, eckey);
+        pthread_mutex_lock(&verify_mutex);
+        verify_running--;
+        pthread_cond_broadcast(&verify_cond);
+        pthread_mutex_unlock(&verify_mutex);
+        return ret;
+    }
+
+    req.next = verify_pending;
+    verify_pending = &req;
+    while (!req.done) {
+        if (verify_pending != NULL && verify_running < verify_max_running) {
+            verify_running++;
+            eccx08_verify_run_batch();
+            verify_running--;
+            pthread_cond_broadcast(&verify_cond);
+        } else {
+            pthread_cond_wait(&verify_cond, &verify_mutex);
+        }
+    }
+    pthread_mutex_unlock(&verify_mutex);
+
+    return req.result;
+}
+#endif // USE_ECCX08
+
+#ifdef USE_ECCX08
+typedef struct {
+    const unsigned char *dgst;
+    const uint8_t *raw_sig;
+    const uint8_t *raw_pubkey;
+    bool verified;
+} eccx08_verify_device_req;
+
+/**
+ *
+ * \brief Verifies a signature on one device, for
+ *        eccx08_failover_run()
+ *
+ * \param[in] cfg the device
+ * \param[in,out] arg an eccx08_verify_device_req, verified is
+ *       set when the device answers
+ * \return ATCA_SUCCESS if the device answered, verified or not
+ */
+static ATCA_STATUS eccx08_verify_device(ATCAIfaceCfg *cfg, void *arg)
+{
+    eccx08_verify_device_req *req = (eccx08_verify_device_req *)arg;
+    ATCA_STATUS status = ATCA_GEN_FAIL;
+
+    status = atcatls_init(cfg);
+    if (status != ATCA_SUCCESS) {
+        eccx08_error("ECDSA_eccx08_do_verify(): error in atcatls_init\n");
+        return status;
+    }
+    // A signature that does not match is ATCA_SUCCESS with verified false
+    status = atcatls_verify(req->dgst, req->raw_sig, &req->raw_pubkey[1], &req->verified);
+    if (status != ATCA_SUCCESS) {
+        eccx08_error("ECDSA_eccx08_do_verify(): error in atcatls_verify\n");
+        atcatls_finish();
+        return status;
+    }
+    status = atcatls_finish();
+    if (status != ATCA_SUCCESS) {
+        eccx08_error("ECDSA_eccx08_do_verify(): error in atcatls_finish\n");
+    }
+    return status;
+}
+#endif // USE_ECCX08
+
 /**
  *
  * \brief Verifies the digest signature.
@@ -178,6 +483,7 @@ static int ECDSA_eccx08_sign_setup(EC_KEY *eckey, BN_CTX *ctx, BIGNUM **kinv,
 static int ECDSA_eccx08_do_verify(const unsigned char *dgst, int dgst_len,
                                   const ECDSA_SIG *sig, EC_KEY *eckey)
 {
+    ATCA_TRACE_SCOPE("engine", "ecdsa_verify");
     int ret = 0;
     const ECDSA_METHOD *std_meth = ECDSA_get_default_method();
 
@@ -186,10 +492,10 @@ static int ECDSA_eccx08_do_verify(const unsigned char *dgst, int dgst_len,
     uint8_t *raw_pubkey = NULL;
     uint8_t *raw_sig = NULL;
     uint16_t sig_len = MEM_BLOCK_SIZE * 2;
-    uint16_t len;
+    int r_len, s_len;
+    size_t len;
     const EC_GROUP *group;
-    point_conversion_form_t form;
-    bool verified = 0;
+    eccx08_verify_device_req req;
 
     eccx08_debug("ECDSA_eccx08_do_verify(): HW\n");
 
@@ -198,56 +504,53 @@ static int ECDSA_eccx08_do_verify(const unsigned char *dgst, int dgst_len,
         goto done;
     }
 
-    len = BN_num_bytes(sig->r);
-    if (len > sig_len / 2) {
-        goto done;
-    }
-    len = BN_num_bytes(sig->s);
-    if (len > sig_len / 2) {
+    // R and S are big-endian and right aligned in their halves, short values get leading zeros
+    r_len = BN_num_bytes(sig->r);
+    s_len = BN_num_bytes(sig->s);
+    if (BN_is_negative(sig->r) || BN_is_negative(sig->s)
+        || r_len > sig_len / 2 || s_len > sig_len / 2) {
         goto done;
     }
-    len = BN_bn2bin(sig->r, raw_sig);
-    if (len > sig_len / 2) {
+    memset(raw_sig, 0, sig_len);
+    BN_bn2bin(sig->r, &raw_sig[sig_len / 2 - r_len]);
+    BN_bn2bin(sig->s, &raw_sig[sig_len - s_len]);
+
+    // The device takes the X and Y after the uncompressed point tag
+    group = EC_KEY_get0_group(eckey);
+    if (group == NULL || eckey->pub_key == NULL) {
         goto done;
     }
-    len = BN_bn2bin(sig->s, &raw_sig[sig_len / 2]);
-    if (len > sig_len / 2) {
+    len = EC_POINT_point2oct(group, eckey->pub_key, POINT_CONVERSION_UNCOMPRESSED, NULL, 0, NULL);
+    if (len != ATCA_PUB_KEY_SIZE + 1) {
         goto done;
     }
 
-    group = EC_KEY_get0_group(eckey);
-    form = EC_GROUP_get_point_conversion_form(group);
-
-    len = EC_POINT_point2oct(group, eckey->pub_key, form, NULL, len, NULL);
-
     raw_pubkey = (uint8_t *)OPENSSL_malloc(len);
     if (raw_pubkey == NULL) {
         goto done;
     }
 
-    if (eckey->pub_key) {
-        EC_POINT_point2oct(group, eckey->pub_key, form, raw_pubkey, len, NULL);
-    }
-
-    status = atcatls_init(pCfg);
-    if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDSA_eccx08_do_verify(): error in atcatls_init\n");
+    if (EC_POINT_point2oct(group, eckey->pub_key, POINT_CONVERSION_UNCOMPRESSED, raw_pubkey, len, NULL) != len
+        || raw_pubkey[0] != POINT_CONVERSION_UNCOMPRESSED) {
         goto done;
     }
 
-    status = atcatls_verify(dgst, raw_sig, &raw_pubkey[1], &verified);
-    if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDSA_eccx08_do_verify(): error in atcatls_verify\n");
-        goto done;
-    }
+    req.dgst = dgst;
+    req.raw_sig = raw_sig;
+    req.raw_pubkey = raw_pubkey;
+    req.verified = 0;
 
-    status = atcatls_finish();
-    if (status != ATCA_SUCCESS) {
-        eccx08_debug("ECDSA_eccx08_do_verify(): error in atcatls_finish\n");
-        goto done;
-    }
+    eccx08_device_acquire();
+    status = eccx08_failover_run(eccx08_verify_device, &req);
+    eccx08_device_release();
 
-    ret = (status == ATCA_SUCCESS);
+    if (status == ATCA_SUCCESS) {
+        ret = req.verified;
+    } else if (eccx08_device_failed(status) && eccx08_failover_sw_fallback()) {
+        // Only the public key is needed, no device answered in time
+        eccx08_warn("ECDSA_eccx08_do_verify(): no device (0x%02X), verifying in software\n", status);
+        ret = std_meth->ecdsa_do_verify(dgst, dgst_len, sig, eckey);
+    }
 
 done:
     if (raw_sig) {
@@ -259,7 +562,7 @@ done:
     }
 #else  // USE_ECCX08
     eccx08_debug("ECDSA_eccx08_do_verify(): SW\n");
-    ret = std_meth->ecdsa_do_verify(dgst, dgst_len, sig, eckey);
+    ret = eccx08_verify_combined(std_meth, dgst, dgst_len, sig, eckey);
 #endif // USE_ECCX08
 
     return (ret);
@@ -70,6 +70,7 @@ EVP_PKEY* eccx08_load_privkey(ENGINE *e, const char *file,
                               UI_METHOD *ui_method,
                               void *callback_data)
 {
+    ATCA_TRACE_SCOPE("engine", "load_privkey");
     BIO *key = NULL;
     EVP_PKEY *pkey = NULL;
 
@@ -89,17 +90,18 @@ EVP_PKEY* eccx08_load_privkey(ENGINE *e, const char *file,
     uint8_t block = 0;
     int16_t raw_key_len;
     char *raw_key = NULL;
+    int device_owned = 0;
 
     eccx08_debug("eccx08_load_privkey()\n");
 
     key = BIO_new(BIO_s_file());
     if (key == NULL) {
-        eccx08_debug("eccx08_load_privkey() - error in BIO_new \n");
+        eccx08_error("eccx08_load_privkey() - error in BIO_new \n");
         goto err;
     }
 
     if (BIO_read_filename(key, file) <= 0) {
-        eccx08_debug("eccx08_load_privkey() - error opening %s\n", file);
+        eccx08_error("eccx08_load_privkey() - error opening %s\n", file);
         goto err;
     }
 
@@ -133,31 +135,33 @@ EVP_PKEY* eccx08_load_privkey(ENGINE *e, const char *file,
     }
 
     //Restore AES key and IV from slot #8 of ATECC508
+    eccx08_device_acquire();
+    device_owned = 1;
     status = atcatls_init(pCfg);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_load_privkey(): error in atcatls_init\n");
+        eccx08_error("eccx08_load_privkey(): error in atcatls_init\n");
         goto err;
     }
     //set encryption key
     status = atcatlsfn_set_get_enckey(&eccx08_get_enc_key);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_load_privkey() - error in atcatlsfn_set_get_enckey \n");
+        eccx08_error("eccx08_load_privkey() - error in atcatlsfn_set_get_enckey \n");
         goto err;
     }
     status = eccx08_get_enc_key(encKey, ATCA_KEY_SIZE);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_load_privkey() - error in eccx08_get_enc_key \n");
+        eccx08_error("eccx08_load_privkey() - error in eccx08_get_enc_key \n");
         goto err;
     }
     status = atcatls_set_enckey(encKey, enckeyId, lock);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_load_privkey() - error in atcatls_init_enckey \n");
+        eccx08_error("eccx08_load_privkey() - error in atcatls_init_enckey \n");
         goto err;
     }
     //read serial number here
     status = atcatls_get_sn(serial_number);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_load_privkey() - error in atcatls_get_sn \n");
+        eccx08_error("eccx08_load_privkey() - error in atcatls_get_sn \n");
         goto err;
     }
 
@@ -177,9 +181,11 @@ EVP_PKEY* eccx08_load_privkey(ENGINE *e, const char *file,
     }
     status = atcatls_finish();
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_load_privkey(): error in atcatls_finish\n");
+        eccx08_error("eccx08_load_privkey(): error in atcatls_finish\n");
         goto err;
     }
+    eccx08_device_release();
+    device_owned = 0;
 
     //Verify the token stored in rsa->d field
     ret = eccx08_eckey_fill_key(ptr, len, slotId, serial_number, ATCA_SERIAL_NUM_SIZE);
@@ -191,7 +197,7 @@ EVP_PKEY* eccx08_load_privkey(ENGINE *e, const char *file,
 
     //Make sure that the token in the file created for this ECC508 device
     if (0 != memcmp(raw_key, ptr, MEM_BLOCK_SIZE)) {
-        eccx08_debug("eccx08_load_privkey(): wrong token\n");
+        eccx08_error("eccx08_load_privkey(): wrong token\n");
         status = atcatls_finish();
         goto err;
     }
@@ -203,7 +209,7 @@ EVP_PKEY* eccx08_load_privkey(ENGINE *e, const char *file,
     }
     ret = eccx08_BN_decrypt(pkey->pkey.rsa->p, aes_iv, aes_key);
     if (ret != 1) {
-        eccx08_debug("eccx08_load_privkey(): eccx08_BN_decrypt p error\n");
+        eccx08_error("eccx08_load_privkey(): eccx08_BN_decrypt p error\n");
         goto err;
     }
     if (NULL == pkey->pkey.rsa->q) {
@@ -212,25 +218,28 @@ EVP_PKEY* eccx08_load_privkey(ENGINE *e, const char *file,
     }
     ret = eccx08_BN_decrypt(pkey->pkey.rsa->q, aes_iv + 1, aes_key);
     if (ret != 1) {
-        eccx08_debug("eccx08_load_privkey(): eccx08_BN_decrypt q error\n");
+        eccx08_error("eccx08_load_privkey(): eccx08_BN_decrypt q error\n");
         goto err;
     }
     ret = eccx08_BN_decrypt(pkey->pkey.rsa->dmp1, aes_iv + 2, aes_key);
     if (ret != 1) {
-        eccx08_debug("eccx08_load_privkey(): eccx08_BN_decrypt dmp1 error\n");
+        eccx08_error("eccx08_load_privkey(): eccx08_BN_decrypt dmp1 error\n");
         goto err;
     }
     ret = eccx08_BN_decrypt(pkey->pkey.rsa->dmq1, aes_iv + 3, aes_key);
     if (ret != 1) {
-        eccx08_debug("eccx08_load_privkey(): eccx08_BN_decrypt dmq1 error\n");
+        eccx08_error("eccx08_load_privkey(): eccx08_BN_decrypt dmq1 error\n");
         goto err;
     }
     ret = eccx08_BN_decrypt(pkey->pkey.rsa->iqmp, aes_iv + 4, aes_key);
     if (ret != 1) {
-        eccx08_debug("eccx08_load_privkey(): eccx08_BN_decrypt iqmp error\n");
+        eccx08_error("eccx08_load_privkey(): eccx08_BN_decrypt iqmp error\n");
         goto err;
     }
 err:
+    if (device_owned) {
+        eccx08_device_release();
+    }
     if (ptr) {
         OPENSSL_free(ptr);
     }
@@ -241,7 +250,7 @@ err:
         BIO_free(key);
     }
     if (pkey == NULL) {
-        eccx08_debug("eccx08_load_privkey() unable to load key from %s\n", file);
+        eccx08_error("eccx08_load_privkey() unable to load key from %s\n", file);
     }
     return (pkey);
 }
@@ -309,6 +318,7 @@ static int eccx08_pkey_ec_init(EVP_PKEY_CTX *ctx)
 
     uint8_t serial_number[ATCA_SERIAL_NUM_SIZE];
     int snid, hnid;
+    int device_owned = 0;
     EC_GROUP *ecgroup = NULL;
 
     const EVP_PKEY_METHOD *std_meth = EVP_PKEY_meth_find(EVP_PKEY_EC);
@@ -321,40 +331,47 @@ static int eccx08_pkey_ec_init(EVP_PKEY_CTX *ctx)
 
 #ifdef USE_ECCX08
     eccx08_debug("eccx08_pkey_ec_init() - hw\n");
+    eccx08_device_acquire();
+    device_owned = 1;
     status = atcatls_init(pCfg);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_pkey_ec_init() - error in atcatls_init \n");
+        eccx08_error("eccx08_pkey_ec_init() - error in atcatls_init \n");
         goto done;
     }
     //read serial number here
     status = atcatls_get_sn(serial_number);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_pkey_ec_init() - error in atcatls_get_sn \n");
+        eccx08_error("eccx08_pkey_ec_init() - error in atcatls_get_sn \n");
         goto done;
     }
     //Get public key without private key generation
     status = atcatls_gen_pubkey(slotid, raw_pubkey);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_pkey_ec_init() - error in atcatls_get_pubkey \n");
+        eccx08_error("eccx08_pkey_ec_init() - error in atcatls_get_pubkey \n");
         goto done;
     }
     status = atcatls_finish();
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_pkey_ec_init() - error in atcatls_finish \n");
+        eccx08_error("eccx08_pkey_ec_init() - error in atcatls_finish \n");
         goto done;
     }
+    eccx08_device_release();
+    device_owned = 0;
 #else // USE_ECCX08
     eccx08_debug("eccx08_pkey_ec_init() - NO HW \n");
     memcpy(raw_pubkey, test_pub_key, MEM_BLOCK_SIZE * 2);
 #endif // USE_ECCX08
     ret = eccx08_eckey_convert(&eckey, raw_pubkey, serial_number, ATCA_SERIAL_NUM_SIZE);
     if (!ret) {
-        eccx08_debug("eccx08_pkey_ec_init() - error in eccx08_eckey_convert \n");
+        eccx08_error("eccx08_pkey_ec_init() - error in eccx08_eckey_convert \n");
         goto done;
     }
     ctx->pkey = evpkey;
     rc = 1;
 done:
+    if (device_owned) {
+        eccx08_device_release();
+    }
     return (rc);
 }
 
@@ -385,6 +402,7 @@ static int eccx08_pkey_ec_keygen_init(EVP_PKEY_CTX *ctx)
  */
 static int eccx08_pkey_ec_keygen(EVP_PKEY_CTX *ctx, EVP_PKEY *pkey)
 {
+    ATCA_TRACE_SCOPE("engine", "keygen");
     int rc = 0;
     int ret = 0;
     EC_KEY *eckey = NULL;
@@ -392,6 +410,7 @@ static int eccx08_pkey_ec_keygen(EVP_PKEY_CTX *ctx, EVP_PKEY *pkey)
 
     uint8_t slotid = TLS_SLOT_AUTH_PRIV;
     uint8_t raw_pubkey[MEM_BLOCK_SIZE * 2];
+    int device_owned = 0;
     uint8_t serial_number[ATCA_SERIAL_NUM_SIZE] =
     { 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39 };
 
@@ -406,34 +425,41 @@ static int eccx08_pkey_ec_keygen(EVP_PKEY_CTX *ctx, EVP_PKEY *pkey)
 
 #ifdef USE_ECCX08
     eccx08_debug("eccx08_pkey_ec_keygen() - HW\n");
+    eccx08_device_acquire();
+    device_owned = 1;
     status = atcatls_init(pCfg);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_pkey_ec_keygen() - error atcatls_init \n");
+        eccx08_error("eccx08_pkey_ec_keygen() - error atcatls_init \n");
         goto done;
     }
     //read serial number here
     status = atcatls_get_sn(serial_number);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_pkey_ec_keygen() - error atcatls_get_sn \n");
+        eccx08_error("eccx08_pkey_ec_keygen() - error atcatls_get_sn \n");
         goto done;
     }
     //Re-generate private key and return public key
     status = atcatls_create_key(slotid, raw_pubkey);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_pkey_ec_keygen() - error atcatls_create_key \n");
+        eccx08_error("eccx08_pkey_ec_keygen() - error atcatls_create_key \n");
         eccx08_debug("probably the key is locked. Just get a public key from it \n");
         //Get public key without private key generation
         status = atcatls_gen_pubkey(slotid, raw_pubkey);
         if (status != ATCA_SUCCESS) {
-            eccx08_debug("eccx08_pkey_ec_keygen() - error atcatls_gen_pubkey \n");
+            eccx08_error("eccx08_pkey_ec_keygen() - error atcatls_gen_pubkey \n");
             goto done;
         }
+    } else {
+        // The device certificate was rebuilt with the old key of this slot
+        eccx08_certcache_invalidate_slot(slotid);
     }
     status = atcatls_finish();
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_pkey_ec_keygen() - error atcatls_finish \n");
+        eccx08_error("eccx08_pkey_ec_keygen() - error atcatls_finish \n");
         goto done;
     }
+    eccx08_device_release();
+    device_owned = 0;
 #else // USE_ECCX08
     eccx08_debug("eccx08_pkey_ec_keygen() - SW \n");
     memcpy(raw_pubkey, test_pub_key, MEM_BLOCK_SIZE * 2);
@@ -441,7 +467,7 @@ static int eccx08_pkey_ec_keygen(EVP_PKEY_CTX *ctx, EVP_PKEY *pkey)
 
     ret = eccx08_eckey_convert(&eckey, raw_pubkey, serial_number, ATCA_SERIAL_NUM_SIZE);
     if (!ret) {
-        eccx08_debug("eccx08_pkey_ec_keygen() - error eccx08_eckey_convert \n");
+        eccx08_error("eccx08_pkey_ec_keygen() - error eccx08_eckey_convert \n");
         goto done;
     }
 #ifdef ECC_DEBUG
@@ -455,6 +481,9 @@ static int eccx08_pkey_ec_keygen(EVP_PKEY_CTX *ctx, EVP_PKEY *pkey)
     pkey->ameth = &eccx08_pkey_asn1_meth;
     rc = 1;
 done:
+    if (device_owned) {
+        eccx08_device_release();
+    }
     return (rc);
 }
 
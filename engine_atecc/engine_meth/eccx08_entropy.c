@@ -0,0 +1,473 @@
+/**
+ *  \file eccx08_entropy.c
+ * \brief Background harvester of ATECCX08 TRNG output and the
+ *        serialization of access to the device shared by all
+ *        ENGINE callbacks
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Atmel nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <openssl/engine.h>
+#include "ecc_meth.h"
+
+#define ENTROPY_RING_MASK    (ECCX08_ENTROPY_RING_SLOTS - 1)
+
+#if (ECCX08_ENTROPY_RING_SLOTS & ENTROPY_RING_MASK) != 0
+#error "ECCX08_ENTROPY_RING_SLOTS must be a power of two"
+#endif
+
+/**
+ * \brief One block of the entropy ring. The sequence number
+ *        tells producer and consumers whose turn it is to touch
+ *        the cell (bounded MPMC queue, no locks on the data path)
+ */
+typedef struct {
+    uint32_t seq;
+    uint8_t data[ECCX08_ENTROPY_BLOCK_SIZE];
+} eccx08_entropy_cell_t;
+
+static eccx08_entropy_cell_t entropy_ring[ECCX08_ENTROPY_RING_SLOTS];
+static uint32_t entropy_enq_pos = 0;
+static uint32_t entropy_deq_pos = 0;
+
+static eccx08_entropy_stats_t entropy_stats;
+
+// Device ownership: every atcatls_init()..atcatls_finish() window
+// runs with this mutex held
+static pthread_mutex_t device_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t device_waiters = 0;
+static uint64_t device_last_use_ms = 0;
+
+// Harvester thread state
+static pthread_t harvest_thread;
+static pthread_mutex_t harvest_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t harvest_cond = PTHREAD_COND_INITIALIZER;
+static int harvest_running = 0;
+
+/**
+ *
+ * \brief Returns a monotonic time stamp in milliseconds
+ */
+static uint64_t entropy_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ *
+ * \brief Puts one block into the ring
+ *
+ * \param[in] block - ECCX08_ENTROPY_BLOCK_SIZE bytes to store
+ * \return 1 for success, 0 if the ring is full
+ */
+static int entropy_ring_put(const uint8_t *block)
+{
+    eccx08_entropy_cell_t *cell;
+    uint32_t pos = __atomic_load_n(&entropy_enq_pos, __ATOMIC_RELAXED);
+    uint32_t seq;
+    int32_t diff;
+
+    for (;;) {
+        cell = &entropy_ring[pos & ENTROPY_RING_MASK];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&entropy_enq_pos, &pos, pos + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = __atomic_load_n(&entropy_enq_pos, __ATOMIC_RELAXED);
+        }
+    }
+    memcpy(cell->data, block, ECCX08_ENTROPY_BLOCK_SIZE);
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/**
+ *
+ * \brief Takes one block out of the ring. The cell is wiped
+ *        before it is handed back to the producer.
+ *
+ * \param[out] block - ECCX08_ENTROPY_BLOCK_SIZE bytes buffer
+ * \return 1 for success, 0 if the ring is empty
+ */
+static int entropy_ring_get(uint8_t *block)
+{
+    eccx08_entropy_cell_t *cell;
+    uint32_t pos = __atomic_load_n(&entropy_deq_pos, __ATOMIC_RELAXED);
+    uint32_t seq;
+    int32_t diff;
+
+    for (;;) {
+        cell = &entropy_ring[pos & ENTROPY_RING_MASK];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        diff = (int32_t)(seq - (pos + 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&entropy_deq_pos, &pos, pos + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = __atomic_load_n(&entropy_deq_pos, __ATOMIC_RELAXED);
+        }
+    }
+    memcpy(block, cell->data, ECCX08_ENTROPY_BLOCK_SIZE);
+    OPENSSL_cleanse(cell->data, ECCX08_ENTROPY_BLOCK_SIZE);
+    __atomic_store_n(&cell->seq, pos + ECCX08_ENTROPY_RING_SLOTS, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/**
+ *
+ * \brief Returns the number of blocks currently stored in the
+ *        ring
+ */
+static uint32_t entropy_ring_occupancy(void)
+{
+    uint32_t enq = __atomic_load_n(&entropy_enq_pos, __ATOMIC_RELAXED);
+    uint32_t deq = __atomic_load_n(&entropy_deq_pos, __ATOMIC_RELAXED);
+    uint32_t n = enq - deq;
+
+    return (n > ECCX08_ENTROPY_RING_SLOTS) ? ECCX08_ENTROPY_RING_SLOTS : n;
+}
+
+/**
+ *
+ * \brief Takes ownership of the ATECCX08 device. Must be called
+ *        before atcatls_init() by every ENGINE callback that
+ *        talks to the chip. Announces itself first so the
+ *        harvester stays away while a request is pending.
+ */
+void eccx08_device_acquire(void)
+{
+    __atomic_add_fetch(&device_waiters, 1, __ATOMIC_SEQ_CST);
+    ATCA_TRACE_BEGIN("engine", "device_wait", 0);
+    pthread_mutex_lock(&device_mutex);
+    ATCA_TRACE_END("engine", "device_wait", 0);
+    eccx08_deadline_begin();
+}
+
+/**
+ *
+ * \brief Gives up ownership of the ATECCX08 device taken by
+ *        eccx08_device_acquire(). Must be called after
+ *        atcatls_finish() (or on the error path)
+ */
+void eccx08_device_release(void)
+{
+    eccx08_deadline_end();
+    __atomic_store_n(&device_last_use_ms, entropy_now_ms(), __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&device_mutex);
+    __atomic_sub_fetch(&device_waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ *
+ * \brief Reads one block from the TRNG of one device, see
+ *        entropy_read_device()
+ *
+ * \param[in] cfg - the device
+ * \param[out] arg - ECCX08_ENTROPY_BLOCK_SIZE bytes buffer
+ * \return ATCA_SUCCESS for success
+ */
+static ATCA_STATUS entropy_read_one(ATCAIfaceCfg *cfg, void *arg)
+{
+    uint8_t *block = (uint8_t *)arg;
+    ATCA_STATUS status = ATCA_GEN_FAIL;
+
+    status = atcatls_init(cfg);
+    if (status != ATCA_SUCCESS) {
+        goto done;
+    }
+    status = atcatls_random(block);
+    if (status != ATCA_SUCCESS) {
+        atcatls_finish();
+        goto done;
+    }
+    status = atcatls_finish();
+done:
+    return status;
+}
+
+/**
+ *
+ * \brief Reads one block from the ATECCX08 TRNG, from another
+ *        device of the pool if the first does not answer. The
+ *        caller must own the device.
+ *
+ * \param[out] block - ECCX08_ENTROPY_BLOCK_SIZE bytes buffer
+ * \return ATCA_SUCCESS for success
+ */
+static ATCA_STATUS entropy_read_device(uint8_t *block)
+{
+    return eccx08_failover_run(entropy_read_one, block);
+}
+
+/**
+ *
+ * \brief Sleeps for the given time unless the harvester is
+ *        being stopped
+ *
+ * \param[in] ms - time to sleep in milliseconds
+ * \return 1 if the harvester should keep running
+ */
+static int entropy_harvest_wait(uint32_t ms)
+{
+    struct timespec ts;
+    int running;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (long)(ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&harvest_mutex);
+    while (harvest_running) {
+        if (pthread_cond_timedwait(&harvest_cond, &harvest_mutex, &ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    running = harvest_running;
+    pthread_mutex_unlock(&harvest_mutex);
+    return running;
+}
+
+/**
+ *
+ * \brief Harvester thread. Fills the ring with TRNG blocks
+ *        while the device is idle. Backs off exponentially
+ *        whenever a request is pending, the device has been
+ *        used recently or the device reports an error, so an
+ *        ECDSA sign or ECDH never has to wait for more than the
+ *        one Random command that may already be in flight.
+ */
+static void* entropy_harvest_main(void *arg)
+{
+    uint8_t block[ECCX08_ENTROPY_BLOCK_SIZE];
+    uint32_t backoff_ms = ECCX08_ENTROPY_IDLE_MS;
+    uint64_t idle_ms;
+    int busy;
+
+    (void)arg;
+    eccx08_debug("entropy_harvest_main(): started\n");
+
+    while (entropy_harvest_wait(backoff_ms)) {
+        if (entropy_ring_occupancy() >= ECCX08_ENTROPY_RING_SLOTS) {
+            backoff_ms = ECCX08_ENTROPY_IDLE_MS;
+            continue;
+        }
+
+        idle_ms = entropy_now_ms() - __atomic_load_n(&device_last_use_ms, __ATOMIC_RELAXED);
+        busy = (__atomic_load_n(&device_waiters, __ATOMIC_SEQ_CST) != 0) ||
+               (idle_ms < ECCX08_ENTROPY_IDLE_MS) ||
+               (pthread_mutex_trylock(&device_mutex) != 0);
+        if (busy) {
+            __atomic_add_fetch(&entropy_stats.backoffs, 1, __ATOMIC_RELAXED);
+            backoff_ms = (backoff_ms * 2 > ECCX08_ENTROPY_BACKOFF_MAX_MS) ?
+                         ECCX08_ENTROPY_BACKOFF_MAX_MS : backoff_ms * 2;
+            continue;
+        }
+
+        if (entropy_read_device(block) != ATCA_SUCCESS) {
+            pthread_mutex_unlock(&device_mutex);
+            __atomic_add_fetch(&entropy_stats.errors, 1, __ATOMIC_RELAXED);
+            backoff_ms = ECCX08_ENTROPY_BACKOFF_MAX_MS;
+            continue;
+        }
+        pthread_mutex_unlock(&device_mutex);
+
+        if (entropy_ring_put(block)) {
+            __atomic_add_fetch(&entropy_stats.harvested, 1, __ATOMIC_RELAXED);
+        }
+        // Keep going back to back while the device stays quiet
+        backoff_ms = 1;
+    }
+
+    OPENSSL_cleanse(block, sizeof(block));
+    eccx08_debug("entropy_harvest_main(): stopped\n");
+    return NULL;
+}
+
+/**
+ *
+ * \brief Fills a buffer with hardware entropy. Blocks are taken
+ *        from the prefetch ring first; if the ring runs dry the
+ *        rest is read from the device synchronously and the
+ *        request is counted as starved.
+ *
+ * \param[out] buf - a pointer to the output buffer
+ * \param[in] len - number of bytes to fill
+ * \return 1 for success
+ */
+int eccx08_entropy_get(uint8_t *buf, size_t len)
+{
+    int rc = 0;
+    int starved = 0;
+    size_t n;
+    uint8_t block[ECCX08_ENTROPY_BLOCK_SIZE];
+    ATCA_STATUS status = ATCA_GEN_FAIL;
+
+    if (buf == NULL) {
+        goto done;
+    }
+
+    while (len > 0) {
+        if (entropy_ring_get(block)) {
+            __atomic_add_fetch(&entropy_stats.consumed, 1, __ATOMIC_RELAXED);
+        } else {
+            starved = 1;
+            eccx08_device_acquire();
+            status = entropy_read_device(block);
+            eccx08_device_release();
+            if (status != ATCA_SUCCESS) {
+                eccx08_error("eccx08_entropy_get(): error in atcatls_random\n");
+                goto done;
+            }
+        }
+        n = (len < sizeof(block)) ? len : sizeof(block);
+        memcpy(buf, block, n);
+        buf += n;
+        len -= n;
+    }
+    rc = 1;
+done:
+    if (starved) {
+        __atomic_add_fetch(&entropy_stats.starved, 1, __ATOMIC_RELAXED);
+    }
+    OPENSSL_cleanse(block, sizeof(block));
+    return (rc);
+}
+
+/**
+ *
+ * \brief Returns a snapshot of the entropy ring counters
+ *
+ * \param[out] stats - a pointer to the structure to fill
+ * \return 1 for success
+ */
+int eccx08_entropy_get_stats(eccx08_entropy_stats_t *stats)
+{
+    if (stats == NULL) {
+        return 0;
+    }
+    stats->capacity = ECCX08_ENTROPY_RING_SLOTS;
+    stats->occupancy = entropy_ring_occupancy();
+    stats->harvested = __atomic_load_n(&entropy_stats.harvested, __ATOMIC_RELAXED);
+    stats->consumed = __atomic_load_n(&entropy_stats.consumed, __ATOMIC_RELAXED);
+    stats->starved = __atomic_load_n(&entropy_stats.starved, __ATOMIC_RELAXED);
+    stats->backoffs = __atomic_load_n(&entropy_stats.backoffs, __ATOMIC_RELAXED);
+    stats->errors = __atomic_load_n(&entropy_stats.errors, __ATOMIC_RELAXED);
+    return 1;
+}
+
+/**
+ *
+ * \brief Starts the background harvester. Does nothing when the
+ *        engine is built without USE_ECCX08.
+ *
+ * \return 1 for success
+ */
+int eccx08_entropy_init(void)
+{
+    uint32_t i;
+
+    eccx08_debug("eccx08_entropy_init()\n");
+
+#ifdef USE_ECCX08
+    pthread_mutex_lock(&harvest_mutex);
+    if (harvest_running) {
+        pthread_mutex_unlock(&harvest_mutex);
+        return 1;
+    }
+    for (i = 0; i < ECCX08_ENTROPY_RING_SLOTS; i++) {
+        entropy_ring[i].seq = i;
+    }
+    entropy_enq_pos = 0;
+    entropy_deq_pos = 0;
+    harvest_running = 1;
+    if (pthread_create(&harvest_thread, NULL, entropy_harvest_main, NULL) != 0) {
+        eccx08_error("eccx08_entropy_init(): cannot start harvester\n");
+        harvest_running = 0;
+    }
+    pthread_mutex_unlock(&harvest_mutex);
+#else  // USE_ECCX08
+    (void)i;
+#endif // USE_ECCX08
+    return 1;
+}
+
+/**
+ *
+ * \brief Stops the background harvester and wipes the ring
+ *
+ * \return 1 for success
+ */
+int eccx08_entropy_finish(void)
+{
+    uint8_t block[ECCX08_ENTROPY_BLOCK_SIZE];
+    int running;
+
+    eccx08_debug("eccx08_entropy_finish()\n");
+
+    pthread_mutex_lock(&harvest_mutex);
+    running = harvest_running;
+    harvest_running = 0;
+    pthread_cond_broadcast(&harvest_cond);
+    pthread_mutex_unlock(&harvest_mutex);
+
+    if (running) {
+        pthread_join(harvest_thread, NULL);
+    }
+    while (entropy_ring_get(block)) {
+    }
+    OPENSSL_cleanse(block, sizeof(block));
+    return 1;
+}
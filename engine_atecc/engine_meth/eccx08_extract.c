@@ -0,0 +1,367 @@
+/**
+ *  \file eccx08_extract.c
+ * \brief Extraction of the certificates from several ATECCX08
+ *        devices in parallel
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Atmel nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <openssl/engine.h>
+#define ECCX08_LOG_CATEGORY ATCA_LOG_CERT
+#include "ecc_meth.h"
+#include "platform.h"
+#include "atcacert/atcacert_client.h"
+#include "atcacert/atcacert_host_sw.h"
+
+#define EXTRACT_MAX_LOCS      (16)
+#define EXTRACT_BLOCK_SIZE    (32)
+#define EXTRACT_LOC_DATA_SIZE (416)
+
+/**
+ * \brief The raw device data of one certificate, read by the
+ *        reader and rebuilt into a certificate by the builder
+ */
+typedef struct {
+    atcacert_device_loc_t device_locs[EXTRACT_MAX_LOCS];
+    size_t device_locs_count;
+    uint8_t data[EXTRACT_MAX_LOCS][EXTRACT_LOC_DATA_SIZE];
+} extract_raw_t;
+
+/**
+ * \brief Pipeline of one device: the reader thread talks to the
+ *        device, the builder thread rebuilds and verifies the
+ *        certificates it has read so far
+ */
+typedef struct {
+    ATCAIfaceCfg *cfg;
+    eccx08_extract_result_t *result;
+    extract_raw_t raw[ECCX08_EXTRACT_CERTS];
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int ready;                      //!< Number of raw[] entries read
+    int done;                       //!< Set when the reader has finished
+    ATCA_STATUS read_status;
+    uint64_t start_us;              //!< Start of the whole run
+    pthread_t reader;
+    pthread_t builder;
+} extract_device_t;
+
+static const atcacert_def_t* const extract_cert_defs[ECCX08_EXTRACT_CERTS] = {
+    &g_cert_def_1_signer_t,
+    &g_cert_def_0_device_t,
+};
+
+/**
+ *
+ * \brief Returns a monotonic time stamp in microseconds
+ */
+static uint64_t extract_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ *
+ * \brief Reads the device data a certificate is rebuilt from
+ *
+ * \param[in] cert_def - certificate definition
+ * \param[out] raw - planned device locations and their data
+ * \return ATCA_SUCCESS for success
+ */
+static ATCA_STATUS extract_read_raw(const atcacert_def_t *cert_def, extract_raw_t *raw)
+{
+    ATCA_STATUS status = ATCA_SUCCESS;
+    atcacert_device_loc_t *loc;
+    size_t i;
+    size_t block;
+
+    raw->device_locs_count = 0;
+    status = atcacert_get_device_locs(cert_def, raw->device_locs, &raw->device_locs_count,
+                                      EXTRACT_MAX_LOCS, EXTRACT_BLOCK_SIZE);
+    if (status == ATCACERT_E_SUCCESS) {
+        status = atcacert_plan_device_reads(raw->device_locs, &raw->device_locs_count, EXTRACT_BLOCK_SIZE);
+    }
+    if (status != ATCACERT_E_SUCCESS) {
+        return status;
+    }
+    for (i = 0; i < raw->device_locs_count; i++) {
+        loc = &raw->device_locs[i];
+        if (loc->zone == DEVZONE_DATA && loc->is_genkey) {
+            status = atcab_get_pubkey(loc->slot, raw->data[i]);
+            if (status != ATCA_SUCCESS) {
+                return status;
+            }
+            continue;
+        }
+        if (loc->count > EXTRACT_LOC_DATA_SIZE) {
+            return ATCACERT_E_BAD_CERT;
+        }
+        for (block = loc->offset / EXTRACT_BLOCK_SIZE;
+             block < (size_t)(loc->offset + loc->count) / EXTRACT_BLOCK_SIZE; block++) {
+            status = atcab_read_zone(loc->zone, loc->slot, (uint8_t)block, 0,
+                                     &raw->data[i][block * EXTRACT_BLOCK_SIZE - loc->offset],
+                                     EXTRACT_BLOCK_SIZE);
+            if (status != ATCA_SUCCESS) {
+                return status;
+            }
+        }
+    }
+    return ATCA_SUCCESS;
+}
+
+/**
+ *
+ * \brief Rebuilds a certificate from the device data read by
+ *        extract_read_raw(). No device access.
+ *
+ * \param[in] cert_def - certificate definition
+ * \param[in] ca_public_key - 64 bytes public key of the issuer
+ * \param[in] raw - device data
+ * \param[out] cert - buffer for the certificate
+ * \param[in,out] cert_size - size of cert as input, certificate
+ *       size as output
+ * \return ATCA_SUCCESS for success
+ */
+static ATCA_STATUS extract_build(const atcacert_def_t *cert_def, const uint8_t *ca_public_key,
+                                 const extract_raw_t *raw, uint8_t *cert, size_t *cert_size)
+{
+    atcacert_build_state_t build_state;
+    int ret;
+    size_t i;
+
+    ret = atcacert_cert_build_start(&build_state, cert_def, cert, cert_size, ca_public_key);
+    if (ret != ATCACERT_E_SUCCESS) {
+        return ret;
+    }
+    for (i = 0; i < raw->device_locs_count; i++) {
+        ret = atcacert_cert_build_process(&build_state, &raw->device_locs[i], raw->data[i]);
+        if (ret != ATCACERT_E_SUCCESS) {
+            return ret;
+        }
+    }
+    return atcacert_cert_build_finish(&build_state);
+}
+
+/**
+ *
+ * \brief Reader thread: reads the serial number and the data of
+ *        every certificate of one device and hands each one to
+ *        the builder as soon as it is read
+ *
+ * \param[in] arg - a pointer to extract_device_t
+ */
+static void* extract_reader_main(void *arg)
+{
+    extract_device_t *dev = (extract_device_t *)arg;
+    eccx08_extract_result_t *result = dev->result;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    uint64_t start;
+    int k;
+
+    status = atcab_init(dev->cfg);
+    if (status == ATCA_SUCCESS) {
+        status = atcab_wake_hold();
+        if (status == ATCA_SUCCESS) {
+            status = atcab_read_serial_number(result->serial);
+            for (k = 0; k < ECCX08_EXTRACT_CERTS && status == ATCA_SUCCESS; k++) {
+                start = extract_now_us();
+                status = extract_read_raw(extract_cert_defs[k], &dev->raw[k]);
+                result->read_us[k] = extract_now_us() - start;
+                if (status != ATCA_SUCCESS) {
+                    break;
+                }
+                pthread_mutex_lock(&dev->mutex);
+                dev->ready = k + 1;
+                pthread_cond_signal(&dev->cond);
+                pthread_mutex_unlock(&dev->mutex);
+            }
+            atcab_wake_release();
+        }
+        atcab_release();
+    }
+
+    pthread_mutex_lock(&dev->mutex);
+    dev->read_status = status;
+    dev->done = 1;
+    pthread_cond_signal(&dev->cond);
+    pthread_mutex_unlock(&dev->mutex);
+    return NULL;
+}
+
+/**
+ *
+ * \brief Builder thread: rebuilds and verifies the certificates
+ *        of one device while the reader is still reading the
+ *        next one. The signer certificate comes first, its
+ *        public key is needed for the device certificate.
+ *
+ * \param[in] arg - a pointer to extract_device_t
+ */
+static void* extract_builder_main(void *arg)
+{
+    extract_device_t *dev = (extract_device_t *)arg;
+    eccx08_extract_result_t *result = dev->result;
+    ATCA_STATUS status = ATCA_SUCCESS;
+    uint8_t signer_pubkey[64];
+    const uint8_t *ca_public_key = g_signer_1_ca_public_key_t;
+    uint8_t *cert;
+    size_t *cert_size;
+    uint64_t start;
+    int k;
+
+    for (k = 0; k < ECCX08_EXTRACT_CERTS; k++) {
+        pthread_mutex_lock(&dev->mutex);
+        while (dev->ready <= k && !dev->done) {
+            pthread_cond_wait(&dev->cond, &dev->mutex);
+        }
+        if (dev->ready <= k) {
+            status = dev->read_status;
+            pthread_mutex_unlock(&dev->mutex);
+            break;
+        }
+        pthread_mutex_unlock(&dev->mutex);
+
+        cert = (k == ECCX08_EXTRACT_SIGNER) ? result->signer_cert : result->device_cert;
+        cert_size = (k == ECCX08_EXTRACT_SIGNER) ? &result->signer_cert_size : &result->device_cert_size;
+        *cert_size = ECCX08_CERT_CACHE_MAX_CERT;
+
+        start = extract_now_us();
+        status = extract_build(extract_cert_defs[k], ca_public_key, &dev->raw[k], cert, cert_size);
+        result->build_us[k] = extract_now_us() - start;
+        if (status != ATCA_SUCCESS) {
+            eccx08_error("extract_builder_main(): cannot rebuild certificate %d\n", k);
+            break;
+        }
+
+        start = extract_now_us();
+        status = atcacert_verify_cert_sw(extract_cert_defs[k], cert, *cert_size, ca_public_key);
+        result->verify_us[k] = extract_now_us() - start;
+        if (status != ATCA_SUCCESS) {
+            eccx08_error("extract_builder_main(): certificate %d does not verify\n", k);
+            break;
+        }
+
+        if (k == ECCX08_EXTRACT_SIGNER) {
+            status = atcacert_get_subj_public_key(extract_cert_defs[k], cert, *cert_size, signer_pubkey);
+            if (status != ATCA_SUCCESS) {
+                break;
+            }
+            ca_public_key = signer_pubkey;
+        }
+    }
+    result->status = status;
+    result->total_us = extract_now_us() - dev->start_us;
+    return NULL;
+}
+
+/**
+ *
+ * \brief Extracts the signer and device certificates from
+ *        several devices in parallel. Each device gets a reader
+ *        thread bound to its own interface configuration and a
+ *        builder thread that rebuilds and verifies a certificate
+ *        while the next one is read.
+ *
+ *        The engine device lock is held for the whole run, so
+ *        the pool may include the default device.
+ *
+ * \param[in,out] pool - configurations of the devices to read
+ *       and their results
+ * \return 1 if every device succeeded, 0 otherwise
+ */
+int eccx08_extract_pool(eccx08_extract_pool_t *pool)
+{
+    extract_device_t *devs = NULL;
+    uint64_t start;
+    size_t started = 0;
+    size_t i;
+    int ret = 1;
+
+    if (pool == NULL || pool->cfgs == NULL || pool->results == NULL
+        || pool->count == 0 || pool->count > ECCX08_EXTRACT_POOL_MAX) {
+        return 0;
+    }
+    devs = (extract_device_t *)OPENSSL_malloc(pool->count * sizeof(*devs));
+    if (devs == NULL) {
+        return 0;
+    }
+    memset(devs, 0, pool->count * sizeof(*devs));
+
+    eccx08_device_acquire();
+    start = extract_now_us();
+    for (i = 0; i < pool->count; i++) {
+        memset(&pool->results[i], 0, sizeof(pool->results[i]));
+        pool->results[i].status = ATCA_GEN_FAIL;
+        devs[i].cfg = pool->cfgs[i];
+        devs[i].result = &pool->results[i];
+        devs[i].start_us = start;
+        pthread_mutex_init(&devs[i].mutex, NULL);
+        pthread_cond_init(&devs[i].cond, NULL);
+        if (pthread_create(&devs[i].reader, NULL, extract_reader_main, &devs[i]) != 0) {
+            break;
+        }
+        if (pthread_create(&devs[i].builder, NULL, extract_builder_main, &devs[i]) != 0) {
+            // The reader still runs, let it finish before leaving
+            pthread_join(devs[i].reader, NULL);
+            break;
+        }
+        started++;
+    }
+    for (i = 0; i < started; i++) {
+        pthread_join(devs[i].reader, NULL);
+        pthread_join(devs[i].builder, NULL);
+    }
+    pool->wall_us = extract_now_us() - start;
+    eccx08_device_release();
+
+    for (i = 0; i < pool->count; i++) {
+        if (pool->results[i].status != ATCA_SUCCESS) {
+            ret = 0;
+        }
+        if (devs[i].cfg) {
+            pthread_mutex_destroy(&devs[i].mutex);
+            pthread_cond_destroy(&devs[i].cond);
+        }
+    }
+    OPENSSL_cleanse(devs, pool->count * sizeof(*devs));
+    OPENSSL_free(devs);
+    return ret;
+}
@@ -0,0 +1,323 @@
+/**
+ *  \file eccx08_failover.c
+ * \brief Deadlines of device operations, failover of public
+ *        operations to other devices and to software
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Atmel nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/engine.h>
+#include "ecc_meth.h"
+
+/*
+ * Every ENGINE callback owns the device from eccx08_device_acquire() to
+ * eccx08_device_release(), and the deadline runs over that window: the HAL
+ * gives up at the deadline and atsend() refuses to start a command past it,
+ * so a stalled kit costs a handshake the deadline instead of hanging it.
+ *
+ * Sign, ECDH and key generation need the private keys of the one device in
+ * pCfg and simply fail. Verify and random numbers only need some device:
+ * eccx08_failover_run() moves on to the next device of the pool and skips a
+ * device that failed for ECCX08_DEVICE_HOLDOFF_MS. The pool and its state
+ * are only touched with the device owned.
+ */
+
+typedef struct {
+    ATCAIfaceCfg cfg;
+    uint64_t held_off_until_ms;     // atca_deadline_now_ms() time the device is tried again
+} eccx08_failover_device_t;
+
+static eccx08_failover_device_t failover_devices[ECCX08_EXTRACT_POOL_MAX];
+static size_t failover_count = 0;
+static uint32_t failover_deadline_ms = ECCX08_DEADLINE_DEFAULT_MS;
+static int failover_sw_fallback = 1;
+static eccx08_failover_stats_t failover_stats;
+
+// Deadline the calling thread had before eccx08_deadline_begin()
+static __thread uint64_t failover_saved_deadline = 0;
+
+/**
+ *
+ * \brief Puts pCfg into the pool if eccx08_failover_init() has
+ *        not run yet
+ */
+static void failover_pool_default(void)
+{
+    if (failover_count == 0) {
+        failover_devices[0].cfg = *pCfg;
+        failover_devices[0].held_off_until_ms = 0;
+        failover_count = 1;
+    }
+}
+
+/**
+ *
+ * \brief Adds a device to the pool, on the same interface as
+ *        pCfg
+ *
+ * \param[in] index - kit port, HID index or I2C bus
+ * \return 1 for success, 0 if the pool is full
+ */
+static int failover_pool_add(int index)
+{
+    ATCAIfaceCfg *cfg;
+
+    if (failover_count >= ECCX08_EXTRACT_POOL_MAX) {
+        return 0;
+    }
+    cfg = &failover_devices[failover_count].cfg;
+    *cfg = *pCfg;
+#ifdef ATCA_HAL_KIT_CDC
+    cfg->atcauart.port = index;
+#elif ATCA_HAL_KIT_HID
+    cfg->atcahid.idx = index;
+#elif ATCA_HAL_I2C
+    cfg->atcai2c.bus = (uint8_t)index;
+#endif
+    failover_devices[failover_count].held_off_until_ms = 0;
+    failover_count++;
+    return 1;
+}
+
+/**
+ *
+ * \brief Reads the deadline, the extra devices and the software
+ *        fallback policy from the environment (ECCX08_DEADLINE_ENV,
+ *        ECCX08_DEVICES_ENV, ECCX08_SW_FALLBACK_ENV). Runs before
+ *        any other thread uses the device.
+ *
+ * \return 1 for success
+ */
+int eccx08_failover_init(void)
+{
+    const char *env;
+    char *end;
+    long value;
+
+    eccx08_debug("eccx08_failover_init()\n");
+
+    env = getenv(ECCX08_DEADLINE_ENV);
+    if (env != NULL && env[0] != '\0') {
+        value = strtol(env, &end, 0);
+        if (*end != '\0' || value < 0) {
+            eccx08_error("eccx08_failover_init(): bad %s %s\n", ECCX08_DEADLINE_ENV, env);
+        } else {
+            __atomic_store_n(&failover_deadline_ms, (uint32_t)value, __ATOMIC_RELAXED);
+        }
+    }
+
+    env = getenv(ECCX08_SW_FALLBACK_ENV);
+    if (env != NULL && env[0] != '\0') {
+        __atomic_store_n(&failover_sw_fallback, strcmp(env, "0") != 0, __ATOMIC_RELAXED);
+    }
+
+    failover_count = 0;
+    failover_pool_default();
+    env = getenv(ECCX08_DEVICES_ENV);
+    while (env != NULL && *env != '\0') {
+        value = strtol(env, &end, 0);
+        if (end == env || value < 0 || (*end != '\0' && *end != ',')) {
+            eccx08_error("eccx08_failover_init(): bad %s\n", ECCX08_DEVICES_ENV);
+            break;
+        }
+        if (!failover_pool_add((int)value)) {
+            eccx08_error("eccx08_failover_init(): more than %d devices\n", ECCX08_EXTRACT_POOL_MAX);
+            break;
+        }
+        env = (*end == ',') ? end + 1 : end;
+    }
+    eccx08_debug("eccx08_failover_init(): %u devices, deadline %u ms\n", (unsigned)failover_count,
+                 failover_deadline_ms);
+    return 1;
+}
+
+/**
+ *
+ * \brief Starts the deadline of the calling thread. Called by
+ *        eccx08_device_acquire() once it owns the device, so the
+ *        time spent waiting for other callbacks does not count.
+ */
+void eccx08_deadline_begin(void)
+{
+    failover_saved_deadline = atca_deadline_set(__atomic_load_n(&failover_deadline_ms, __ATOMIC_RELAXED));
+}
+
+/**
+ *
+ * \brief Ends the deadline started by eccx08_deadline_begin()
+ *        and counts it if it ran out. Called by
+ *        eccx08_device_release().
+ */
+void eccx08_deadline_end(void)
+{
+    if (atca_deadline_expired()) {
+        __atomic_add_fetch(&failover_stats.timeouts, 1, __ATOMIC_RELAXED);
+    }
+    atca_deadline_restore(failover_saved_deadline);
+}
+
+/**
+ *
+ * \brief Tells a device that did not answer (or could not be
+ *        reached) from a device that answered with an error
+ *
+ * \param[in] status - result of a device operation
+ * \return 1 if another device or software may complete the
+ *         operation
+ */
+int eccx08_device_failed(ATCA_STATUS status)
+{
+    switch (status) {
+    // atcab_init() cannot tell a port that does not open from other errors
+    case ATCA_GEN_FAIL:
+    case ATCA_COMM_FAIL:
+    case ATCA_TX_FAIL:
+    case ATCA_WAKE_FAILED:
+    case ATCA_NO_DEVICES:
+        return 1;
+    default:
+        return atca_status_is_timeout(status);
+    }
+}
+
+/**
+ *
+ * \brief Runs a public operation on the first device of the
+ *        pool that is not held off, and on the next one as long
+ *        as the device fails (see eccx08_device_failed()). Each
+ *        device gets the full deadline. A failed device is held
+ *        off for ECCX08_DEVICE_HOLDOFF_MS. The caller must own
+ *        the device.
+ *
+ * \param[in] op - the operation, it binds the device it is given
+ *       with atcatls_init() and releases it with atcatls_finish()
+ * \param[in] arg - passed to op
+ * \return the status of the last device tried, ATCA_NO_DEVICES
+ *         if every device is held off
+ */
+ATCA_STATUS eccx08_failover_run(eccx08_device_op_f op, void *arg)
+{
+    ATCA_STATUS status = ATCA_NO_DEVICES;
+    uint32_t deadline_ms = __atomic_load_n(&failover_deadline_ms, __ATOMIC_RELAXED);
+    uint64_t saved = atca_deadline_set(0);
+    eccx08_failover_device_t *device;
+    int tried = 0;
+    size_t i;
+
+    failover_pool_default();
+    for (i = 0; i < failover_count; i++) {
+        device = &failover_devices[i];
+        if (device->held_off_until_ms > atca_deadline_now_ms()) {
+            __atomic_add_fetch(&failover_stats.held_off, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (tried) {
+            __atomic_add_fetch(&failover_stats.failovers, 1, __ATOMIC_RELAXED);
+        }
+        tried = 1;
+        atca_deadline_set(deadline_ms);
+        status = op(&device->cfg, arg);
+        if (!eccx08_device_failed(status)) {
+            break;
+        }
+        eccx08_error("eccx08_failover_run(): device %u failed (0x%02X), held off for %d ms\n",
+                     (unsigned)i, status, ECCX08_DEVICE_HOLDOFF_MS);
+        device->held_off_until_ms = atca_deadline_now_ms() + ECCX08_DEVICE_HOLDOFF_MS;
+    }
+    atca_deadline_restore(saved);
+    return status;
+}
+
+/**
+ *
+ * \brief Asks whether a public operation no device could
+ *        complete may be completed in software, and counts it
+ *        if so
+ *
+ * \return 1 if the caller should complete it in software
+ */
+int eccx08_failover_sw_fallback(void)
+{
+    if (!__atomic_load_n(&failover_sw_fallback, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+    __atomic_add_fetch(&failover_stats.fallbacks, 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+/**
+ *
+ * \brief Handles the ECCX08_CMD_DEADLINE,
+ *        ECCX08_CMD_SW_FALLBACK and ECCX08_CMD_GET_FAILOVER_STATS
+ *        commands
+ *
+ * \param[in] cmd the command
+ * \param[in] i for ECCX08_CMD_DEADLINE: the deadline in ms, 0
+ *       for none; for ECCX08_CMD_SW_FALLBACK: 0 forbids software
+ *       fallback, 1 allows it
+ * \param[out] p for ECCX08_CMD_GET_FAILOVER_STATS: an
+ *       eccx08_failover_stats_t to fill
+ * \return 1 for success, 0 for error
+ */
+int eccx08_failover_ctrl(int cmd, long i, void *p)
+{
+    eccx08_failover_stats_t *stats = (eccx08_failover_stats_t *)p;
+
+    switch (cmd) {
+    case ECCX08_CMD_DEADLINE:
+        if (i < 0 || i > UINT32_MAX) {
+            return 0;
+        }
+        __atomic_store_n(&failover_deadline_ms, (uint32_t)i, __ATOMIC_RELAXED);
+        return 1;
+    case ECCX08_CMD_SW_FALLBACK:
+        __atomic_store_n(&failover_sw_fallback, i != 0, __ATOMIC_RELAXED);
+        return 1;
+    case ECCX08_CMD_GET_FAILOVER_STATS:
+        if (stats == NULL) {
+            return 0;
+        }
+        stats->timeouts = __atomic_load_n(&failover_stats.timeouts, __ATOMIC_RELAXED);
+        stats->failovers = __atomic_load_n(&failover_stats.failovers, __ATOMIC_RELAXED);
+        stats->fallbacks = __atomic_load_n(&failover_stats.fallbacks, __ATOMIC_RELAXED);
+        stats->held_off = __atomic_load_n(&failover_stats.held_off, __ATOMIC_RELAXED);
+        return 1;
+    default:
+        return 0;
+    }
+}
@@ -49,6 +49,34 @@
 
 static int total_num = 0;
 
+/**
+ *
+ * \brief Mixes one block of ATECCX08 TRNG output into the
+ *        standard OpenSSL PRNG (RAND_SSLeay()). The block is
+ *        taken from the entropy prefetch ring when available so
+ *        the caller does not wait for a device round trip.
+ *
+ * \return 1 for success
+ */
+int eccx08_rand_reseed(void)
+{
+    int rc = 0;
+    uint8_t seed[ECCX08_ENTROPY_BLOCK_SIZE];
+    const RAND_METHOD *meth_rand = RAND_SSLeay();
+
+#ifdef USE_ECCX08
+    if (!eccx08_entropy_get(seed, sizeof(seed))) {
+        eccx08_error("eccx08_rand_reseed(): error in eccx08_entropy_get\n");
+        goto done;
+    }
+    meth_rand->add(seed, sizeof(seed), (double)sizeof(seed));
+    OPENSSL_cleanse(seed, sizeof(seed));
+#endif // USE_ECCX08
+    rc = 1;
+done:
+    return (rc);
+}
+
 /**
  *
  * \brief Generates a random bytes stream. The ATECCX08 TRNG is
@@ -64,11 +92,9 @@ static int total_num = 0;
  */
 static int RAND_eccx08_rand_bytes(unsigned char *buf, int num)
 {
+    ATCA_TRACE_SCOPE("engine", "rand_bytes");
     int rc = 0;
-    uint32_t atcab_buf[TLS_RANDOM_SIZE / sizeof(uint32_t)];
-    double entropy;
     RAND_METHOD *meth_rand = RAND_SSLeay();
-    ATCA_STATUS status = ATCA_GEN_FAIL;
 
 #ifdef USE_ECCX08
     if (total_num > MAX_RAND_BYTES) {
@@ -76,14 +102,7 @@ static int RAND_eccx08_rand_bytes(unsigned char *buf, int num)
     }
     if (total_num == 0) {
         eccx08_debug("RAND_eccx08_rand_bytes() -  hw\n");
-        status = atcatls_init(pCfg);
-        if (status != ATCA_SUCCESS) goto done;
-        status = atcatls_random((uint8_t *)atcab_buf);
-        if (status != ATCA_SUCCESS) goto done;
-        status = atcatls_finish();
-        if (status != ATCA_SUCCESS) goto done;
-        entropy = (double)atcab_buf[0];
-        meth_rand->add(buf, num, entropy);
+        if (!eccx08_rand_reseed()) goto done;
     }
     total_num += num;
 #else // USE_ECCX08
@@ -207,6 +207,7 @@ static int eccx08_rsa_keygen(RSA *rsa, int bits, BIGNUM *e_value, BN_GENCB *cb)
     uint8_t slotId = TLS_SLOT8_ENC_STORE;
     int16_t raw_key_len;
     char *raw_key = NULL;
+    int device_owned = 0;
     const RAND_METHOD *rand_meth = RAND_get_rand_method();
 
     //Generate AES key and IV to encrypt RSA private key
@@ -215,61 +216,63 @@ static int eccx08_rsa_keygen(RSA *rsa, int bits, BIGNUM *e_value, BN_GENCB *cb)
 
     ret = eccx08_rsa_builtin_keygen(rsa, bits, e_value, cb);
     if (ret != 1) {
-        eccx08_debug("eccx08_rsa_keygen(): error in eccx08_rsa_builtin_keygen\n");
+        eccx08_error("eccx08_rsa_keygen(): error in eccx08_rsa_builtin_keygen\n");
         return ret;
     }
     ret = eccx08_BN_encrypt(rsa->p, aes_iv, aes_key);
     if (ret != 1) {
-        eccx08_debug("eccx08_rsa_keygen(): error in eccx08_BN_encrypt: rsa->p\n");
+        eccx08_error("eccx08_rsa_keygen(): error in eccx08_BN_encrypt: rsa->p\n");
         return ret;
     }
     ret = eccx08_BN_encrypt(rsa->q, aes_iv + 1, aes_key);
     if (ret != 1) {
-        eccx08_debug("eccx08_rsa_keygen(): error in eccx08_BN_encrypt: rsa->q\n");
+        eccx08_error("eccx08_rsa_keygen(): error in eccx08_BN_encrypt: rsa->q\n");
         return ret;
     }
     ret = eccx08_BN_encrypt(rsa->dmp1, aes_iv + 2, aes_key);
     if (ret != 1) {
-        eccx08_debug("eccx08_rsa_keygen(): error in eccx08_BN_encrypt: rsa->dmp1\n");
+        eccx08_error("eccx08_rsa_keygen(): error in eccx08_BN_encrypt: rsa->dmp1\n");
         return ret;
     }
     ret = eccx08_BN_encrypt(rsa->dmq1, aes_iv + 3, aes_key);
     if (ret != 1) {
-        eccx08_debug("eccx08_rsa_keygen(): error in eccx08_BN_encrypt: rsa->dmq1\n");
+        eccx08_error("eccx08_rsa_keygen(): error in eccx08_BN_encrypt: rsa->dmq1\n");
         return ret;
     }
     ret = eccx08_BN_encrypt(rsa->iqmp, aes_iv + 4, aes_key);
     if (ret != 1) {
-        eccx08_debug("eccx08_rsa_keygen(): error in eccx08_BN_encrypt: rsa->iqmp\n");
+        eccx08_error("eccx08_rsa_keygen(): error in eccx08_BN_encrypt: rsa->iqmp\n");
         return ret;
     }
 
     //Save AES key and IV to slot #8 of ATECC508
+    eccx08_device_acquire();
+    device_owned = 1;
     status = atcatls_init(pCfg);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_rsa_keygen(): error in atcatls_init\n");
+        eccx08_error("eccx08_rsa_keygen(): error in atcatls_init\n");
         goto err;
     }
     //set encryption key
     status = atcatlsfn_set_get_enckey(&eccx08_get_enc_key);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_rsa_keygen() - error in atcatlsfn_set_get_enckey \n");
+        eccx08_error("eccx08_rsa_keygen() - error in atcatlsfn_set_get_enckey \n");
         goto err;
     }
     status = eccx08_get_enc_key(encKey, ATCA_KEY_SIZE);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_rsa_keygen() - error in eccx08_get_enc_key \n");
+        eccx08_error("eccx08_rsa_keygen() - error in eccx08_get_enc_key \n");
         goto err;
     }
     status = atcatls_set_enckey(encKey, enckeyId, lock);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_rsa_keygen() - error in atcatls_init_enckey \n");
+        eccx08_error("eccx08_rsa_keygen() - error in atcatls_init_enckey \n");
         goto err;
     }
     //read serial number here
     status = atcatls_get_sn(serial_number);
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_rsa_keygen() - error in atcatls_get_sn \n");
+        eccx08_error("eccx08_rsa_keygen() - error in atcatls_get_sn \n");
         goto err;
     }
     status = atcatls_enc_write(slotId, 0, enckeyId, aes_key, ATCA_KEY_SIZE);
@@ -284,9 +287,11 @@ static int eccx08_rsa_keygen(RSA *rsa, int bits, BIGNUM *e_value, BN_GENCB *cb)
     }
     status = atcatls_finish();
     if (status != ATCA_SUCCESS) {
-        eccx08_debug("eccx08_rsa_keygen(): error in atcatls_finish\n");
+        eccx08_error("eccx08_rsa_keygen(): error in atcatls_finish\n");
         goto err;
     }
+    eccx08_device_release();
+    device_owned = 0;
 
     //Replace private key in RSA structure with a token
     //For now p and q are used rather than d in openssl
@@ -305,6 +310,9 @@ static int eccx08_rsa_keygen(RSA *rsa, int bits, BIGNUM *e_value, BN_GENCB *cb)
     BN_bin2bn(raw_key, raw_key_len, rsa->d);
     ret = 1;
 err:
+    if (device_owned) {
+        eccx08_device_release();
+    }
     if (raw_key) {
         OPENSSL_free(raw_key);
     }
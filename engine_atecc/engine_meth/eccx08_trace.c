@@ -0,0 +1,227 @@
+/**
+ *  \file eccx08_trace.c
+ * \brief Runtime control and dumps of the device event trace
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of Atmel nor the names of its contributors may be used to endorse
+ *    or promote products derived from this software without specific prior written permission.
+ *
+ * 4. This software may only be redistributed and used in connection with an
+ *    Atmel integrated circuit.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <openssl/engine.h>
+#include "ecc_meth.h"
+
+static char trace_path[256];
+static int trace_running = 0;
+static volatile int trace_stop = 0;
+static pthread_t trace_thread;
+static sem_t trace_sem;
+static struct sigaction trace_old_action;
+
+/**
+ *
+ * \brief Writes the trace ring to a file as Chrome trace JSON
+ *        (chrome://tracing, ui.perfetto.dev)
+ *
+ * \param[in] path the file
+ * \return 1 for success, 0 for error
+ */
+static int trace_dump(const char *path)
+{
+    FILE *fp;
+    int ret;
+
+    fp = fopen(path, "w");
+    if (fp == NULL) {
+        eccx08_error("trace_dump(): cannot open %s\n", path);
+        return 0;
+    }
+    ret = atca_trace_write_chrome(fp);
+    if (fclose(fp) != 0) {
+        ret = 0;
+    }
+    return ret;
+}
+
+/**
+ *
+ * \brief SIGUSR2 handler. Only wakes the dump thread, the dump
+ *        itself is not async signal safe
+ */
+static void trace_signal(int sig)
+{
+    (void)sig;
+    sem_post(&trace_sem);
+}
+
+/**
+ *
+ * \brief Dumps the trace to trace_path every time SIGUSR2 arrives
+ */
+static void *trace_dump_thread(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        if (sem_wait(&trace_sem) != 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (trace_stop) {
+            break;
+        }
+        if (trace_dump(trace_path)) {
+            eccx08_debug("trace_dump_thread(): trace written to %s\n", trace_path);
+        }
+    }
+    return NULL;
+}
+
+/**
+ *
+ * \brief Starts the event trace when the ECCX08_TRACE_ENV
+ *        environment variable names a file. The trace is written
+ *        to that file on SIGUSR2 and at eccx08_trace_finish().
+ *
+ * \return 1 for success
+ */
+int eccx08_trace_init(void)
+{
+    const char *path = getenv(ECCX08_TRACE_ENV);
+    struct sigaction action;
+
+    eccx08_debug("eccx08_trace_init()\n");
+
+    if (trace_running || path == NULL || path[0] == '\0') {
+        return 1;
+    }
+    if (strlen(path) >= sizeof(trace_path)) {
+        eccx08_debug("eccx08_trace_init(): %s too long\n", ECCX08_TRACE_ENV);
+        return 1;
+    }
+    strcpy(trace_path, path);
+
+    if (sem_init(&trace_sem, 0, 0) != 0) {
+        return 1;
+    }
+    trace_stop = 0;
+    if (pthread_create(&trace_thread, NULL, trace_dump_thread, NULL) != 0) {
+        sem_destroy(&trace_sem);
+        return 1;
+    }
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = trace_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR2, &action, &trace_old_action);
+
+    trace_running = 1;
+    atca_trace_clear();
+    atca_trace_enable(1);
+    return 1;
+}
+
+/**
+ *
+ * \brief Stops the trace started by eccx08_trace_init() and
+ *        writes it out a last time
+ *
+ * \return 1 for success
+ */
+int eccx08_trace_finish(void)
+{
+    int ret = 1;
+
+    eccx08_debug("eccx08_trace_finish()\n");
+
+    if (!trace_running) {
+        return 1;
+    }
+    sigaction(SIGUSR2, &trace_old_action, NULL);
+    trace_stop = 1;
+    sem_post(&trace_sem);
+    pthread_join(trace_thread, NULL);
+    sem_destroy(&trace_sem);
+    trace_running = 0;
+
+    atca_trace_enable(0);
+    ret = trace_dump(trace_path);
+    return ret;
+}
+
+/**
+ *
+ * \brief Handles the ECCX08_CMD_TRACE_ENABLE and
+ *        ECCX08_CMD_TRACE_DUMP commands
+ *
+ * \param[in] cmd the command
+ * \param[in] i for ECCX08_CMD_TRACE_ENABLE: 0 stops recording,
+ *       1 starts it, 2 empties the ring and starts it
+ * \param[in] p for ECCX08_CMD_TRACE_DUMP: the file to write,
+ *       NULL for the ECCX08_TRACE_ENV file
+ * \return 1 for success, 0 for error
+ */
+int eccx08_trace_ctrl(int cmd, long i, void *p)
+{
+    const char *path = (const char *)p;
+
+    if (cmd == ECCX08_CMD_TRACE_ENABLE) {
+        eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_TRACE_ENABLE, %ld)\n", i);
+        if (i < 0 || i > 2) {
+            return 0;
+        }
+        if (i == 2) {
+            atca_trace_clear();
+        }
+        atca_trace_enable(i != 0);
+        return 1;
+    }
+    if (cmd == ECCX08_CMD_TRACE_DUMP) {
+        eccx08_debug("eccx08_cmd_ctrl(ECCX08_CMD_TRACE_DUMP)\n");
+        if (path == NULL) {
+            path = trace_path;
+        }
+        if (path[0] == '\0') {
+            return 0;
+        }
+        return trace_dump(path);
+    }
+    return 0;
+}
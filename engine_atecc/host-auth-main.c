@@ -0,0 +1,412 @@
+/** \file host-auth-main.c
+ * \brief Host side device authentication service. Authenticates field devices by challenge and
+ * response with software verify, so the gateway's own ATECC508 is not used per check.
+ *
+ * Copyright (c) 2015 Atmel Corporation. All rights reserved.
+ *
+ * \atmel_crypto_device_library_license_start
+ *
+ * \page License
+ *  
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ *    this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ *    this list of conditions and the following disclaimer in the documentation 
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of Atmel nor the names of its contributors may be used to endorse 
+ *    or promote products derived from this software without specific prior written permission.  
+ * 
+ * 4. This software may only be redistributed and used in connection with an 
+ *    Atmel integrated circuit.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE 
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE 
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "cryptoauthlib.h"
+#include "atcacert/atcacert_host_auth.h"
+#include "engine_meth/platform.h"
+
+/*
+ * Requests are read one per line from stdin and answered one per line on stdout. Every request
+ * carries a caller chosen id that is echoed back, since with more than one worker thread answers
+ * can come back out of order. Binary values are hex.
+ *
+ *   challenge <id>                                     -> <id> <challenge>
+ *   auth <id> <signer-cert> <device-cert> <challenge> <response>
+ *                                                      -> <id> ok | <id> fail <atcacert error>
+ *   stats                                              -> stats challenges=... key_hits=... ...
+ */
+
+#define HOST_AUTH_LINE_SIZE     (4096)
+#define HOST_AUTH_CERT_SIZE     (1024)
+#define HOST_AUTH_QUEUE_SIZE    (256)
+#define HOST_AUTH_MAX_THREADS   (64)
+
+typedef struct {
+	char line[HOST_AUTH_LINE_SIZE];
+} host_auth_request;
+
+typedef struct {
+	uint8_t signer_cert[HOST_AUTH_CERT_SIZE];
+	uint8_t device_cert[HOST_AUTH_CERT_SIZE];
+	uint8_t challenge[ATCACERT_AUTH_CHALLENGE_SIZE];
+	uint8_t response[64];
+} host_auth_buffers;
+
+/* Everything one worker drains from the queue in a go */
+typedef struct {
+	host_auth_request lines[ATCACERT_AUTH_BATCH_MAX];
+	host_auth_buffers buffers[ATCACERT_AUTH_BATCH_MAX];
+	atcacert_auth_request_t requests[ATCACERT_AUTH_BATCH_MAX];
+	const char* ids[ATCACERT_AUTH_BATCH_MAX];
+	int results[ATCACERT_AUTH_BATCH_MAX];
+} host_auth_batch;
+
+static atcacert_auth_ctx_t g_auth;
+static pthread_mutex_t g_out_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_mutex_t g_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_queue_not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t g_queue_not_full = PTHREAD_COND_INITIALIZER;
+static host_auth_request g_queue[HOST_AUTH_QUEUE_SIZE];
+static size_t g_queue_head;
+static size_t g_queue_count;
+static int g_queue_closed;
+
+/** \brief Strict hex to binary. No whitespace, even length only.
+ * \return number of bytes written, or -1 on malformed input or overflow
+ */
+static int hex_to_bin(const char* hex, uint8_t* bin, size_t bin_size)
+{
+	static const char digits[] = "0123456789abcdef0123456789ABCDEF";
+	size_t len = strlen(hex);
+	size_t i;
+	const char* hi;
+	const char* lo;
+
+	if (len % 2 != 0 || len / 2 > bin_size)
+		return -1;
+	for (i = 0; i < len / 2; i++) {
+		hi = strchr(digits, hex[i * 2]);
+		lo = strchr(digits, hex[i * 2 + 1]);
+		if (hi == NULL || lo == NULL || *hi == '\0' || *lo == '\0')
+			return -1;
+		bin[i] = (uint8_t)((((hi - digits) & 0x0F) << 4) | ((lo - digits) & 0x0F));
+	}
+
+	return (int)(len / 2);
+}
+
+static void bin_to_hex(const uint8_t* bin, size_t bin_size, char* hex)
+{
+	static const char digits[] = "0123456789abcdef";
+	size_t i;
+
+	for (i = 0; i < bin_size; i++) {
+		hex[i * 2] = digits[bin[i] >> 4];
+		hex[i * 2 + 1] = digits[bin[i] & 0x0F];
+	}
+	hex[bin_size * 2] = '\0';
+}
+
+static void host_auth_reply(const char* fmt_id, const char* text)
+{
+	pthread_mutex_lock(&g_out_lock);
+	fprintf(stdout, "%s %s\n", fmt_id, text);
+	fflush(stdout);
+	pthread_mutex_unlock(&g_out_lock);
+}
+
+static int host_auth_challenge(const char* id)
+{
+	uint8_t challenge[ATCACERT_AUTH_CHALLENGE_SIZE];
+	char hex[ATCACERT_AUTH_CHALLENGE_SIZE * 2 + 1];
+	char err[32];
+	int ret;
+
+	ret = atcacert_auth_gen_challenge(&g_auth, challenge);
+	if (ret != ATCACERT_E_SUCCESS) {
+		snprintf(err, sizeof(err), "fail %d", ret);
+		host_auth_reply(id, err);
+		return ret;
+	}
+	bin_to_hex(challenge, sizeof(challenge), hex);
+	host_auth_reply(id, hex);
+
+	return ATCACERT_E_SUCCESS;
+}
+
+/** \brief Decodes the arguments of an auth request into buffers owned by the caller.
+ * \return ATCACERT_E_SUCCESS, or the error to answer the request with
+ */
+static int host_auth_parse_auth(char* args, host_auth_buffers* buf, atcacert_auth_request_t* request)
+{
+	int signer_cert_size, device_cert_size;
+	char* save = NULL;
+	char* signer_hex = args ? strtok_r(args, " \t", &save) : NULL;
+	char* device_hex = strtok_r(NULL, " \t", &save);
+	char* challenge_hex = strtok_r(NULL, " \t", &save);
+	char* response_hex = strtok_r(NULL, " \t", &save);
+
+	if (signer_hex == NULL || device_hex == NULL || challenge_hex == NULL || response_hex == NULL)
+		return ATCACERT_E_BAD_PARAMS;
+
+	signer_cert_size = hex_to_bin(signer_hex, buf->signer_cert, sizeof(buf->signer_cert));
+	device_cert_size = hex_to_bin(device_hex, buf->device_cert, sizeof(buf->device_cert));
+	if (signer_cert_size < 0 || device_cert_size < 0
+	    || hex_to_bin(challenge_hex, buf->challenge, sizeof(buf->challenge)) != sizeof(buf->challenge)
+	    || hex_to_bin(response_hex, buf->response, sizeof(buf->response)) != sizeof(buf->response))
+		return ATCACERT_E_DECODING_ERROR;
+
+	request->signer_cert = buf->signer_cert;
+	request->signer_cert_size = (size_t)signer_cert_size;
+	request->device_cert = buf->device_cert;
+	request->device_cert_size = (size_t)device_cert_size;
+	request->challenge = buf->challenge;
+	request->response = buf->response;
+
+	return ATCACERT_E_SUCCESS;
+}
+
+static void host_auth_auth_reply(const char* id, int ret)
+{
+	char err[32];
+
+	if (ret == ATCACERT_E_SUCCESS) {
+		host_auth_reply(id, "ok");
+	}else  {
+		snprintf(err, sizeof(err), "fail %d", ret);
+		host_auth_reply(id, err);
+	}
+}
+
+static int host_auth_auth(const char* id, char* args)
+{
+	host_auth_buffers buf;
+	atcacert_auth_request_t request;
+	int ret;
+
+	ret = host_auth_parse_auth(args, &buf, &request);
+	if (ret == ATCACERT_E_SUCCESS)
+		ret = atcacert_auth_device(&g_auth, request.signer_cert, request.signer_cert_size, request.device_cert,
+		                           request.device_cert_size, request.challenge, request.response);
+	host_auth_auth_reply(id, ret);
+
+	return ret;
+}
+
+static void host_auth_stats(void)
+{
+	atcacert_auth_stats_t stats;
+
+	atcacert_auth_get_stats(&g_auth, &stats);
+	pthread_mutex_lock(&g_out_lock);
+	fprintf(stdout, "stats challenges=%u evicted=%u key_hits=%u key_misses=%u verified=%u failed=%u bad_challenges=%u\n",
+	        stats.challenges, stats.evicted, stats.key_hits, stats.key_misses, stats.verified, stats.failed,
+	        stats.bad_challenges);
+	fflush(stdout);
+	pthread_mutex_unlock(&g_out_lock);
+}
+
+static void host_auth_dispatch(char* line)
+{
+	char* save = NULL;
+	char* cmd = strtok_r(line, " \t\r\n", &save);
+	char* id = NULL;
+
+	if (cmd == NULL)
+		return;
+	if (strcmp(cmd, "stats") == 0) {
+		host_auth_stats();
+		return;
+	}
+
+	id = strtok_r(NULL, " \t\r\n", &save);
+	if (id == NULL) {
+		host_auth_reply("-", "fail missing id");
+		return;
+	}
+	if (strcmp(cmd, "challenge") == 0)
+		host_auth_challenge(id);
+	else if (strcmp(cmd, "auth") == 0)
+		host_auth_auth(id, strtok_r(NULL, "\r\n", &save));
+	else
+		host_auth_reply(id, "fail unknown command");
+}
+
+/** \brief Answers a run of lines taken off the queue together. Well formed auth requests are
+ * verified as one batch, which is cheaper per signature than one at a time; anything else is
+ * dispatched as it comes. Replies to the batched requests go out after the other lines.
+ */
+static void host_auth_run_batch(host_auth_batch* batch, size_t line_count)
+{
+	char* line;
+	char* save;
+	char* id;
+	size_t count = 0;
+	size_t i;
+	int ret;
+
+	for (i = 0; i < line_count; i++) {
+		line = batch->lines[i].line;
+		line += strspn(line, " \t");
+		if (strncmp(line, "auth", 4) != 0 || line[4] == '\0' || strchr(" \t\r\n", line[4]) == NULL) {
+			host_auth_dispatch(batch->lines[i].line);
+			continue;
+		}
+		save = NULL;
+		strtok_r(line, " \t\r\n", &save);
+		id = strtok_r(NULL, " \t\r\n", &save);
+		if (id == NULL) {
+			host_auth_reply("-", "fail missing id");
+			continue;
+		}
+		ret = host_auth_parse_auth(strtok_r(NULL, "\r\n", &save), &batch->buffers[count], &batch->requests[count]);
+		if (ret != ATCACERT_E_SUCCESS) {
+			host_auth_auth_reply(id, ret);
+			continue;
+		}
+		batch->ids[count++] = id;
+	}
+	if (count == 0)
+		return;
+
+	ret = atcacert_auth_device_batch(&g_auth, count, batch->requests, batch->results);
+	for (i = 0; i < count; i++)
+		host_auth_auth_reply(batch->ids[i], ret == ATCACERT_E_SUCCESS ? batch->results[i] : ret);
+}
+
+static void* host_auth_worker(void* arg)
+{
+	host_auth_batch* batch = malloc(sizeof(*batch));
+	host_auth_request req;
+	size_t count;
+
+	(void)arg;
+	for (;; ) {
+		pthread_mutex_lock(&g_queue_lock);
+		while (g_queue_count == 0 && !g_queue_closed)
+			pthread_cond_wait(&g_queue_not_empty, &g_queue_lock);
+		if (g_queue_count == 0) {
+			pthread_mutex_unlock(&g_queue_lock);
+			break;
+		}
+		if (batch == NULL) {
+			req = g_queue[g_queue_head];
+			g_queue_head = (g_queue_head + 1) % HOST_AUTH_QUEUE_SIZE;
+			g_queue_count--;
+			pthread_cond_signal(&g_queue_not_full);
+			pthread_mutex_unlock(&g_queue_lock);
+
+			host_auth_dispatch(req.line);
+			continue;
+		}
+
+		/* Take whatever has queued up, so work arriving faster than it is verified gets batched */
+		for (count = 0; count < ATCACERT_AUTH_BATCH_MAX && g_queue_count > 0; count++) {
+			batch->lines[count] = g_queue[g_queue_head];
+			g_queue_head = (g_queue_head + 1) % HOST_AUTH_QUEUE_SIZE;
+			g_queue_count--;
+		}
+		pthread_cond_broadcast(&g_queue_not_full);
+		pthread_mutex_unlock(&g_queue_lock);
+
+		host_auth_run_batch(batch, count);
+	}
+	free(batch);
+
+	return NULL;
+}
+
+static void host_auth_enqueue(const char* line)
+{
+	pthread_mutex_lock(&g_queue_lock);
+	while (g_queue_count == HOST_AUTH_QUEUE_SIZE)
+		pthread_cond_wait(&g_queue_not_full, &g_queue_lock);
+	strcpy(g_queue[(g_queue_head + g_queue_count) % HOST_AUTH_QUEUE_SIZE].line, line);
+	g_queue_count++;
+	pthread_cond_signal(&g_queue_not_empty);
+	pthread_mutex_unlock(&g_queue_lock);
+}
+
+static void usage(const char* prog)
+{
+	fprintf(stderr, "usage: %s [-t threads] [-w window_ms]\n"
+	        "  -t  worker threads verifying responses (default 1)\n"
+	        "  -w  time a device has to answer a challenge, in ms (default 30000)\n", prog);
+}
+
+/** \brief Authenticates devices whose certificates chain to the root CA built into the engine.
+ *
+ * \return For success return 0
+ */
+int main(int argc, char* argv[])
+{
+	char line[HOST_AUTH_LINE_SIZE];
+	pthread_t threads[HOST_AUTH_MAX_THREADS];
+	int thread_count = 1;
+	unsigned long window_ms = 30000;
+	int opt;
+	int i;
+	int ret;
+
+	while ((opt = getopt(argc, argv, "t:w:h")) != -1) {
+		switch (opt) {
+		case 't': thread_count = atoi(optarg); break;
+		case 'w': window_ms = strtoul(optarg, NULL, 0); break;
+		default: usage(argv[0]); return 1;
+		}
+	}
+	if (thread_count < 1 || thread_count > HOST_AUTH_MAX_THREADS || window_ms == 0 || window_ms > 0x7FFFFFFF) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	ret = atcacert_auth_init(&g_auth, &g_cert_def_1_signer_t, &g_cert_def_0_device_t, g_signer_1_ca_public_key_t,
+	                         (uint32_t)window_ms);
+	if (ret != ATCACERT_E_SUCCESS) {
+		fprintf(stderr, "atcacert_auth_init failed: %d\n", ret);
+		return 1;
+	}
+
+	if (thread_count == 1) {
+		while (fgets(line, sizeof(line), stdin) != NULL)
+			host_auth_dispatch(line);
+	}else  {
+		for (i = 0; i < thread_count; i++)
+			pthread_create(&threads[i], NULL, host_auth_worker, NULL);
+		while (fgets(line, sizeof(line), stdin) != NULL)
+			host_auth_enqueue(line);
+
+		pthread_mutex_lock(&g_queue_lock);
+		g_queue_closed = 1;
+		pthread_cond_broadcast(&g_queue_not_empty);
+		pthread_mutex_unlock(&g_queue_lock);
+		for (i = 0; i < thread_count; i++)
+			pthread_join(threads[i], NULL);
+	}
+
+	atcacert_auth_release(&g_auth);
+
+	return 0;
+}
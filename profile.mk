@@ -0,0 +1,44 @@
+#
+# profile.mk
+#
+
+#
+# Build profiles of the engine, cryptoauthlib and the client-server tools.
+# Select one on the make command line, e.g. make PROFILE=release
+#
+#   debug    -O0 -g, debug messages compiled in (default)
+#   release  -O2, link time optimization, hidden symbols (the engine only
+#            exports its OpenSSL entry points), stack protector, fortify
+#            and full RELRO
+#   profile  -O2 -g with frame pointers, for perf record -g
+#
+# Every Makefile includes this file and passes PROFILE on to the ones it
+# runs, so the whole tree is built with one profile. The objects do not
+# record the flags they were built with, run make clean when switching
+# profiles (scripts/compare_profiles does).
+#
+
+PROFILE?=	debug
+
+ifeq ($(PROFILE),debug)
+OPT_CFLAGS=	-g -O0
+OPT_LDFLAGS=
+PROFILE_DEFS=	-DECC_DEBUG
+PROFILE_AR=	ar
+PROFILE_RANLIB=	ranlib
+else ifeq ($(PROFILE),release)
+OPT_CFLAGS=	-O2 -flto -fvisibility=hidden -fstack-protector-strong -D_FORTIFY_SOURCE=2
+OPT_LDFLAGS=	-O2 -flto -Wl,-z,relro -Wl,-z,now
+PROFILE_DEFS=
+# The archives hold LTO objects, their symbol index needs the LTO plugin
+PROFILE_AR=	gcc-ar
+PROFILE_RANLIB=	gcc-ranlib
+else ifeq ($(PROFILE),profile)
+OPT_CFLAGS=	-g -O2 -fno-omit-frame-pointer
+OPT_LDFLAGS=
+PROFILE_DEFS=
+PROFILE_AR=	ar
+PROFILE_RANLIB=	ranlib
+else
+$(error PROFILE=$(PROFILE), must be debug, release or profile)
+endif
@@ -0,0 +1,27 @@
+#!/bin/bash
+# Builds the ateccx08 engine without USE_ECCX08 into a directory of its own.
+# That engine does all of its crypto in software, so the performance suite
+# (run_perf) can run the whole cipher matrix without a device attached.
+# The engine for the device is rebuilt afterwards.
+#
+# PROFILE (see profile.mk) selects the build profile of the stand-in,
+# debug by default.
+
+set -e
+set -x
+cd $(dirname $0)
+source ./common.sh
+
+STAND_IN_DIR=${TREE_TOP}/install_dir/lib/engines-stand-in
+
+make -w -C ${TREE_TOP} clean_engine_atecc
+make -w -C ${TREE_TOP} build_engine_atecc HW="" PROFILE=${PROFILE:-debug}
+mkdir -p ${STAND_IN_DIR}
+cp -f ${TREE_TOP}/engine_atecc/libateccx08.so ${STAND_IN_DIR}
+
+make -w -C ${TREE_TOP} clean_engine_atecc
+make -w -C ${TREE_TOP} build_engine_atecc
+
+STATUS=$?
+echo "EXIT STATUS: ${STATUS}"
+exit ${STATUS}
@@ -44,6 +44,11 @@ if [ -z "$USE_EXAMPLE" ]; then
     export USE_EXAMPLE=0
 fi
 
+# Extra exchange-tls12 options for USE_EXAMPLE=1, e.g. "-L 4 -T 10" or "-W 2"
+if [ -z "$EX_OPTS" ]; then
+    export EX_OPTS=
+fi
+
 if [ -z "$USE_ENGINE" ]; then
     export USE_ENGINE=0
 fi
@@ -66,7 +66,7 @@ else
     -f ${DEVICE_CERT_PEM} \
     -k ${DEVICE_KEY} \
     -I ${IP_ADDRESS} \
-    -P ${PORT_NUMBER}
+    -P ${PORT_NUMBER} ${EX_OPTS}
 fi
 STATUS=$?
 echo "EXIT STATUS: ${STATUS}"